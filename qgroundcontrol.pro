@@ -424,8 +424,11 @@ HEADERS += \
     src/ADSB/ADSBVehicle.h \
     src/ADSB/ADSBVehicleManager.h \
     src/AnalyzeView/LogDownloadController.h \
+    src/AnalyzeView/MAVLinkChartSeries.h \
     src/AnalyzeView/PX4LogParser.h \
+    src/AnalyzeView/TLogAnalyzer.h \
     src/AnalyzeView/ULogParser.h \
+    src/AnalyzeView/ULogReader.h \
     src/AnalyzeView/MavlinkConsoleController.h \
     src/Audio/AudioOutput.h \
     src/Vehicle/Autotune.h \
@@ -467,6 +470,7 @@ HEADERS += \
     src/MissionManager/PlanCreator.h \
     src/MissionManager/PlanManager.h \
     src/MissionManager/PlanMasterController.h \
+    src/MissionManager/PlanUndoHistory.h \
     src/MissionManager/QGCFenceCircle.h \
     src/MissionManager/QGCFencePolygon.h \
     src/MissionManager/QGCMapCircle.h \
@@ -547,6 +551,8 @@ HEADERS += \
     src/Settings/VideoSettings.h \
     src/Utilities/ShapeFileHelper.h \
     src/Utilities/SHPFileHelper.h \
+    src/Terrain/TerrainDEMFile.h \
+    src/Terrain/TerrainDEMQuery.h \
     src/Terrain/TerrainQuery.h \
     src/Terrain/TerrainTile.h \
     src/Vehicle/Actuators/ActuatorActions.h \
@@ -603,8 +609,11 @@ HEADERS += \
     src/comm/LinkConfiguration.h \
     src/comm/LinkInterface.h \
     src/comm/LinkManager.h \
+    src/comm/LogReplayIndex.h \
     src/comm/LogReplayLink.h \
+    src/comm/MAVLinkParser.h \
     src/comm/MAVLinkProtocol.h \
+    src/comm/MAVLinkTLogWriter.h \
     src/comm/QGCMAVLink.h \
     src/comm/TCPLink.h \
     src/comm/UDPLink.h \
@@ -687,8 +696,11 @@ SOURCES += \
     src/ADSB/ADSBVehicle.cc \
     src/ADSB/ADSBVehicleManager.cc \
     src/AnalyzeView/LogDownloadController.cc \
+    src/AnalyzeView/MAVLinkChartSeries.cc \
     src/AnalyzeView/PX4LogParser.cc \
+    src/AnalyzeView/TLogAnalyzer.cc \
     src/AnalyzeView/ULogParser.cc \
+    src/AnalyzeView/ULogReader.cc \
     src/AnalyzeView/MavlinkConsoleController.cc \
     src/Audio/AudioOutput.cc \
     src/Vehicle/Autotune.cpp \
@@ -729,6 +741,7 @@ SOURCES += \
     src/MissionManager/PlanCreator.cc \
     src/MissionManager/PlanManager.cc \
     src/MissionManager/PlanMasterController.cc \
+    src/MissionManager/PlanUndoHistory.cc \
     src/MissionManager/QGCFenceCircle.cc \
     src/MissionManager/QGCFencePolygon.cc \
     src/MissionManager/QGCMapCircle.cc \
@@ -806,6 +819,8 @@ SOURCES += \
     src/Settings/VideoSettings.cc \
     src/Utilities/ShapeFileHelper.cc \
     src/Utilities/SHPFileHelper.cc \
+    src/Terrain/TerrainDEMFile.cc \
+    src/Terrain/TerrainDEMQuery.cc \
     src/Terrain/TerrainQuery.cc \
     src/Terrain/TerrainTile.cc \
     src/Vehicle/Actuators/ActuatorActions.cc \
@@ -862,8 +877,11 @@ SOURCES += \
     src/comm/LinkConfiguration.cc \
     src/comm/LinkInterface.cc \
     src/comm/LinkManager.cc \
+    src/comm/LogReplayIndex.cc \
     src/comm/LogReplayLink.cc \
+    src/comm/MAVLinkParser.cc \
     src/comm/MAVLinkProtocol.cc \
+    src/comm/MAVLinkTLogWriter.cc \
     src/comm/QGCMAVLink.cc \
     src/comm/TCPLink.cc \
     src/comm/UDPLink.cc \
@@ -1112,9 +1130,11 @@ HEADERS += \
     src/FactSystem/Fact.h \
     src/FactSystem/FactControls/FactPanelController.h \
     src/FactSystem/FactGroup.h \
+    src/FactSystem/FactGroupUpdateScheduler.h \
     src/FactSystem/FactMetaData.h \
     src/FactSystem/FactSystem.h \
     src/FactSystem/FactValueSliderListModel.h \
+    src/FactSystem/ParameterCacheFile.h \
     src/FactSystem/ParameterManager.h \
     src/FactSystem/SettingsFact.h \
 
@@ -1122,9 +1142,11 @@ SOURCES += \
     src/FactSystem/Fact.cc \
     src/FactSystem/FactControls/FactPanelController.cc \
     src/FactSystem/FactGroup.cc \
+    src/FactSystem/FactGroupUpdateScheduler.cc \
     src/FactSystem/FactMetaData.cc \
     src/FactSystem/FactSystem.cc \
     src/FactSystem/FactValueSliderListModel.cc \
+    src/FactSystem/ParameterCacheFile.cc \
     src/FactSystem/ParameterManager.cc \
     src/FactSystem/SettingsFact.cc \
 
@@ -183,25 +183,25 @@ void GeoTagWorker::run()
         }
     }
 
-    // Load log
-    bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
-    QFile file(_logFile);
-    if (!file.open(QIODevice::ReadOnly)) {
-        emit error(tr("Geotagging failed. Couldn't open log file."));
-        return;
-    }
-    QByteArray log = file.readAll();
-    file.close();
-
     // Instantiate appropriate parser
+    bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
     _triggerList.clear();
     bool parseComplete = false;
     QString errorString;
     if (isULog) {
+        // ULogs are memory mapped and only the camera topic is read, they can be larger than available memory
         ULogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList, errorString);
+        parseComplete = parser.getTagsFromLog(_logFile, _triggerList, errorString);
 
     } else {
+        QFile file(_logFile);
+        if (!file.open(QIODevice::ReadOnly)) {
+            emit error(tr("Geotagging failed. Couldn't open log file."));
+            return;
+        }
+        QByteArray log = file.readAll();
+        file.close();
+
         PX4LogParser parser;
         parseComplete = parser.getTagsFromLog(log, _triggerList);
 
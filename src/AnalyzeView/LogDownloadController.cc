@@ -27,57 +27,64 @@
 #define kGUIRateMilliseconds 17
 #define kTableBins           512
 #define kChunkSize           (kTableBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)
+#define kWindowChunks        8                              // Chunks covered by a streaming request
+#define kWindowLowWater      ((kWindowChunks / 2) * kChunkSize) // Extend the stream once this much is left of it
+#define kRepairMergeBins     32                             // Gaps closer than this are filled by a single request
 
 QGC_LOGGING_CATEGORY(LogDownloadLog, "LogDownloadLog")
 
 //-----------------------------------------------------------------------------
+/// Download state of a single log. The vehicle only serves one LOG_REQUEST_DATA at a time, a new request replaces
+/// the previous one. Data is streamed with requests of up to kWindowChunks chunks, which are extended before they run
+/// dry so the link never idles waiting on a round trip. Bins lost from the stream are re-requested as soon as the
+/// stream is extended, ahead of the rest of the stream, and again as soon as such a repair request drains.
 struct LogDownloadData {
     LogDownloadData(QGCLogEntry* entry);
-    QBitArray     chunk_table;
-    uint32_t      current_chunk;
+    QBitArray     bins;             ///< Received MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins of the whole log
+    uint32_t      binsReceived;
+    uint32_t      firstMissingBin;  ///< All bins before this one have been received
+    uint32_t      streamOffset;     ///< End of the contiguous data received from the stream
+    uint32_t      requestOffset;    ///< Range of the outstanding request
+    uint32_t      requestEnd;
+    bool          repairing;        ///< Outstanding request fills a gap behind the stream
     QFile         file;
     QString       filename;
     uint          ID;
     QGCLogEntry*  entry;
     uint          written;
-    size_t        rate_bytes;
-    qreal         rate_avg;
-    QElapsedTimer elapsed;
 
-    void advanceChunk()
+    bool complete() const
     {
-           current_chunk++;
-           chunk_table = QBitArray(chunkBins(), false);
+        return binsReceived == static_cast<uint32_t>(bins.size());
     }
 
-    // The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the current chunk
-    uint32_t chunkBins() const
+    // The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins covering offset
+    static uint32_t binCount(uint32_t offset)
     {
-        return qMin(qCeil((entry->size() - current_chunk*kChunkSize)/static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)),
-                    kTableBins);
+        return (offset + MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN - 1) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
     }
 
-    // The number of kChunkSize chunks in the file
-    uint32_t numChunks() const
+    uint32_t nextMissingBin()
     {
-        return qCeil(entry->size() / static_cast<qreal>(kChunkSize));
-    }
-
-    // True if all bins in the chunk have been set to val
-    bool chunkEquals(const bool val) const
-    {
-        return chunk_table == QBitArray(chunk_table.size(), val);
+        while(firstMissingBin < static_cast<uint32_t>(bins.size()) && bins.testBit(firstMissingBin)) {
+            firstMissingBin++;
+        }
+        return firstMissingBin;
     }
-
 };
 
 //----------------------------------------------------------------------------------------
 LogDownloadData::LogDownloadData(QGCLogEntry* entry_)
-    : ID(entry_->id())
+    : bins(static_cast<int>(binCount(entry_->size())), false)
+    , binsReceived(0)
+    , firstMissingBin(0)
+    , streamOffset(0)
+    , requestOffset(0)
+    , requestEnd(0)
+    , repairing(false)
+    , ID(entry_->id())
     , entry(entry_)
     , written(0)
-    , rate_bytes(0)
-    , rate_avg(0)
 {
 
 }
@@ -108,6 +115,10 @@ LogDownloadController::LogDownloadController(void)
     , _downloadingLogs(false)
     , _retries(0)
     , _apmOneBased(0)
+    , _bytesTotal(0)
+    , _bytesReceived(0)
+    , _rateBytes(0)
+    , _rateAvg(0)
 {
     MultiVehicleManager *manager = qgcApp()->toolbox()->multiVehicleManager();
     connect(manager, &MultiVehicleManager::activeVehicleChanged, this, &LogDownloadController::_setActiveVehicle);
@@ -290,21 +301,40 @@ LogDownloadController::_findMissingEntries()
 
 void LogDownloadController::_updateDataRate(void)
 {
-    if (_downloadData->elapsed.elapsed() >= kGUIRateMilliseconds) {
-        //-- Update download rate
-        qreal rrate = _downloadData->rate_bytes / (_downloadData->elapsed.elapsed() / 1000.0);
-        _downloadData->rate_avg = (_downloadData->rate_avg * 0.95) + (rrate * 0.05);
-        _downloadData->rate_bytes = 0;
+    if (_rateElapsed.elapsed() >= kGUIRateMilliseconds) {
+        //-- Update download rate, over all queued logs
+        qreal rrate = _rateBytes / (_rateElapsed.elapsed() / 1000.0);
+        _rateAvg = (_rateAvg * 0.95) + (rrate * 0.05);
+        _rateBytes = 0;
 
         //-- Update status
         const QString status = QString("%1 (%2/s)").arg(QGCMapEngine::bigSizeToString(_downloadData->written),
-                                                        QGCMapEngine::bigSizeToString(_downloadData->rate_avg));
+                                                        QGCMapEngine::bigSizeToString(_rateAvg));
 
         _downloadData->entry->setStatus(status);
-        _downloadData->elapsed.start();
+        _rateElapsed.start();
+        emit progressChanged();
     }
 }
 
+//----------------------------------------------------------------------------------------
+qreal
+LogDownloadController::progress() const
+{
+    return _bytesTotal ? static_cast<qreal>(_bytesReceived) / static_cast<qreal>(_bytesTotal) : 0;
+}
+
+//----------------------------------------------------------------------------------------
+QString
+LogDownloadController::progressStatus() const
+{
+    if(!_downloadingLogs) {
+        return QString();
+    }
+    return tr("%1 of %2 (%3/s)").arg(QGCMapEngine::bigSizeToString(_bytesReceived),
+                                     QGCMapEngine::bigSizeToString(_bytesTotal),
+                                     QGCMapEngine::bigSizeToString(_rateAvg));
+}
 
 //----------------------------------------------------------------------------------------
 void
@@ -325,75 +355,97 @@ LogDownloadController::_logData(uint32_t ofs, uint16_t id, uint8_t count, const
         return;
     }
 
-    bool result = false;
-    uint32_t timeout_time = kTimeOutMilliseconds;
-    if(ofs <= _downloadData->entry->size()) {
-        const uint32_t chunk = ofs / kChunkSize;
-        if (chunk != _downloadData->current_chunk) {
-            qWarning() << "Ignored packet for out of order chunk actual:expected" << chunk << _downloadData->current_chunk;
-            return;
-        }
-        const uint16_t bin = (ofs - chunk*kChunkSize) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-        if (bin >= _downloadData->chunk_table.size()) {
-            qWarning() << "Out of range bin received";
-        } else
-            _downloadData->chunk_table.setBit(bin);
+    if(ofs >= _downloadData->entry->size() || count == 0 || count > _downloadData->entry->size() - ofs) {
+        qWarning() << "Received log offset greater than expected";
+        _downloadData->entry->setStatus(tr("Error"));
+        return;
+    }
+
+    //-- The vehicle is sending, whether or not this is new data
+    _retries = 0;
+    _timer.start(kTimeOutMilliseconds);
+
+    const uint32_t bin = ofs / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    if(!_downloadData->bins.testBit(bin)) {
         if (_downloadData->file.pos() != ofs) {
             // Seek to correct position
             if (!_downloadData->file.seek(ofs)) {
                 qWarning() << "Error while seeking log file offset";
+                _downloadData->entry->setStatus(tr("Error"));
                 return;
             }
         }
-
-        //-- Write chunk to file
-        if(_downloadData->file.write((const char*)data, count)) {
-            _downloadData->written += count;
-            _downloadData->rate_bytes += count;
-            _updateDataRate();
-            result = true;
-            //-- reset retries
-            _retries = 0;
-            //-- Reset timer
-            _timer.start(timeout_time);
-            //-- Do we have it all?
-            if(_logComplete()) {
-                _downloadData->entry->setStatus(tr("Downloaded"));
-                //-- Check for more
-                _receivedAllData();
-            } else if (_chunkComplete()) {
-                _downloadData->advanceChunk();
-                _requestLogData(_downloadData->ID,
-                                _downloadData->current_chunk*kChunkSize,
-                                _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            } else if (bin < _downloadData->chunk_table.size() - 1 && _downloadData->chunk_table.at(bin+1)) {
-                // Likely to be grabbing fragments and got to the end of a gap
-                _findMissingData();
-            }
-        } else {
+        //-- Write data to file, each bin is only written once
+        if(_downloadData->file.write((const char*)data, count) != count) {
             qWarning() << "Error while writing log file chunk";
+            _downloadData->entry->setStatus(tr("Error"));
+            return;
         }
-    } else {
-        qWarning() << "Received log offset greater than expected";
+        _downloadData->bins.setBit(bin);
+        _downloadData->binsReceived++;
+        _downloadData->written += count;
+        _bytesReceived += count;
+        _rateBytes += count;
+        _updateDataRate();
     }
-    if(!result) {
-        _downloadData->entry->setStatus(tr("Error"));
-    }
-}
 
+    //-- Track the end of the contiguous stream. Packets past it while streaming mean the ones in between were lost.
+    if(ofs + count > _downloadData->streamOffset && (ofs <= _downloadData->streamOffset || !_downloadData->repairing)) {
+        _downloadData->streamOffset = ofs + count;
+    }
 
-//----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_chunkComplete() const
-{
-    return _downloadData->chunkEquals(true);
+    //-- Do we have it all?
+    if(_downloadData->complete()) {
+        _downloadData->entry->setStatus(tr("Downloaded"));
+        //-- Check for more
+        _receivedAllData();
+    } else if(_downloadData->repairing) {
+        //-- Gaps are requested starting at the first missing bin, so the gap is filled once it moves past it. If the
+        //   last packet of the request arrives first, the rest was lost and is requested again without a timeout.
+        if(_downloadData->nextMissingBin() >= LogDownloadData::binCount(_downloadData->requestEnd) ||
+           ofs + count == _downloadData->requestEnd) {
+            _requestNextData();
+        }
+    } else if(_downloadData->streamOffset >= _downloadData->requestEnd ||
+              (_downloadData->requestEnd < _downloadData->entry->size() && _downloadData->requestEnd - _downloadData->streamOffset <= kWindowLowWater)) {
+        //-- Stream ran dry or is about to
+        _requestNextData();
+    }
 }
 
 //----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_logComplete() const
+void
+LogDownloadController::_requestNextData(int retryCount)
 {
-    return _chunkComplete() && (_downloadData->current_chunk+1) == _downloadData->numChunks();
+    LogDownloadData* d = _downloadData;
+    const uint32_t size = d->entry->size();
+    const uint32_t missingBin = d->nextMissingBin();
+    const uint32_t streamBin = LogDownloadData::binCount(d->streamOffset);
+    if(missingBin < streamBin) {
+        //-- Fill the gaps behind the stream first. Rather than a round trip for each one, nearby gaps are filled by
+        //   the same request at the cost of resending the bins between them.
+        uint32_t endBin = missingBin + 1;
+        for(uint32_t bin = endBin; bin < streamBin && bin - missingBin < static_cast<uint32_t>(kTableBins); bin++) {
+            if(!d->bins.testBit(bin)) {
+                endBin = bin + 1;
+            } else if(bin - endBin >= kRepairMergeBins) {
+                break;
+            }
+        }
+        //-- End the request one bin past its last gap, so its last packet is one which is rarely missing. Once that
+        //   arrives the vehicle is done with the request and anything still missing in it was lost again.
+        endBin = qMin(endBin + 1, streamBin);
+        d->repairing     = true;
+        d->requestOffset = missingBin * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+        d->requestEnd    = qMin(endBin * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN, size);
+    } else {
+        //-- Continue the stream
+        d->repairing     = false;
+        d->requestOffset = d->streamOffset;
+        d->requestEnd    = qMin(d->streamOffset + kWindowChunks * kChunkSize, size);
+    }
+    _requestLogData(d->ID, d->requestOffset, d->requestEnd - d->requestOffset, retryCount);
+    _timer.start(kTimeOutMilliseconds);
 }
 
 //----------------------------------------------------------------------------------------
@@ -404,8 +456,7 @@ LogDownloadController::_receivedAllData()
     //-- Anything queued up for download?
     if(_prepareLogDownload()) {
         //-- Request Log
-        _requestLogData(_downloadData->ID, 0, _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-        _timer.start(kTimeOutMilliseconds);
+        _requestNextData();
     } else {
         _resetSelection();
         _setDownloading(false);
@@ -416,11 +467,9 @@ LogDownloadController::_receivedAllData()
 void
 LogDownloadController::_findMissingData()
 {
-    if (_logComplete()) {
+    if (_downloadData->complete()) {
          _receivedAllData();
          return;
-    } else if (_chunkComplete()) {
-        _downloadData->advanceChunk();
     }
 
     _retries++;
@@ -437,24 +486,7 @@ LogDownloadController::_findMissingData()
 #endif
 
     _updateDataRate();
-
-    uint16_t start = 0, end = 0;
-    const int size = _downloadData->chunk_table.size();
-    for (; start < size; start++) {
-        if (!_downloadData->chunk_table.testBit(start)) {
-            break;
-        }
-    }
-
-    for (end = start; end < size; end++) {
-        if (_downloadData->chunk_table.testBit(end)) {
-            break;
-        }
-    }
-
-    const uint32_t pos = _downloadData->current_chunk*kChunkSize + start*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-                   len = (end - start)*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-    _requestLogData(_downloadData->ID, pos, len, _retries);
+    _requestNextData(_retries);
 }
 
 //----------------------------------------------------------------------------------------
@@ -543,15 +575,21 @@ void LogDownloadController::downloadToDirectory(const QString& dir)
         if(!_downloadPath.endsWith(QDir::separator()))
             _downloadPath += QDir::separator();
         //-- Iterate selected entries and shown them as waiting
+        _bytesTotal = 0;
+        _bytesReceived = 0;
+        _rateBytes = 0;
+        _rateAvg = 0;
         int num_logs = _logEntriesModel.count();
         for(int i = 0; i < num_logs; i++) {
             QGCLogEntry* entry = _logEntriesModel.value<QGCLogEntry*>(i);
             if(entry) {
                 if(entry->selected()) {
                    entry->setStatus(tr("Waiting"));
+                   _bytesTotal += entry->size();
                 }
             }
         }
+        _rateElapsed.start();
         //-- Start download process
         _setDownloading(true);
         _receivedAllData();
@@ -628,9 +666,6 @@ LogDownloadController::_prepareLogDownload()
         if(!_downloadData->file.resize(entry->size())) {
             qWarning() << "Failed to allocate space for log file:" <<  _downloadData->filename;
         } else {
-            _downloadData->current_chunk = 0;
-            _downloadData->chunk_table = QBitArray(_downloadData->chunkBins(), false);
-            _downloadData->elapsed.start();
             result = true;
         }
     }
@@ -639,8 +674,12 @@ LogDownloadController::_prepareLogDownload()
             _downloadData->file.remove();
         }
         _downloadData->entry->setStatus(tr("Error"));
+        //-- Leave it out of the overall progress
+        _bytesTotal -= qMin(_bytesTotal, static_cast<quint64>(entry->size()));
         delete _downloadData;
         _downloadData = nullptr;
+        //-- Move on to the next one
+        return _prepareLogDownload();
     }
     return result;
 }
@@ -653,6 +692,7 @@ LogDownloadController::_setDownloading(bool active)
         _downloadingLogs = active;
         _vehicle->vehicleLinkManager()->setCommunicationLostEnabled(!active);
         emit downloadingLogsChanged();
+        emit progressChanged();
     }
 }
 
@@ -75,6 +75,8 @@ private:
 };
 
 //-----------------------------------------------------------------------------
+/// Lists and downloads logs over MAVLink. Selected logs are queued and downloaded back to back, progress and rate
+/// are reported over the whole queue.
 class LogDownloadController : public QObject
 {
     Q_OBJECT
@@ -85,10 +87,16 @@ public:
     Q_PROPERTY(QmlObjectListModel* model    READ model              NOTIFY modelChanged)
     Q_PROPERTY(bool         requestingList  READ requestingList     NOTIFY requestingListChanged)
     Q_PROPERTY(bool         downloadingLogs READ downloadingLogs    NOTIFY downloadingLogsChanged)
+    Q_PROPERTY(qreal        progress        READ progress           NOTIFY progressChanged)
+    Q_PROPERTY(QString      progressStatus  READ progressStatus     NOTIFY progressChanged)
 
     QmlObjectListModel* model           () { return &_logEntriesModel; }
     bool                requestingList  () const{ return _requestingLogEntries; }
     bool                downloadingLogs () const{ return _downloadingLogs; }
+    /// Fraction of the queued logs downloaded, 0 to 1
+    qreal               progress        () const;
+    /// Bytes downloaded, total and rate over the queued logs
+    QString             progressStatus  () const;
 
     Q_INVOKABLE void refresh                ();
     Q_INVOKABLE void download               (QString path = QString());
@@ -102,6 +110,7 @@ signals:
     void downloadingLogsChanged ();
     void modelChanged           ();
     void selectionChanged       ();
+    void progressChanged        ();
 
 private slots:
     void _setActiveVehicle  (Vehicle* vehicle);
@@ -111,8 +120,6 @@ private slots:
 
 private:
     bool _entriesComplete   ();
-    bool _chunkComplete     () const;
-    bool _logComplete       () const;
     void _findMissingEntries();
     void _receivedAllEntries();
     void _receivedAllData   ();
@@ -120,6 +127,7 @@ private:
     void _findMissingData   ();
     void _requestLogList    (uint32_t start, uint32_t end);
     void _requestLogData    (uint16_t id, uint32_t offset, uint32_t count, int retryCount = 0);
+    void _requestNextData   (int retryCount = 0);
     bool _prepareLogDownload();
     void _setDownloading    (bool active);
     void _setListing        (bool active);
@@ -136,6 +144,11 @@ private:
     int                 _retries;
     int                 _apmOneBased;
     QString             _downloadPath;
+    quint64             _bytesTotal;        ///< Size of the logs queued for download
+    quint64             _bytesReceived;     ///< Bytes received of the queued logs
+    size_t              _rateBytes;
+    qreal               _rateAvg;
+    QElapsedTimer       _rateElapsed;
 };
 
 #endif
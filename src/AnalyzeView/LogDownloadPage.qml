@@ -213,6 +213,17 @@ AnalyzePage {
                     enabled:    logController.requestingList || logController.downloadingLogs
                     onClicked:  logController.cancel()
                 }
+
+                ProgressBar {
+                    width:      _butttonWidth
+                    value:      logController.progress
+                    visible:    logController.downloadingLogs
+                }
+
+                QGCLabel {
+                    text:       logController.progressStatus
+                    visible:    logController.downloadingLogs
+                }
             }
         }
     }
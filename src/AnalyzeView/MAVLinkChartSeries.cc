@@ -0,0 +1,83 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkChartSeries.h"
+
+#include <QtGlobal>
+
+//-----------------------------------------------------------------------------
+MAVLinkChartSeries::MAVLinkChartSeries(int capacity)
+    : _times(qMax(1, capacity))
+    , _values(qMax(1, capacity))
+{
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkChartSeries::append(qreal time, qreal value)
+{
+    const int cap = capacity();
+    const quint64 sequence = _nextSequence++;
+    if(_count < cap) {
+        const int index = (_head + _count) % cap;
+        _times[index]  = time;
+        _values[index] = value;
+        _count++;
+    } else {
+        //-- Overwrite the oldest sample
+        _times[_head]  = time;
+        _values[_head] = value;
+        _head = (_head + 1) % cap;
+    }
+    //-- Drop extremes which came from overwritten samples
+    if(sequence >= static_cast<quint64>(cap)) {
+        const quint64 oldest = sequence - static_cast<quint64>(cap) + 1;
+        while(!_minQueue.empty() && _minQueue.front().sequence < oldest) {
+            _minQueue.pop_front();
+        }
+        while(!_maxQueue.empty() && _maxQueue.front().sequence < oldest) {
+            _maxQueue.pop_front();
+        }
+    }
+    //-- A value can never be the extreme again once a newer sample is at least as extreme
+    while(!_minQueue.empty() && _minQueue.back().value >= value) {
+        _minQueue.pop_back();
+    }
+    _minQueue.push_back({ sequence, value });
+    while(!_maxQueue.empty() && _maxQueue.back().value <= value) {
+        _maxQueue.pop_back();
+    }
+    _maxQueue.push_back({ sequence, value });
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkChartSeries::clear()
+{
+    _head  = 0;
+    _count = 0;
+    _minQueue.clear();
+    _maxQueue.clear();
+}
+
+//-----------------------------------------------------------------------------
+QList<QPointF>
+MAVLinkChartSeries::points() const
+{
+    const int cap = capacity();
+    QList<QPointF> result;
+    result.reserve(_count);
+    for(int i = 0, index = _head; i < _count; i++, index++) {
+        if(index >= cap) {
+            index = 0;
+        }
+        result.append(QPointF(_times[index], _values[index]));
+    }
+    return result;
+}
@@ -0,0 +1,56 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QList>
+#include <QPointF>
+#include <QVector>
+
+#include <deque>
+
+//-----------------------------------------------------------------------------
+/// Fixed capacity history of chart samples for a single MAVLink Inspector field. Once full the oldest sample is
+/// overwritten. Times and values are held in separate arrays. The minimum and maximum of the held values are
+/// maintained incrementally with monotonic queues, so appending a sample is amortized O(1) no matter how many
+/// samples are held.
+class MAVLinkChartSeries
+{
+public:
+    explicit MAVLinkChartSeries(int capacity = defaultCapacity);
+
+    int     capacity    () const { return _times.count(); }
+    int     count       () const { return _count; }
+    /// @return Minimum of the held values, 0 when empty
+    qreal   minimum     () const { return _minQueue.empty() ? 0 : _minQueue.front().value; }
+    /// @return Maximum of the held values, 0 when empty
+    qreal   maximum     () const { return _maxQueue.empty() ? 0 : _maxQueue.front().value; }
+
+    void    append      (qreal time, qreal value);
+    void    clear       ();
+
+    /// @return Held samples, oldest first
+    QList<QPointF> points() const;
+
+    static constexpr int defaultCapacity = 50 * 60;     ///< 1 minute of data at 50Hz
+
+private:
+    struct Extreme_t {
+        quint64 sequence;                               ///< Sequence number of the sample the value came from
+        qreal   value;
+    };
+
+    QVector<qreal>          _times;
+    QVector<qreal>          _values;
+    int                     _head           = 0;        ///< Index of the oldest sample
+    int                     _count          = 0;
+    quint64                 _nextSequence   = 0;
+    std::deque<Extreme_t>   _minQueue;                  ///< Values increase from front to back, front is the minimum
+    std::deque<Extreme_t>   _maxQueue;                  ///< Values decrease from front to back, front is the maximum
+};
@@ -36,7 +36,8 @@ QGCMAVLinkMessageField::addSeries(MAVLinkChartController* chart, QAbstractSeries
         _chart = chart;
         _pSeries = series;
         emit seriesChanged();
-        _dataIndex = 0;
+        _samples.clear();
+        _samplesChanged = false;
         _msg->updateFieldSelection();
     }
 }
@@ -46,9 +47,10 @@ void
 QGCMAVLinkMessageField::delSeries()
 {
     if(_pSeries) {
-        _values.clear();
+        _samples.clear();
+        _samplesChanged = false;
         QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(_values);
+        lineSeries->clear();
         _pSeries = nullptr;
         _chart   = nullptr;
         emit seriesChanged();
@@ -85,33 +87,25 @@ QGCMAVLinkMessageField::chartIndex()
 
 //-----------------------------------------------------------------------------
 void
-QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
+QGCMAVLinkMessageField::setValue(const QString& newValue)
 {
     if(_value != newValue) {
         _value = newValue;
         emit valueChanged();
     }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessageField::appendSample(qreal v)
+{
     if(_pSeries && _chart) {
-        int count = _values.count();
-        //-- Arbitrary limit of 1 minute of data at 50Hz for now
-        if(count < (50 * 60)) {
-            QPointF p(QGC::bootTimeMilliseconds(), v);
-            _values.append(p);
-        } else {
-            if(_dataIndex >= count) _dataIndex = 0;
-            _values[_dataIndex].setX(QGC::bootTimeMilliseconds());
-            _values[_dataIndex].setY(v);
-            _dataIndex++;
-        }
+        _samples.append(QGC::bootTimeMilliseconds(), v);
+        _samplesChanged = true;
         //-- Auto Range
         if(_chart->rangeYIndex() == 0) {
-            qreal vmin  = std::numeric_limits<qreal>::max();
-            qreal vmax  = std::numeric_limits<qreal>::min();
-            for(int i = 0; i < _values.count(); i++) {
-                qreal v = _values[i].y();
-                if(vmax < v) vmax = v;
-                if(vmin > v) vmin = v;
-            }
+            const qreal vmin = _samples.minimum();
+            const qreal vmax = _samples.maximum();
             bool changed = false;
             if(std::abs(_rangeMin - vmin) > 0.000001) {
                 _rangeMin = vmin;
@@ -132,18 +126,11 @@ QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
 void
 QGCMAVLinkMessageField::updateSeries()
 {
-    int count = _values.count();
-    if (count > 1) {
-        QList<QPointF> s;
-        s.reserve(count);
-        int idx = _dataIndex;
-        for(int i = 0; i < count; i++, idx++) {
-            if(idx >= count) idx = 0;
-            QPointF p(_values[idx]);
-            s.append(p);
-        }
+    //-- Only rebuild the series when there is something new to show
+    if(_samplesChanged && _samples.count() > 1) {
+        _samplesChanged = false;
         QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(s);
+        lineSeries->replace(_samples.points());
     }
 }
 
@@ -157,6 +144,7 @@ QGCMAVLinkMessage::QGCMAVLinkMessage(QObject *parent, mavlink_message_t* message
         qCWarning(MAVLinkInspectorLog) << QStringLiteral("QGCMAVLinkMessage NULL msgInfo msgid(%1)").arg(message->msgid);
         return;
     }
+    _msgInfo = msgInfo;
     _name = QString(msgInfo->name);
     qCDebug(MAVLinkInspectorLog) << "New Message:" << _name;
     for (unsigned int i = 0; i < msgInfo->num_fields; ++i) {
@@ -175,6 +163,10 @@ QGCMAVLinkMessage::QGCMAVLinkMessage(QObject *parent, mavlink_message_t* message
             case MAVLINK_TYPE_INT64_T:  type = QString("int64_t");  break;
         }
         QGCMAVLinkMessageField* f = new QGCMAVLinkMessageField(this, msgInfo->fields[i].name, type);
+        //-- Text can't be charted
+        if (msgInfo->fields[i].type == MAVLINK_TYPE_CHAR) {
+            f->setSelectable(false);
+        }
         _fields.append(f);
     }
 }
@@ -189,16 +181,14 @@ QGCMAVLinkMessage::~QGCMAVLinkMessage()
 void
 QGCMAVLinkMessage::updateFieldSelection()
 {
-    bool sel = false;
+    _chartedFields.clear();
     for (int i = 0; i < _fields.count(); ++i) {
         QGCMAVLinkMessageField* f = qobject_cast<QGCMAVLinkMessageField*>(_fields.get(i));
-        if(f) {
-            if(f->selected()) {
-                sel = true;
-                break;
-            }
+        if(f && f->selected()) {
+            _chartedFields.append(i);
         }
     }
+    bool sel = !_chartedFields.isEmpty();
     if(sel != _fieldSelected) {
         _fieldSelected = sel;
         emit fieldSelectedChanged();
@@ -219,7 +209,9 @@ void QGCMAVLinkMessage::setSelected(bool sel)
 {
     if (_selected != sel) {
         _selected = sel;
-        _updateFields();
+        if (_selected) {
+            _updateFields();
+        }
         emit selectedChanged();
     }
 }
@@ -231,11 +223,97 @@ QGCMAVLinkMessage::update(mavlink_message_t* message)
     _count++;
     _message = *message;
 
-    if (_selected) {
-        // Don't update field info unless selected to reduce perf hit of message processing
-        _updateFields();
+    // Chart samples are taken from every message, value strings and the count are only updated by refresh()
+    if (_fieldSelected) {
+        _updateSamples();
+    }
+    _stale = true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessage::refresh()
+{
+    if (_stale) {
+        _stale = false;
+        if (_selected) {
+            // Don't update field info unless selected to reduce perf hit of message processing
+            _updateFields();
+        }
+        emit countChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessage::_updateSamples(void)
+{
+    if (!_msgInfo || _fields.count() != static_cast<int>(_msgInfo->num_fields)) {
+        return;
+    }
+    const uint8_t* m = reinterpret_cast<const uint8_t*>(&_message.payload64[0]);
+    for (int i: std::as_const(_chartedFields)) {
+        QGCMAVLinkMessageField* f = qobject_cast<QGCMAVLinkMessageField*>(_fields.get(i));
+        if (f) {
+            f->appendSample(_fieldSample(_msgInfo->fields[i], m));
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// @return Value charted for the field, the first element for arrays
+qreal
+QGCMAVLinkMessage::_fieldSample(const mavlink_field_info_t& fieldInfo, const uint8_t* payload)
+{
+    const uint8_t* p = payload + fieldInfo.wire_offset;
+    switch (fieldInfo.type) {
+    case MAVLINK_TYPE_UINT8_T:
+        return static_cast<qreal>(*p);
+    case MAVLINK_TYPE_INT8_T:
+        return static_cast<qreal>(*reinterpret_cast<const int8_t*>(p));
+    case MAVLINK_TYPE_UINT16_T: {
+        uint16_t n;
+        memcpy(&n, p, sizeof(n));
+        return static_cast<qreal>(n);
+    }
+    case MAVLINK_TYPE_INT16_T: {
+        int16_t n;
+        memcpy(&n, p, sizeof(n));
+        return static_cast<qreal>(n);
+    }
+    case MAVLINK_TYPE_UINT32_T: {
+        uint32_t n;
+        memcpy(&n, p, sizeof(n));
+        return static_cast<qreal>(n);
+    }
+    case MAVLINK_TYPE_INT32_T: {
+        int32_t n;
+        memcpy(&n, p, sizeof(n));
+        return static_cast<qreal>(n);
+    }
+    case MAVLINK_TYPE_FLOAT: {
+        float n;
+        memcpy(&n, p, sizeof(n));
+        return static_cast<qreal>(n);
+    }
+    case MAVLINK_TYPE_DOUBLE: {
+        double n;
+        memcpy(&n, p, sizeof(n));
+        return static_cast<qreal>(n);
+    }
+    case MAVLINK_TYPE_UINT64_T: {
+        uint64_t n;
+        memcpy(&n, p, sizeof(n));
+        return static_cast<qreal>(n);
+    }
+    case MAVLINK_TYPE_INT64_T: {
+        int64_t n;
+        memcpy(&n, p, sizeof(n));
+        return static_cast<qreal>(n);
+    }
+    default:
+        return 0;
     }
-    emit countChanged();
 }
 
 void QGCMAVLinkMessage::_updateFields(void)
@@ -258,18 +336,17 @@ void QGCMAVLinkMessage::_updateFields(void)
             static const unsigned int array_buffer_length = (MAVLINK_MAX_PAYLOAD_LEN + MAVLINK_NUM_CHECKSUM_BYTES + 7);
             switch (msgInfo->fields[i].type) {
             case MAVLINK_TYPE_CHAR:
-                f->setSelectable(false);
                 if (array_length > 0) {
                     char* str = reinterpret_cast<char*>(m + offset);
                     // Enforce null termination
                     str[array_length - 1] = '\0';
                     QString v(str);
-                    f->updateValue(v, 0);
+                    f->setValue(v);
                 } else {
                     // Single char
                     char b = *(reinterpret_cast<char*>(m + offset));
                     QString v(b);
-                    f->updateValue(v, 0);
+                    f->setValue(v);
                 }
                 break;
             case MAVLINK_TYPE_UINT8_T:
@@ -281,11 +358,11 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->setValue(string);
                 } else {
                     // Single value
                     uint8_t u = *(m + offset);
-                    f->updateValue(QString::number(u), static_cast<qreal>(u));
+                    f->setValue(QString::number(u));
                 }
                 break;
             case MAVLINK_TYPE_INT8_T:
@@ -297,11 +374,11 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->setValue(string);
                 } else {
                     // Single value
                     int8_t n = *(reinterpret_cast<int8_t*>(m + offset));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
+                    f->setValue(QString::number(n));
                 }
                 break;
             case MAVLINK_TYPE_UINT16_T:
@@ -314,12 +391,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->setValue(string);
                 } else {
                     // Single value
                     uint16_t n;
                     memcpy(&n, m + offset, sizeof(uint16_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
+                    f->setValue(QString::number(n));
                 }
                 break;
             case MAVLINK_TYPE_INT16_T:
@@ -332,12 +409,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->setValue(string);
                 } else {
                     // Single value
                     int16_t n;
                     memcpy(&n, m + offset, sizeof(int16_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
+                    f->setValue(QString::number(n));
                 }
                 break;
             case MAVLINK_TYPE_UINT32_T:
@@ -350,7 +427,7 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->setValue(string);
                 } else {
                     // Single value
                     uint32_t n;
@@ -358,9 +435,9 @@ void QGCMAVLinkMessage::_updateFields(void)
                     //-- Special case
                     if(_message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
                         QDateTime d = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(n),Qt::UTC,0);
-                        f->updateValue(d.toString("HH:mm:ss"), static_cast<qreal>(n));
+                        f->setValue(d.toString("HH:mm:ss"));
                     } else {
-                        f->updateValue(QString::number(n), static_cast<qreal>(n));
+                        f->setValue(QString::number(n));
                     }
                 }
                 break;
@@ -374,12 +451,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->setValue(string);
                 } else {
                     // Single value
                     int32_t n;
                     memcpy(&n, m + offset, sizeof(int32_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
+                    f->setValue(QString::number(n));
                 }
                 break;
             case MAVLINK_TYPE_FLOAT:
@@ -392,12 +469,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                        string += tmp.arg(static_cast<double>(nums[j]));
                     }
                     string += QString::number(static_cast<double>(nums[array_length - 1]));
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->setValue(string);
                 } else {
                     // Single value
                     float fv;
                     memcpy(&fv, m + offset, sizeof(float));
-                    f->updateValue(QString::number(static_cast<double>(fv)), static_cast<qreal>(fv));
+                    f->setValue(QString::number(static_cast<double>(fv)));
                 }
                 break;
             case MAVLINK_TYPE_DOUBLE:
@@ -410,12 +487,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(static_cast<double>(nums[array_length - 1]));
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->setValue(string);
                 } else {
                     // Single value
                     double d;
                     memcpy(&d, m + offset, sizeof(double));
-                    f->updateValue(QString::number(d), static_cast<qreal>(d));
+                    f->setValue(QString::number(d));
                 }
                 break;
             case MAVLINK_TYPE_UINT64_T:
@@ -428,7 +505,7 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->setValue(string);
                 } else {
                     // Single value
                     uint64_t n;
@@ -436,9 +513,9 @@ void QGCMAVLinkMessage::_updateFields(void)
                     //-- Special case
                     if(_message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
                         QDateTime d = QDateTime::fromMSecsSinceEpoch(n/1000,Qt::UTC,0);
-                        f->updateValue(d.toString("yyyy MM dd HH:mm:ss"), static_cast<qreal>(n));
+                        f->setValue(d.toString("yyyy MM dd HH:mm:ss"));
                     } else {
-                        f->updateValue(QString::number(n), static_cast<qreal>(n));
+                        f->setValue(QString::number(n));
                     }
                 }
                 break;
@@ -452,12 +529,12 @@ void QGCMAVLinkMessage::_updateFields(void)
                         string += tmp.arg(nums[j]);
                     }
                     string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
+                    f->setValue(string);
                 } else {
                     // Single value
                     int64_t n;
                     memcpy(&n, m + offset, sizeof(int64_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
+                    f->setValue(QString::number(n));
                 }
                 break;
             }
@@ -483,28 +560,22 @@ QGCMAVLinkSystem::~QGCMAVLinkSystem()
 QGCMAVLinkMessage*
 QGCMAVLinkSystem::findMessage(uint32_t id, uint8_t cid)
 {
-    for(int i = 0; i < _messages.count(); i++) {
-        QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(_messages.get(i));
-        if(m) {
-            if(m->id() == id && m->cid() == cid) {
-                return m;
-            }
-        }
-    }
-    return nullptr;
+    return _messageIndex.value(_messageKey(id, cid), nullptr);
 }
 
 //-----------------------------------------------------------------------------
 int
 QGCMAVLinkSystem::findMessage(QGCMAVLinkMessage* message)
 {
-    for(int i = 0; i < _messages.count(); i++) {
-        QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(_messages.get(i));
-        if(m && m == message) {
-            return i;
-        }
-    }
-    return -1;
+    return _messages.indexOf(message);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkSystem::clearMessages()
+{
+    _messageIndex.clear();
+    _messages.clearAndDeleteContents();
 }
 
 //-----------------------------------------------------------------------------
@@ -560,6 +631,7 @@ QGCMAVLinkSystem::append(QGCMAVLinkMessage* message)
         message->setSelected(true);
     }
     _messages.append(message);
+    _messageIndex.insert(_messageKey(message->id(), message->cid()), message);
     //-- Sort messages by id and then cid
     if (_messages.count() > 0) {
         _messages.beginReset();
@@ -648,7 +720,7 @@ MAVLinkChartController::updateYRange()
 {
     if(_chartFields.count()) {
         qreal vmin  = std::numeric_limits<qreal>::max();
-        qreal vmax  = std::numeric_limits<qreal>::min();
+        qreal vmax  = std::numeric_limits<qreal>::lowest();
         for(int i = 0; i < _chartFields.count(); i++) {
             QObject* object = qvariant_cast<QObject*>(_chartFields.at(i));
             QGCMAVLinkMessageField* pField = qobject_cast<QGCMAVLinkMessageField*>(object);
@@ -731,6 +803,8 @@ MAVLinkInspectorController::MAVLinkInspectorController()
     connect(mavlinkProtocol, &MAVLinkProtocol::messageReceived, this, &MAVLinkInspectorController::_receiveMessage);
     connect(&_updateFrequencyTimer, &QTimer::timeout, this, &MAVLinkInspectorController::_refreshFrequency);
     _updateFrequencyTimer.start(1000);
+    connect(&_refreshMessagesTimer, &QTimer::timeout, this, &MAVLinkInspectorController::_refreshMessages);
+    _refreshMessagesTimer.start(UPDATE_FREQUENCY);
     MultiVehicleManager *manager = qgcApp()->toolbox()->multiVehicleManager();
     connect(manager, &MultiVehicleManager::activeVehicleChanged, this, &MAVLinkInspectorController::_setActiveVehicle);
     _timeScaleSt.append(new TimeScale_st(this, tr("5 Sec"),   5 * 1000));
@@ -802,29 +876,49 @@ MAVLinkInspectorController::_setActiveVehicle(Vehicle* vehicle)
 //-----------------------------------------------------------------------------
 QGCMAVLinkSystem*
 MAVLinkInspectorController::_findVehicle(uint8_t id)
+{
+    return _systemIndex.value(id, nullptr);
+}
+
+//-----------------------------------------------------------------------------
+QGCMAVLinkSystem*
+MAVLinkInspectorController::_addSystem(uint8_t id)
+{
+    QGCMAVLinkSystem* v = new QGCMAVLinkSystem(this, id);
+    _systems.append(v);
+    _systemIndex.insert(id, v);
+    _systemNames.append(tr("System %1").arg(id));
+    return v;
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkInspectorController::_refreshFrequency()
 {
     for(int i = 0; i < _systems.count(); i++) {
         QGCMAVLinkSystem* v = qobject_cast<QGCMAVLinkSystem*>(_systems.get(i));
         if(v) {
-            if(v->id() == id) {
-                return v;
+            for(int i = 0; i < v->messages()->count(); i++) {
+                QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(v->messages()->get(i));
+                if(m) {
+                    m->updateFreq();
+                }
             }
         }
     }
-    return nullptr;
 }
 
 //-----------------------------------------------------------------------------
 void
-MAVLinkInspectorController::_refreshFrequency()
+MAVLinkInspectorController::_refreshMessages()
 {
     for(int i = 0; i < _systems.count(); i++) {
         QGCMAVLinkSystem* v = qobject_cast<QGCMAVLinkSystem*>(_systems.get(i));
         if(v) {
-            for(int i = 0; i < v->messages()->count(); i++) {
-                QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(v->messages()->get(i));
+            for(int j = 0; j < v->messages()->count(); j++) {
+                QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(v->messages()->get(j));
                 if(m) {
-                    m->updateFreq();
+                    m->refresh();
                 }
             }
         }
@@ -837,11 +931,9 @@ MAVLinkInspectorController::_vehicleAdded(Vehicle* vehicle)
 {
     QGCMAVLinkSystem* v = _findVehicle(static_cast<uint8_t>(vehicle->id()));
     if(v) {
-        v->messages()->clearAndDeleteContents();
+        v->clearMessages();
     } else {
-        v = new QGCMAVLinkSystem(this, static_cast<uint8_t>(vehicle->id()));
-        _systems.append(v);
-        _systemNames.append(tr("System %1").arg(vehicle->id()));
+        _addSystem(static_cast<uint8_t>(vehicle->id()));
     }
     emit systemsChanged();
 }
@@ -854,6 +946,7 @@ MAVLinkInspectorController::_vehicleRemoved(Vehicle* vehicle)
     if(v) {
         v->deleteLater();
         _systems.removeOne(v);
+        _systemIndex.remove(v->id());
         QString vs = tr("System %1").arg(vehicle->id());
         _systemNames.removeOne(vs);
         emit systemsChanged();
@@ -867,9 +960,7 @@ MAVLinkInspectorController::_receiveMessage(LinkInterface*, mavlink_message_t me
     QGCMAVLinkMessage* m = nullptr;
     QGCMAVLinkSystem* v = _findVehicle(message.sysid);
     if(!v) {
-        v = new QGCMAVLinkSystem(this, message.sysid);
-        _systems.append(v);
-        _systemNames.append(tr("System %1").arg(message.sysid));
+        v = _addSystem(message.sysid);
         emit systemsChanged();
         if(!_activeSystem) {
             _activeSystem = v;
@@ -14,11 +14,13 @@
 #pragma once
 
 #include "MAVLinkProtocol.h"
+#include "MAVLinkChartSeries.h"
 #include "Vehicle.h"
 
 #include <QObject>
 #include <QString>
 #include <QDebug>
+#include <QHash>
 #include <QVariantList>
 #include <QAbstractSeries>
 
@@ -30,7 +32,8 @@ class MAVLinkChartController;
 class MAVLinkInspectorController;
 
 //-----------------------------------------------------------------------------
-/// MAVLink message field
+/// MAVLink message field. The value string is only kept up to date while the message is selected, chart samples are
+/// collected from every message while the field is charted.
 class QGCMAVLinkMessageField : public QObject {
     Q_OBJECT
 public:
@@ -51,13 +54,14 @@ public:
     bool            selectable      () const{ return _selectable; }
     bool            selected        () { return _pSeries != nullptr; }
     QAbstractSeries*series          () { return _pSeries; }
-    QList<QPointF>* values          () { return &_values;}
+    const MAVLinkChartSeries& samples() const{ return _samples; }
     qreal           rangeMin        () const{ return _rangeMin; }
     qreal           rangeMax        () const{ return _rangeMax; }
     int             chartIndex      ();
 
     void            setSelectable   (bool sel);
-    void            updateValue     (QString newValue, qreal v);
+    void            setValue        (const QString& newValue);
+    void            appendSample    (qreal v);
 
     void            addSeries       (MAVLinkChartController* chart, QAbstractSeries* series);
     void            delSeries       ();
@@ -73,14 +77,14 @@ private:
     QString     _name;
     QString     _value;
     bool        _selectable = true;
-    int         _dataIndex  = 0;
+    bool        _samplesChanged = false;    ///< New samples since the series was last updated
     qreal       _rangeMin   = 0;
     qreal       _rangeMax   = 0;
 
     QAbstractSeries*    _pSeries = nullptr;
     QGCMAVLinkMessage*  _msg     = nullptr;
     MAVLinkChartController*      _chart   = nullptr;
-    QList<QPointF>      _values;
+    MAVLinkChartSeries  _samples;
 };
 
 //-----------------------------------------------------------------------------
@@ -114,6 +118,8 @@ public:
     void                update          (mavlink_message_t* message);
     void                updateFreq      ();
     void                setSelected     (bool sel);
+    /// Brings count and field values up to date with the last message received, called at display rate
+    void                refresh         ();
 
 signals:
     void countChanged                   ();
@@ -122,7 +128,10 @@ signals:
     void selectedChanged                ();
 
 private:
-    void _updateFields(void);
+    void _updateFields  (void);
+    void _updateSamples (void);
+
+    static qreal _fieldSample(const mavlink_field_info_t& fieldInfo, const uint8_t* payload);
 
     QmlObjectListModel  _fields;
     QString             _name;
@@ -130,8 +139,11 @@ private:
     uint64_t            _count          = 1;
     uint64_t            _lastCount      = 0;
     mavlink_message_t   _message;
+    const mavlink_message_info_t* _msgInfo = nullptr;
+    QList<int>          _chartedFields;                 ///< Indices of fields which are charted
     bool                _fieldSelected  = false;
     bool                _selected       = false;
+    bool                _stale          = false;        ///< Messages received since the last refresh
 };
 
 //-----------------------------------------------------------------------------
@@ -158,6 +170,7 @@ public:
     QGCMAVLinkMessage*  findMessage     (uint32_t id, uint8_t cid);
     int                 findMessage     (QGCMAVLinkMessage* message);
     void                append          (QGCMAVLinkMessage* message);
+    void                clearMessages   ();
 
 signals:
     void compIDsChanged                 ();
@@ -172,7 +185,10 @@ private:
     QList<int>          _compIDs;
     QStringList         _compIDsStr;
     QmlObjectListModel  _messages;      //-- List of QGCMAVLinkMessage
+    QHash<quint32, QGCMAVLinkMessage*> _messageIndex;   ///< Messages by _messageKey
     int                 _selected = 0;
+
+    static quint32 _messageKey(uint32_t id, uint8_t cid) { return (id << 8) | cid; }
 };
 
 //-----------------------------------------------------------------------------
@@ -293,9 +309,11 @@ private slots:
     void _vehicleRemoved    (Vehicle* vehicle);
     void _setActiveVehicle  (Vehicle* vehicle);
     void _refreshFrequency  ();
+    void _refreshMessages   ();
 
 private:
     QGCMAVLinkSystem* _findVehicle (uint8_t id);
+    QGCMAVLinkSystem* _addSystem   (uint8_t id);
 
 private:
 
@@ -305,8 +323,10 @@ private:
     QStringList         _rangeList;
     QGCMAVLinkSystem*   _activeSystem           = nullptr;
     QTimer              _updateFrequencyTimer;
+    QTimer              _refreshMessagesTimer;
     QStringList         _systemNames;
     QmlObjectListModel  _systems;                           ///< List of QGCMAVLinkSystem
+    QHash<uint8_t, QGCMAVLinkSystem*> _systemIndex;         ///< Systems by id
     QmlObjectListModel  _charts;                            ///< List of MAVLinkCharts
     QList<TimeScale_st*>_timeScaleSt;
     QList<Range_st*>    _rangeSt;
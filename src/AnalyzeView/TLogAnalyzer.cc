@@ -0,0 +1,504 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TLogAnalyzer.h"
+#include "LogReplayIndex.h"
+#include "QGCMAVLink.h"
+#include "QGCLoggingCategory.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+QGC_LOGGING_CATEGORY(TLogAnalyzerLog, "TLogAnalyzerLog")
+
+namespace {
+
+template<typename T>
+void appendNumbers(QByteArray& row, const uchar* field, unsigned int arrayLength)
+{
+    const unsigned int count = arrayLength > 0 ? arrayLength : 1;
+    for (unsigned int i = 0; i < count; i++) {
+        T value;
+        memcpy(&value, field + (i * sizeof(T)), sizeof(T));
+        if (i > 0) {
+            row.append(' ');
+        }
+        row.append(QByteArray::number(value));
+    }
+}
+
+template<typename T>
+void appendFloats(QByteArray& row, const uchar* field, unsigned int arrayLength)
+{
+    const unsigned int count = arrayLength > 0 ? arrayLength : 1;
+    for (unsigned int i = 0; i < count; i++) {
+        T value;
+        memcpy(&value, field + (i * sizeof(T)), sizeof(T));
+        if (i > 0) {
+            row.append(' ');
+        }
+        row.append(QByteArray::number(static_cast<double>(value), 'g', std::numeric_limits<T>::max_digits10));
+    }
+}
+
+}
+
+TLogAnalyzer::TLogAnalyzer(const QString& outputDir)
+    : _outputDir(outputDir)
+{
+
+}
+
+bool TLogAnalyzer::addField(const QString& fieldSpec, QString& errorMessage)
+{
+    const QStringList parts = fieldSpec.trimmed().split(QLatin1Char('.'));
+    if (parts.count() != 2) {
+        errorMessage = QStringLiteral("Field selection must be MESSAGE_NAME.field_name: %1").arg(fieldSpec);
+        return false;
+    }
+
+    const QByteArray messageName = parts[0].toUpper().toLatin1();
+    const mavlink_message_info_t* msgInfo = mavlink_get_message_info_by_name(messageName.constData());
+    if (!msgInfo) {
+        errorMessage = QStringLiteral("Unknown message: %1").arg(parts[0]);
+        return false;
+    }
+
+    for (unsigned int i = 0; i < msgInfo->num_fields; i++) {
+        if (parts[1] == QLatin1String(msgInfo->fields[i].name)) {
+            Selection_t& selection = _selections[msgInfo->msgid];
+            selection.msgid         = msgInfo->msgid;
+            selection.messageName   = QString(msgInfo->name);
+            if (!selection.fieldIndices.contains(static_cast<int>(i))) {
+                selection.fieldIndices.append(static_cast<int>(i));
+            }
+            return true;
+        }
+    }
+
+    errorMessage = QStringLiteral("Unknown field %1 in message %2").arg(parts[1], parts[0]);
+    return false;
+}
+
+QStringList TLogAnalyzer::_expandPaths(const QStringList& paths)
+{
+    QStringList logFilenames;
+
+    for (const QString& path: paths) {
+        QFileInfo fileInfo(path);
+        if (fileInfo.isDir()) {
+            QDir dir(path);
+            for (const QString& filename: dir.entryList(QStringList("*.tlog"), QDir::Files, QDir::Name)) {
+                logFilenames.append(dir.filePath(filename));
+            }
+        } else {
+            logFilenames.append(path);
+        }
+    }
+
+    return logFilenames;
+}
+
+/// Accounts for the step from the last in order sequence number to seq. A step of more than half the sequence
+/// space can't be told apart from a packet going backwards, so it is counted as a duplicate or reorder instead of
+/// as almost 256 lost packets.
+void TLogAnalyzer::_updateSequence(LinkStats_t& stats, uint8_t seq)
+{
+    const uint8_t gap = static_cast<uint8_t>(seq - stats.lastSeq - 1);
+    if (gap > _maxSequenceGap) {
+        stats.outOfOrder++;
+    } else {
+        stats.lost      += gap;
+        stats.lastSeq   = seq;
+    }
+}
+
+TLogAnalyzer::ChunkResult_t TLogAnalyzer::_analyzeChunk(const Chunk_t& chunk) const
+{
+    ChunkResult_t   result;
+    const uchar*    data    = chunk.data;
+    const qint64    size    = chunk.size;
+    qint64          pos     = chunk.start;
+
+    while (pos < chunk.end && pos + LogReplayIndex::cbTimestamp < size) {
+        const uchar*    frame       = data + pos + LogReplayIndex::cbTimestamp;
+        const int       frameLen    = LogReplayIndex::frameLength(frame, size - pos - LogReplayIndex::cbTimestamp);
+        if (!frameLen) {
+            // Corrupt record, resync on the next valid one
+            qint64 next = LogReplayIndex::nextRecord(data, size, pos + 1);
+            if (next < 0 || next > chunk.end) {
+                next = chunk.end;
+            }
+            result.badBytes += next - pos;
+            pos = next;
+            continue;
+        }
+
+        const quint64   timestamp   = LogReplayIndex::parseTimestamp(data + pos);
+        const bool      mavlink1    = frame[0] == MAVLINK_STX_MAVLINK1;
+        const int       payloadLen  = frame[1];
+        uint8_t         seq;
+        uint8_t         sysid;
+        uint8_t         compid;
+        uint32_t        msgid;
+        const uchar*    payload;
+
+        if (mavlink1) {
+            seq     = frame[2];
+            sysid   = frame[3];
+            compid  = frame[4];
+            msgid   = frame[5];
+            payload = frame + MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+        } else {
+            seq     = frame[4];
+            sysid   = frame[5];
+            compid  = frame[6];
+            msgid   = frame[7] | (frame[8] << 8) | (frame[9] << 16);
+            payload = frame + MAVLINK_CORE_HEADER_LEN + 1;
+        }
+
+        auto messageIt = result.messages.find(msgid);
+        if (messageIt == result.messages.end()) {
+            result.messages.insert(msgid, { 1, timestamp, timestamp });
+        } else {
+            messageIt->count++;
+            messageIt->firstUSecs   = qMin(messageIt->firstUSecs, timestamp);
+            messageIt->lastUSecs    = qMax(messageIt->lastUSecs, timestamp);
+        }
+
+        const uint16_t componentKey = static_cast<uint16_t>((sysid << 8) | compid);
+        auto linkIt = result.links.find(componentKey);
+        if (linkIt == result.links.end()) {
+            result.links.insert(componentKey, { 1, 0, 0, seq, seq });
+        } else {
+            linkIt->received++;
+            _updateSequence(*linkIt, seq);
+        }
+
+        auto selectionIt = _selections.constFind(msgid);
+        if (selectionIt != _selections.constEnd()) {
+            _decodeRow(*selectionIt, timestamp, sysid, compid, payload, payloadLen, result.rows[msgid]);
+        }
+
+        pos += LogReplayIndex::cbTimestamp + frameLen;
+    }
+
+    return result;
+}
+
+void TLogAnalyzer::_decodeRow(const Selection_t& selection, quint64 timestamp, uint8_t sysid, uint8_t compid, const uchar* payload, int payloadLen, QByteArray& row) const
+{
+    const mavlink_message_info_t* msgInfo = mavlink_get_message_info_by_id(selection.msgid);
+    if (!msgInfo) {
+        return;
+    }
+
+    // MAVLink 2 truncates trailing zero bytes from the payload, so decode from a zero filled copy
+    uchar buffer[MAVLINK_MAX_PAYLOAD_LEN] = {};
+    memcpy(buffer, payload, static_cast<size_t>(qMin(payloadLen, MAVLINK_MAX_PAYLOAD_LEN)));
+
+    row.append(QByteArray::number(timestamp));
+    row.append(',');
+    row.append(QByteArray::number(sysid));
+    row.append(',');
+    row.append(QByteArray::number(compid));
+
+    for (int fieldIndex: selection.fieldIndices) {
+        const mavlink_field_info_t& field = msgInfo->fields[fieldIndex];
+        const uchar* fieldData = buffer + field.wire_offset;
+
+        row.append(',');
+        switch (field.type) {
+        case MAVLINK_TYPE_CHAR:
+            if (field.array_length > 0) {
+                QByteArray str(reinterpret_cast<const char*>(fieldData), static_cast<int>(field.array_length));
+                str.truncate(static_cast<int>(qstrnlen(str.constData(), field.array_length)));
+                row.append('"');
+                row.append(str.replace('"', "\"\""));
+                row.append('"');
+            } else {
+                row.append(QByteArray::number(static_cast<int>(static_cast<const char>(*fieldData))));
+            }
+            break;
+        case MAVLINK_TYPE_UINT8_T:
+            appendNumbers<uint8_t>(row, fieldData, field.array_length);
+            break;
+        case MAVLINK_TYPE_INT8_T:
+            appendNumbers<int8_t>(row, fieldData, field.array_length);
+            break;
+        case MAVLINK_TYPE_UINT16_T:
+            appendNumbers<uint16_t>(row, fieldData, field.array_length);
+            break;
+        case MAVLINK_TYPE_INT16_T:
+            appendNumbers<int16_t>(row, fieldData, field.array_length);
+            break;
+        case MAVLINK_TYPE_UINT32_T:
+            appendNumbers<uint32_t>(row, fieldData, field.array_length);
+            break;
+        case MAVLINK_TYPE_INT32_T:
+            appendNumbers<int32_t>(row, fieldData, field.array_length);
+            break;
+        case MAVLINK_TYPE_UINT64_T:
+            appendNumbers<qulonglong>(row, fieldData, field.array_length);
+            break;
+        case MAVLINK_TYPE_INT64_T:
+            appendNumbers<qlonglong>(row, fieldData, field.array_length);
+            break;
+        case MAVLINK_TYPE_FLOAT:
+            appendFloats<float>(row, fieldData, field.array_length);
+            break;
+        case MAVLINK_TYPE_DOUBLE:
+            appendFloats<double>(row, fieldData, field.array_length);
+            break;
+        }
+    }
+
+    row.append('\n');
+}
+
+void TLogAnalyzer::_mergeResult(ChunkResult_t& merged, const ChunkResult_t& result) const
+{
+    for (auto it = result.messages.constBegin(); it != result.messages.constEnd(); it++) {
+        auto mergedIt = merged.messages.find(it.key());
+        if (mergedIt == merged.messages.end()) {
+            merged.messages.insert(it.key(), it.value());
+        } else {
+            mergedIt->count         += it->count;
+            mergedIt->firstUSecs    = qMin(mergedIt->firstUSecs, it->firstUSecs);
+            mergedIt->lastUSecs     = qMax(mergedIt->lastUSecs, it->lastUSecs);
+        }
+    }
+
+    // Chunks are merged in file order, so the gap across the chunk boundary is just like any other gap
+    for (auto it = result.links.constBegin(); it != result.links.constEnd(); it++) {
+        auto mergedIt = merged.links.find(it.key());
+        if (mergedIt == merged.links.end()) {
+            merged.links.insert(it.key(), it.value());
+        } else {
+            _updateSequence(*mergedIt, it->firstSeq);
+            mergedIt->lost          += it->lost;
+            mergedIt->outOfOrder    += it->outOfOrder;
+            mergedIt->received      += it->received;
+            mergedIt->lastSeq       = it->lastSeq;
+        }
+    }
+
+    for (auto it = result.rows.constBegin(); it != result.rows.constEnd(); it++) {
+        merged.rows[it.key()].append(it.value());
+    }
+
+    merged.badBytes += result.badBytes;
+}
+
+QString TLogAnalyzer::_outputPrefix(const QString& logFilename) const
+{
+    QFileInfo fileInfo(logFilename);
+    if (_outputDir.isEmpty()) {
+        return fileInfo.absolutePath() + QLatin1Char('/') + fileInfo.completeBaseName();
+    }
+    return QDir(_outputDir).filePath(fileInfo.completeBaseName());
+}
+
+bool TLogAnalyzer::_writeResults(const QString& logFilename, const ChunkResult_t& result, QString& errorMessage) const
+{
+    const QString prefix = _outputPrefix(logFilename);
+
+    QFile messagesFile(prefix + QStringLiteral(".messages.csv"));
+    if (!messagesFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        errorMessage = QStringLiteral("Unable to write %1: %2").arg(messagesFile.fileName(), messagesFile.errorString());
+        return false;
+    }
+    QList<uint32_t> msgids = result.messages.keys();
+    std::sort(msgids.begin(), msgids.end());
+    messagesFile.write("msgid,name,count,first_usec,last_usec,rate_hz\n");
+    for (uint32_t msgid: msgids) {
+        const MessageStats_t&           stats   = result.messages[msgid];
+        const mavlink_message_info_t*   msgInfo = mavlink_get_message_info_by_id(msgid);
+        const quint64                   spanUSecs = stats.lastUSecs - stats.firstUSecs;
+        const double                    rate    = spanUSecs ? (stats.count - 1) * 1.0e6 / spanUSecs : 0.0;
+
+        messagesFile.write(QStringLiteral("%1,%2,%3,%4,%5,%6\n")
+                           .arg(msgid)
+                           .arg(QString(msgInfo ? msgInfo->name : ""))
+                           .arg(stats.count)
+                           .arg(stats.firstUSecs)
+                           .arg(stats.lastUSecs)
+                           .arg(rate, 0, 'f', 3).toLatin1());
+    }
+
+    QFile lossFile(prefix + QStringLiteral(".loss.csv"));
+    if (!lossFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        errorMessage = QStringLiteral("Unable to write %1: %2").arg(lossFile.fileName(), lossFile.errorString());
+        return false;
+    }
+    lossFile.write("sysid,compid,received,lost,out_of_order,loss_percent\n");
+    for (auto it = result.links.constBegin(); it != result.links.constEnd(); it++) {
+        const quint64 total = it->received + it->lost;
+        lossFile.write(QStringLiteral("%1,%2,%3,%4,%5,%6\n")
+                       .arg(it.key() >> 8)
+                       .arg(it.key() & 0xFF)
+                       .arg(it->received)
+                       .arg(it->lost)
+                       .arg(it->outOfOrder)
+                       .arg(total ? it->lost * 100.0 / total : 0.0, 0, 'f', 2).toLatin1());
+    }
+
+    for (const Selection_t& selection: _selections) {
+        const mavlink_message_info_t* msgInfo = mavlink_get_message_info_by_id(selection.msgid);
+        QFile fieldFile(prefix + QLatin1Char('.') + selection.messageName + QStringLiteral(".csv"));
+        if (!fieldFile.open(QFile::WriteOnly | QFile::Truncate)) {
+            errorMessage = QStringLiteral("Unable to write %1: %2").arg(fieldFile.fileName(), fieldFile.errorString());
+            return false;
+        }
+        QByteArray header("time_usec,sysid,compid");
+        for (int fieldIndex: selection.fieldIndices) {
+            header.append(',');
+            header.append(msgInfo->fields[fieldIndex].name);
+        }
+        header.append('\n');
+        fieldFile.write(header);
+        fieldFile.write(result.rows.value(selection.msgid));
+    }
+
+    return true;
+}
+
+bool TLogAnalyzer::analyze(const QStringList& paths, QString& errorMessage)
+{
+    QElapsedTimer       timer;
+    const QStringList   logFilenames = _expandPaths(paths);
+    qint64              totalBytes = 0;
+    int                 totalChunks = 0;
+    bool                success = true;
+
+    timer.start();
+
+    // Logs are analyzed in batches so open files, mapped memory and decoded rows stay bounded no matter how many logs
+    // there are. A log larger than a batch is analyzed on its own.
+    int next = 0;
+    while (next < logFilenames.count()) {
+        QStringList batch;
+        qint64      batchBytes = 0;
+        while (next < logFilenames.count() && batch.count() < kBatchFiles) {
+            const qint64 size = QFileInfo(logFilenames[next]).size();
+            if (!batch.isEmpty() && batchBytes + size > kBatchBytes) {
+                break;
+            }
+            batchBytes += size;
+            batch.append(logFilenames[next++]);
+        }
+        if (!_analyzeBatch(batch, totalBytes, totalChunks, errorMessage)) {
+            success = false;
+        }
+    }
+
+    qCDebug(TLogAnalyzerLog) << "Analyzed logs:chunks:bytes:msecs" << logFilenames.count() << totalChunks << totalBytes << timer.elapsed();
+
+    return success;
+}
+
+/// Maps the logs, walks all of their chunks in parallel and writes the results of each log. The logs are unmapped and
+/// the chunk results freed on return.
+bool TLogAnalyzer::_analyzeBatch(const QStringList& logFilenames, qint64& totalBytes, int& totalChunks, QString& errorMessage) const
+{
+    QList<QFile*>       logFiles;
+    QVector<Chunk_t>    chunks;
+    bool                success = true;
+
+    // Mapping is done up front on this thread, the workers only ever see read only memory
+    for (int i = 0; i < logFilenames.count(); i++) {
+        QFile* logFile = new QFile(logFilenames[i]);
+        logFiles.append(logFile);
+
+        const uchar* data = nullptr;
+        const qint64 size = logFile->size();
+        if (logFile->open(QFile::ReadOnly) && size > 0) {
+            data = logFile->map(0, size);
+        }
+        if (!data) {
+            errorMessage = QStringLiteral("Unable to open %1: %2").arg(logFilenames[i], logFile->errorString());
+            qWarning() << errorMessage;
+            success = false;
+            continue;
+        }
+
+        // Chunk boundaries are moved forward to the next valid record so no record is split between workers
+        qint64 start = LogReplayIndex::nextRecord(data, size, 0);
+        while (start >= 0) {
+            qint64 end = start + kChunkSize < size ? LogReplayIndex::nextRecord(data, size, start + kChunkSize) : -1;
+            chunks.append({ i, data, start, end < 0 ? size : end, size });
+            start = end;
+        }
+    }
+
+    const QList<ChunkResult_t> results = QtConcurrent::blockingMapped<QList<ChunkResult_t>>(chunks, [this](const Chunk_t& chunk) {
+        return _analyzeChunk(chunk);
+    });
+
+    // Chunks are in file order, so the chunks of each log follow each other
+    int j = 0;
+    while (j < chunks.count()) {
+        const int       fileIndex = chunks[j].fileIndex;
+        ChunkResult_t   merged;
+
+        for (; j < chunks.count() && chunks[j].fileIndex == fileIndex; j++) {
+            _mergeResult(merged, results[j]);
+        }
+        totalBytes += logFiles[fileIndex]->size();
+
+        quint64 messageCount = 0;
+        for (const MessageStats_t& stats: merged.messages) {
+            messageCount += stats.count;
+        }
+        qCDebug(TLogAnalyzerLog) << logFilenames[fileIndex] << "messages:components:badBytes" << messageCount << merged.links.count() << merged.badBytes;
+
+        if (!_writeResults(logFilenames[fileIndex], merged, errorMessage)) {
+            qWarning() << errorMessage;
+            success = false;
+        }
+    }
+    totalChunks += chunks.count();
+
+    qDeleteAll(logFiles);
+
+    return success;
+}
+
+int TLogAnalyzer::runCommandLine(const QString& logs, const QString& fields, const QString& outputDir)
+{
+    TLogAnalyzer    analyzer(outputDir);
+    QString         errorMessage;
+
+    if (!outputDir.isEmpty() && !QDir().mkpath(outputDir)) {
+        qWarning() << "Unable to create output directory" << outputDir;
+        return -1;
+    }
+
+    for (const QString& fieldSpec: fields.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        if (!analyzer.addField(fieldSpec, errorMessage)) {
+            qWarning() << errorMessage;
+            return -1;
+        }
+    }
+
+    const QStringList paths = logs.split(QLatin1Char(','), Qt::SkipEmptyParts);
+    if (paths.isEmpty()) {
+        qWarning() << "No logs specified for analysis";
+        return -1;
+    }
+
+    return analyzer.analyze(paths, errorMessage) ? 0 : -1;
+}
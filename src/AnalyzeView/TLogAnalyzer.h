@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QByteArray>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(TLogAnalyzerLog)
+
+/// Headless batch analysis of telemetry logs.
+///
+/// Each log is memory mapped and split into chunks which are aligned to record boundaries. Logs are taken in batches
+/// of up to kBatchFiles logs and kBatchBytes. All chunks of a batch are walked in parallel on the global thread pool,
+/// then the per chunk results are merged in file order and written before the next batch is mapped.
+/// For every log the analyzer writes:
+///     <log>.messages.csv      count, rate and time span for each message id
+///     <log>.loss.csv          received/lost/out of order counts from the sequence numbers of each component
+///     <log>.<MESSAGE>.csv     one row per message for each message which has selected fields
+/// Field selections are "MESSAGE_NAME.field_name" and are decoded using the same generated message info as the
+/// MAVLink Inspector.
+class TLogAnalyzer
+{
+public:
+    /// @param outputDir Directory to write results to, empty to write next to each log
+    TLogAnalyzer(const QString& outputDir = QString());
+
+    /// @return false: field selection is not a known message field, errorMessage set
+    bool addField(const QString& fieldSpec, QString& errorMessage);
+
+    /// Analyzes the specified logs. Directories are expanded to the *.tlog files they contain.
+    ///     @return false: one or more logs failed, errorMessage set to the last error
+    bool analyze(const QStringList& paths, QString& errorMessage);
+
+    /// Runs the analyzer from the command line options
+    ///     @param logs Comma separated list of logs or directories
+    ///     @param fields Comma separated list of field selections
+    ///     @param outputDir Directory to write results to, empty for next to each log
+    ///     @return process exit code
+    static int runCommandLine(const QString& logs, const QString& fields, const QString& outputDir);
+
+    static constexpr qint64 kChunkSize  = 64 * 1024 * 1024;     ///< Target size for a single parallel work unit
+    static constexpr int    kBatchFiles = 64;                   ///< Most logs mapped at the same time
+    static constexpr qint64 kBatchBytes = 1024 * 1024 * 1024;   ///< Most log bytes mapped at the same time
+
+private:
+    typedef struct {
+        quint64 count;
+        quint64 firstUSecs;
+        quint64 lastUSecs;
+    } MessageStats_t;
+
+    typedef struct {
+        quint64 received;
+        quint64 lost;
+        quint64 outOfOrder;                         ///< Duplicated or reordered packets
+        uint8_t firstSeq;
+        uint8_t lastSeq;                            ///< Newest in order sequence number
+    } LinkStats_t;
+
+    typedef struct {
+        int                 fileIndex;
+        const uchar*        data;
+        qint64              start;
+        qint64              end;
+        qint64              size;
+    } Chunk_t;
+
+    typedef struct {
+        QHash<uint32_t, MessageStats_t> messages;   ///< Keyed by msgid
+        QMap<uint16_t, LinkStats_t>     links;      ///< Keyed by sysid << 8 | compid
+        QHash<uint32_t, QByteArray>     rows;       ///< CSV rows for selected fields, keyed by msgid
+        quint64                         badBytes = 0;
+    } ChunkResult_t;
+
+    typedef struct {
+        uint32_t        msgid;
+        QString         messageName;
+        QList<int>      fieldIndices;               ///< Into mavlink_message_info_t::fields
+    } Selection_t;
+
+    bool            _analyzeBatch   (const QStringList& logFilenames, qint64& totalBytes, int& totalChunks, QString& errorMessage) const;
+    ChunkResult_t   _analyzeChunk   (const Chunk_t& chunk) const;
+    void            _decodeRow      (const Selection_t& selection, quint64 timestamp, uint8_t sysid, uint8_t compid, const uchar* payload, int payloadLen, QByteArray& row) const;
+    void            _mergeResult    (ChunkResult_t& merged, const ChunkResult_t& result) const;
+    bool            _writeResults   (const QString& logFilename, const ChunkResult_t& result, QString& errorMessage) const;
+    QString         _outputPrefix   (const QString& logFilename) const;
+
+    static QStringList _expandPaths (const QStringList& paths);
+    static void     _updateSequence (LinkStats_t& stats, uint8_t seq);
+
+    QString                         _outputDir;
+    QHash<uint32_t, Selection_t>    _selections;    ///< Keyed by msgid
+
+    static constexpr uint8_t _maxSequenceGap = 128;     ///< Larger sequence gaps are packets going backwards
+};
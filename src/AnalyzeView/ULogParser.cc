@@ -1,6 +1,8 @@
 #include "ULogParser.h"
+#include "ULogReader.h"
 #include <math.h>
-#include <QDateTime>
+
+#include <algorithm>
 
 ULogParser::ULogParser()
 {
@@ -12,173 +14,66 @@ ULogParser::~ULogParser()
 
 }
 
-int ULogParser::sizeOfType(QString& typeName)
-{
-    if (typeName == QLatin1String("int8_t") || typeName == QLatin1String("uint8_t")) {
-        return 1;
-
-    } else if (typeName == QLatin1String("int16_t") || typeName == QLatin1String("uint16_t")) {
-        return 2;
-
-    } else if (typeName == QLatin1String("int32_t") || typeName == QLatin1String("uint32_t")) {
-        return 4;
-
-    } else if (typeName == QLatin1String("int64_t") || typeName == QLatin1String("uint64_t")) {
-        return 8;
-
-    } else if (typeName == QLatin1String("float")) {
-        return 4;
-
-    } else if (typeName == QLatin1String("double")) {
-        return 8;
-
-    } else if (typeName == QLatin1String("char") || typeName == QLatin1String("bool")) {
-        return 1;
-    }
-
-    qWarning() << "Unknown type in ULog : " << typeName;
-    return 0;
-}
-
-int ULogParser::sizeOfFullType(QString& typeNameFull)
-{
-    int arraySize;
-    QString typeName = extractArraySize(typeNameFull, arraySize);
-    return sizeOfType(typeName) * arraySize;
-}
-
-QString ULogParser::extractArraySize(QString &typeNameFull, int &arraySize)
+bool ULogParser::getTagsFromLog(const QString& logFile, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage)
 {
-    int startPos = typeNameFull.indexOf('[');
-    int endPos = typeNameFull.indexOf(']');
+    errorMessage.clear();
 
-    if (startPos == -1 || endPos == -1) {
-        arraySize = 1;
-        return typeNameFull;
+    const QString topicName = QStringLiteral("camera_capture");
+    ULogReader reader;
+    if (!reader.open(logFile, errorMessage, QStringList(topicName))) {
+        return false;
     }
 
-    arraySize = typeNameFull.mid(startPos + 1, endPos - startPos - 1).toInt();
-    return typeNameFull.mid(0, startPos);
-}
-
-bool ULogParser::parseFieldFormat(QString& fields)
-{
-    int prevFieldEnd = 0;
-    int fieldEnd = fields.indexOf(';');
-    int offset = 0;
-
-    while (fieldEnd != -1) {
-        int spacePos = fields.indexOf(' ', prevFieldEnd);
-
-        if (spacePos != -1) {
-            QString typeNameFull = fields.mid(prevFieldEnd, spacePos - prevFieldEnd);
-            QString fieldName = fields.mid(spacePos + 1, fieldEnd - spacePos - 1);
-
-            if (!fieldName.contains(QLatin1String("_padding"))) {
-                _cameraCaptureOffsets.insert(fieldName, offset);
-                offset += sizeOfFullType(typeNameFull);
-            }
+    // Captures can be published on more than one instance of the topic, all of them are used
+    QList<const ULogReader::Topic*> topics;
+    for (const ULogReader::Topic* topic: reader.topics()) {
+        if (topic->name() == topicName && topic->count() > 0) {
+            topics.append(topic);
         }
-
-        prevFieldEnd = fieldEnd + 1;
-        fieldEnd = fields.indexOf(';', prevFieldEnd);
     }
-    return false;
-}
-
-bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage)
-{
-    errorMessage.clear();
-
-    //verify it's an ULog file
-    if(!log.contains(_ULogMagic)) {
-        errorMessage = tr("Could not detect ULog file header magic");
+    if (topics.isEmpty()) {
+        errorMessage = tr("Could not detect camera_capture packets in ULog");
         return false;
     }
 
-    int index = ULOG_FILE_HEADER_LEN;
-    bool geotagFound = false;
-
-    while(index < log.length() - 1) {
-
-        ULogMessageHeader header;
-        memset(&header, 0, sizeof(header));
-        memcpy(&header, log.data() + index, ULOG_MSG_HEADER_LEN);
-
-        switch (header.msgType) {
-            case (int)ULogMessageType::FORMAT:
-            {
-                ULogMessageFormat format_msg;
-                memset(&format_msg, 0, sizeof(format_msg));
-                memcpy(&format_msg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
-
-                QString fmt(format_msg.format);
-                int posSeparator = fmt.indexOf(':');
-                QString messageName = fmt.left(posSeparator);
-                QString messageFields = fmt.mid(posSeparator + 1, header.msgSize - posSeparator - 1);
-
-                if(messageName == QLatin1String("camera_capture")) {
-                    parseFieldFormat(messageFields);
-                }
-                break;
-            }
-
-            case (int)ULogMessageType::ADD_LOGGED_MSG:
-            {
-                ULogMessageAddLogged addLoggedMsg;
-                memset(&addLoggedMsg, 0, sizeof(addLoggedMsg));
-                memcpy(&addLoggedMsg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
-
-                QString messageName(addLoggedMsg.msgName);
-
-                if(messageName.contains(QLatin1String("camera_capture"))) {
-                    _cameraCaptureMsgID = addLoggedMsg.msgID;
-                    geotagFound = true;
-                }
-
-                break;
+    const int firstFeedback = cameraFeedback.count();
+    for (const ULogReader::Topic* topic: topics) {
+        // Fields are looked up by name, so that changing/reordering the message format will not break the parser
+        const ULogReader::Format_t& format = topic->format();
+        const ULogReader::Field_t* timestampUTC     = format.field(QStringLiteral("timestamp_utc"));
+        const ULogReader::Field_t* seq              = format.field(QStringLiteral("seq"));
+        const ULogReader::Field_t* lat              = format.field(QStringLiteral("lat"));
+        const ULogReader::Field_t* lon              = format.field(QStringLiteral("lon"));
+        const ULogReader::Field_t* alt              = format.field(QStringLiteral("alt"));
+        const ULogReader::Field_t* groundDistance   = format.field(QStringLiteral("ground_distance"));
+        const ULogReader::Field_t* q                = format.field(QStringLiteral("q"));
+        const ULogReader::Field_t* result           = format.field(QStringLiteral("result"));
+
+        cameraFeedback.reserve(cameraFeedback.count() + topic->count());
+        for (const ULogReader::Sample sample: *topic) {
+            GeoTagWorker::cameraFeedbackPacket feedback;
+            memset(&feedback, 0, sizeof(feedback));
+            feedback.timestamp = sample.timestamp() / 1.0e6; // to seconds
+            feedback.timestampUTC = sample.toDouble(timestampUTC) / 1.0e6; // to seconds
+            feedback.imageSequence = static_cast<uint32_t>(sample.toDouble(seq));
+            feedback.latitude = sample.toDouble(lat);
+            feedback.longitude = fmod(180.0 + sample.toDouble(lon), 360.0) - 180.0;
+            feedback.altitude = static_cast<float>(sample.toDouble(alt));
+            feedback.groundDistance = static_cast<float>(sample.toDouble(groundDistance));
+            for (int i = 0; i < 4; i++) {
+                feedback.attitudeQuaternion[i] = static_cast<float>(sample.toDouble(q, i));
             }
+            feedback.captureResult = static_cast<uint8_t>(sample.toDouble(result));
 
-            case (int)ULogMessageType::DATA:
-            {
-                uint16_t msgID = -1;
-                memcpy(&msgID, log.data() + index + ULOG_MSG_HEADER_LEN, 2);
-
-                if (geotagFound && msgID == _cameraCaptureMsgID) {
-
-                    // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
-                    GeoTagWorker::cameraFeedbackPacket feedback;
-                    memset(&feedback, 0, sizeof(feedback));
-                    memcpy(&feedback.timestamp, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("timestamp")), 8);
-                    feedback.timestamp /= 1.0e6; // to seconds
-                    memcpy(&feedback.timestampUTC, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("timestamp_utc")), 8);
-                    feedback.timestampUTC /= 1.0e6; // to seconds
-                    memcpy(&feedback.imageSequence, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("seq")), 4);
-                    memcpy(&feedback.latitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("lat")), 8);
-                    memcpy(&feedback.longitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("lon")), 8);
-                    feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-                    memcpy(&feedback.altitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("alt")), 4);
-                    memcpy(&feedback.groundDistance, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("ground_distance")), 4);
-                    memcpy(&feedback.captureResult, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("result")), 1);
-
-                    cameraFeedback.append(feedback);
-
-                }
-
-                break;
-            }
-
-            default:
-                break;
+            cameraFeedback.append(feedback);
         }
-
-        index += (3 + header.msgSize);
-
     }
 
-    if (cameraFeedback.count() == 0) {
-        errorMessage = tr("Could not detect camera_capture packets in ULog");
-        return false;
+    // Instances are read one after the other, the captures are put back in log order
+    if (topics.count() > 1) {
+        std::stable_sort(cameraFeedback.begin() + firstFeedback, cameraFeedback.end(), [](const GeoTagWorker::cameraFeedbackPacket& a, const GeoTagWorker::cameraFeedbackPacket& b) {
+            return a.timestamp < b.timestamp;
+        });
     }
 
     return true;
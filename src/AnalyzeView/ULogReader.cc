@@ -0,0 +1,402 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ULogReader.h"
+
+#include <QDebug>
+#include <QPair>
+
+#include <algorithm>
+
+const char ULogReader::_magic[7] = { 'U', 'L', 'o', 'g', 0x01, 0x12, 0x35 };
+
+namespace {
+
+enum class ULogMessageType : uint8_t {
+    FORMAT = 'F',
+    DATA = 'D',
+    INFO = 'I',
+    INFO_MULTIPLE = 'M',
+    PARAMETER = 'P',
+    PARAMETER_DEFAULT = 'Q',
+    ADD_LOGGED_MSG = 'A',
+    REMOVE_LOGGED_MSG = 'R',
+    SYNC = 'S',
+    DROPOUT = 'O',
+    LOGGING = 'L',
+    LOGGING_TAGGED = 'C',
+    FLAG_BITS = 'B',
+};
+
+const int       kMessageHeaderSize      = 3;    // uint16_t msg_size, uint8_t msg_type
+const int       kFlagBitsSize           = 40;   // uint8_t compat_flags[8], uint8_t incompat_flags[8], uint64_t appended_offsets[3]
+const uint8_t   kIncompatDataAppended   = 0x01;
+const int       kMaxNestingDepth        = 8;
+
+template<typename T>
+T readValue(const uchar* p)
+{
+    T v;
+    memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+const ULogReader::Field_t*
+ULogReader::Format_t::field(const QString& fieldName) const
+{
+    for(const Field_t& f: fields) {
+        if(f.name == fieldName) {
+            return &f;
+        }
+    }
+    return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+double
+ULogReader::Sample::toDouble(const Field_t* field, int index) const
+{
+    if(!field) {
+        return 0;
+    }
+    switch(field->type) {
+    case FieldTypeInt8:     return value<qint8>(field, index);
+    case FieldTypeUInt8:    return value<quint8>(field, index);
+    case FieldTypeInt16:    return value<qint16>(field, index);
+    case FieldTypeUInt16:   return value<quint16>(field, index);
+    case FieldTypeInt32:    return value<qint32>(field, index);
+    case FieldTypeUInt32:   return value<quint32>(field, index);
+    case FieldTypeInt64:    return static_cast<double>(value<qint64>(field, index));
+    case FieldTypeUInt64:   return static_cast<double>(value<quint64>(field, index));
+    case FieldTypeFloat:    return static_cast<double>(value<float>(field, index));
+    case FieldTypeDouble:   return value<double>(field, index);
+    case FieldTypeBool:     return value<quint8>(field, index) ? 1 : 0;
+    case FieldTypeChar:     return value<qint8>(field, index);
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+ULogReader::Topic::Topic(const uchar* log, const Format_t& format, quint8 multiId)
+    : _log(log)
+    , _format(format)
+    , _multiId(multiId)
+{
+    _timestampField = _format.field(QStringLiteral("timestamp"));
+}
+
+//-----------------------------------------------------------------------------
+ULogReader::Sample
+ULogReader::Topic::sample(int index) const
+{
+    //-- DATA: uint16_t msg_size, uint8_t msg_type, uint16_t msg_id, uint8_t data[]
+    const uchar* message = _log + _offsets[index];
+    const int dataSize = readValue<quint16>(message) - static_cast<int>(sizeof(quint16));
+    return Sample(message + kMessageHeaderSize + sizeof(quint16), dataSize, _timestampField);
+}
+
+//-----------------------------------------------------------------------------
+ULogReader::ULogReader()
+{
+}
+
+//-----------------------------------------------------------------------------
+ULogReader::~ULogReader()
+{
+    close();
+}
+
+//-----------------------------------------------------------------------------
+bool
+ULogReader::open(const QString& fileName, QString& errorMessage, const QStringList& topicNames)
+{
+    close();
+    errorMessage.clear();
+
+    _file.setFileName(fileName);
+    if(!_file.open(QIODevice::ReadOnly)) {
+        errorMessage = tr("Unable to open log file: %1").arg(_file.errorString());
+        return false;
+    }
+    _size = _file.size();
+    if(_size < fileHeaderSize) {
+        errorMessage = tr("Log file is too small to be a ULog");
+        close();
+        return false;
+    }
+    _log = _file.map(0, _size);
+    if(!_log) {
+        errorMessage = tr("Unable to map log file: %1").arg(_file.errorString());
+        close();
+        return false;
+    }
+    //-- The mapping stays valid after the file is closed
+    _file.close();
+
+    //-- Header: uint8_t magic[7], uint8_t version, uint64_t timestamp
+    if(memcmp(_log, _magic, sizeof(_magic)) != 0) {
+        errorMessage = tr("Could not detect ULog file header magic");
+        close();
+        return false;
+    }
+    _version = _log[sizeof(_magic)];
+    _startTimestamp = readValue<quint64>(_log + sizeof(_magic) + 1);
+
+    if(!_index(topicNames, errorMessage)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+ULogReader::close()
+{
+    qDeleteAll(_topics);
+    _topics.clear();
+    _formatDefinitions.clear();
+    if(_log) {
+        _file.unmap(const_cast<uchar*>(_log));
+        _log = nullptr;
+    }
+    _file.close();
+    _size = 0;
+    _version = 0;
+    _startTimestamp = 0;
+}
+
+//-----------------------------------------------------------------------------
+QList<const ULogReader::Topic*>
+ULogReader::topics() const
+{
+    QList<const Topic*> result;
+    result.reserve(_topics.count());
+    for(const Topic* t: _topics) {
+        result.append(t);
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+const ULogReader::Topic*
+ULogReader::topic(const QString& name, quint8 multiId) const
+{
+    for(const Topic* t: _topics) {
+        if(t->multiId() == multiId && t->name() == name) {
+            return t;
+        }
+    }
+    return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+bool
+ULogReader::_index(const QStringList& topicNames, QString& errorMessage)
+{
+    //-- Topic of each msg_id currently subscribed
+    QVector<Topic*> msgIdTopics(0x10000, nullptr);
+    QList<qint64> appendedOffsets;
+
+    qint64 pos = fileHeaderSize;
+    while(pos + kMessageHeaderSize <= _size) {
+        const int msgSize = readValue<quint16>(_log + pos);
+        const uint8_t msgType = _log[pos + 2];
+        const qint64 next = pos + kMessageHeaderSize + msgSize;
+        if(next > _size) {
+            //-- Log was cut off
+            break;
+        }
+        if(!appendedOffsets.isEmpty() && next > appendedOffsets.first()) {
+            //-- A message can be cut off where appended data starts
+            pos = appendedOffsets.takeFirst();
+            continue;
+        }
+        const uchar* msg = _log + pos + kMessageHeaderSize;
+
+        switch(static_cast<ULogMessageType>(msgType)) {
+        case ULogMessageType::DATA:
+            if(msgSize >= static_cast<int>(sizeof(quint16))) {
+                Topic* t = msgIdTopics[readValue<quint16>(msg)];
+                if(t) {
+                    t->_offsets.append(pos);
+                }
+            }
+            break;
+
+        case ULogMessageType::FORMAT:
+        {
+            //-- char format[]: message_name:field0;field1;...
+            const QByteArray format = QByteArray::fromRawData(reinterpret_cast<const char*>(msg), msgSize);
+            const int separator = format.indexOf(':');
+            if(separator > 0) {
+                _formatDefinitions.insert(QString::fromLatin1(format.left(separator)), format.mid(separator + 1));
+            }
+            break;
+        }
+
+        case ULogMessageType::ADD_LOGGED_MSG:
+            //-- uint8_t multi_id, uint16_t msg_id, char message_name[]
+            if(msgSize > 3) {
+                const quint8 multiId = msg[0];
+                const quint16 msgId = readValue<quint16>(msg + 1);
+                const QString name = QString::fromLatin1(reinterpret_cast<const char*>(msg + 3), static_cast<int>(strnlen(reinterpret_cast<const char*>(msg + 3), msgSize - 3)));
+                msgIdTopics[msgId] = (topicNames.isEmpty() || topicNames.contains(name)) ? _addTopic(name, multiId) : nullptr;
+            }
+            break;
+
+        case ULogMessageType::REMOVE_LOGGED_MSG:
+            if(msgSize >= static_cast<int>(sizeof(quint16))) {
+                msgIdTopics[readValue<quint16>(msg)] = nullptr;
+            }
+            break;
+
+        case ULogMessageType::FLAG_BITS:
+            if(msgSize >= kFlagBitsSize) {
+                const uchar* incompatFlags = msg + 8;
+                if(incompatFlags[0] & ~kIncompatDataAppended) {
+                    errorMessage = tr("Log uses unsupported ULog features");
+                    return false;
+                }
+                for(int i = 1; i < 8; i++) {
+                    if(incompatFlags[i]) {
+                        errorMessage = tr("Log uses unsupported ULog features");
+                        return false;
+                    }
+                }
+                if(incompatFlags[0] & kIncompatDataAppended) {
+                    for(int i = 0; i < 3; i++) {
+                        const qint64 offset = static_cast<qint64>(readValue<quint64>(msg + 16 + (i * sizeof(quint64))));
+                        if(offset > 0 && offset < _size) {
+                            appendedOffsets.append(offset);
+                        }
+                    }
+                    std::sort(appendedOffsets.begin(), appendedOffsets.end());
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        pos = next;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+ULogReader::Topic*
+ULogReader::_addTopic(const QString& name, quint8 multiId)
+{
+    //-- A topic can be removed and added again under a new msg_id
+    for(Topic* t: std::as_const(_topics)) {
+        if(t->multiId() == multiId && t->name() == name) {
+            return t;
+        }
+    }
+    Format_t format;
+    if(!_resolveFormat(name, format, 0)) {
+        qWarning() << "ULog message format missing or invalid:" << name;
+        return nullptr;
+    }
+    Topic* t = new Topic(_log, format, multiId);
+    _topics.append(t);
+    return t;
+}
+
+//-----------------------------------------------------------------------------
+bool
+ULogReader::_resolveFormat(const QString& name, Format_t& format, int depth) const
+{
+    if(depth > kMaxNestingDepth || !_formatDefinitions.contains(name)) {
+        return false;
+    }
+    format.name = name;
+    format.size = 0;
+    format.fields.clear();
+
+    const QList<QByteArray> definitions = _formatDefinitions.value(name).split(';');
+    for(const QByteArray& definition: definitions) {
+        //-- type[array_size] field_name
+        const int space = definition.indexOf(' ');
+        if(space <= 0) {
+            continue;
+        }
+        QString typeName = QString::fromLatin1(definition.left(space));
+        const QString fieldName = QString::fromLatin1(definition.mid(space + 1)).trimmed();
+        int arraySize = 1;
+        const bool isArray = typeName.endsWith(']');
+        if(isArray) {
+            const int bracket = typeName.indexOf('[');
+            bool ok = false;
+            arraySize = typeName.mid(bracket + 1, typeName.length() - bracket - 2).toInt(&ok);
+            if(bracket <= 0 || !ok || arraySize <= 0) {
+                return false;
+            }
+            typeName.truncate(bracket);
+        }
+        //-- Padding takes space, but isn't a field
+        const bool padding = fieldName.startsWith(QLatin1String("_padding"));
+
+        FieldType_t type;
+        int size;
+        if(_primitiveType(typeName, type, size)) {
+            if(!padding) {
+                format.fields.append({ fieldName, type, format.size, size, arraySize });
+            }
+        } else {
+            Format_t nested;
+            if(!_resolveFormat(typeName, nested, depth + 1)) {
+                return false;
+            }
+            size = nested.size;
+            if(!padding) {
+                for(int i = 0; i < arraySize; i++) {
+                    const QString prefix = isArray ? QStringLiteral("%1[%2].").arg(fieldName).arg(i) : fieldName + QLatin1Char('.');
+                    for(const Field_t& f: std::as_const(nested.fields)) {
+                        format.fields.append({ prefix + f.name, f.type, format.size + (i * size) + f.offset, f.size, f.arraySize });
+                    }
+                }
+            }
+        }
+        format.size += size * arraySize;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+ULogReader::_primitiveType(const QString& typeName, FieldType_t& type, int& size)
+{
+    static const QHash<QString, QPair<FieldType_t, int>> types = {
+        { QStringLiteral("int8_t"),     { FieldTypeInt8,    1 } },
+        { QStringLiteral("uint8_t"),    { FieldTypeUInt8,   1 } },
+        { QStringLiteral("int16_t"),    { FieldTypeInt16,   2 } },
+        { QStringLiteral("uint16_t"),   { FieldTypeUInt16,  2 } },
+        { QStringLiteral("int32_t"),    { FieldTypeInt32,   4 } },
+        { QStringLiteral("uint32_t"),   { FieldTypeUInt32,  4 } },
+        { QStringLiteral("int64_t"),    { FieldTypeInt64,   8 } },
+        { QStringLiteral("uint64_t"),   { FieldTypeUInt64,  8 } },
+        { QStringLiteral("float"),      { FieldTypeFloat,   4 } },
+        { QStringLiteral("double"),     { FieldTypeDouble,  8 } },
+        { QStringLiteral("bool"),       { FieldTypeBool,    1 } },
+        { QStringLiteral("char"),       { FieldTypeChar,    1 } },
+    };
+    auto it = types.constFind(typeName);
+    if(it == types.constEnd()) {
+        return false;
+    }
+    type = it->first;
+    size = it->second;
+    return true;
+}
@@ -0,0 +1,186 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <cstring>
+#include <iterator>
+
+//-----------------------------------------------------------------------------
+/// Reader for ULog files (https://docs.px4.io/main/en/dev_log/ulog_file_format.html).
+///
+/// The file is memory mapped and indexed in a single pass which only reads message headers. The index holds the
+/// offset of every DATA message of each topic, so a topic can be read without touching the rest of the log. Samples
+/// point into the mapping, nothing is copied until a field is read. Samples are only valid while the reader is open.
+///
+/// ULog and all supported targets are little endian.
+class ULogReader
+{
+    Q_DECLARE_TR_FUNCTIONS(ULogReader)
+
+public:
+    ULogReader();
+    ~ULogReader();
+
+    typedef enum {
+        FieldTypeInt8,
+        FieldTypeUInt8,
+        FieldTypeInt16,
+        FieldTypeUInt16,
+        FieldTypeInt32,
+        FieldTypeUInt32,
+        FieldTypeInt64,
+        FieldTypeUInt64,
+        FieldTypeFloat,
+        FieldTypeDouble,
+        FieldTypeBool,
+        FieldTypeChar,
+    } FieldType_t;
+
+    /// Field of a message format. Fields of nested types are flattened, named parent.field or parent[index].field
+    /// for arrays. Padding fields are left out.
+    struct Field_t {
+        QString     name;
+        FieldType_t type;
+        int         offset;     ///< Offset from the start of the message data
+        int         size;       ///< Size of a single element
+        int         arraySize;  ///< 1 if the field isn't an array
+    };
+
+    struct Format_t {
+        QString         name;
+        int             size = 0;   ///< Size of the message data, trailing padding may not be logged
+        QList<Field_t>  fields;
+
+        /// @return nullptr if there is no such field
+        const Field_t* field(const QString& fieldName) const;
+    };
+
+    /// Zero copy view of a single DATA message
+    class Sample {
+    public:
+        Sample(const uchar* data, int size, const Field_t* timestampField)
+            : _data(data), _size(size), _timestampField(timestampField) {}
+
+        /// Message data, laid out as described by the topic format
+        const uchar*    data        () const { return _data; }
+        int             size        () const { return _size; }
+        /// @return Timestamp in microseconds, 0 if the format has no timestamp field
+        quint64         timestamp   () const { return value<quint64>(_timestampField); }
+
+        /// @return Field value, 0 if the field is nullptr, not logged or not of size T
+        template<typename T>
+        T value(const Field_t* field, int index = 0) const {
+            T v{};
+            if(field && index >= 0 && index < field->arraySize && static_cast<int>(sizeof(T)) == field->size) {
+                const int offset = field->offset + (index * field->size);
+                if(offset + field->size <= _size) {
+                    memcpy(&v, _data + offset, sizeof(T));
+                }
+            }
+            return v;
+        }
+
+        /// @return Field value of any numeric type as double, 0 if the field is nullptr or not logged
+        double toDouble(const Field_t* field, int index = 0) const;
+
+    private:
+        const uchar*    _data;
+        int             _size;
+        const Field_t*  _timestampField;
+    };
+
+    /// DATA messages logged for one instance of a topic
+    class Topic {
+    public:
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = Sample;
+            using difference_type   = int;
+            using pointer           = void;
+            using reference         = Sample;
+
+            const_iterator(const Topic* topic, int index) : _topic(topic), _index(index) {}
+
+            Sample          operator*   () const { return _topic->sample(_index); }
+            const_iterator& operator++  () { _index++; return *this; }
+            bool            operator==  (const const_iterator& other) const { return _index == other._index; }
+            bool            operator!=  (const const_iterator& other) const { return _index != other._index; }
+
+        private:
+            const Topic*    _topic;
+            int             _index;
+        };
+
+        const QString&  name        () const { return _format.name; }
+        quint8          multiId     () const { return _multiId; }
+        const Format_t& format      () const { return _format; }
+        int             count       () const { return _offsets.count(); }
+        Sample          sample      (int index) const;
+
+        const_iterator  begin       () const { return const_iterator(this, 0); }
+        const_iterator  end         () const { return const_iterator(this, count()); }
+
+    private:
+        friend class ULogReader;
+
+        Topic(const uchar* log, const Format_t& format, quint8 multiId);
+        Q_DISABLE_COPY(Topic)
+
+        const uchar*        _log;
+        Format_t            _format;
+        const Field_t*      _timestampField;
+        quint8              _multiId;
+        QVector<qint64>     _offsets;       ///< File offsets of the DATA messages
+    };
+
+    /// Maps and indexes the log
+    ///     @param topicNames Only index these topics, all topics if empty
+    ///     @return false: failed, errorMessage set
+    bool open(const QString& fileName, QString& errorMessage, const QStringList& topicNames = QStringList());
+    void close();
+
+    bool            isOpen          () const { return _log != nullptr; }
+    quint8          version         () const { return _version; }
+    /// @return Start of logging in microseconds
+    quint64         startTimestamp  () const { return _startTimestamp; }
+
+    /// @return Indexed topics
+    QList<const Topic*> topics      () const;
+    /// @return nullptr if the topic instance wasn't logged or indexed
+    const Topic*    topic           (const QString& name, quint8 multiId = 0) const;
+
+    static constexpr int fileHeaderSize = 16;
+
+private:
+    bool _index             (const QStringList& topicNames, QString& errorMessage);
+    bool _resolveFormat     (const QString& name, Format_t& format, int depth) const;
+    Topic* _addTopic        (const QString& name, quint8 multiId);
+
+    static bool _primitiveType(const QString& typeName, FieldType_t& type, int& size);
+
+    QFile                       _file;
+    const uchar*                _log            = nullptr;
+    qint64                      _size           = 0;
+    quint8                      _version        = 0;
+    quint64                     _startTimestamp = 0;
+    QHash<QString, QByteArray>  _formatDefinitions;     ///< FORMAT field lists by message name
+    QList<Topic*>               _topics;
+
+    static const char           _magic[7];
+};
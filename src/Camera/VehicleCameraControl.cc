@@ -2032,7 +2032,7 @@ VehicleCameraControl::_handleDefinitionFile(const QString &url)
             ver,
             ext.toStdString().c_str());
         connect(_vehicle->ftpManager(), &FTPManager::downloadComplete, this, &VehicleCameraControl::_ftpDownloadComplete);
-        _vehicle->ftpManager()->download(_compID, url,
+        _ftpDownloadId = _vehicle->ftpManager()->download(_compID, url,
             qgcApp()->toolbox()->settingsManager()->appSettings()->parameterSavePath().toStdString().c_str(),
             fileName);
         return;
@@ -2108,8 +2108,13 @@ VehicleCameraControl::_downloadFinished()
     //reply->deleteLater();
 }
 
-void VehicleCameraControl::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg)
+void VehicleCameraControl::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg, int downloadId)
 {
+    if (downloadId != _ftpDownloadId) {
+        return;
+    }
+    _ftpDownloadId = 0;
+
     qCDebug(CameraControlLog) << "FTP Download completed: " << fileName << ", " << errorMsg;
 
     disconnect(_vehicle->ftpManager(), &FTPManager::downloadComplete, this, &VehicleCameraControl::_ftpDownloadComplete);
@@ -208,7 +208,7 @@ private:
     void    _updateRanges                   (Fact* pFact);
     void    _httpRequest                    (const QString& url);
     void    _handleDefinitionFile           (const QString& url);
-    void    _ftpDownloadComplete            (const QString& fileName, const QString& errorMsg);
+    void    _ftpDownloadComplete            (const QString& fileName, const QString& errorMsg, int downloadId);
 
     QStringList     _loadExclusions         (QDomNode option);
     QStringList     _loadUpdates            (QDomNode option);
@@ -230,6 +230,7 @@ protected:
     QString                             _modelName;
     QString                             _vendor;
     QString                             _cacheFile;
+    int                                 _ftpDownloadId = 0;
     CameraMode                          _cameraMode         = CAM_MODE_UNDEFINED;
     StorageStatus                       _storageStatus      = STORAGE_NOT_SUPPORTED;
     PhotoCaptureMode                    _photoMode          = PHOTO_CAPTURE_SINGLE;
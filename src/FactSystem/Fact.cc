@@ -8,6 +8,7 @@
  ****************************************************************************/
 
 #include "Fact.h"
+#include "FactGroup.h"
 #include "FactValueSliderListModel.h"
 #include "QGCMAVLink.h"
 #include "QGCApplication.h"
@@ -15,6 +16,8 @@
 
 #include <QtQml>
 #include <QQmlEngine>
+#include <QMetaMethod>
+#include <QtNumeric>
 
 static const char* kMissingMetadata = "Meta data pointer missing";
 
@@ -112,10 +115,10 @@ void Fact::forceSetRawValue(const QVariant& value)
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
             _rawValue.setValue(typedValue);
-            _sendValueChangedSignal(cookedValue());
+            _sendValueChangedSignal();
             //-- Must be in this order
             emit _containerRawValueChanged(rawValue());
-            emit rawValueChanged(_rawValue);
+            _sendRawValueChangedSignal();
         }
     } else {
         qWarning() << kMissingMetadata << name();
@@ -129,12 +132,12 @@ void Fact::setRawValue(const QVariant& value)
         QString     errorString;
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
-            if (typedValue != _rawValue) {
+            if (!_rawValueEquals(typedValue)) {
                 _rawValue.setValue(typedValue);
-                _sendValueChangedSignal(cookedValue());
+                _sendValueChangedSignal();
                 //-- Must be in this order
                 emit _containerRawValueChanged(rawValue());
-                emit rawValueChanged(_rawValue);
+                _sendRawValueChangedSignal();
             }
         }
     } else {
@@ -179,14 +182,17 @@ void Fact::setEnumIndex(int index)
 
 void Fact::_containerSetRawValue(const QVariant& value)
 {
-    if(_rawValue != value) {
+    if (!_rawValueEquals(value)) {
         _rawValue = value;
-        _sendValueChangedSignal(cookedValue());
-        emit rawValueChanged(_rawValue);
+        _sendValueChangedSignal();
+        _sendRawValueChangedSignal();
     }
 
     // This always need to be signalled in order to support forceSetRawValue usage and waiting for vehicleUpdated signal
-    emit vehicleUpdated(_rawValue);
+    static const QMetaMethod vehicleUpdatedSignal = QMetaMethod::fromSignal(&Fact::vehicleUpdated);
+    if (isSignalConnected(vehicleUpdatedSignal)) {
+        emit vehicleUpdated(_rawValue);
+    }
 }
 
 QString Fact::name(void) const
@@ -671,24 +677,82 @@ void Fact::setSendValueChangedSignals (bool sendValueChangedSignals)
     }
 }
 
-void Fact::_sendValueChangedSignal(QVariant value)
+// High rate telemetry goes through here, so the cooked value is only computed if something is actually listening.
+// QML bindings show up as connections to the NOTIFY signal.
+void Fact::_sendValueChangedSignal(void)
 {
+    static const QMetaMethod valueChangedSignal = QMetaMethod::fromSignal(&Fact::valueChanged);
+
     if (_sendValueChangedSignals) {
-        emit valueChanged(value);
         _deferredValueChangeSignal = false;
-    } else {
+        if (isSignalConnected(valueChangedSignal)) {
+            emit valueChanged(cookedValue());
+        }
+    } else if (!_deferredValueChangeSignal) {
         _deferredValueChangeSignal = true;
+        if (_deferredUpdateGroup) {
+            _deferredUpdateGroup->_factValueDeferred(this);
+        }
     }
 }
 
 void Fact::sendDeferredValueChangedSignal(void)
 {
+    static const QMetaMethod valueChangedSignal = QMetaMethod::fromSignal(&Fact::valueChanged);
+
     if (_deferredValueChangeSignal) {
         _deferredValueChangeSignal = false;
-        emit valueChanged(cookedValue());
+        if (isSignalConnected(valueChangedSignal)) {
+            emit valueChanged(cookedValue());
+        }
+    }
+}
+
+void Fact::_sendRawValueChangedSignal(void)
+{
+    static const QMetaMethod rawValueChangedSignal = QMetaMethod::fromSignal(&Fact::rawValueChanged);
+
+    if (isSignalConnected(rawValueChangedSignal)) {
+        emit rawValueChanged(_rawValue);
     }
 }
 
+bool Fact::_rawValueEquals(const QVariant& value) const
+{
+    // Compare values of the same numeric type directly rather than through the QVariant meta type system.
+    // NaN is treated as equal to itself so telemetry which is not available doesn't signal on every update.
+    if (value.typeId() == _rawValue.typeId()) {
+        switch (value.typeId()) {
+        case QMetaType::Double:
+        {
+            const double a = _rawValue.value<double>();
+            const double b = value.value<double>();
+            return a == b || (qIsNaN(a) && qIsNaN(b));
+        }
+        case QMetaType::Float:
+        {
+            const float a = _rawValue.value<float>();
+            const float b = value.value<float>();
+            return a == b || (qIsNaN(a) && qIsNaN(b));
+        }
+        case QMetaType::Int:
+            return _rawValue.value<int>() == value.value<int>();
+        case QMetaType::UInt:
+            return _rawValue.value<uint>() == value.value<uint>();
+        case QMetaType::LongLong:
+            return _rawValue.value<qlonglong>() == value.value<qlonglong>();
+        case QMetaType::ULongLong:
+            return _rawValue.value<qulonglong>() == value.value<qulonglong>();
+        case QMetaType::Bool:
+            return _rawValue.value<bool>() == value.value<bool>();
+        default:
+            break;
+        }
+    }
+
+    return _rawValue == value;
+}
+
 QString Fact::enumOrValueString(void)
 {
     if (_metaData) {
@@ -18,6 +18,7 @@
 #include <QAbstractListModel>
 
 class FactValueSliderListModel;
+class FactGroup;
 
 /// @brief A Fact is used to hold a single value within the system.
 class Fact : public QObject
@@ -200,7 +201,9 @@ private:
     
 protected:
     QString _variantToString(const QVariant& variant, int decimalPlaces) const;
-    void _sendValueChangedSignal(QVariant value);
+    void _sendValueChangedSignal(void);
+    void _sendRawValueChangedSignal(void);
+    bool _rawValueEquals(const QVariant& value) const;
 
     QString                     _name;
     int                         _componentId;
@@ -211,4 +214,7 @@ protected:
     bool                        _deferredValueChangeSignal;
     FactValueSliderListModel*   _valueSliderModel;
     bool                        _ignoreQGCRebootRequired;
+    FactGroup*                  _deferredUpdateGroup = nullptr;    ///< Group which sends the deferred valueChanged signal
+
+    friend class FactGroup;
 };
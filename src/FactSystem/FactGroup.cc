@@ -9,6 +9,7 @@
 
 
 #include "FactGroup.h"
+#include "FactGroupUpdateScheduler.h"
 #include "JsonHelper.h"
 
 #include <QJsonDocument>
@@ -37,6 +38,11 @@ FactGroup::FactGroup(int updateRateMsecs, QObject* parent, bool ignoreCamelCase)
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 }
 
+FactGroup::~FactGroup()
+{
+    FactGroupUpdateScheduler::instance()->removeGroup(this);
+}
+
 void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
 {
     QMap<QString, QString> defineMap;
@@ -46,10 +52,7 @@ void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
 void FactGroup::_setupTimer()
 {
     if (_updateRateMSecs > 0) {
-        connect(&_updateTimer, &QTimer::timeout, this, &FactGroup::_updateAllValues);
-        _updateTimer.setSingleShot(false);
-        _updateTimer.setInterval(_updateRateMSecs);
-        _updateTimer.start();
+        FactGroupUpdateScheduler::instance()->addGroup(this, _updateRateMSecs);
     }
 }
 
@@ -130,6 +133,9 @@ void FactGroup::_addFact(Fact* fact, const QString& name)
     }
 
     fact->setSendValueChangedSignals(_updateRateMSecs == 0);
+    if (_updateRateMSecs > 0) {
+        fact->_deferredUpdateGroup = this;
+    }
     if (_nameToFactMetaDataMap.contains(name)) {
         fact->setMetaData(_nameToFactMetaDataMap[name], true /* setDefaultFromMetaData */);
     }
@@ -151,23 +157,34 @@ void FactGroup::_addFactGroup(FactGroup* factGroup, const QString& name)
     emit factGroupNamesChanged();
 }
 
+void FactGroup::_factValueDeferred(Fact* fact)
+{
+    _deferredFacts.append(fact);
+}
+
 void FactGroup::_updateAllValues(void)
 {
-    for(Fact* fact: _nameToFactMap) {
+    // Only the facts which changed since the last update are signalled. Handlers can change values again while
+    // we are signalling, those go out with the next update.
+    QList<Fact*> deferredFacts;
+    deferredFacts.swap(_deferredFacts);
+    for (Fact* fact: deferredFacts) {
         fact->sendDeferredValueChangedSignal();
     }
 }
 
 void FactGroup::setLiveUpdates(bool liveUpdates)
 {
-    if (_updateTimer.interval() == 0) {
+    if (_updateRateMSecs == 0 || liveUpdates == _liveUpdates) {
         return;
     }
+    _liveUpdates = liveUpdates;
 
     if (liveUpdates) {
-        _updateTimer.stop();
+        FactGroupUpdateScheduler::instance()->removeGroup(this);
+        _updateAllValues();
     } else {
-        _updateTimer.start();
+        FactGroupUpdateScheduler::instance()->addGroup(this, _updateRateMSecs);
     }
     for(Fact* fact: _nameToFactMap) {
         fact->setSendValueChangedSignals(liveUpdates);
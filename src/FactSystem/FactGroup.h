@@ -15,7 +15,6 @@
 
 #include <QStringList>
 #include <QMap>
-#include <QTimer>
 
 class Vehicle;
 
@@ -27,6 +26,7 @@ class FactGroup : public QObject
 public:
     FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject* parent = nullptr, bool ignoreCamelCase = false);
     FactGroup(int updateRateMsecs, QObject* parent = nullptr, bool ignoreCamelCase = false);
+    ~FactGroup();
 
     Q_PROPERTY(QStringList  factNames           READ factNames          NOTIFY factNamesChanged)
     Q_PROPERTY(QStringList  factGroupNames      READ factGroupNames     NOTIFY factGroupNamesChanged)
@@ -54,6 +54,9 @@ public:
     /// Allows a FactGroup to parse incoming messages and fill in values
     virtual void handleMessage(Vehicle* vehicle, mavlink_message_t& message);
 
+    /// @return Message ids which handleMessage is interested in, empty for all messages
+    const QList<uint32_t>& handledMessageIds() const { return _handledMessageIds; }
+
 signals:
     void factNamesChanged           (void);
     void factGroupNamesChanged      (void);
@@ -68,7 +71,11 @@ protected:
     void _loadFromJsonArray     (const QJsonArray jsonArray);
     void _setTelemetryAvailable (bool telemetryAvailable);
 
-    int  _updateRateMSecs;   ///< Update rate for Fact::valueChanged signals, 0: immediate update
+    /// Registers the message ids which handleMessage should be called for. Groups which don't register any ids
+    /// are given every message.
+    void _setHandledMessageIds  (const QList<uint32_t>& msgids) { _handledMessageIds = msgids; }
+
+    int  _updateRateMSecs;   ///< Update rate for Fact::valueChanged signals, 0: immediate update. Rate limited signals are sent by FactGroupUpdateScheduler.
 
     QMap<QString, Fact*>            _nameToFactMap;
     QMap<QString, FactGroup*>       _nameToFactGroupMap;
@@ -76,10 +83,17 @@ protected:
     QStringList                     _factNames;
 
 private:
-    void    _setupTimer (void);
-    QString _camelCase  (const QString& text);
+    void    _setupTimer         (void);
+    QString _camelCase          (const QString& text);
+    void    _factValueDeferred  (Fact* fact);
+
+    bool            _ignoreCamelCase    = false;
+    bool            _liveUpdates        = false;
+    bool            _telemetryAvailable = false;
+    QList<Fact*>    _deferredFacts;                 ///< Facts with a pending valueChanged signal
+
+    friend class Fact;
+    friend class FactGroupUpdateScheduler;
 
-    bool    _ignoreCamelCase    = false;
-    QTimer  _updateTimer;
-    bool    _telemetryAvailable = false;
+    QList<uint32_t> _handledMessageIds;
 };
@@ -0,0 +1,90 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupUpdateScheduler.h"
+#include "FactGroup.h"
+
+FactGroupUpdateScheduler* FactGroupUpdateScheduler::instance(void)
+{
+    static FactGroupUpdateScheduler* scheduler = new FactGroupUpdateScheduler();
+    return scheduler;
+}
+
+FactGroupUpdateScheduler::FactGroupUpdateScheduler(QObject* parent)
+    : QObject(parent)
+{
+    _frameTimer.setSingleShot(false);
+    _frameTimer.setTimerType(Qt::PreciseTimer);
+    _frameTimer.setInterval(1000 / _frameRate);
+    connect(&_frameTimer, &QTimer::timeout, this, &FactGroupUpdateScheduler::_frame);
+    _clock.start();
+}
+
+void FactGroupUpdateScheduler::setFrameRate(int framesPerSecond)
+{
+    _frameRate = qBound(1, framesPerSecond, 1000);
+    _frameTimer.setInterval(1000 / _frameRate);
+}
+
+void FactGroupUpdateScheduler::addGroup(FactGroup* factGroup, int updateRateMSecs)
+{
+    if (_groupRates.contains(factGroup)) {
+        return;
+    }
+
+    RateBucket_t& bucket = _rateBuckets[updateRateMSecs];
+    if (bucket.groups.isEmpty()) {
+        bucket.nextFlushMSecs = _clock.elapsed() + updateRateMSecs;
+    }
+    bucket.groups.append(factGroup);
+    _groupRates[factGroup] = updateRateMSecs;
+
+    if (!_frameTimer.isActive()) {
+        _frameTimer.start();
+    }
+}
+
+void FactGroupUpdateScheduler::removeGroup(FactGroup* factGroup)
+{
+    auto it = _groupRates.find(factGroup);
+    if (it == _groupRates.end()) {
+        return;
+    }
+
+    // Buckets are left in place even when empty, since removal can happen from within a flush
+    _rateBuckets[it.value()].groups.removeOne(factGroup);
+    _groupRates.erase(it);
+
+    if (_groupRates.isEmpty()) {
+        _frameTimer.stop();
+    }
+}
+
+void FactGroupUpdateScheduler::_frame(void)
+{
+    const qint64 now = _clock.elapsed();
+
+    for (auto it = _rateBuckets.begin(); it != _rateBuckets.end(); it++) {
+        RateBucket_t& bucket = it.value();
+        if (now < bucket.nextFlushMSecs) {
+            continue;
+        }
+
+        // Stay on the rate grid unless we have fallen behind by more than a full interval
+        bucket.nextFlushMSecs += it.key();
+        if (bucket.nextFlushMSecs <= now) {
+            bucket.nextFlushMSecs = now + it.key();
+        }
+
+        // Signal handlers can add or remove groups, so the list is re-checked on each pass
+        for (int i=0; i<bucket.groups.count(); i++) {
+            bucket.groups[i]->_updateAllValues();
+        }
+    }
+}
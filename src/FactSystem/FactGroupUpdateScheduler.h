@@ -0,0 +1,56 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QList>
+
+class FactGroup;
+
+/// Sends the deferred value change signals for all rate limited FactGroups from a single display frame timer.
+///
+/// Groups with the same update rate are flushed together on the same frame, so with many vehicles connected the
+/// QML bindings are re-evaluated in one burst per frame instead of at random times from a timer per group.
+/// Groups which need every sample turn on live updates, which bypasses the scheduler.
+class FactGroupUpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static FactGroupUpdateScheduler* instance(void);
+
+    int  frameRate      (void) const { return _frameRate; }
+    void setFrameRate   (int framesPerSecond);
+
+    void addGroup       (FactGroup* factGroup, int updateRateMSecs);
+    void removeGroup    (FactGroup* factGroup);
+
+    static constexpr int kDefaultFrameRate = 30;
+
+private slots:
+    void _frame(void);
+
+private:
+    FactGroupUpdateScheduler(QObject* parent = nullptr);
+
+    typedef struct {
+        QList<FactGroup*>   groups;
+        qint64              nextFlushMSecs = 0;
+    } RateBucket_t;
+
+    QMap<int, RateBucket_t> _rateBuckets;           ///< Keyed by group update rate in msecs
+    QMap<FactGroup*, int>   _groupRates;
+    QTimer                  _frameTimer;
+    QElapsedTimer           _clock;
+    int                     _frameRate = kDefaultFrameRate;
+};
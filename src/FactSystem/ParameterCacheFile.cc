@@ -0,0 +1,335 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterCacheFile.h"
+#include "QGC.h"
+
+#include <QSaveFile>
+#include <QVector>
+
+#include <algorithm>
+#include <cstring>
+
+const char ParameterCacheFile::_magic[4] = { 'Q', 'G', 'P', 'C' };
+
+ParameterCacheFile::~ParameterCacheFile()
+{
+    close();
+}
+
+void ParameterCacheFile::_encodeValue(FactMetaData::ValueType_t type, const QVariant& value, quint8* bytes)
+{
+    memset(bytes, 0, 8);
+
+    switch (type) {
+    case FactMetaData::valueTypeUint8:
+    {
+        const quint8 v = static_cast<quint8>(value.toUInt());
+        memcpy(bytes, &v, sizeof(v));
+        break;
+    }
+    case FactMetaData::valueTypeInt8:
+    {
+        const qint8 v = static_cast<qint8>(value.toInt());
+        memcpy(bytes, &v, sizeof(v));
+        break;
+    }
+    case FactMetaData::valueTypeUint16:
+    {
+        const quint16 v = static_cast<quint16>(value.toUInt());
+        memcpy(bytes, &v, sizeof(v));
+        break;
+    }
+    case FactMetaData::valueTypeInt16:
+    {
+        const qint16 v = static_cast<qint16>(value.toInt());
+        memcpy(bytes, &v, sizeof(v));
+        break;
+    }
+    case FactMetaData::valueTypeUint32:
+    {
+        const quint32 v = value.toUInt();
+        memcpy(bytes, &v, sizeof(v));
+        break;
+    }
+    case FactMetaData::valueTypeInt32:
+    {
+        const qint32 v = value.toInt();
+        memcpy(bytes, &v, sizeof(v));
+        break;
+    }
+    case FactMetaData::valueTypeUint64:
+    {
+        const quint64 v = value.toULongLong();
+        memcpy(bytes, &v, sizeof(v));
+        break;
+    }
+    case FactMetaData::valueTypeInt64:
+    {
+        const qint64 v = value.toLongLong();
+        memcpy(bytes, &v, sizeof(v));
+        break;
+    }
+    case FactMetaData::valueTypeFloat:
+    {
+        const float v = value.toFloat();
+        memcpy(bytes, &v, sizeof(v));
+        break;
+    }
+    case FactMetaData::valueTypeDouble:
+    {
+        const double v = value.toDouble();
+        memcpy(bytes, &v, sizeof(v));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+QVariant ParameterCacheFile::_decodeValue(FactMetaData::ValueType_t type, const quint8* bytes)
+{
+    switch (type) {
+    case FactMetaData::valueTypeUint8:
+        return QVariant::fromValue(static_cast<uint>(bytes[0]));
+    case FactMetaData::valueTypeInt8:
+        return QVariant::fromValue(static_cast<int>(static_cast<qint8>(bytes[0])));
+    case FactMetaData::valueTypeUint16:
+    {
+        quint16 v;
+        memcpy(&v, bytes, sizeof(v));
+        return QVariant::fromValue(static_cast<uint>(v));
+    }
+    case FactMetaData::valueTypeInt16:
+    {
+        qint16 v;
+        memcpy(&v, bytes, sizeof(v));
+        return QVariant::fromValue(static_cast<int>(v));
+    }
+    case FactMetaData::valueTypeUint32:
+    {
+        quint32 v;
+        memcpy(&v, bytes, sizeof(v));
+        return QVariant::fromValue(v);
+    }
+    case FactMetaData::valueTypeInt32:
+    {
+        qint32 v;
+        memcpy(&v, bytes, sizeof(v));
+        return QVariant::fromValue(v);
+    }
+    case FactMetaData::valueTypeUint64:
+    {
+        quint64 v;
+        memcpy(&v, bytes, sizeof(v));
+        return QVariant::fromValue(v);
+    }
+    case FactMetaData::valueTypeInt64:
+    {
+        qint64 v;
+        memcpy(&v, bytes, sizeof(v));
+        return QVariant::fromValue(v);
+    }
+    case FactMetaData::valueTypeFloat:
+    {
+        float v;
+        memcpy(&v, bytes, sizeof(v));
+        return QVariant::fromValue(v);
+    }
+    case FactMetaData::valueTypeDouble:
+    {
+        double v;
+        memcpy(&v, bytes, sizeof(v));
+        return QVariant::fromValue(v);
+    }
+    default:
+        return QVariant();
+    }
+}
+
+quint32 ParameterCacheFile::hash(const QList<Entry_t>& sortedEntries)
+{
+    quint32 crc32Value = 0;
+
+    for (const Entry_t& entry: sortedEntries) {
+        if (entry.volatileValue) {
+            // Does not take part in CRC
+            continue;
+        }
+
+        quint8              valueBytes[8];
+        const QByteArray    nameBytes = entry.name.toLatin1();
+        _encodeValue(entry.type, entry.value, valueBytes);
+        crc32Value = QGC::crc32(reinterpret_cast<const quint8*>(nameBytes.constData()), static_cast<unsigned>(nameBytes.length()), crc32Value);
+        crc32Value = QGC::crc32(valueBytes, static_cast<unsigned>(FactMetaData::typeToSize(entry.type)), crc32Value);
+    }
+
+    return crc32Value;
+}
+
+bool ParameterCacheFile::write(const QString& filename, QList<Entry_t> entries, QString& errorString)
+{
+    std::sort(entries.begin(), entries.end(), [](const Entry_t& a, const Entry_t& b) { return a.name < b.name; });
+
+    QByteArray          names;
+    QVector<Record_t>   records(entries.count());
+
+    for (int i=0; i<entries.count(); i++) {
+        const Entry_t&      entry       = entries[i];
+        const QByteArray    nameBytes   = entry.name.toLatin1();
+        Record_t&           record      = records[i];
+
+        if (FactMetaData::typeToSize(entry.type) > sizeof(record.value) || entry.type > FactMetaData::valueTypeDouble) {
+            errorString = QStringLiteral("Unsupported type %1 for %2").arg(entry.type).arg(entry.name);
+            return false;
+        }
+        if (nameBytes.length() > 255) {
+            errorString = QStringLiteral("Name too long %1").arg(entry.name);
+            return false;
+        }
+
+        record.nameOffset   = static_cast<quint32>(names.length());
+        record.nameLength   = static_cast<quint8>(nameBytes.length());
+        record.valueType    = static_cast<quint8>(entry.type);
+        record.reserved     = 0;
+        _encodeValue(entry.type, entry.value, record.value);
+        names.append(nameBytes);
+    }
+
+    Header_t header;
+    memcpy(header.magic, _magic, sizeof(header.magic));
+    header.version      = kVersion;
+    header.recordSize   = sizeof(Record_t);
+    header.count        = static_cast<quint32>(records.count());
+    header.hash         = hash(entries);
+    header.namesSize    = static_cast<quint32>(names.length());
+    header.bodyCrc      = QGC::crc32(reinterpret_cast<const quint8*>(records.constData()), static_cast<unsigned>(records.count() * sizeof(Record_t)), 0);
+    header.bodyCrc      = QGC::crc32(reinterpret_cast<const quint8*>(names.constData()), static_cast<unsigned>(names.length()), header.bodyCrc);
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        errorString = file.errorString();
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.constData()), records.count() * sizeof(Record_t));
+    file.write(names);
+    if (!file.commit()) {
+        errorString = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+bool ParameterCacheFile::open(const QString& filename)
+{
+    close();
+
+    _file.setFileName(filename);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64    fileSize    = _file.size();
+    const uchar*    data        = fileSize >= static_cast<qint64>(sizeof(Header_t)) ? _file.map(0, fileSize) : nullptr;
+    if (!data) {
+        close();
+        return false;
+    }
+
+    const Header_t* header = reinterpret_cast<const Header_t*>(data);
+    if (memcmp(header->magic, _magic, sizeof(_magic)) || header->version != kVersion || header->recordSize != sizeof(Record_t)) {
+        close();
+        return false;
+    }
+
+    const qint64 recordsSize = static_cast<qint64>(header->count) * static_cast<qint64>(sizeof(Record_t));
+    if (static_cast<qint64>(sizeof(Header_t)) + recordsSize + header->namesSize != fileSize) {
+        close();
+        return false;
+    }
+
+    const uchar* body = data + sizeof(Header_t);
+    if (QGC::crc32(body, static_cast<unsigned>(recordsSize + header->namesSize), 0) != header->bodyCrc) {
+        close();
+        return false;
+    }
+
+    const Record_t* records = reinterpret_cast<const Record_t*>(body);
+    for (quint32 i=0; i<header->count; i++) {
+        if (static_cast<quint64>(records[i].nameOffset) + records[i].nameLength > header->namesSize || records[i].valueType > FactMetaData::valueTypeDouble) {
+            close();
+            return false;
+        }
+    }
+
+    _header     = header;
+    _records    = records;
+    _names      = reinterpret_cast<const char*>(body + recordsSize);
+    _count      = static_cast<int>(header->count);
+
+    return true;
+}
+
+void ParameterCacheFile::close(void)
+{
+    _header     = nullptr;
+    _records    = nullptr;
+    _names      = nullptr;
+    _count      = 0;
+    _file.close();  // Also unmaps
+}
+
+quint32 ParameterCacheFile::hash(void) const
+{
+    return _header ? _header->hash : 0;
+}
+
+QString ParameterCacheFile::name(int index) const
+{
+    const Record_t& record = _records[index];
+    return QString::fromLatin1(_names + record.nameOffset, record.nameLength);
+}
+
+FactMetaData::ValueType_t ParameterCacheFile::type(int index) const
+{
+    return static_cast<FactMetaData::ValueType_t>(_records[index].valueType);
+}
+
+QVariant ParameterCacheFile::value(int index) const
+{
+    return _decodeValue(type(index), _records[index].value);
+}
+
+int ParameterCacheFile::indexOf(const QString& name) const
+{
+    const QByteArray nameBytes = name.toLatin1();
+
+    int low     = 0;
+    int high    = _count - 1;
+    while (low <= high) {
+        const int       mid     = (low + high) / 2;
+        const Record_t& record  = _records[mid];
+        const int       cmpLen  = qMin(static_cast<int>(record.nameLength), nameBytes.length());
+        int             result  = memcmp(_names + record.nameOffset, nameBytes.constData(), static_cast<size_t>(cmpLen));
+        if (result == 0) {
+            result = static_cast<int>(record.nameLength) - nameBytes.length();
+        }
+        if (result == 0) {
+            return mid;
+        } else if (result < 0) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,98 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QVariant>
+
+#include "FactMetaData.h"
+
+/// Flat binary parameter cache for a single vehicle component.
+///
+/// File layout:
+///     Header_t
+///     Record_t[count]     sorted by parameter name
+///     name table          latin1 names referenced by the records, not null terminated
+///
+/// The header carries the parameter set hash as the vehicle reports it through _HASH_CHECK, so checking whether the
+/// cache is still valid does not need to look at the parameters at all. The file is memory mapped when opened and
+/// values are decoded straight out of the mapping.
+class ParameterCacheFile
+{
+public:
+    ParameterCacheFile(void) = default;
+    ~ParameterCacheFile();
+
+    typedef struct {
+        QString                     name;
+        FactMetaData::ValueType_t   type;
+        QVariant                    value;
+        bool                        volatileValue;  ///< true: does not take part in the parameter set hash
+    } Entry_t;
+
+    /// Writes a new cache file, replacing any existing one
+    ///     @param entries Parameters to write, need not be sorted
+    ///     @return false: write failed, errorString set
+    static bool write(const QString& filename, QList<Entry_t> entries, QString& errorString);
+
+    /// @return Parameter set hash in the same form as the _HASH_CHECK value sent by the vehicle
+    static quint32 hash(const QList<Entry_t>& sortedEntries);
+
+    /// Maps and validates the specified cache file
+    ///     @return false: file missing, wrong version or corrupt
+    bool open(const QString& filename);
+    void close(void);
+
+    bool                        isOpen  (void) const { return _records != nullptr; }
+    quint32                     hash    (void) const;
+    int                         count   (void) const { return _count; }
+    QString                     name    (int index) const;
+    FactMetaData::ValueType_t   type    (int index) const;
+    QVariant                    value   (int index) const;
+
+    /// @return Index of the named parameter, -1 if not found
+    int indexOf(const QString& name) const;
+
+    static constexpr quint16 kVersion = 1;
+
+private:
+#pragma pack(push, 1)
+    typedef struct {
+        char    magic[4];
+        quint16 version;
+        quint16 recordSize;
+        quint32 count;
+        quint32 hash;
+        quint32 bodyCrc;        ///< Records and name table
+        quint32 namesSize;
+    } Header_t;
+
+    typedef struct {
+        quint32 nameOffset;
+        quint8  nameLength;
+        quint8  valueType;
+        quint16 reserved;
+        quint8  value[8];
+    } Record_t;
+#pragma pack(pop)
+
+    static void     _encodeValue(FactMetaData::ValueType_t type, const QVariant& value, quint8* bytes);
+    static QVariant _decodeValue(FactMetaData::ValueType_t type, const quint8* bytes);
+
+    QFile           _file;
+    const Header_t* _header     = nullptr;
+    const Record_t* _records    = nullptr;
+    const char*     _names      = nullptr;
+    int             _count      = 0;
+
+    static const char _magic[4];
+};
@@ -17,6 +17,7 @@
 #include "ComponentInformationManager.h"
 #include "CompInfoParam.h"
 #include "FTPManager.h"
+#include "ParameterCacheFile.h"
 
 #include <QEasingCurve>
 #include <QFile>
@@ -101,6 +102,11 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     _waitingParamTimeoutTimer.setInterval(3000);
     connect(&_waitingParamTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_waitingParamTimeout);
 
+    _indexRequestTimer.setSingleShot(false);
+    _indexRequestTimer.setInterval(_indexRequestCheckMSecs);
+    connect(&_indexRequestTimer, &QTimer::timeout, this, &ParameterManager::_indexRequestTimeoutCheck);
+    _indexRequestClock.start();
+
     // Ensure the cache directory exists
     QFileInfo(QSettings().fileName()).dir().mkdir("ParamCache");
 }
@@ -291,10 +297,7 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
     // If we've never seen this component id before, setup the index wait lists.
     if (!_waitingReadParamIndexMap.contains(componentId)) {
         // Add all indices to the wait list, parameter index is 0-based
-        for (int waitingIndex=0; waitingIndex<parameterCount; waitingIndex++) {
-            // This will add the new component id, as well as the the new waiting index and set the retry count for that index to 0
-            _waitingReadParamIndexMap[componentId][waitingIndex] = 0;
-        }
+        _waitingReadParamIndexMap[componentId].reset(parameterCount);
 
         // The read and write waiting lists for this component are initialized the empty
         _waitingReadParamNameMap[componentId] = QMap<QString, int>();
@@ -310,15 +313,14 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
     }
 
     // Remove this parameter from the waiting lists
-    if (_waitingReadParamIndexMap[componentId].contains(parameterIndex)) {
-        _waitingReadParamIndexMap[componentId].remove(parameterIndex);
-        _indexBatchQueue.removeOne(parameterIndex);
+    if (_waitingReadParamIndexMap[componentId].remove(parameterIndex)) {
+        _indexRequestResponse(componentId, parameterIndex);
         _fillIndexBatchQueue(false /* waitingParamTimeout */);
     }
     _waitingReadParamNameMap[componentId].remove(parameterName);
     _waitingWriteParamNameMap[componentId].remove(parameterName);
     if (_waitingReadParamIndexMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap:" << _waitingReadParamIndexMap[componentId];
+        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap count:" << _waitingReadParamIndexMap[componentId].count();
     }
     if (_waitingReadParamNameMap[componentId].count()) {
         qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamNameMap" << _waitingReadParamNameMap[componentId];
@@ -443,8 +445,13 @@ void ParameterManager::_factRawValueUpdated(const QVariant& rawValue)
     _factRawValueUpdateWorker(fact->componentId(), fact->name(), fact->type(), rawValue);
 }
 
-void ParameterManager::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg)
+void ParameterManager::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg, int downloadId)
 {
+    if (downloadId != _ftpDownloadId) {
+        return;
+    }
+    _ftpDownloadId = 0;
+
     bool continueWithDefaultParameterdownload = true;
     bool immediateRetry = false;
 
@@ -492,8 +499,12 @@ void ParameterManager::_ftpDownloadComplete(const QString& fileName, const QStri
 }
 
 
-void ParameterManager::_ftpDownloadProgress(float progress)
+void ParameterManager::_ftpDownloadProgress(float progress, int downloadId)
 {
+    if (downloadId != _ftpDownloadId) {
+        return;
+    }
+
     qCDebug(ParameterManagerVerbose1Log) << "ParameterManager::_ftpDownloadProgress: " << progress;
     _setLoadProgress(static_cast<double>(progress));
     if (progress > 0.001)
@@ -526,9 +537,10 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
         FTPManager* ftpManager = _vehicle->ftpManager();
         connect(ftpManager, &FTPManager::downloadComplete, this, &ParameterManager::_ftpDownloadComplete);
         _waitingParamTimeoutTimer.stop();
-        if (ftpManager->download(MAV_COMP_ID_AUTOPILOT1, "@PARAM/param.pck",
-                                 QStandardPaths::writableLocation(QStandardPaths::TempLocation),
-                                 "", false /* No filesize check */)) {
+        _ftpDownloadId = ftpManager->download(MAV_COMP_ID_AUTOPILOT1, "@PARAM/param.pck",
+                                              QStandardPaths::writableLocation(QStandardPaths::TempLocation),
+                                              "", false /* No filesize check */);
+        if (_ftpDownloadId) {
             connect(ftpManager, &FTPManager::commandProgress, this, &ParameterManager::_ftpDownloadProgress);
         } else {
             qCWarning(ParameterManagerLog) << "ParameterManager::refreshallParameters FTPManager::download returned failure";
@@ -540,10 +552,7 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
             // Add/Update all indices to the wait list, parameter index is 0-based
             if(componentId != MAV_COMP_ID_ALL && componentId != cid)
                 continue;
-            for (int waitingIndex = 0; waitingIndex < _paramCountMap[cid]; waitingIndex++) {
-                // This will add a new waiting index if needed and set the retry count for that index to 0
-                _waitingReadParamIndexMap[cid][waitingIndex] = 0;
-            }
+            _waitingReadParamIndexMap[cid].reset(_paramCountMap[cid]);
         }
         MAVLinkProtocol*        mavlink = qgcApp()->toolbox()->mavlinkProtocol();
         mavlink_message_t       msg;
@@ -647,8 +656,8 @@ QStringList ParameterManager::parameterNames(int componentId)
     return names;
 }
 
-/// Requests missing index based parameters from the vehicle.
-///     @param waitingParamTimeout: true: being called due to timeout, false: being called to re-fill the batch queue
+/// Requests missing index based parameters from the vehicle, keeping up to the current window of requests in flight.
+///     @param waitingParamTimeout: true: being called due to timeout, false: being called to re-fill the window
 /// return true: Parameters were requested, false: No more requests needed
 bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
 {
@@ -656,48 +665,153 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
         return false;
     }
 
-    const int maxBatchSize = 10;
-
     if (waitingParamTimeout) {
-        // We timed out, clear the queue and try again
-        qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to timeout";
-        _indexBatchQueue.clear();
+        // Nothing came back for the whole timeout period, everything still in flight is lost
+        qCDebug(ParameterManagerLog) << "Refilling index based request window due to timeout - lost:" << _indexRequestsInFlight.count();
+        if (!_indexRequestsInFlight.isEmpty()) {
+            _indexRequestsLost += _indexRequestsInFlight.count();
+            _indexRequestsInFlight.clear();
+            _shrinkIndexRequestWindow();
+        }
     } else {
-        qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to received parameter";
+        qCDebug(ParameterManagerVerbose1Log) << "Refilling index based request window due to received parameter";
     }
 
-    for(int componentId: _waitingReadParamIndexMap.keys()) {
-        if (_waitingReadParamIndexMap[componentId].count()) {
-            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap count" << _waitingReadParamIndexMap[componentId].count();
-            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap" << _waitingReadParamIndexMap[componentId];
+    const int window = static_cast<int>(_indexWindow);
+
+    for (auto it = _waitingReadParamIndexMap.begin(); it != _waitingReadParamIndexMap.end(); it++) {
+        const int               componentId = it.key();
+        ParameterIndexWaitList& waitList    = it.value();
+
+        if (waitList.count() && waitingParamTimeout) {
+            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap count" << waitList.count();
         }
 
-        for(int paramIndex: _waitingReadParamIndexMap[componentId].keys()) {
-            if (_indexBatchQueue.contains(paramIndex)) {
-                // Don't add more than once
+        // Walk the waiting indices round robin from where the last fill left off. Only indices which are still
+        // missing are visited, so the cost is proportional to the number of missing params, not the total.
+        const int   startCursor = waitList.scanCursor;
+        bool        wrapped     = false;
+        while (waitList.count() && _indexRequestsInFlight.count() < window) {
+            int paramIndex = waitList.nextWaiting(waitList.scanCursor);
+            if (paramIndex == -1 || (wrapped && paramIndex >= startCursor)) {
+                if (wrapped) {
+                    waitList.scanCursor = startCursor;
+                    break;
+                }
+                wrapped = true;
+                waitList.scanCursor = 0;
                 continue;
             }
+            waitList.scanCursor = paramIndex + 1;
 
-            if (_indexBatchQueue.count() > maxBatchSize) {
-                break;
+            const quint32 requestKey = (static_cast<quint32>(componentId) << 16) | static_cast<quint32>(paramIndex);
+            if (_indexRequestsInFlight.contains(requestKey)) {
+                // Don't request more than once at a time
+                continue;
             }
 
-            _waitingReadParamIndexMap[componentId][paramIndex]++;   // Bump retry count
-            if (_disableAllRetries || _waitingReadParamIndexMap[componentId][paramIndex] > _maxInitialLoadRetrySingleParam) {
+            // Only a full _waitingParamTimeout with nothing received counts against the retry limit. Re-requests from the
+            // adaptive timeout can be as quick as _indexRequestTimeoutMinMSecs, so counting those would fail the load
+            // on a short dropout.
+            int retryCount = waitingParamTimeout ? waitList.bumpRetryCount(paramIndex) : waitList.retryCount(paramIndex);
+            if (_disableAllRetries || retryCount > _maxInitialLoadRetrySingleParam) {
                 // Give up on this index
                 _failedReadParamIndexMap[componentId] << paramIndex;
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Giving up on (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
-                _waitingReadParamIndexMap[componentId].remove(paramIndex);
+                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Giving up on (paramIndex:" << paramIndex << "retryCount:" << retryCount << ")";
+                waitList.remove(paramIndex);
             } else {
                 // Retry again
-                _indexBatchQueue.append(paramIndex);
+                _indexRequestsInFlight[requestKey] = _indexRequestClock.elapsed();
+                _indexRequestsSent++;
                 _readParameterRaw(componentId, "", paramIndex);
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
+                qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << retryCount << ")";
             }
         }
     }
 
-    return _indexBatchQueue.count() != 0;
+    if (_indexRequestsInFlight.isEmpty()) {
+        _indexRequestTimer.stop();
+    } else if (!_indexRequestTimer.isActive()) {
+        _indexRequestTimer.start();
+    }
+
+    return _indexRequestsInFlight.count() != 0;
+}
+
+/// Called when an index based parameter which was still waiting arrives. Updates the round trip time estimate and
+/// opens up the window if the parameter was one we requested.
+void ParameterManager::_indexRequestResponse(int componentId, int paramIndex)
+{
+    const quint32 requestKey = (static_cast<quint32>(componentId) << 16) | static_cast<quint32>(paramIndex);
+
+    auto it = _indexRequestsInFlight.find(requestKey);
+    if (it == _indexRequestsInFlight.end()) {
+        // Part of the initial stream
+        return;
+    }
+
+    const double rtt = static_cast<double>(_indexRequestClock.elapsed() - it.value());
+    _indexRequestsInFlight.erase(it);
+
+    if (_indexRttMSecs < 0) {
+        _indexRttMSecs      = rtt;
+        _indexRttVarMSecs   = rtt / 2;
+    } else {
+        _indexRttVarMSecs   = (0.75 * _indexRttVarMSecs) + (0.25 * qAbs(_indexRttMSecs - rtt));
+        _indexRttMSecs      = (0.875 * _indexRttMSecs) + (0.125 * rtt);
+    }
+
+    if (_indexWindow < _indexWindowThreshold) {
+        _indexWindow += 1;
+    } else {
+        _indexWindow += 1 / _indexWindow;
+    }
+    _indexWindow = qMin(_indexWindow, static_cast<double>(_indexWindowMax));
+}
+
+/// Periodically checks for index requests which have been in flight for longer than the round trip time allows
+void ParameterManager::_indexRequestTimeoutCheck(void)
+{
+    const qint64    now         = _indexRequestClock.elapsed();
+    const int       timeout     = _indexRequestTimeoutMSecs();
+    int             lostCount   = 0;
+
+    for (auto it = _indexRequestsInFlight.begin(); it != _indexRequestsInFlight.end(); ) {
+        if (now - it.value() > timeout) {
+            it = _indexRequestsInFlight.erase(it);
+            lostCount++;
+        } else {
+            it++;
+        }
+    }
+
+    if (lostCount) {
+        _indexRequestsLost += lostCount;
+        _shrinkIndexRequestWindow();
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Index requests lost:" << lostCount << "window:" << _indexWindow << "rtt:" << _indexRttMSecs << "timeout:" << timeout << "sent:lost" << _indexRequestsSent << _indexRequestsLost;
+        _fillIndexBatchQueue(false /* waitingParamTimeout */);
+    }
+}
+
+void ParameterManager::_shrinkIndexRequestWindow(void)
+{
+    // A burst of losses from the same window only counts as a single congestion event
+    const qint64 now = _indexRequestClock.elapsed();
+    if (now - _indexWindowShrinkMSecs < _indexRequestTimeoutMSecs()) {
+        return;
+    }
+    _indexWindowShrinkMSecs = now;
+
+    _indexWindowThreshold   = qMax(_indexWindow / 2, static_cast<double>(_indexWindowMin));
+    _indexWindow            = _indexWindowThreshold;
+}
+
+int ParameterManager::_indexRequestTimeoutMSecs(void) const
+{
+    if (_indexRttMSecs < 0) {
+        return _indexRequestTimeoutMaxMSecs / 2;
+    }
+    return qBound(_indexRequestTimeoutMinMSecs, static_cast<int>(_indexRttMSecs + (4 * _indexRttVarMSecs)), _indexRequestTimeoutMaxMSecs);
 }
 
 void ParameterManager::_waitingParamTimeout(void)
@@ -869,18 +983,17 @@ void ParameterManager::_sendParamSetToVehicle(int componentId, const QString& pa
 
 void ParameterManager::_writeLocalParamCache(int vehicleId, int componentId)
 {
-    CacheMapName2ParamTypeVal cacheMap;
+    QList<ParameterCacheFile::Entry_t>  entries;
+    CompInfoParam*                      compInfoParam = _vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1);
 
-    for (const QString& paramName: _mapCompId2FactMap[componentId].keys()) {
-        const Fact *fact = _mapCompId2FactMap[componentId][paramName];
-        cacheMap[paramName] = ParamTypeVal(fact->type(), fact->rawValue());
+    for (const Fact* fact: _mapCompId2FactMap[componentId]) {
+        entries.append({ fact->name(), fact->type(), fact->rawValue(), compInfoParam->factMetaDataForName(fact->name(), fact->type())->volatileValue() });
     }
 
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
-
-    QDataStream ds(&cacheFile);
-    ds << cacheMap;
+    QString errorString;
+    if (!ParameterCacheFile::write(parameterCacheFile(vehicleId, componentId), entries, errorString)) {
+        qCWarning(ParameterManagerLog) << "Parameter cache write failed" << errorString;
+    }
 }
 
 QDir ParameterManager::parameterCacheDir()
@@ -891,56 +1004,27 @@ QDir ParameterManager::parameterCacheDir()
 
 QString ParameterManager::parameterCacheFile(int vehicleId, int componentId)
 {
-    return parameterCacheDir().filePath(QString("%1_%2.v2").arg(vehicleId).arg(componentId));
+    return parameterCacheDir().filePath(QString("%1_%2.v3").arg(vehicleId).arg(componentId));
 }
 
 void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value)
 {
     qCInfo(ParameterManagerLog) << "Attemping load from cache";
 
-    uint32_t crc32_value = 0;
-    /* The datastructure of the cache table */
-    CacheMapName2ParamTypeVal cacheMap;
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    if (!cacheFile.exists()) {
+    /* The cache is memory mapped and the hash of the cached parameter set is precomputed in its header */
+    ParameterCacheFile cacheFile;
+    if (!cacheFile.open(parameterCacheFile(vehicleId, componentId))) {
         /* no local cache, just wait for them to come in*/
         return;
     }
-    cacheFile.open(QIODevice::ReadOnly);
-
-    /* Deserialize the parameter cache table */
-    QDataStream ds(&cacheFile);
-    ds >> cacheMap;
-
-    /* compute the crc of the local cache to check against the remote */
 
-    for (const QString& name: cacheMap.keys()) {
-        const ParamTypeVal&             paramTypeVal    = cacheMap[name];
-        const FactMetaData::ValueType_t fact_type       = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-
-        if (_vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1)->factMetaDataForName(name, fact_type)->volatileValue()) {
-            // Does not take part in CRC
-            qCDebug(ParameterManagerLog) << "Volatile parameter" << name;
-        } else {
-            const void *vdat = paramTypeVal.second.constData();
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            crc32_value = QGC::crc32((const uint8_t *)qPrintable(name), name.length(),  crc32_value);
-            crc32_value = QGC::crc32((const uint8_t *)vdat, FactMetaData::typeToSize(fact_type), crc32_value);
-        }
-    }
+    const uint32_t crc32_value = cacheFile.hash();
 
     /* if the two param set hashes match, just load from the disk */
     if (crc32_value == hash_value.toUInt()) {
-        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
-
-        int count = cacheMap.count();
-        int index = 0;
-        for (const QString& name: cacheMap.keys()) {
-            const ParamTypeVal& paramTypeVal = cacheMap[name];
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            const MAV_PARAM_TYPE mavParamType = factTypeToMavType(fact_type);
-            _handleParamValue(componentId, name, count, index++, mavParamType, paramTypeVal.second);
-        }
+        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(parameterCacheFile(vehicleId, componentId));
+
+        _loadParamCache(componentId, cacheFile);
 
         WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
 
@@ -986,11 +1070,12 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
 
         ani->start(QAbstractAnimation::DeleteWhenStopped);
     } else {
-        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
+        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(parameterCacheFile(vehicleId, componentId));
         if (ParameterManagerDebugCacheFailureLog().isDebugEnabled()) {
             _debugCacheCRC[componentId] = true;
-            _debugCacheMap[componentId] = cacheMap;
-            for (const QString& name: cacheMap.keys()) {
+            for (int i=0; i<cacheFile.count(); i++) {
+                const QString name = cacheFile.name(i);
+                _debugCacheMap[componentId][name] = ParamTypeVal(cacheFile.type(i), cacheFile.value(i));
                 _debugCacheParamSeen[componentId][name] = false;
             }
             qgcApp()->showAppMessage(tr("Parameter cache CRC match failed"));
@@ -998,6 +1083,74 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
     }
 }
 
+/// Loads all parameters for a component straight from the cache into the fact map. Since the cached set is known to match
+/// the vehicle this bypasses the wait list bookkeeping which _handleParamValue does for each parameter.
+void ParameterManager::_loadParamCache(int componentId, const ParameterCacheFile& cacheFile)
+{
+    QMap<QString, Fact*>&   factMap         = _mapCompId2FactMap[componentId];
+    CompInfoParam*          compInfoParam   = _vehicle->compInfoManager()->compInfoParam(componentId);
+
+    for (int i=0; i<cacheFile.count(); i++) {
+        const QString   name    = cacheFile.name(i);
+        Fact*           fact    = factMap.value(name, nullptr);
+
+        if (!fact) {
+            fact = new Fact(componentId, name, cacheFile.type(i), this);
+            fact->setMetaData(compInfoParam->factMetaDataForName(name, fact->type()));
+
+            factMap[name] = fact;
+
+            // We need to know when the fact value changes so we can update the vehicle
+            connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_factRawValueUpdated);
+
+            emit factAdded(componentId, fact);
+        }
+        fact->_containerSetRawValue(cacheFile.value(i));
+    }
+
+    /* Some parameters may have already streamed in, but we now have all of them */
+    if (!_paramCountMap.contains(componentId)) {
+        _paramCountMap[componentId] = cacheFile.count();
+        _totalParamCount += cacheFile.count();
+    }
+    _waitingReadParamIndexMap[componentId] = ParameterIndexWaitList();
+    if (!_waitingReadParamNameMap.contains(componentId)) {
+        _waitingReadParamNameMap[componentId] = QMap<QString, int>();
+    }
+    if (!_waitingWriteParamNameMap.contains(componentId)) {
+        _waitingWriteParamNameMap[componentId] = QMap<QString, int>();
+    }
+
+    // Track how many parameters we are still waiting for, the same as _handleParamValue would have after the last one
+    int waitingReadParamIndexCount = 0;
+    int waitingReadParamNameCount = 0;
+    int waitingWriteParamNameCount = 0;
+    for (const ParameterIndexWaitList& waitList: _waitingReadParamIndexMap) {
+        waitingReadParamIndexCount += waitList.count();
+    }
+    for (const QMap<QString, int>& waitMap: _waitingReadParamNameMap) {
+        waitingReadParamNameCount += waitMap.count();
+    }
+    for (const QMap<QString, int>& waitMap: _waitingWriteParamNameMap) {
+        waitingWriteParamNameCount += waitMap.count();
+    }
+    _prevWaitingReadParamIndexCount = waitingReadParamIndexCount;
+    _prevWaitingReadParamNameCount = waitingReadParamNameCount;
+    _prevWaitingWriteParamNameCount = waitingWriteParamNameCount;
+
+    _initialRequestTimeoutTimer.stop();
+    if (waitingReadParamIndexCount + waitingReadParamNameCount + waitingWriteParamNameCount || !_mapCompId2FactMap.contains(_vehicle->defaultComponentId())) {
+        _waitingParamTimeoutTimer.start();
+    } else {
+        _waitingParamTimeoutTimer.stop();
+    }
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Loaded from cache - paramcount:" << cacheFile.count();
+
+    _updateProgressBar();
+    _checkInitialLoadComplete();
+}
+
 QString ParameterManager::readParametersFromStream(QTextStream& stream)
 {
     QString missingErrors;
@@ -1611,7 +1764,7 @@ Success:
     /* Create empty waiting lists as we have all parameters */
     _paramCountMap[componentId] = num_params;
     _totalParamCount += num_params;
-    _waitingReadParamIndexMap[componentId] = QMap<int, int>();
+    _waitingReadParamIndexMap[componentId] = ParameterIndexWaitList();
     _waitingReadParamNameMap[componentId] = QMap<QString, int>();
     _waitingWriteParamNameMap[componentId] = QMap<QString, int>();
     _checkInitialLoadComplete();
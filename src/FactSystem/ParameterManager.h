@@ -16,6 +16,11 @@
 #include <QMutex>
 #include <QDir>
 #include <QJsonObject>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QtAlgorithms>
 
 #include "FactSystem.h"
 #include "MAVLinkProtocol.h"
@@ -28,6 +33,68 @@ Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose2Log)
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerDebugCacheFailureLog)
 
 class ParameterEditorController;
+class ParameterCacheFile;
+
+/// Set of parameter indices of a single component which are still waiting to be received, along with their retry counts.
+/// Stored as a bitmap so that finding the next missing index skips over whole words of received parameters.
+class ParameterIndexWaitList
+{
+public:
+    /// Marks all indices in [0,paramCount) as waiting with a retry count of 0
+    void reset(int paramCount)
+    {
+        _words.fill(0, (paramCount + 63) / 64);
+        for (int i=0; i<paramCount / 64; i++) {
+            _words[i] = ~quint64(0);
+        }
+        if (paramCount % 64) {
+            _words[paramCount / 64] = (quint64(1) << (paramCount % 64)) - 1;
+        }
+        _retryCounts.fill(0, paramCount);
+        _count      = paramCount;
+        scanCursor  = 0;
+    }
+
+    int  count      (void) const        { return _count; }
+    bool contains   (int index) const   { return index >= 0 && index < _retryCounts.count() && (_words[index / 64] & (quint64(1) << (index % 64))); }
+    int  retryCount (int index) const   { return _retryCounts[index]; }
+    int  bumpRetryCount(int index)      { return ++_retryCounts[index]; }
+
+    /// @return true: index was waiting and has been removed
+    bool remove(int index)
+    {
+        if (!contains(index)) {
+            return false;
+        }
+        _words[index / 64] &= ~(quint64(1) << (index % 64));
+        _count--;
+        return true;
+    }
+
+    /// @return First waiting index >= fromIndex, -1 if none
+    int nextWaiting(int fromIndex) const
+    {
+        if (fromIndex < 0 || fromIndex >= _retryCounts.count()) {
+            return -1;
+        }
+        int     wordIndex   = fromIndex / 64;
+        quint64 word        = _words[wordIndex] & (~quint64(0) << (fromIndex % 64));
+        while (!word) {
+            if (++wordIndex >= _words.count()) {
+                return -1;
+            }
+            word = _words[wordIndex];
+        }
+        return (wordIndex * 64) + qCountTrailingZeroBits(word);
+    }
+
+    int scanCursor = 0;     ///< Round robin position of the next re-request scan
+
+private:
+    QVector<quint64>    _words;
+    QVector<quint8>     _retryCounts;
+    int                 _count = 0;
+};
 
 class ParameterManager : public QObject
 {
@@ -117,6 +184,7 @@ private:
     void    _sendParamSetToVehicle              (int componentId, const QString& paramName, FactMetaData::ValueType_t valueType, const QVariant& value);
     void    _writeLocalParamCache               (int vehicleId, int componentId);
     void    _tryCacheHashLoad                   (int vehicleId, int componentId, QVariant hash_value);
+    void    _loadParamCache                     (int componentId, const ParameterCacheFile& cacheFile);
     void    _loadMetaData                       (void);
     void    _clearMetaData                      (void);
     QString _remapParamNameToVersion            (const QString& paramName);
@@ -124,10 +192,14 @@ private:
     QString _logVehiclePrefix                   (int componentId);
     void    _setLoadProgress                    (double loadProgress);
     bool    _fillIndexBatchQueue                (bool waitingParamTimeout);
+    void    _indexRequestResponse               (int componentId, int paramIndex);
+    void    _indexRequestTimeoutCheck           (void);
+    void    _shrinkIndexRequestWindow           (void);
+    int     _indexRequestTimeoutMSecs           (void) const;
     void    _updateProgressBar                  (void);
     void    _checkInitialLoadComplete           (void);
-    void    _ftpDownloadComplete                (const QString& fileName, const QString& errorMsg);
-    void    _ftpDownloadProgress                (float progress);
+    void    _ftpDownloadComplete                (const QString& fileName, const QString& errorMsg, int downloadId);
+    void    _ftpDownloadProgress                (float progress, int downloadId);
     bool    _parseParamFile                     (const QString& filename);
 
     static QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool failOk = false);
@@ -169,10 +241,30 @@ private:
     bool                _disableAllRetries;                     ///< true: Don't retry any requests (used for testing)
 
     bool        _indexBatchQueueActive; ///< true: we are actively batching re-requests for missing index base params, false: index based re-request has not yet started
-    QList<int>  _indexBatchQueue;       ///< The current queue of index re-requests
 
-    QMap<int, int>                  _paramCountMap;             ///< Key: Component id, Value: count of parameters in this component
-    QMap<int, QMap<int, int> >      _waitingReadParamIndexMap;  ///< Key: Component id, Value: Map { Key: parameter index still waiting for, Value: retry count }
+    // Index based re-requests are pipelined through a window of in flight requests. The window grows while responses
+    // come back and is halved when requests are lost, the same way a TCP congestion window works. The per request
+    // timeout is derived from the smoothed round trip time of the responses.
+    static constexpr int    _indexWindowMin                 = 1;
+    static constexpr int    _indexWindowMax                 = 64;
+    static constexpr int    _indexWindowInitial             = 10;
+    static constexpr int    _indexRequestTimeoutMinMSecs    = 100;
+    static constexpr int    _indexRequestTimeoutMaxMSecs    = 2000;
+    static constexpr int    _indexRequestCheckMSecs         = 50;
+
+    double                  _indexWindow                    = _indexWindowInitial;  ///< Max number of index requests in flight
+    double                  _indexWindowThreshold           = _indexWindowMax;      ///< Window grows by one per response below this, by 1/window above
+    double                  _indexRttMSecs                  = -1;                   ///< Smoothed round trip time, -1 for no samples yet
+    double                  _indexRttVarMSecs               = 0;                    ///< Smoothed round trip time variation
+    qint64                  _indexWindowShrinkMSecs         = 0;                    ///< Time of last window decrease, window only shrinks once per timeout period
+    int                     _indexRequestsSent              = 0;
+    int                     _indexRequestsLost              = 0;
+    QHash<quint32, qint64>  _indexRequestsInFlight;                                 ///< Key: component id << 16 | param index, Value: send time
+    QElapsedTimer           _indexRequestClock;
+    QTimer                  _indexRequestTimer;
+
+    QMap<int, int>                      _paramCountMap;             ///< Key: Component id, Value: count of parameters in this component
+    QMap<int, ParameterIndexWaitList>   _waitingReadParamIndexMap;  ///< Key: Component id, Value: parameter indices still waiting for
     QMap<int, QMap<QString, int> >  _waitingReadParamNameMap;   ///< Key: Component id, Value: Map { Key: parameter name still waiting for, Value: retry count }
     QMap<int, QMap<QString, int> >  _waitingWriteParamNameMap;  ///< Key: Component id, Value: Map { Key: parameter name still waiting for, Value: retry count }
     QMap<int, QList<int> >          _failedReadParamIndexMap;   ///< Key: Component id, Value: failed parameter index
@@ -188,4 +280,5 @@ private:
 
     /* MavFTP */
     bool               _tryftp;
+    int                _ftpDownloadId = 0;  ///< FTPManager download id of the parameter file, 0 for none
 };
@@ -256,6 +256,16 @@ FlightMap {
         z:          QGroundControl.zOrderTrajectoryLines
         visible:    !pipMode
 
+        // Simplification only drops points, so coordinates is never longer than the range it replaces
+        function replaceCoordinates(first, count, coordinates) {
+            for (var i = 0; i < coordinates.length; i++) {
+                replaceCoordinate(first + i, coordinates[i])
+            }
+            for (var j = coordinates.length; j < count; j++) {
+                removeCoordinate(first + coordinates.length)
+            }
+        }
+
         Connections {
             target:                 QGroundControl.multiVehicleManager
             function onActiveVehicleChanged(activeVehicle) {
@@ -267,7 +277,17 @@ FlightMap {
             target:                             _activeVehicle ? _activeVehicle.trajectoryPoints : null
             onPointAdded: (coordinate) =>       trajectoryPolyline.addCoordinate(coordinate)
             onUpdateLastPoint: (coordinate) =>  trajectoryPolyline.replaceCoordinate(trajectoryPolyline.pathLength() - 1, coordinate)
+            onPointsReplaced: (first, count, coordinates) => trajectoryPolyline.replaceCoordinates(first, count, coordinates)
             onPointsCleared:                    trajectoryPolyline.path = []
+            onPointsReset:                      trajectoryPolyline.path = _activeVehicle.trajectoryPoints.list()
+        }
+
+        // The trail is simplified to the map resolution in meters per pixel
+        Binding {
+            target:     _activeVehicle ? _activeVehicle.trajectoryPoints : null
+            property:   "resolution"
+            value:      156543.03392 * Math.cos(_root.center.latitude * Math.PI / 180) / Math.pow(2, _root.zoomLevel)
+            when:       _activeVehicle
         }
     }
 
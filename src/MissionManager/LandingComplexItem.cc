@@ -524,6 +524,9 @@ void LandingComplexItem::setDirty(bool dirty)
         _dirty = dirty;
         emit dirtyChanged(_dirty);
     }
+    if (dirty) {
+        emit modified();
+    }
 }
 
 void LandingComplexItem::_setDirty(void)
@@ -33,6 +33,10 @@
 #include "TakeoffMissionItem.h"
 #include "PlanViewSettings.h"
 
+#include <QSet>
+
+#include <limits>
+
 #define UPDATE_TIMEOUT 5000 ///< How often we check for bounding box changes
 
 QGC_LOGGING_CATEGORY(MissionControllerLog, "MissionControllerLog")
@@ -791,94 +795,12 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
             errorString = tr("Mission item %1 is not an object").arg(i);
             return false;
         }
-        const QJsonObject itemObject = itemValue.toObject();
-
-        // Load item based on type
-
-        QList<JsonHelper::KeyValidateInfo> itemKeyInfoList = {
-            { VisualMissionItem::jsonTypeKey,  QJsonValue::String, true },
-        };
-        if (!JsonHelper::validateKeys(itemObject, itemKeyInfoList, errorString)) {
+        VisualMissionItem* visualItem = nullptr;
+        if (!_loadVisualItem(itemValue.toObject(), settingsItem, nextSequenceNumber, visualItem, errorString)) {
             return false;
         }
-        QString itemType = itemObject[VisualMissionItem::jsonTypeKey].toString();
-
-        if (itemType == VisualMissionItem::jsonTypeSimpleItemValue) {
-            SimpleMissionItem* simpleItem = new SimpleMissionItem(_masterController, _flyView, true /* forLoad */);
-            if (simpleItem->load(itemObject, nextSequenceNumber, errorString)) {
-                if (TakeoffMissionItem::isTakeoffCommand(static_cast<MAV_CMD>(simpleItem->command()))) {
-                    // This needs to be a TakeoffMissionItem
-                    TakeoffMissionItem* takeoffItem = new TakeoffMissionItem(_masterController, _flyView, settingsItem, true /* forLoad */);
-                    takeoffItem->load(itemObject, nextSequenceNumber, errorString);
-                    simpleItem->deleteLater();
-                    simpleItem = takeoffItem;
-                }
-                qCDebug(MissionControllerLog) << "Loading simple item: nextSequenceNumber:command" << nextSequenceNumber << simpleItem->command();
-                nextSequenceNumber = simpleItem->lastSequenceNumber() + 1;
-                visualItems->append(simpleItem);
-            } else {
-                return false;
-            }
-        } else if (itemType == VisualMissionItem::jsonTypeComplexItemValue) {
-            QList<JsonHelper::KeyValidateInfo> complexItemKeyInfoList = {
-                { ComplexMissionItem::jsonComplexItemTypeKey,  QJsonValue::String, true },
-            };
-            if (!JsonHelper::validateKeys(itemObject, complexItemKeyInfoList, errorString)) {
-                return false;
-            }
-            QString complexItemType = itemObject[ComplexMissionItem::jsonComplexItemTypeKey].toString();
-
-            if (complexItemType == SurveyComplexItem::jsonComplexItemTypeValue) {
-                qCDebug(MissionControllerLog) << "Loading Survey: nextSequenceNumber" << nextSequenceNumber;
-                SurveyComplexItem* surveyItem = new SurveyComplexItem(_masterController, _flyView, QString() /* kmlFile */);
-                if (!surveyItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
-                }
-                nextSequenceNumber = surveyItem->lastSequenceNumber() + 1;
-                qCDebug(MissionControllerLog) << "Survey load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(surveyItem);
-            } else if (complexItemType == FixedWingLandingComplexItem::jsonComplexItemTypeValue) {
-                qCDebug(MissionControllerLog) << "Loading Fixed Wing Landing Pattern: nextSequenceNumber" << nextSequenceNumber;
-                FixedWingLandingComplexItem* landingItem = new FixedWingLandingComplexItem(_masterController, _flyView);
-                if (!landingItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
-                }
-                nextSequenceNumber = landingItem->lastSequenceNumber() + 1;
-                qCDebug(MissionControllerLog) << "FW Landing Pattern load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(landingItem);
-            } else if (complexItemType == VTOLLandingComplexItem::jsonComplexItemTypeValue) {
-                qCDebug(MissionControllerLog) << "Loading VTOL Landing Pattern: nextSequenceNumber" << nextSequenceNumber;
-                VTOLLandingComplexItem* landingItem = new VTOLLandingComplexItem(_masterController, _flyView);
-                if (!landingItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
-                }
-                nextSequenceNumber = landingItem->lastSequenceNumber() + 1;
-                qCDebug(MissionControllerLog) << "VTOL Landing Pattern load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(landingItem);
-            } else if (complexItemType == StructureScanComplexItem::jsonComplexItemTypeValue) {
-                qCDebug(MissionControllerLog) << "Loading Structure Scan: nextSequenceNumber" << nextSequenceNumber;
-                StructureScanComplexItem* structureItem = new StructureScanComplexItem(_masterController, _flyView, QString() /* kmlFile */);
-                if (!structureItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
-                }
-                nextSequenceNumber = structureItem->lastSequenceNumber() + 1;
-                qCDebug(MissionControllerLog) << "Structure Scan load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(structureItem);
-            } else if (complexItemType == CorridorScanComplexItem::jsonComplexItemTypeValue) {
-                qCDebug(MissionControllerLog) << "Loading Corridor Scan: nextSequenceNumber" << nextSequenceNumber;
-                CorridorScanComplexItem* corridorItem = new CorridorScanComplexItem(_masterController, _flyView, QString() /* kmlFile */);
-                if (!corridorItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
-                }
-                nextSequenceNumber = corridorItem->lastSequenceNumber() + 1;
-                qCDebug(MissionControllerLog) << "Corridor Scan load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(corridorItem);
-            } else {
-                errorString = tr("Unsupported complex item type: %1").arg(complexItemType);
-            }
-        } else {
-            errorString = tr("Unknown item type: %1").arg(itemType);
-            return false;
+        if (visualItem) {
+            visualItems->append(visualItem);
         }
     }
 
@@ -910,6 +832,103 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
     return true;
 }
 
+/// Creates the visual item for a single item object of a V2 mission
+///     @param[in,out] nextSequenceNumber Sequence number for the item, updated to the one following the item
+///     @param[out] visualItem Loaded item, nullptr for unsupported complex item types which are skipped
+/// @return false: load failed, errorString set
+bool MissionController::_loadVisualItem(const QJsonObject& itemObject, MissionSettingsItem* settingsItem, int& nextSequenceNumber, VisualMissionItem*& visualItem, QString& errorString)
+{
+    visualItem = nullptr;
+
+    QList<JsonHelper::KeyValidateInfo> itemKeyInfoList = {
+        { VisualMissionItem::jsonTypeKey,  QJsonValue::String, true },
+    };
+    if (!JsonHelper::validateKeys(itemObject, itemKeyInfoList, errorString)) {
+        return false;
+    }
+    QString itemType = itemObject[VisualMissionItem::jsonTypeKey].toString();
+
+    if (itemType == VisualMissionItem::jsonTypeSimpleItemValue) {
+        SimpleMissionItem* simpleItem = new SimpleMissionItem(_masterController, _flyView, true /* forLoad */);
+        if (simpleItem->load(itemObject, nextSequenceNumber, errorString)) {
+            if (TakeoffMissionItem::isTakeoffCommand(static_cast<MAV_CMD>(simpleItem->command()))) {
+                // This needs to be a TakeoffMissionItem
+                TakeoffMissionItem* takeoffItem = new TakeoffMissionItem(_masterController, _flyView, settingsItem, true /* forLoad */);
+                takeoffItem->load(itemObject, nextSequenceNumber, errorString);
+                simpleItem->deleteLater();
+                simpleItem = takeoffItem;
+            }
+            qCDebug(MissionControllerLog) << "Loading simple item: nextSequenceNumber:command" << nextSequenceNumber << simpleItem->command();
+            nextSequenceNumber = simpleItem->lastSequenceNumber() + 1;
+            visualItem = simpleItem;
+        } else {
+            return false;
+        }
+    } else if (itemType == VisualMissionItem::jsonTypeComplexItemValue) {
+        QList<JsonHelper::KeyValidateInfo> complexItemKeyInfoList = {
+            { ComplexMissionItem::jsonComplexItemTypeKey,  QJsonValue::String, true },
+        };
+        if (!JsonHelper::validateKeys(itemObject, complexItemKeyInfoList, errorString)) {
+            return false;
+        }
+        QString complexItemType = itemObject[ComplexMissionItem::jsonComplexItemTypeKey].toString();
+
+        if (complexItemType == SurveyComplexItem::jsonComplexItemTypeValue) {
+            qCDebug(MissionControllerLog) << "Loading Survey: nextSequenceNumber" << nextSequenceNumber;
+            SurveyComplexItem* surveyItem = new SurveyComplexItem(_masterController, _flyView, QString() /* kmlFile */);
+            if (!surveyItem->load(itemObject, nextSequenceNumber++, errorString)) {
+                return false;
+            }
+            nextSequenceNumber = surveyItem->lastSequenceNumber() + 1;
+            qCDebug(MissionControllerLog) << "Survey load complete: nextSequenceNumber" << nextSequenceNumber;
+            visualItem = surveyItem;
+        } else if (complexItemType == FixedWingLandingComplexItem::jsonComplexItemTypeValue) {
+            qCDebug(MissionControllerLog) << "Loading Fixed Wing Landing Pattern: nextSequenceNumber" << nextSequenceNumber;
+            FixedWingLandingComplexItem* landingItem = new FixedWingLandingComplexItem(_masterController, _flyView);
+            if (!landingItem->load(itemObject, nextSequenceNumber++, errorString)) {
+                return false;
+            }
+            nextSequenceNumber = landingItem->lastSequenceNumber() + 1;
+            qCDebug(MissionControllerLog) << "FW Landing Pattern load complete: nextSequenceNumber" << nextSequenceNumber;
+            visualItem = landingItem;
+        } else if (complexItemType == VTOLLandingComplexItem::jsonComplexItemTypeValue) {
+            qCDebug(MissionControllerLog) << "Loading VTOL Landing Pattern: nextSequenceNumber" << nextSequenceNumber;
+            VTOLLandingComplexItem* landingItem = new VTOLLandingComplexItem(_masterController, _flyView);
+            if (!landingItem->load(itemObject, nextSequenceNumber++, errorString)) {
+                return false;
+            }
+            nextSequenceNumber = landingItem->lastSequenceNumber() + 1;
+            qCDebug(MissionControllerLog) << "VTOL Landing Pattern load complete: nextSequenceNumber" << nextSequenceNumber;
+            visualItem = landingItem;
+        } else if (complexItemType == StructureScanComplexItem::jsonComplexItemTypeValue) {
+            qCDebug(MissionControllerLog) << "Loading Structure Scan: nextSequenceNumber" << nextSequenceNumber;
+            StructureScanComplexItem* structureItem = new StructureScanComplexItem(_masterController, _flyView, QString() /* kmlFile */);
+            if (!structureItem->load(itemObject, nextSequenceNumber++, errorString)) {
+                return false;
+            }
+            nextSequenceNumber = structureItem->lastSequenceNumber() + 1;
+            qCDebug(MissionControllerLog) << "Structure Scan load complete: nextSequenceNumber" << nextSequenceNumber;
+            visualItem = structureItem;
+        } else if (complexItemType == CorridorScanComplexItem::jsonComplexItemTypeValue) {
+            qCDebug(MissionControllerLog) << "Loading Corridor Scan: nextSequenceNumber" << nextSequenceNumber;
+            CorridorScanComplexItem* corridorItem = new CorridorScanComplexItem(_masterController, _flyView, QString() /* kmlFile */);
+            if (!corridorItem->load(itemObject, nextSequenceNumber++, errorString)) {
+                return false;
+            }
+            nextSequenceNumber = corridorItem->lastSequenceNumber() + 1;
+            qCDebug(MissionControllerLog) << "Corridor Scan load complete: nextSequenceNumber" << nextSequenceNumber;
+            visualItem = corridorItem;
+        } else {
+            errorString = tr("Unsupported complex item type: %1").arg(complexItemType);
+        }
+    } else {
+        errorString = tr("Unknown item type: %1").arg(itemType);
+        return false;
+    }
+
+    return true;
+}
+
 bool MissionController::_loadItemsFromJson(const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString)
 {
     // V1 file format has no file type key and version key is string. Convert to new format.
@@ -1141,6 +1160,137 @@ void MissionController::save(QJsonObject& json)
     json[_jsonItemsKey] = rgJsonMissionItems;
 }
 
+void MissionController::saveMissionSettings(QJsonObject& json) const
+{
+    QJsonValue coordinateValue;
+    JsonHelper::saveGeoCoordinate(plannedHomePosition(), true /* writeAltitude */, coordinateValue);
+    json[_jsonPlannedHomePositionKey]       = coordinateValue;
+    json[_jsonGlobalPlanAltitudeModeKey]    = _globalAltMode;
+}
+
+void MissionController::loadMissionSettings(const QJsonObject& json)
+{
+    QString         errorString;
+    QGeoCoordinate  homeCoordinate;
+
+    if (_settingsItem && JsonHelper::loadGeoCoordinate(json[_jsonPlannedHomePositionKey], true /* altitudeRequired */, homeCoordinate, errorString)) {
+        _settingsItem->setCoordinate(homeCoordinate);
+    }
+    setGlobalAltitudeMode(json[_jsonGlobalPlanAltitudeModeKey].toVariant().value<QGroundControlQmlGlobal::AltMode>());
+}
+
+VisualMissionItem* MissionController::loadVisualItem(const QJsonArray& json, QString& errorString)
+{
+    if (json.isEmpty() || !json[0].isObject()) {
+        errorString = tr("Mission item is not an object");
+        return nullptr;
+    }
+
+    // Sequence numbers are fixed up once the item is part of the mission
+    int                 nextSequenceNumber  = 1;
+    VisualMissionItem*  visualItem          = nullptr;
+    if (!_loadVisualItem(json[0].toObject(), _settingsItem, nextSequenceNumber, visualItem, errorString) || !visualItem) {
+        return nullptr;
+    }
+
+    // Simple items save their camera and speed sections as separate items following the item itself
+    SimpleMissionItem* simpleItem = qobject_cast<SimpleMissionItem*>(visualItem);
+    if (simpleItem && json.count() > 1) {
+        QmlObjectListModel sectionItems;
+
+        sectionItems.append(simpleItem);
+        for (int i=1; i<json.count(); i++) {
+            SimpleMissionItem* sectionItem = new SimpleMissionItem(_masterController, _flyView, true /* forLoad */);
+            sectionItems.append(sectionItem);
+            if (!sectionItem->load(json[i].toObject(), nextSequenceNumber, errorString)) {
+                sectionItems.clearAndDeleteContents();
+                return nullptr;
+            }
+            nextSequenceNumber = sectionItem->lastSequenceNumber() + 1;
+        }
+        simpleItem->scanForSections(&sectionItems, 1, _masterController);
+
+        // Anything which wasn't picked up by a section is dropped
+        for (int i=1; i<sectionItems.count(); i++) {
+            sectionItems[i]->deleteLater();
+        }
+    }
+
+    return visualItem;
+}
+
+void MissionController::replaceVisualItems(const QList<VisualMissionItem*>& visualItems)
+{
+    // Only the range between the unchanged items at the start and end of the mission is touched
+    const int oldCount  = _visualItems->count() - 1;
+    const int newCount  = visualItems.count();
+    int       prefix    = 0;
+    int       suffix    = 0;
+
+    while (prefix < oldCount && prefix < newCount && _visualItems->get(prefix + 1) == visualItems[prefix]) {
+        prefix++;
+    }
+    if (prefix == oldCount && prefix == newCount) {
+        return;
+    }
+    while (suffix < oldCount - prefix && suffix < newCount - prefix && _visualItems->get(oldCount - suffix) == visualItems[newCount - 1 - suffix]) {
+        suffix++;
+    }
+
+    QSet<QObject*> removedItems;
+    for (int i=oldCount-suffix; i>prefix; i--) {
+        removedItems.insert(_visualItems->removeAt(i));
+    }
+
+    QList<QObject*> insertedItems;
+    for (int i=prefix; i<newCount-suffix; i++) {
+        VisualMissionItem* item = visualItems[i];
+        if (!removedItems.remove(item)) {
+            _initVisualItem(item);
+        }
+        insertedItems.append(item);
+    }
+    if (!insertedItems.isEmpty()) {
+        _visualItems->insert(prefix + 1, insertedItems);
+    }
+
+    for (QObject* object: removedItems) {
+        VisualMissionItem* item = qobject_cast<VisualMissionItem*>(object);
+        if (item == _takeoffMissionItem) {
+            _takeoffMissionItem = nullptr;
+        }
+        _deinitVisualItem(item);
+        item->deleteLater();
+    }
+    for (QObject* object: insertedItems) {
+        TakeoffMissionItem* takeoffItem = qobject_cast<TakeoffMissionItem*>(object);
+        if (takeoffItem) {
+            _takeoffMissionItem = takeoffItem;
+        }
+    }
+
+    _recalcAll();
+
+    // Keep the current item if it is still part of the mission
+    int currentSeqNum = 0;
+    for (int i=1; i<_visualItems->count(); i++) {
+        VisualMissionItem* item = _visualItems->value<VisualMissionItem*>(i);
+        if (item == _currentPlanViewItem) {
+            currentSeqNum = item->sequenceNumber();
+            break;
+        }
+    }
+    setCurrentPlanViewSeqNum(currentSeqNum, true);
+
+    setDirty(true);
+
+    if (_visualItems->count() > 1) {
+        _firstItemAdded();
+    } else {
+        _allItemsRemoved();
+    }
+}
+
 void MissionController::_calcPrevWaypointValues(VisualMissionItem* currentItem, VisualMissionItem* prevItem, double* azimuth, double* distance, double* altDifference)
 {
     QGeoCoordinate  currentCoord =  currentItem->coordinate();
@@ -1193,11 +1343,13 @@ FlightPathSegment* MissionController::_createFlightPathSegmentWorker(VisualItemP
     connect(pair.second, &VisualMissionItem::coordinateChanged,     segment,    &FlightPathSegment::setCoordinate2);
     connect(pair.second, &VisualMissionItem::amslEntryAltChanged,   segment,    &FlightPathSegment::setCoord2AMSLAlt);
 
-    connect(pair.second, &VisualMissionItem::coordinateChanged,         this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(pair.second, &VisualMissionItem::coordinateChanged,         this,       &MissionController::_flightStatusChanged,             Qt::UniqueConnection);
 
+    // Altitude changes at either end of the segment affect the flight status from the first item of the pair on
+    VisualMissionItem* firstItem = pair.first;
     connect(segment,    &FlightPathSegment::totalDistanceChanged,       this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
-    connect(segment,    &FlightPathSegment::coord1AMSLAltChanged,       this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(segment,    &FlightPathSegment::coord2AMSLAltChanged,       this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(segment,    &FlightPathSegment::coord1AMSLAltChanged,       this,       [this, firstItem]() { _markFlightStatusDirty(firstItem); });
+    connect(segment,    &FlightPathSegment::coord2AMSLAltChanged,       this,       [this, firstItem]() { _markFlightStatusDirty(firstItem); });
     connect(segment,    &FlightPathSegment::amslTerrainHeightsChanged,  this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
     connect(segment,    &FlightPathSegment::terrainCollisionChanged,    this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
 
@@ -1446,7 +1598,7 @@ void MissionController::_recalcFlightPathSegments(void)
     // Anything left in the old table is an obsolete line object that can go
     qDeleteAll(oldSegmentTable);
 
-    emit _recalcMissionFlightStatusSignal();
+    _markFlightStatusDirty(nullptr);
 
     if (_waypointPath.count() == 0) {
         // MapPolyLine has a bug where if you change from a path which has elements to an empty path the line drawn
@@ -1534,28 +1686,73 @@ void MissionController::_recalcMissionFlightStatus()
 
     bool homePositionValid = _settingsItem->coordinate().isValid();
 
-    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus";
+    // Items before the first changed one keep their values. The walk restarts from the state saved before that item,
+    // as long as the items up to there are still the ones the states were saved for.
+    const int itemCount = _visualItems->count();
+    int startIndex = qMax(0, qMin(_flightStatusDirtyIndex, qMin(itemCount, _flightStatusCheckpoints.count() - 1)));
+    for (int i=0; i<startIndex; i++) {
+        if (_flightStatusCheckpoints[i].item != _visualItems->get(i)) {
+            startIndex = i;
+            break;
+        }
+    }
+    _flightStatusDirtyIndex = std::numeric_limits<int>::max();
+    _flightStatusCheckpoints.resize(itemCount + 1);
+
+    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus startIndex" << startIndex << "itemCount" << itemCount;
 
     // If home position is valid we can calculate distances between all waypoints.
     // If home position is not valid we can only calculate distances between waypoints which are
     // both relative altitude.
 
-    // No values for first item
-    lastFlyThroughVI->setAltDifference(0);
-    lastFlyThroughVI->setAzimuth(0);
-    lastFlyThroughVI->setDistance(0);
-    lastFlyThroughVI->setDistanceFromStart(0);
-
-    _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
-
-    _resetMissionFlightStatus();
+    const double prevMinAMSLAltitude = _minAMSLAltitude;
+    const double prevMaxAMSLAltitude = _maxAMSLAltitude;
 
     bool   linkStartToHome =            false;
     bool   foundRTL =                   false;
     double totalHorizontalDistance =    0;
 
-    for (int i=0; i<_visualItems->count(); i++) {
-        VisualMissionItem*  item =          qobject_cast<VisualMissionItem*>(_visualItems->get(i));
+    if (startIndex == 0) {
+        // No values for first item
+        lastFlyThroughVI->setAltDifference(0);
+        lastFlyThroughVI->setAzimuth(0);
+        lastFlyThroughVI->setDistance(0);
+        lastFlyThroughVI->setDistanceFromStart(0);
+
+        _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
+
+        _resetMissionFlightStatus();
+        _flightStatusItemIndices.clear();
+    } else {
+        const FlightStatusCheckpoint_t& checkpoint = _flightStatusCheckpoints[startIndex];
+        _missionFlightStatus    = checkpoint.flightStatus;
+        lastFlyThroughVI        = checkpoint.lastFlyThroughVI;
+        totalHorizontalDistance = checkpoint.totalHorizontalDistance;
+        _minAMSLAltitude        = checkpoint.minAMSLAltitude;
+        _maxAMSLAltitude        = checkpoint.maxAMSLAltitude;
+        firstCoordinateItem     = checkpoint.firstCoordinateItem;
+        linkStartToHome         = checkpoint.linkStartToHome;
+        foundRTL                = checkpoint.foundRTL;
+    }
+
+    for (int i=startIndex; i<=itemCount; i++) {
+        VisualMissionItem* item = i < itemCount ? qobject_cast<VisualMissionItem*>(_visualItems->get(i)) : nullptr;
+
+        FlightStatusCheckpoint_t& checkpoint = _flightStatusCheckpoints[i];
+        checkpoint.item                     = item;
+        checkpoint.flightStatus             = _missionFlightStatus;
+        checkpoint.lastFlyThroughVI         = lastFlyThroughVI;
+        checkpoint.totalHorizontalDistance  = totalHorizontalDistance;
+        checkpoint.minAMSLAltitude          = _minAMSLAltitude;
+        checkpoint.maxAMSLAltitude          = _maxAMSLAltitude;
+        checkpoint.firstCoordinateItem      = firstCoordinateItem;
+        checkpoint.linkStartToHome          = linkStartToHome;
+        checkpoint.foundRTL                 = foundRTL;
+        if (!item) {
+            break;
+        }
+        _flightStatusItemIndices[item] = i;
+
         SimpleMissionItem*  simpleItem =    qobject_cast<SimpleMissionItem*>(item);
         ComplexMissionItem* complexItem =   qobject_cast<ComplexMissionItem*>(item);
 
@@ -1768,9 +1965,11 @@ void MissionController::_recalcMissionFlightStatus()
     emit minAMSLAltitudeChanged         (_minAMSLAltitude);
     emit maxAMSLAltitudeChanged         (_maxAMSLAltitude);
 
-    // Walk the list again calculating altitude percentages
+    // Walk the list again calculating altitude percentages. They are relative to the mission wide altitude range, so
+    // all items need updating when the range changed.
     double altRange = _maxAMSLAltitude - _minAMSLAltitude;
-    for (int i=0; i<_visualItems->count(); i++) {
+    const int percentStartIndex = _minAMSLAltitude == prevMinAMSLAltitude && _maxAMSLAltitude == prevMaxAMSLAltitude ? startIndex : 0;
+    for (int i=percentStartIndex; i<_visualItems->count(); i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
 
         if (item->specifiesCoordinate()) {
@@ -1954,13 +2153,13 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
     setDirty(false);
 
     connect(visualItem, &VisualMissionItem::specifiesCoordinateChanged,                 this, &MissionController::_recalcFlightPathSegmentsSignal,  Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedVehicleYawChanged,                 this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::currentVTOLModeChanged,                     this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_flightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_flightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, &MissionController::_flightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedVehicleYawChanged,                 this, &MissionController::_flightStatusChanged);
+    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_flightStatusChanged);
+    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, &MissionController::_flightStatusChanged);
+    connect(visualItem, &VisualMissionItem::currentVTOLModeChanged,                     this, &MissionController::_flightStatusChanged);
     connect(visualItem, &VisualMissionItem::lastSequenceNumberChanged,                  this, &MissionController::_recalcSequence);
 
     if (visualItem->isSimpleItem()) {
@@ -1974,10 +2173,10 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
     } else {
         ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(visualItem);
         if (complexItem) {
-            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::minAMSLAltitudeChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::maxAMSLAltitudeChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_flightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_flightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::minAMSLAltitudeChanged,       this, &MissionController::_flightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::maxAMSLAltitudeChanged,       this, &MissionController::_flightStatusChanged);
             connect(complexItem, &ComplexMissionItem::isIncompleteChanged,          this, &MissionController::_recalcFlightPathSegmentsSignal,  Qt::QueuedConnection);
         } else {
             qWarning() << "ComplexMissionItem not found";
@@ -1991,6 +2190,22 @@ void MissionController::_deinitVisualItem(VisualMissionItem* visualItem)
     disconnect(visualItem, nullptr, nullptr, nullptr);
 }
 
+/// Flight status changes signalled by a visual item only affect that item and the ones after it. Anything else
+/// affects the whole mission.
+void MissionController::_flightStatusChanged(void)
+{
+    _markFlightStatusDirty(qobject_cast<VisualMissionItem*>(sender()));
+}
+
+/// Queues a flight status recalc from the item on
+///     @param item nullptr to recalc the whole mission
+void MissionController::_markFlightStatusDirty(VisualMissionItem* item)
+{
+    const int index = item ? _flightStatusItemIndices.value(item, 0) : 0;
+    _flightStatusDirtyIndex = qMin(_flightStatusDirtyIndex, index);
+    emit _recalcMissionFlightStatusSignal();
+}
+
 void MissionController::_itemCommandChanged(void)
 {
     _recalcChildItems();
@@ -2022,8 +2237,8 @@ void MissionController::_managerVehicleChanged(Vehicle* managerVehicle)
     connect(_missionManager, &MissionManager::lastCurrentIndexChanged,  this, &MissionController::resumeMissionIndexChanged);
     connect(_missionManager, &MissionManager::resumeMissionReady,       this, &MissionController::resumeMissionReady);
     connect(_missionManager, &MissionManager::resumeMissionUploadFail,  this, &MissionController::resumeMissionUploadFail);
-    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_flightStatusChanged);
+    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_flightStatusChanged);
     connect(_managerVehicle, &Vehicle::vehicleTypeChanged,              this, &MissionController::complexMissionItemNamesChanged);
 
     emit complexMissionItemNamesChanged();
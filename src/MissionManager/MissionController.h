@@ -18,6 +18,7 @@
 #include "QGroundControlQmlGlobal.h"
 
 #include <QHash>
+#include <QVector>
 
 class FlightPathSegment;
 class VisualMissionItem;
@@ -262,6 +263,18 @@ public:
     QGroundControlQmlGlobal::AltMode globalAltitudeModeDefault(void);
     void setGlobalAltitudeMode(QGroundControlQmlGlobal::AltMode altMode);
 
+    // Used by PlanUndoHistory
+
+    /// Saves the planned home position and global altitude mode
+    void                saveMissionSettings (QJsonObject& json) const;
+    void                loadMissionSettings (const QJsonObject& json);
+    /// Creates an item from the json written by VisualMissionItem::save. The item isn't added to the mission.
+    ///     @return nullptr: load failed, errorString set
+    VisualMissionItem*  loadVisualItem      (const QJsonArray& json, QString& errorString);
+    /// Replaces all items following the mission settings item. Items which are already part of the mission are kept
+    /// as is, items no longer in the list are deleted.
+    void                replaceVisualItems  (const QList<VisualMissionItem*>& visualItems);
+
 signals:
     void visualItemsChanged                 (void);
     void waypointPathChanged                (void);
@@ -320,6 +333,7 @@ private slots:
     void _recalcAll                             (void);
     void _managerVehicleChanged                 (Vehicle* managerVehicle);
     void _takeoffItemNotRequiredChanged         (void);
+    void _flightStatusChanged                   (void);
 
 private:
     void                    _init                               (void);
@@ -339,6 +353,7 @@ private:
     bool                    _loadJsonMissionFile                (const QByteArray& bytes, QmlObjectListModel* visualItems, QString& errorString);
     bool                    _loadJsonMissionFileV1              (const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
     bool                    _loadJsonMissionFileV2              (const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
+    bool                    _loadVisualItem                     (const QJsonObject& itemObject, MissionSettingsItem* settingsItem, int& nextSequenceNumber, VisualMissionItem*& visualItem, QString& errorString);
     bool                    _loadTextMissionFile                (QTextStream& stream, QmlObjectListModel* visualItems, QString& errorString);
     int                     _nextSequenceNumber                 (void);
     void                    _scanForAdditionalSettings          (QmlObjectListModel* visualItems, PlanMasterController* masterController);
@@ -358,6 +373,7 @@ private:
     FlightPathSegment*      _createFlightPathSegmentWorker      (VisualItemPair& pair, bool mavlinkTerrainFrame);
     void                    _allItemsRemoved                    (void);
     void                    _firstItemAdded                     (void);
+    void                    _markFlightStatusDirty              (VisualMissionItem* item);
 
     static double           _calcDistanceToHome                 (VisualMissionItem* currentItem, VisualMissionItem* homeItem);
     static double           _normalizeLat                       (double lat);
@@ -403,6 +419,24 @@ private:
     double                      _maxAMSLAltitude =              0;
     bool                        _missionContainsVTOLTakeoff =   false;
 
+    // State of the flight status walk before the visual item at the same index is processed, plus the state after the
+    // last item. A change to an item only requires the walk to be repeated from that item on.
+    typedef struct {
+        VisualMissionItem*      item;
+        MissionFlightStatus_t   flightStatus;
+        VisualMissionItem*      lastFlyThroughVI;
+        double                  totalHorizontalDistance;
+        double                  minAMSLAltitude;
+        double                  maxAMSLAltitude;
+        bool                    firstCoordinateItem;
+        bool                    linkStartToHome;
+        bool                    foundRTL;
+    } FlightStatusCheckpoint_t;
+
+    QVector<FlightStatusCheckpoint_t>   _flightStatusCheckpoints;
+    QHash<VisualMissionItem*, int>      _flightStatusItemIndices;
+    int                                 _flightStatusDirtyIndex = 0;    ///< First visual item index to walk again
+
     QGroundControlQmlGlobal::AltMode _globalAltMode = QGroundControlQmlGlobal::AltitudeModeRelative;
 
     static const char*  _settingsGroup;
@@ -86,6 +86,9 @@ void MissionSettingsItem::setDirty(bool dirty)
         }
         emit dirtyChanged(_dirty);
     }
+    if (dirty) {
+        emit modified();
+    }
 }
 
 void MissionSettingsItem::save(QJsonArray&  missionItems)
@@ -41,6 +41,7 @@ PlanMasterController::PlanMasterController(QObject* parent)
     , _missionController    (this)
     , _geoFenceController   (this)
     , _rallyPointController (this)
+    , _undoHistory          (this)
 {
     _commonInit();
 }
@@ -54,6 +55,7 @@ PlanMasterController::PlanMasterController(MAV_AUTOPILOT firmwareType, MAV_TYPE
     , _missionController    (this)
     , _geoFenceController   (this)
     , _rallyPointController (this)
+    , _undoHistory          (this)
 {
     _commonInit();
 }
@@ -73,6 +75,9 @@ void PlanMasterController::_commonInit(void)
     connect(&_geoFenceController,   &GeoFenceController::syncInProgressChanged,     this, &PlanMasterController::syncInProgressChanged);
     connect(&_rallyPointController, &RallyPointController::syncInProgressChanged,   this, &PlanMasterController::syncInProgressChanged);
 
+    connect(&_undoHistory,          &PlanUndoHistory::canUndoChanged,               this, &PlanMasterController::canUndoChanged);
+    connect(&_undoHistory,          &PlanUndoHistory::canRedoChanged,               this, &PlanMasterController::canRedoChanged);
+
     // Offline vehicle can change firmware/vehicle type
     connect(_controllerVehicle,     &Vehicle::vehicleTypeChanged,                   this, &PlanMasterController::_updatePlanCreatorsList);
 }
@@ -93,6 +98,10 @@ void PlanMasterController::start(void)
     connect(_multiVehicleMgr, &MultiVehicleManager::activeVehicleChanged, this, &PlanMasterController::_activeVehicleChanged);
 
     _updatePlanCreatorsList();
+
+    if (!_flyView) {
+        _undoHistory.start();
+    }
 }
 
 void PlanMasterController::startStaticActiveVehicle(Vehicle* vehicle, bool deleteWhenSendCompleted)
@@ -250,6 +259,7 @@ void PlanMasterController::_loadGeoFenceComplete(void)
 {
     if (!_flyView && _loadRallyPoints) {
         _loadRallyPoints = false;
+        _resetUndoHistory = true;
         if (_rallyPointController.supported()) {
             qCDebug(PlanMasterControllerLog) << "PlanMasterController::_loadGeoFenceComplete calling _rallyPointController.loadFromVehicle";
             _rallyPointController.loadFromVehicle();
@@ -265,6 +275,11 @@ void PlanMasterController::_loadGeoFenceComplete(void)
 void PlanMasterController::_loadRallyPointsComplete(void)
 {
     qCDebug(PlanMasterControllerLog) << "PlanMasterController::_loadRallyPointsComplete";
+    if (_resetUndoHistory) {
+        // Only a plan loaded by loadFromVehicle starts a new history, not every rally point load of the vehicle
+        _resetUndoHistory = false;
+        _undoHistory.reset();
+    }
 }
 
 void PlanMasterController::_sendMissionComplete(void)
@@ -412,6 +427,8 @@ void PlanMasterController::loadFromFile(const QString& filename)
     if (!offline()) {
         setDirty(true);
     }
+
+    _undoHistory.reset();
 }
 
 QJsonDocument PlanMasterController::saveToJson()
@@ -511,6 +528,8 @@ void PlanMasterController::removeAll(void)
         _rallyPointController.setDirty(false);
         _currentPlanFile.clear();
         emit currentPlanFileChanged();
+        // This is a new plan
+        _undoHistory.reset();
     }
 }
 
@@ -14,6 +14,7 @@
 #include "MissionController.h"
 #include "GeoFenceController.h"
 #include "RallyPointController.h"
+#include "PlanUndoHistory.h"
 #include "Vehicle.h"
 #include "MultiVehicleManager.h"
 #include "QGCLoggingCategory.h"
@@ -51,6 +52,8 @@ public:
     Q_PROPERTY(QStringList              loadNameFilters         READ loadNameFilters                        CONSTANT)                       ///< File filter list loading plan files
     Q_PROPERTY(QStringList              saveNameFilters         READ saveNameFilters                        CONSTANT)                       ///< File filter list saving plan files
     Q_PROPERTY(QmlObjectListModel*      planCreators            MEMBER _planCreators                        NOTIFY planCreatorsChanged)
+    Q_PROPERTY(bool                     canUndo                 READ canUndo                                NOTIFY canUndoChanged)
+    Q_PROPERTY(bool                     canRedo                 READ canRedo                                NOTIFY canRedoChanged)
 
     /// Should be called immediately upon Component.onCompleted.
     Q_INVOKABLE void start(void);
@@ -80,10 +83,13 @@ public:
     Q_INVOKABLE void saveToKml(const QString& filename);
     Q_INVOKABLE void removeAll(void);                       ///< Removes all from controller only, synce required to remove from vehicle
     Q_INVOKABLE void removeAllFromVehicle(void);            ///< Removes all from vehicle and controller
+    Q_INVOKABLE void undo(void) { _undoHistory.undo(); }    ///< Reverts the last change to the plan
+    Q_INVOKABLE void redo(void) { _undoHistory.redo(); }    ///< Reapplies the last change reverted by undo
 
     MissionController*      missionController(void)     { return &_missionController; }
     GeoFenceController*     geoFenceController(void)    { return &_geoFenceController; }
     RallyPointController*   rallyPointController(void)  { return &_rallyPointController; }
+    PlanUndoHistory*        undoHistory(void)           { return &_undoHistory; }
 
     bool        offline         (void) const { return _offline; }
     bool        containsItems   (void) const;
@@ -96,6 +102,8 @@ public:
     QStringList loadNameFilters (void) const;
     QStringList saveNameFilters (void) const;
     bool        isEmpty         (void) const;
+    bool        canUndo         (void) const { return _undoHistory.canUndo(); }
+    bool        canRedo         (void) const { return _undoHistory.canRedo(); }
 
     void        setFlyView(bool flyView) { _flyView = flyView; }
 
@@ -119,6 +127,8 @@ signals:
     void planCreatorsChanged                (QmlObjectListModel* planCreators);
     void managerVehicleChanged              (Vehicle* managerVehicle);
     void promptForPlanUsageOnVehicleChange  (void);
+    void canUndoChanged                     (bool canUndo);
+    void canRedoChanged                     (bool canRedo);
 
 private slots:
     void _activeVehicleChanged      (Vehicle* activeVehicle);
@@ -142,8 +152,10 @@ private:
     MissionController       _missionController;
     GeoFenceController      _geoFenceController;
     RallyPointController    _rallyPointController;
+    PlanUndoHistory         _undoHistory;
     bool                    _loadGeoFence =             false;
     bool                    _loadRallyPoints =          false;
+    bool                    _resetUndoHistory =         false;     ///< Rally points load completes a loadFromVehicle
     bool                    _sendGeoFence =             false;
     bool                    _sendRallyPoints =          false;
     QString                 _currentPlanFile;
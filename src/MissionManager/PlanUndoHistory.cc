@@ -0,0 +1,415 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "PlanUndoHistory.h"
+#include "PlanMasterController.h"
+#include "MissionController.h"
+#include "GeoFenceController.h"
+#include "RallyPointController.h"
+#include "VisualMissionItem.h"
+#include "SimpleMissionItem.h"
+#include "QGCFencePolygon.h"
+#include "QGCFenceCircle.h"
+#include "RallyPoint.h"
+
+QGC_LOGGING_CATEGORY(PlanUndoHistoryLog, "PlanUndoHistoryLog")
+
+PlanUndoHistory::PlanUndoHistory(PlanMasterController* masterController)
+    : _missionController    (masterController->missionController())
+    , _geoFenceController   (masterController->geoFenceController())
+    , _rallyPointController (masterController->rallyPointController())
+{
+    _captureTimer.setSingleShot(true);
+    _captureTimer.setInterval(captureDelayMSecs);
+    connect(&_captureTimer, &QTimer::timeout, this, &PlanUndoHistory::capture);
+}
+
+int PlanUndoHistory::itemStateCount(void) const
+{
+    QSet<const QJsonArray*> itemStates;
+    for (const Snapshot_t& snapshot: _snapshots) {
+        for (const Chunk& chunk: snapshot.missionItems) {
+            for (const ItemState& itemState: *chunk) {
+                itemStates.insert(itemState.data());
+            }
+        }
+    }
+    return itemStates.count();
+}
+
+void PlanUndoHistory::start(void)
+{
+    connect(_missionController,     &MissionController::visualItemsChanged,         this, &PlanUndoHistory::_visualItemsChanged);
+    connect(_missionController,     &MissionController::plannedHomePositionChanged, this, &PlanUndoHistory::_missionSettingsChanged);
+    connect(_missionController,     &MissionController::globalAltitudeModeChanged,  this, &PlanUndoHistory::_missionSettingsChanged);
+    connect(_missionController,     &MissionController::newItemsFromVehicle,        this, &PlanUndoHistory::reset);
+
+    connect(_geoFenceController->polygons(),        &QmlObjectListModel::countChanged,          this, &PlanUndoHistory::_connectGeoFence);
+    connect(_geoFenceController->circles(),         &QmlObjectListModel::countChanged,          this, &PlanUndoHistory::_connectGeoFence);
+    connect(_geoFenceController,                    &GeoFenceController::breachReturnPointChanged, this, &PlanUndoHistory::_geoFenceChanged);
+    connect(_geoFenceController->breachReturnAltitude(), &Fact::rawValueChanged,                this, &PlanUndoHistory::_geoFenceChanged);
+    connect(_rallyPointController->points(),        &QmlObjectListModel::countChanged,          this, &PlanUndoHistory::_connectRallyPoints);
+
+    _started = true;
+    _visualItemsChanged();
+    _connectGeoFence();
+    _connectRallyPoints();
+    reset();
+}
+
+void PlanUndoHistory::reset(void)
+{
+    if (!_started) {
+        return;
+    }
+
+    _captureTimer.stop();
+    _snapshots.clear();
+    _current = -1;
+    _itemStates.clear();
+    _modifiedItems.clear();
+    _missionSettingsModified = true;
+    _geoFenceModified = true;
+    _rallyPointsModified = true;
+
+    capture();
+}
+
+void PlanUndoHistory::capture(void)
+{
+    _captureTimer.stop();
+    if (!_started || _restoring) {
+        return;
+    }
+
+    const Snapshot_t*   previous = _current == -1 ? nullptr : &_snapshots[_current];
+    Snapshot_t          snapshot;
+
+    if (_missionSettingsModified || !previous) {
+        _missionController->saveMissionSettings(snapshot.missionSettings);
+    } else {
+        snapshot.missionSettings = previous->missionSettings;
+    }
+    if (_geoFenceModified || !previous) {
+        _geoFenceController->save(snapshot.geoFence);
+    } else {
+        snapshot.geoFence = previous->geoFence;
+    }
+    if (_rallyPointsModified || !previous) {
+        _rallyPointController->save(snapshot.rallyPoints);
+    } else {
+        snapshot.rallyPoints = previous->rallyPoints;
+    }
+
+    // Only items which changed are saved again, all others keep their previous state
+    QmlObjectListModel*                     visualItems = _missionController->visualItems();
+    QHash<VisualMissionItem*, ItemState>    itemStates;
+    ItemStates                              chunkStates;
+
+    itemStates.reserve(visualItems->count());
+    chunkStates.reserve(chunkSize);
+    for (int i=1; i<visualItems->count(); i++) {
+        VisualMissionItem*  item    = visualItems->value<VisualMissionItem*>(i);
+        ItemState           state   = _itemStates.value(item);
+
+        if (!state || _modifiedItems.contains(item)) {
+            state = _itemState(item, state);
+        }
+        itemStates.insert(item, state);
+
+        chunkStates.append(state);
+        if (chunkStates.count() == chunkSize) {
+            snapshot.missionItems.append(_chunk(chunkStates, previous, snapshot.missionItems.count()));
+            chunkStates.clear();
+        }
+    }
+    if (!chunkStates.isEmpty()) {
+        snapshot.missionItems.append(_chunk(chunkStates, previous, snapshot.missionItems.count()));
+    }
+    snapshot.missionItemCount = visualItems->count() - 1;
+
+    _itemStates = itemStates;
+    _modifiedItems.clear();
+    _missionSettingsModified = false;
+    _geoFenceModified = false;
+    _rallyPointsModified = false;
+
+    if (previous && _equal(*previous, snapshot)) {
+        return;
+    }
+
+    // A new change drops everything which could have been redone
+    while (_snapshots.count() > _current + 1) {
+        _snapshots.removeLast();
+    }
+    _snapshots.append(snapshot);
+    _current = _snapshots.count() - 1;
+    while (_snapshots.count() > maxSnapshots) {
+        _snapshots.removeFirst();
+        _current--;
+    }
+    qCDebug(PlanUndoHistoryLog) << "capture count:current" << _snapshots.count() << _current;
+
+    _updateCanUndoRedo();
+}
+
+void PlanUndoHistory::undo(void)
+{
+    capture();
+    if (canUndo()) {
+        _restore(_snapshots[--_current]);
+        qCDebug(PlanUndoHistoryLog) << "undo count:current" << _snapshots.count() << _current;
+        _updateCanUndoRedo();
+    }
+}
+
+void PlanUndoHistory::redo(void)
+{
+    capture();
+    if (canRedo()) {
+        _restore(_snapshots[++_current]);
+        qCDebug(PlanUndoHistoryLog) << "redo count:current" << _snapshots.count() << _current;
+        _updateCanUndoRedo();
+    }
+}
+
+PlanUndoHistory::ItemState PlanUndoHistory::_itemState(VisualMissionItem* item, const ItemState& previousState)
+{
+    QJsonArray json;
+
+    item->save(json);
+    if (previousState && *previousState == json) {
+        return previousState;
+    }
+    return ItemState(new QJsonArray(json));
+}
+
+/// @return The chunk at the same index of the previous snapshot if it holds the same states, otherwise a new chunk
+PlanUndoHistory::Chunk PlanUndoHistory::_chunk(const ItemStates& itemStates, const Snapshot_t* previous, int chunkIndex)
+{
+    if (previous && chunkIndex < previous->missionItems.count()) {
+        const Chunk& previousChunk = previous->missionItems[chunkIndex];
+        if (*previousChunk == itemStates) {
+            return previousChunk;
+        }
+    }
+    return Chunk(new ItemStates(itemStates));
+}
+
+bool PlanUndoHistory::_equal(const Snapshot_t& snapshot1, const Snapshot_t& snapshot2) const
+{
+    return snapshot1.missionItemCount == snapshot2.missionItemCount &&
+            snapshot1.missionItems == snapshot2.missionItems &&
+            snapshot1.missionSettings == snapshot2.missionSettings &&
+            snapshot1.geoFence == snapshot2.geoFence &&
+            snapshot1.rallyPoints == snapshot2.rallyPoints;
+}
+
+void PlanUndoHistory::_restore(const Snapshot_t& snapshot)
+{
+    _restoring = true;
+
+    QJsonObject json;
+    _missionController->saveMissionSettings(json);
+    if (json != snapshot.missionSettings) {
+        _missionController->loadMissionSettings(snapshot.missionSettings);
+    }
+
+    // Items which are already in the restored state are kept as they are
+    QHash<const QJsonArray*, VisualMissionItem*> currentItems;
+    for (auto it = _itemStates.constBegin(); it != _itemStates.constEnd(); it++) {
+        currentItems.insert(it.value().data(), it.key());
+    }
+
+    QList<ItemState>            states;
+    QList<VisualMissionItem*>   visualItems;
+    states.reserve(snapshot.missionItemCount);
+    visualItems.reserve(snapshot.missionItemCount);
+    for (const Chunk& chunk: snapshot.missionItems) {
+        for (const ItemState& state: *chunk) {
+            states.append(state);
+            visualItems.append(currentItems.take(state.data()));
+        }
+    }
+
+    // Edited simple items get their saved state applied in place when their sequence number and command still match.
+    // Only items which were added or removed, and complex items, are created from their saved state.
+    QHash<int, SimpleMissionItem*> simpleItems;
+    for (auto it = currentItems.constBegin(); it != currentItems.constEnd(); it++) {
+        SimpleMissionItem* simpleItem = qobject_cast<SimpleMissionItem*>(it.value());
+        if (simpleItem && it.key()->count() == 1) {
+            simpleItems.insert(simpleItem->sequenceNumber(), simpleItem);
+        }
+    }
+
+    QHash<VisualMissionItem*, ItemState> itemStates;
+    itemStates.reserve(states.count());
+    bool reloaded = false;
+    for (int i=0; i<states.count(); i++) {
+        const QJsonArray& state = *states[i];
+        VisualMissionItem*& item = visualItems[i];
+        if (!item && state.count() == 1) {
+            SimpleMissionItem* simpleItem = simpleItems.take(SimpleMissionItem::savedSequenceNumber(state[0].toObject()));
+            QString errorString;
+            if (simpleItem && simpleItem->reload(state[0].toObject(), errorString)) {
+                item = simpleItem;
+                reloaded = true;
+            }
+        }
+        if (!item) {
+            QString errorString;
+            item = _missionController->loadVisualItem(state, errorString);
+            if (!item) {
+                qCWarning(PlanUndoHistoryLog) << "Unable to restore mission item" << errorString;
+                continue;
+            }
+        }
+        itemStates.insert(item, states[i]);
+    }
+    visualItems.removeAll(nullptr);
+    _missionController->replaceVisualItems(visualItems);
+    if (reloaded) {
+        _missionController->setDirty(true);
+    }
+    _itemStates = itemStates;
+
+    QString errorString;
+    json = QJsonObject();
+    _geoFenceController->save(json);
+    if (json != snapshot.geoFence) {
+        if (!_geoFenceController->load(snapshot.geoFence, errorString)) {
+            qCWarning(PlanUndoHistoryLog) << "Unable to restore GeoFence" << errorString;
+        }
+        _geoFenceController->setDirty(true);
+    }
+    json = QJsonObject();
+    _rallyPointController->save(json);
+    if (json != snapshot.rallyPoints) {
+        if (!_rallyPointController->load(snapshot.rallyPoints, errorString)) {
+            qCWarning(PlanUndoHistoryLog) << "Unable to restore Rally Points" << errorString;
+        }
+        _rallyPointController->setDirty(true);
+    }
+
+    _modifiedItems.clear();
+    _missionSettingsModified = false;
+    _geoFenceModified = false;
+    _rallyPointsModified = false;
+    _captureTimer.stop();
+    _restoring = false;
+}
+
+void PlanUndoHistory::_updateCanUndoRedo(void)
+{
+    if (_canUndo != canUndo()) {
+        _canUndo = canUndo();
+        emit canUndoChanged(_canUndo);
+    }
+    if (_canRedo != canRedo()) {
+        _canRedo = canRedo();
+        emit canRedoChanged(_canRedo);
+    }
+}
+
+void PlanUndoHistory::_scheduleCapture(void)
+{
+    if (!_restoring) {
+        _captureTimer.start();
+    }
+}
+
+void PlanUndoHistory::_itemModified(void)
+{
+    if (!_restoring) {
+        _modifiedItems.insert(qobject_cast<VisualMissionItem*>(sender()));
+        _scheduleCapture();
+    }
+}
+
+void PlanUndoHistory::_itemsInserted(const QModelIndex& /*parent*/, int first, int last)
+{
+    for (int i=first; i<=last; i++) {
+        VisualMissionItem* item = _visualItems->value<VisualMissionItem*>(i);
+        if (item && i != 0) {
+            connect(item, &VisualMissionItem::modified, this, &PlanUndoHistory::_itemModified, Qt::UniqueConnection);
+            if (!_restoring) {
+                _modifiedItems.insert(item);
+            }
+        }
+    }
+    _scheduleCapture();
+}
+
+void PlanUndoHistory::_visualItemsChanged(void)
+{
+    if (_visualItems) {
+        disconnect(_visualItems, nullptr, this, nullptr);
+    }
+    _visualItems = _missionController->visualItems();
+    if (!_visualItems) {
+        return;
+    }
+
+    connect(_visualItems, &QmlObjectListModel::rowsInserted,  this, &PlanUndoHistory::_itemsInserted);
+    connect(_visualItems, &QmlObjectListModel::rowsMoved,     this, &PlanUndoHistory::_scheduleCapture);
+    connect(_visualItems, &QmlObjectListModel::countChanged,  this, &PlanUndoHistory::_scheduleCapture);
+    if (_visualItems->count() > 1) {
+        _itemsInserted(QModelIndex(), 1, _visualItems->count() - 1);
+    }
+    _missionSettingsModified = true;
+    _scheduleCapture();
+}
+
+void PlanUndoHistory::_missionSettingsChanged(void)
+{
+    _missionSettingsModified = true;
+    _scheduleCapture();
+}
+
+void PlanUndoHistory::_geoFenceChanged(void)
+{
+    _geoFenceModified = true;
+    _scheduleCapture();
+}
+
+void PlanUndoHistory::_rallyPointsChanged(void)
+{
+    _rallyPointsModified = true;
+    _scheduleCapture();
+}
+
+void PlanUndoHistory::_connectGeoFence(void)
+{
+    QmlObjectListModel* polygons = _geoFenceController->polygons();
+    for (int i=0; i<polygons->count(); i++) {
+        QGCFencePolygon* polygon = polygons->value<QGCFencePolygon*>(i);
+        connect(polygon, &QGCFencePolygon::pathChanged,         this, &PlanUndoHistory::_geoFenceChanged, Qt::UniqueConnection);
+        connect(polygon, &QGCFencePolygon::inclusionChanged,    this, &PlanUndoHistory::_geoFenceChanged, Qt::UniqueConnection);
+    }
+
+    QmlObjectListModel* circles = _geoFenceController->circles();
+    for (int i=0; i<circles->count(); i++) {
+        QGCFenceCircle* circle = circles->value<QGCFenceCircle*>(i);
+        connect(circle,             &QGCFenceCircle::centerChanged,     this, &PlanUndoHistory::_geoFenceChanged, Qt::UniqueConnection);
+        connect(circle,             &QGCFenceCircle::inclusionChanged,  this, &PlanUndoHistory::_geoFenceChanged, Qt::UniqueConnection);
+        connect(circle->radius(),   &Fact::rawValueChanged,             this, &PlanUndoHistory::_geoFenceChanged, Qt::UniqueConnection);
+    }
+
+    _geoFenceChanged();
+}
+
+void PlanUndoHistory::_connectRallyPoints(void)
+{
+    QmlObjectListModel* points = _rallyPointController->points();
+    for (int i=0; i<points->count(); i++) {
+        connect(points->value<RallyPoint*>(i), &RallyPoint::coordinateChanged, this, &PlanUndoHistory::_rallyPointsChanged, Qt::UniqueConnection);
+    }
+
+    _rallyPointsChanged();
+}
@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QModelIndex>
+#include <QPointer>
+#include <QSet>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QVector>
+
+#include "QGCLoggingCategory.h"
+#include "QmlObjectListModel.h"
+
+Q_DECLARE_LOGGING_CATEGORY(PlanUndoHistoryLog)
+
+class PlanMasterController;
+class MissionController;
+class GeoFenceController;
+class RallyPointController;
+class VisualMissionItem;
+
+/// Undo/redo history of the plan being edited.
+///
+/// Each snapshot holds the saved json of every mission item, plus the mission settings, fence and rally points. Item
+/// states are immutable and shared between snapshots, grouped in fixed size chunks which are shared as well. Only the
+/// items which signalled VisualMissionItem::modified since the last snapshot are saved again, so an edit to a single
+/// item costs one item save and one new chunk no matter how large the mission is.
+///
+/// Restoring a snapshot keeps all items whose state is unchanged. Simple items whose sequence number and command match
+/// the saved state are updated in place, only items which were added or removed and changed complex items are
+/// recreated from their saved json. Complex items load their generated transects from json, so nothing is regenerated.
+class PlanUndoHistory : public QObject
+{
+    Q_OBJECT
+
+public:
+    PlanUndoHistory(PlanMasterController* masterController);
+
+    bool    canUndo         (void) const { return _current > 0; }
+    bool    canRedo         (void) const { return _current < _snapshots.count() - 1; }
+    int     count           (void) const { return _snapshots.count(); }
+
+    /// @return Number of distinct item states held by all snapshots
+    int     itemStateCount  (void) const;
+
+    /// Starts tracking changes to the plan, the current plan becomes the start of the history
+    void    start           (void);
+
+    /// Drops the history, the current plan becomes the start of the history
+    void    reset           (void);
+
+    /// Adds a snapshot for changes which are still waiting on the capture delay
+    void    capture         (void);
+
+    void    undo            (void);
+    void    redo            (void);
+
+    static constexpr int maxSnapshots       = 100;
+    static constexpr int captureDelayMSecs  = 500;  ///< Changes which follow each other closer than this are a single step
+    static constexpr int chunkSize          = 64;   ///< Item states per chunk
+
+signals:
+    void canUndoChanged     (bool canUndo);
+    void canRedoChanged     (bool canRedo);
+
+private slots:
+    void _scheduleCapture       (void);
+    void _itemModified          (void);
+    void _itemsInserted         (const QModelIndex& parent, int first, int last);
+    void _visualItemsChanged    (void);
+    void _missionSettingsChanged(void);
+    void _geoFenceChanged       (void);
+    void _rallyPointsChanged    (void);
+    void _connectGeoFence       (void);
+    void _connectRallyPoints    (void);
+
+private:
+    typedef QSharedPointer<const QJsonArray>    ItemState;
+    typedef QVector<ItemState>                  ItemStates;
+    typedef QSharedPointer<const ItemStates>    Chunk;
+
+    struct Snapshot_t {
+        QJsonObject     missionSettings;
+        QVector<Chunk>  missionItems;
+        int             missionItemCount = 0;
+        QJsonObject     geoFence;
+        QJsonObject     rallyPoints;
+    };
+
+    ItemState   _itemState              (VisualMissionItem* item, const ItemState& previousState);
+    Chunk       _chunk                  (const ItemStates& itemStates, const Snapshot_t* previous, int chunkIndex);
+    bool        _equal                  (const Snapshot_t& snapshot1, const Snapshot_t& snapshot2) const;
+    void        _restore                (const Snapshot_t& snapshot);
+    void        _updateCanUndoRedo      (void);
+
+    MissionController*                      _missionController;
+    GeoFenceController*                     _geoFenceController;
+    RallyPointController*                   _rallyPointController;
+    QPointer<QmlObjectListModel>            _visualItems;
+    QList<Snapshot_t>                       _snapshots;
+    int                                     _current =                  -1;
+    QHash<VisualMissionItem*, ItemState>    _itemStates;                ///< State of each mission item as of the current snapshot
+    QSet<VisualMissionItem*>                _modifiedItems;             ///< Items changed since the current snapshot
+    bool                                    _missionSettingsModified =  false;
+    bool                                    _geoFenceModified =         false;
+    bool                                    _rallyPointsModified =      false;
+    bool                                    _started =                  false;
+    bool                                    _restoring =                false;
+    bool                                    _canUndo =                  false;
+    bool                                    _canRedo =                  false;
+    QTimer                                  _captureTimer;
+};
@@ -348,6 +348,45 @@ bool SimpleMissionItem::load(const QJsonObject& json, int sequenceNumber, QStrin
     return true;
 }
 
+bool SimpleMissionItem::reload(const QJsonObject& json, QString& errorString)
+{
+    // Validate into a scratch item first, so a bad state leaves this one alone
+    MissionItem savedItem;
+    if (!savedItem.load(json, sequenceNumber(), errorString)) {
+        return false;
+    }
+    if (savedItem.command() != _missionItem.command()) {
+        errorString = tr("Saved command %1 does not match item command %2").arg(savedItem.command()).arg(_missionItem.command());
+        return false;
+    }
+
+    // Altitude mode and altitude update the frame and param7, the saved values are applied over them afterwards
+    const bool restoreAltitude = specifiesAltitude() && json.contains(_jsonAltitudeModeKey);
+    if (restoreAltitude) {
+        setAltitudeMode(static_cast<QGroundControlQmlGlobal::AltMode>(json[_jsonAltitudeModeKey].toInt()));
+        _altitudeFact.setRawValue(JsonHelper::possibleNaNJsonValue(json[_jsonAltitudeKey]));
+    }
+    _missionItem.setFrame(savedItem.frame());
+    _missionItem.setAutoContinue(savedItem.autoContinue());
+    _missionItem.setParam1(savedItem.param1());
+    _missionItem.setParam2(savedItem.param2());
+    _missionItem.setParam3(savedItem.param3());
+    _missionItem.setParam4(savedItem.param4());
+    _missionItem.setParam5(savedItem.param5());
+    _missionItem.setParam6(savedItem.param6());
+    _missionItem.setParam7(savedItem.param7());
+    if (restoreAltitude) {
+        _amslAltAboveTerrainFact.setRawValue(JsonHelper::possibleNaNJsonValue(json[_jsonAMSLAltAboveTerrainKey]));
+    }
+
+    return true;
+}
+
+int SimpleMissionItem::savedSequenceNumber(const QJsonObject& json)
+{
+    return json[MissionItem::_jsonDoJumpIdKey].toInt(-1);
+}
+
 bool SimpleMissionItem::isStandaloneCoordinate(void) const
 {
     const MissionCommandUIInfo* uiInfo = _commandTree->getUIInfo(_controllerVehicle, _previousVTOLMode, (MAV_CMD)command());
@@ -669,6 +708,9 @@ void SimpleMissionItem::setDirty(bool dirty)
         }
         emit dirtyChanged(dirty);
     }
+    if (dirty) {
+        emit modified();
+    }
 }
 
 void SimpleMissionItem::_setDirty(void)
@@ -100,6 +100,14 @@ public:
     virtual bool load(QTextStream &loadStream);
     virtual bool load(const QJsonObject& json, int sequenceNumber, QString& errorString);
 
+    /// Applies the state saved by save() to this item, which keeps its connections and sequence number. The saved
+    /// state must be for the same command and must not include camera or speed sections.
+    ///     @return false: state can't be applied to this item, nothing was changed
+    bool reload(const QJsonObject& json, QString& errorString);
+
+    /// @return Sequence number of the item saved in json by save(), -1 for none
+    static int savedSequenceNumber(const QJsonObject& json);
+
     MissionItem& missionItem(void) { return _missionItem; }
     const MissionItem& missionItem(void) const { return _missionItem; }
 
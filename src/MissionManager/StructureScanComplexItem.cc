@@ -172,6 +172,9 @@ void StructureScanComplexItem::setDirty(bool dirty)
         _dirty = dirty;
         emit dirtyChanged(_dirty);
     }
+    if (dirty) {
+        emit modified();
+    }
 }
 
 void StructureScanComplexItem::save(QJsonArray&  missionItems)
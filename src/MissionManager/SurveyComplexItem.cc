@@ -469,7 +469,7 @@ bool SurveyComplexItem::_gridAngleIsNorthSouthTransects()
     return gridAngle < 45.0 || (gridAngle > 360.0 - 45.0) || (gridAngle > 90.0 + 45.0 && gridAngle < 270.0 - 45.0);
 }
 
-void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects)
+void SurveyComplexItem::_adjustTransectsToEntryPointLocation(int entryPoint, QList<QList<QGeoCoordinate>>& transects)
 {
     if (transects.count() == 0) {
         return;
@@ -478,10 +478,10 @@ void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoo
     bool reversePoints = false;
     bool reverseTransects = false;
 
-    if (_entryPoint == EntryLocationBottomLeft || _entryPoint == EntryLocationBottomRight) {
+    if (entryPoint == EntryLocationBottomLeft || entryPoint == EntryLocationBottomRight) {
         reversePoints = true;
     }
-    if (_entryPoint == EntryLocationTopRight || _entryPoint == EntryLocationBottomRight) {
+    if (entryPoint == EntryLocationTopRight || entryPoint == EntryLocationBottomRight) {
         reverseTransects = true;
     }
 
@@ -494,7 +494,7 @@ void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoo
         _reverseTransectOrder(transects);
     }
 
-    qCDebug(SurveyComplexItemLog) << "_adjustTransectsToEntryPointLocation Modified entry point:entryLocation" << transects.first().first() << _entryPoint;
+    qCDebug(SurveyComplexItemLog) << "_adjustTransectsToEntryPointLocation Modified entry point:entryLocation" << transects.first().first() << entryPoint;
 }
 
 QPointF SurveyComplexItem::_rotatePoint(const QPointF& point, const QPointF& origin, double angle)
@@ -672,37 +672,79 @@ double SurveyComplexItem::_turnaroundDistance(void) const
 
 void SurveyComplexItem::_rebuildTransectsPhase1(void)
 {
-    _rebuildTransectsPhase1WorkerSinglePolygon(false /* refly */);
-    if (_refly90DegreesFact.rawValue().toBool()) {
-        _rebuildTransectsPhase1WorkerSinglePolygon(true /* refly */);
-    }
+    _clearLoadedMissionItems();
+    _transects = _buildTransects(_transectParams(), [](void) { return false; });
 }
 
-void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
+TransectStyleComplexItem::TransectsJob_t SurveyComplexItem::_rebuildTransectsJob(void)
 {
-    if (_ignoreRecalc) {
-        return;
-    }
+    _clearLoadedMissionItems();
 
-    // If the transects are getting rebuilt then any previously loaded mission items are now invalid
+    const TransectParams_t params = _transectParams();
+    return [params](const std::function<bool(void)>& cancelled) {
+        return _buildTransects(params, cancelled);
+    };
+}
+
+/// If the transects are getting rebuilt then any previously loaded mission items are now invalid
+void SurveyComplexItem::_clearLoadedMissionItems(void)
+{
     if (_loadedMissionItemsParent) {
         _loadedMissionItems.clear();
         _loadedMissionItemsParent->deleteLater();
         _loadedMissionItemsParent = nullptr;
     }
+}
 
-    if (_surveyAreaPolygon.count() < 3) {
-        return;
+SurveyComplexItem::TransectParams_t SurveyComplexItem::_transectParams(void) const
+{
+    TransectParams_t params;
+
+    params.polygon                  = _surveyAreaPolygon.coordinateList();
+    params.gridAngle                = _gridAngleFact.rawValue().toDouble();
+    params.gridSpacing              = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    params.entryPoint               = _entryPoint;
+    params.refly90Degrees           = _refly90DegreesFact.rawValue().toBool();
+    params.flyAlternateTransects    = _flyAlternateTransectsFact.rawValue().toBool();
+    params.hoverAndCapture          = triggerCamera() && hoverAndCaptureEnabled();
+    params.triggerDistance          = triggerDistance();
+    params.turnAroundDistance       = _hasTurnaround() ? _turnAroundDistanceFact.rawValue().toDouble() : 0;
+
+    return params;
+}
+
+/// Runs on the GUI thread for synchronous rebuilds and on the thread pool for transect jobs, so it may only use params.
+///     @return Empty if cancelled
+TransectStyleComplexItem::Transects_t SurveyComplexItem::_buildTransects(const TransectParams_t& params, const std::function<bool(void)>& cancelled)
+{
+    Transects_t transects;
+
+    if (params.polygon.count() < 3) {
+        return transects;
     }
 
+    if (!_buildTransectsSinglePolygon(params, false /* refly */, cancelled, transects)) {
+        return Transects_t();
+    }
+    if (params.refly90Degrees && !_buildTransectsSinglePolygon(params, true /* refly */, cancelled, transects)) {
+        return Transects_t();
+    }
+
+    return transects;
+}
+
+/// Appends the transects for one pass over the polygon
+///     @return false: cancelled
+bool SurveyComplexItem::_buildTransectsSinglePolygon(const TransectParams_t& params, bool refly, const std::function<bool(void)>& cancelled, Transects_t& coordInfoTransects)
+{
     // Convert polygon to NED
 
     QList<QPointF> polygonPoints;
-    QGeoCoordinate tangentOrigin = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(0)->coordinate();
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - _surveyAreaPolygon.count():tangentOrigin" << _surveyAreaPolygon.count() << tangentOrigin;
-    for (int i=0; i<_surveyAreaPolygon.count(); i++) {
+    QGeoCoordinate tangentOrigin = params.polygon.first();
+    qCDebug(SurveyComplexItemLog) << "_buildTransectsSinglePolygon Convert polygon to NED - polygon.count():tangentOrigin" << params.polygon.count() << tangentOrigin;
+    for (int i=0; i<params.polygon.count(); i++) {
         double y, x, down;
-        QGeoCoordinate vertex = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate();
+        const QGeoCoordinate& vertex = params.polygon[i];
         if (i == 0) {
             // This avoids a nan calculation that comes out of convertGeoToNed
             x = y = 0;
@@ -710,13 +752,13 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
             convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
         }
         polygonPoints += QPointF(x, y);
-        qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 vertex:x:y" << vertex << polygonPoints.last().x() << polygonPoints.last().y();
+        qCDebug(SurveyComplexItemLog) << "_buildTransectsSinglePolygon vertex:x:y" << vertex << polygonPoints.last().x() << polygonPoints.last().y();
     }
 
     // Generate transects
 
-    double gridAngle = _gridAngleFact.rawValue().toDouble();
-    double gridSpacing = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    double gridAngle = params.gridAngle;
+    double gridSpacing = params.gridSpacing;
     if (gridSpacing < 0.5) {
         // We can't let gridSpacing get too small otherwise we will end up with too many transects.
         // So we limit to 0.5 meter spacing as min and set to huge value which will cause a single
@@ -726,13 +768,13 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
 
     gridAngle = _clampGridAngle90(gridAngle);
     gridAngle += refly ? 90 : 0;
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Clamped grid angle" << gridAngle;
+    qCDebug(SurveyComplexItemLog) << "_buildTransectsSinglePolygon Clamped grid angle" << gridAngle;
 
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 gridSpacing:gridAngle:refly" << gridSpacing << gridAngle << refly;
+    qCDebug(SurveyComplexItemLog) << "_buildTransectsSinglePolygon gridSpacing:gridAngle:refly" << gridSpacing << gridAngle << refly;
 
     // Convert polygon to bounding rect
 
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Polygon";
+    qCDebug(SurveyComplexItemLog) << "_buildTransectsSinglePolygon Polygon";
     QPolygonF polygon;
     for (int i=0; i<polygonPoints.count(); i++) {
         qCDebug(SurveyComplexItemLog) << "Vertex" << polygonPoints[i];
@@ -763,6 +805,10 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         transectX += gridSpacing;
     }
 
+    if (cancelled()) {
+        return false;
+    }
+
     // Now intersect the lines with the polygon
     QList<QLineF> intersectLines;
 #if 1
@@ -776,7 +822,6 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
     //      Create a single transect which goes through the center of the polygon
     //      Intersect it with the polygon
     if (intersectLines.count() < 2) {
-        _surveyAreaPolygon.center();
         QLineF firstLine = lineList.first();
         QPointF lineCenter = firstLine.pointAt(0.5);
         QPointF centerOffset = boundingCenter - lineCenter;
@@ -787,6 +832,10 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         _intersectLinesWithPolygon(lineList, polygon, intersectLines);
     }
 
+    if (cancelled()) {
+        return false;
+    }
+
     // Make sure all lines are going the same direction. Polygon intersection leads to lines which
     // can be in varied directions depending on the order of the intesecting sides.
     QList<QLineF> resultLines;
@@ -806,13 +855,13 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         transects.append(transect);
     }
 
-    _adjustTransectsToEntryPointLocation(transects);
+    _adjustTransectsToEntryPointLocation(params.entryPoint, transects);
 
-    if (refly) {
-        _optimizeTransectsForShortestDistance(_transects.last().last().coord, transects);
+    if (refly && !coordInfoTransects.isEmpty() && !transects.isEmpty()) {
+        _optimizeTransectsForShortestDistance(coordInfoTransects.last().last().coord, transects);
     }
 
-    if (_flyAlternateTransectsFact.rawValue().toBool()) {
+    if (params.flyAlternateTransects) {
         QList<QList<QGeoCoordinate>> alternatingTransects;
         for (int i=0; i<transects.count(); i++) {
             if (!(i & 1)) {
@@ -845,26 +894,30 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         transects[i] = transectVertices;
     }
 
-    // Convert to CoordInfo transects and append to _transects
+    // Convert to CoordInfo transects and append to coordInfoTransects
     for (const QList<QGeoCoordinate>& transect : transects) {
         QGeoCoordinate                                  coord;
         QList<TransectStyleComplexItem::CoordInfo_t>    coordInfoTransect;
         TransectStyleComplexItem::CoordInfo_t           coordInfo;
 
+        if (cancelled()) {
+            return false;
+        }
+
         coordInfo = { transect[0], CoordTypeSurveyEntry };
         coordInfoTransect.append(coordInfo);
         coordInfo = { transect[1], CoordTypeSurveyExit };
         coordInfoTransect.append(coordInfo);
 
         // For hover and capture we need points for each camera location within the transect
-        if (triggerCamera() && hoverAndCaptureEnabled()) {
+        if (params.hoverAndCapture) {
             double transectLength = transect[0].distanceTo(transect[1]);
             double transectAzimuth = transect[0].azimuthTo(transect[1]);
-            if (triggerDistance() < transectLength) {
-                int cInnerHoverPoints = static_cast<int>(floor(transectLength / triggerDistance()));
+            if (params.triggerDistance < transectLength) {
+                int cInnerHoverPoints = static_cast<int>(floor(transectLength / params.triggerDistance));
                 qCDebug(SurveyComplexItemLog) << "cInnerHoverPoints" << cInnerHoverPoints;
                 for (int i=0; i<cInnerHoverPoints; i++) {
-                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(triggerDistance() * (i + 1), transectAzimuth);
+                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(params.triggerDistance * (i + 1), transectAzimuth);
                     TransectStyleComplexItem::CoordInfo_t coordInfo = { hoverCoord, CoordTypeInteriorHoverTrigger };
                     coordInfoTransect.insert(1 + i, coordInfo);
                 }
@@ -872,9 +925,9 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         }
 
         // Extend the transect ends for turnaround
-        if (_hasTurnaround()) {
+        if (params.turnAroundDistance > 0) {
             QGeoCoordinate turnaroundCoord;
-            double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
+            double turnAroundDistance = params.turnAroundDistance;
 
             double azimuth = transect[0].azimuthTo(transect[1]);
             turnaroundCoord = transect[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
@@ -889,8 +942,10 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
             coordInfoTransect.append(coordInfo);
         }
 
-        _transects.append(coordInfoTransect);
+        coordInfoTransects.append(coordInfoTransect);
     }
+
+    return true;
 }
 
 #if 0
@@ -1213,7 +1268,7 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         transects.append(transect);
     }
 
-    _adjustTransectsToEntryPointLocation(transects);
+    _adjustTransectsToEntryPointLocation(_entryPoint, transects);
 
     if (refly) {
         _optimizeTransectsForShortestDistance(_transects.last().last().coord, transects);
@@ -22,6 +22,7 @@
 #include "MissionCommandUIInfo.h"
 
 #include <QPolygonF>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(TransectStyleComplexItemLog, "TransectStyleComplexItemLog")
 
@@ -59,6 +60,10 @@ TransectStyleComplexItem::TransectStyleComplexItem(PlanMasterController* masterC
     _terrainPolyPathQueryTimer.setSingleShot(true);
     connect(&_terrainPolyPathQueryTimer, &QTimer::timeout, this, &TransectStyleComplexItem::_reallyQueryTransectsPathHeightInfo);
 
+    // Unit tests expect the transects to be available as soon as a setting changes
+    _buildTransectsAsync = !qgcApp()->runningUnitTests();
+    connect(&_transectsWatcher, &QFutureWatcher<Transects_t>::finished, this, &TransectStyleComplexItem::_transectsJobFinished);
+
     // The follow is used to compress multiple recalc calls in a row to into a single call.
     connect(this, &TransectStyleComplexItem::_updateFlightPathSegmentsSignal, this, &TransectStyleComplexItem::_updateFlightPathSegmentsDontCallDirectly,   Qt::QueuedConnection);
     qgcApp()->addCompressedSignal(QMetaMethod::fromSignal(&TransectStyleComplexItem::_updateFlightPathSegmentsSignal));
@@ -124,6 +129,13 @@ TransectStyleComplexItem::TransectStyleComplexItem(PlanMasterController* masterC
     setDirty(false);
 }
 
+TransectStyleComplexItem::~TransectStyleComplexItem()
+{
+    // A running job references _transectsGeneration
+    _transectsGeneration.fetchAndAddOrdered(1);
+    _transectsWatcher.waitForFinished();
+}
+
 void TransectStyleComplexItem::_setCameraShots(int cameraShots)
 {
     if (_cameraShots != cameraShots) {
@@ -142,10 +154,15 @@ void TransectStyleComplexItem::setDirty(bool dirty)
         _dirty = dirty;
         emit dirtyChanged(_dirty);
     }
+    if (dirty) {
+        emit modified();
+    }
 }
 
 void TransectStyleComplexItem::_save(QJsonObject& complexObject)
 {
+    _waitForTransects();
+
     QJsonObject innerObject;
 
     innerObject[JsonHelper::jsonVersionKey] =       2;
@@ -407,12 +424,94 @@ void TransectStyleComplexItem::_rebuildTransects(void)
         return;
     }
 
+    if (_buildTransectsAsync) {
+        TransectsJob_t job = _rebuildTransectsJob();
+        if (job) {
+            // The current transects stay in place until the job completes
+            _startTransectsJob(job);
+            return;
+        }
+    }
+    _cancelTransectsJob();
+
     _transects.clear();
     _rgPathHeightInfo.clear();
     _rgFlightPathCoordInfo.clear();
 
     _rebuildTransectsPhase1();
+    _rebuildTransectsPhase2();
+}
+
+void TransectStyleComplexItem::_startTransectsJob(const TransectsJob_t& job)
+{
+    const int generation = _transectsGeneration.fetchAndAddOrdered(1) + 1;
+
+    _setTransectsBuilding(true);
+    if (_transectsWatcher.isRunning()) {
+        // The running job sees it is stale and returns early, the latest settings are built once it has
+        _pendingTransectsJob = job;
+        return;
+    }
+    _pendingTransectsJob = nullptr;
+    _transectsJobGeneration = generation;
+
+    const QAtomicInt* currentGeneration = &_transectsGeneration;
+    _transectsWatcher.setFuture(QtConcurrent::run([job, generation, currentGeneration]() {
+        return job([generation, currentGeneration]() { return currentGeneration->loadRelaxed() != generation; });
+    }));
+}
+
+void TransectStyleComplexItem::_cancelTransectsJob(void)
+{
+    _transectsGeneration.fetchAndAddOrdered(1);
+    _pendingTransectsJob = nullptr;
+    _setTransectsBuilding(false);
+}
+
+void TransectStyleComplexItem::_transectsJobFinished(void)
+{
+    if (!_transectsBuilding) {
+        // Already handled by _waitForTransects, or superseded by a synchronous rebuild
+        return;
+    }
+    if (_pendingTransectsJob) {
+        TransectsJob_t job = _pendingTransectsJob;
+        _pendingTransectsJob = nullptr;
+        _startTransectsJob(job);
+        return;
+    }
+    if (_transectsJobGeneration != _transectsGeneration.loadRelaxed()) {
+        _setTransectsBuilding(false);
+        return;
+    }
+
+    _transects = _transectsWatcher.result();
+    _rgPathHeightInfo.clear();
+    _rgFlightPathCoordInfo.clear();
+    _setTransectsBuilding(false);
+
+    _rebuildTransectsPhase2();
+}
+
+void TransectStyleComplexItem::_waitForTransects(void)
+{
+    while (_transectsBuilding) {
+        _transectsWatcher.waitForFinished();
+        _transectsJobFinished();
+    }
+}
 
+void TransectStyleComplexItem::_setTransectsBuilding(bool transectsBuilding)
+{
+    if (transectsBuilding != _transectsBuilding) {
+        _transectsBuilding = transectsBuilding;
+        emit transectsBuildingChanged(_transectsBuilding);
+    }
+}
+
+/// Rebuilds everything which is derived from _transects
+void TransectStyleComplexItem::_rebuildTransectsPhase2(void)
+{
     _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
 
     switch (_cameraCalc.distanceMode()) {
@@ -1128,6 +1227,8 @@ void TransectStyleComplexItem::_handleHoverAndCaptureEnabled(QVariant enabled)
 
 void TransectStyleComplexItem::appendMissionItems(QList<MissionItem*>& items, QObject* missionItemParent)
 {
+    _waitForTransects();
+
     if (_loadedMissionItems.count()) {
         // We have mission items from the loaded plan, use those
         _appendLoadedMissionItems(items, missionItemParent);
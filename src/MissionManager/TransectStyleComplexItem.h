@@ -18,6 +18,11 @@
 #include "CameraCalc.h"
 #include "TerrainQuery.h"
 
+#include <QAtomicInt>
+#include <QFutureWatcher>
+
+#include <functional>
+
 Q_DECLARE_LOGGING_CATEGORY(TransectStyleComplexItemLog)
 
 class PlanMasterController;
@@ -28,6 +33,7 @@ class TransectStyleComplexItem : public ComplexMissionItem
 
 public:
     TransectStyleComplexItem(PlanMasterController* masterController, bool flyView, QString settignsGroup);
+    ~TransectStyleComplexItem();
 
     Q_PROPERTY(QGCMapPolygon*   surveyAreaPolygon           READ surveyAreaPolygon                                  CONSTANT)
     Q_PROPERTY(CameraCalc*      cameraCalc                  READ cameraCalc                                         CONSTANT)
@@ -41,6 +47,7 @@ public:
     Q_PROPERTY(double           coveredArea                 READ coveredArea                                        NOTIFY coveredAreaChanged)
     Q_PROPERTY(bool             hoverAndCaptureAllowed      READ hoverAndCaptureAllowed                             CONSTANT)
     Q_PROPERTY(QVariantList     visualTransectPoints        READ visualTransectPoints                               NOTIFY visualTransectPointsChanged)
+    Q_PROPERTY(bool             transectsBuilding           READ transectsBuilding                                  NOTIFY transectsBuildingChanged)   ///< true: visualTransectPoints are from before the last change
 
     Q_PROPERTY(Fact*            terrainAdjustTolerance      READ terrainAdjustTolerance                             CONSTANT)
     Q_PROPERTY(Fact*            terrainAdjustMaxDescentRate READ terrainAdjustMaxDescentRate                        CONSTANT)
@@ -61,6 +68,7 @@ public:
     const Fact* hoverAndCapture         (void) const { return &_hoverAndCaptureFact; }
 
     int             cameraShots             (void) const { return _cameraShots; }
+    bool            transectsBuilding       (void) const { return _transectsBuilding; }
     double          coveredArea             (void) const;
     bool            hoverAndCaptureAllowed  (void) const;
 
@@ -71,7 +79,8 @@ public:
     bool    triggerCamera           (void) const { return triggerDistance() != 0; }
 
     // Used internally only by unit tests
-    int _transectCount(void) const { return _transects.count(); }
+    int     _transectCount          (void) const { return _transects.count(); }
+    void    _setBuildTransectsAsync (bool async) { _buildTransectsAsync = async; }
 
     // Overrides from ComplexMissionItem
     int     lastSequenceNumber  (void) const final;
@@ -124,6 +133,7 @@ signals:
     void timeBetweenShotsChanged        (void);
     void visualTransectPointsChanged    (void);
     void coveredAreaChanged             (void);
+    void transectsBuildingChanged       (bool transectsBuilding);
     void _updateFlightPathSegmentsSignal(void);
 
 protected slots:
@@ -153,6 +163,7 @@ protected:
     void    _buildAndAppendMissionItems     (QList<MissionItem*>& items, QObject* missionItemParent);
     void    _appendLoadedMissionItems       (QList<MissionItem*>& items, QObject* missionItemParent);
     void    _recalcComplexDistance          (void);
+    void    _rebuildTransectsPhase2         (void);
 
     int                 _sequenceNumber = 0;
     QGeoCoordinate      _coordinate;
@@ -173,8 +184,21 @@ protected:
         CoordType       coordType;
     } CoordInfo_t;
 
+    typedef QList<QList<CoordInfo_t>> Transects_t;
+
+    /// Builds transects on the thread pool. Must not reference the item, everything it needs is copied into it when it is created.
+    ///     @param cancelled Returns true once the job has been superseded, the job should return as soon as it can
+    typedef std::function<Transects_t(const std::function<bool(void)>& cancelled)> TransectsJob_t;
+
+    /// Derived classes which can build their transects off the GUI thread return a job for the current settings. Called on the
+    /// GUI thread each time the transects need to be rebuilt. Return an empty job to have _rebuildTransectsPhase1 called instead.
+    virtual TransectsJob_t _rebuildTransectsJob(void) { return TransectsJob_t(); }
+
+    /// Waits for a transect job in progress and applies its result
+    void _waitForTransects(void);
+
     QVariantList                                _visualTransectPoints;                          ///< Used to draw the flight path visuals on the screen
-    QList<QList<CoordInfo_t>>                   _transects;
+    Transects_t                                 _transects;
     QList<TerrainPathQuery::PathHeightInfo_t>   _rgPathHeightInfo;                              ///< Path height for each segment includes turn segments
     QList<QGeoCoordinate>                       _rgFlyThroughMissionItemCoords;
     QList<double>                               _rgFlyThroughMissionItemCoordsTerrainHeights;
@@ -218,6 +242,7 @@ private slots:
     void _updateFlightPathSegmentsDontCallDirectly  (void);
     void _segmentTerrainCollisionChanged            (bool terrainCollision) final;
     void _distanceModeChanged                       (int distanceMode);
+    void _transectsJobFinished                      (void);
 
 private:
     typedef struct {
@@ -239,11 +264,23 @@ private:
     double  _altitudeBetweenCoords                                          (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double percentTowardsTo);
     int     _maxPathHeight                                                  (const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo, int fromIndex, int toIndex, double& maxHeight);
     BuildMissionItemsState_t _buildMissionItemsState                        (void) const;
+    void    _startTransectsJob                                              (const TransectsJob_t& job);
+    void    _cancelTransectsJob                                             (void);
+    void    _setTransectsBuilding                                           (bool transectsBuilding);
 
     TerrainPolyPathQuery*       _currentTerrainPolyPathQuery        = nullptr;
     TerrainAtCoordinateQuery*   _currentTerrainAtCoordinateQuery    = nullptr;
     QTimer                      _terrainPolyPathQueryTimer;
 
+    // Only one transect job runs at a time. A rebuild requested while it runs cancels it and waits as the pending job, so
+    // continuous edits (dragging a vertex) only ever queue the latest settings.
+    QFutureWatcher<Transects_t>     _transectsWatcher;
+    QAtomicInt                      _transectsGeneration;                   ///< Bumped for each rebuild, jobs from older generations are stale
+    int                             _transectsJobGeneration     = 0;        ///< Generation of the running job
+    TransectsJob_t                  _pendingTransectsJob;
+    bool                            _transectsBuilding          = false;
+    bool                            _buildTransectsAsync        = true;
+
     // Deprecated json keys
     static const char* _jsonTerrainFollowKeyDeprecated;
 };
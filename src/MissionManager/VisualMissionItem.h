@@ -216,6 +216,7 @@ signals:
     void coordinateChanged              (const QGeoCoordinate& coordinate);
     void exitCoordinateChanged          (const QGeoCoordinate& exitCoordinate);
     void dirtyChanged                   (bool dirty);
+    void modified                       (void);                 ///< Signalled on every change which sets the item dirty, dirtyChanged is only signalled when dirty toggles
     void distanceChanged                (double distance);
     void distanceFromStartChanged       (double distanceFromStart);
     void isCurrentItemChanged           (bool isCurrentItem);
@@ -251,6 +251,18 @@ Item {
         }
     }
 
+    Shortcut {
+        sequences:  [ StandardKey.Undo ]
+        enabled:    _planMasterController.canUndo
+        onActivated: _planMasterController.undo()
+    }
+
+    Shortcut {
+        sequences:  [ StandardKey.Redo ]
+        enabled:    _planMasterController.canRedo
+        onActivated: _planMasterController.redo()
+    }
+
     Connections {
         target: _missionController
 
@@ -80,7 +80,7 @@ Item {
         interiorOpacity:    0.5 * _root.opacity
     }
 
-    // Full set of transects lines. Shown when item is selected.
+    // Full set of transects lines. Shown when item is selected. Dimmed while they are being rebuilt after a change.
     Component {
         id: fullTransectsComponent
 
@@ -89,7 +89,7 @@ Item {
             line.width: 2
             path:       _transectPoints
             visible:    _currentItem
-            opacity:    _root.opacity
+            opacity:    _missionItem.transectsBuilding ? 0.5 * _root.opacity : _root.opacity
         }
     }
 
@@ -69,6 +69,8 @@ Rectangle {
                 ListElement { text: "2x";   value: 2 }
                 ListElement { text: "5x";   value: 5 }
                 ListElement { text: "10x";  value: 10 }
+                ListElement { text: "100x"; value: 100 }
+                ListElement { text: qsTr("Max"); value: 0 }
             }
 
             onActivated: (index) => { controller.playbackSpeed = model.get(currentIndex).value }
@@ -81,7 +83,7 @@ Rectangle {
             Layout.fillWidth:   true
             from:               0
             to:                 100
-            enabled:            controller.link
+            enabled:            controller.link && controller.seekable
 
             property bool manualUpdate: false
 
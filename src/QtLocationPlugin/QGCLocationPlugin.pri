@@ -16,7 +16,11 @@ HEADERS += \
     $$PWD/QGCMapEngineData.h \
     $$PWD/QGCMapTileSet.h \
     $$PWD/QGCMapUrlEngine.h \
+    $$PWD/QGCTileCacheReader.h \
     $$PWD/QGCTileCacheWorker.h \
+    $$PWD/QGCTileDownloadScheduler.h \
+    $$PWD/QGCTileMemoryCache.h \
+    $$PWD/QGCTileStore.h \
     $$PWD/QGeoCodeReplyQGC.h \
     $$PWD/QGeoCodingManagerEngineQGC.h \
     $$PWD/QGeoMapReplyQGC.h \
@@ -37,7 +41,11 @@ SOURCES += \
     $$PWD/QGCMapEngine.cpp \
     $$PWD/QGCMapTileSet.cpp \
     $$PWD/QGCMapUrlEngine.cpp \
+    $$PWD/QGCTileCacheReader.cpp \
     $$PWD/QGCTileCacheWorker.cpp \
+    $$PWD/QGCTileDownloadScheduler.cpp \
+    $$PWD/QGCTileMemoryCache.cpp \
+    $$PWD/QGCTileStore.cpp \
     $$PWD/QGeoCodeReplyQGC.cpp \
     $$PWD/QGeoCodingManagerEngineQGC.cpp \
     $$PWD/QGeoMapReplyQGC.cpp \
@@ -27,6 +27,7 @@
 
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
+#include "QGCTileStore.h"
 
 Q_DECLARE_METATYPE(QGCMapTask::TaskType)
 Q_DECLARE_METATYPE(QGCTile)
@@ -160,10 +161,43 @@ QGCMapEngine::init()
     } else {
         qCritical() << "Could not find suitable map cache directory.";
     }
+    if(qgcApp() && qgcApp()->toolbox() && qgcApp()->toolbox()->settingsManager()) {
+        loadTilePackages(qgcApp()->toolbox()->settingsManager()->appSettings()->mapPackagesSavePath());
+    }
     QGCMapTask* task = new QGCMapTask(QGCMapTask::taskInit);
     _worker.enqueueTask(task);
 }
 
+//-----------------------------------------------------------------------------
+/// Map packages are named after the map type they hold, e.g. "Bing Satellite.mbtiles"
+int
+QGCMapEngine::loadTilePackages(const QString& directory)
+{
+    if(directory.isEmpty()) {
+        return 0;
+    }
+    int count = 0;
+    const QStringList nameFilters = { QStringLiteral("*.mbtiles"), QStringLiteral("*.qgctiles") };
+    const QFileInfoList fileInfos = QDir(directory).entryInfoList(nameFilters, QDir::Files, QDir::Name);
+    for(const QFileInfo& fileInfo: fileInfos) {
+        const QString type = fileInfo.completeBaseName();
+        if(!_urlFactory->getMapProviderFromProviderType(type)) {
+            qWarning() << "Map package for unknown map type skipped:" << fileInfo.fileName();
+            continue;
+        }
+        QString errorString;
+        QGCTileStore* store = QGCTileStore::open(fileInfo.absoluteFilePath(), type, errorString);
+        if(!store) {
+            qWarning() << "Map package skipped:" << fileInfo.fileName() << errorString;
+            continue;
+        }
+        _worker.addTileStore(store, _urlFactory->hashFromProviderType(type));
+        count++;
+    }
+    qDebug() << "Map packages in:" << directory << count;
+    return count;
+}
+
 //-----------------------------------------------------------------------------
 bool
 QGCMapEngine::_wipeDirectory(const QString& dirPath)
@@ -35,6 +35,9 @@ public:
     ~QGCMapEngine               ();
 
     void                        init                ();
+    /// Serves the tiles of all map packages (.mbtiles, .qgctiles) in the directory without importing them
+    ///     @return Number of packages loaded
+    int                         loadTilePackages    (const QString& directory);
     void                        addTask             (QGCMapTask *task);
     void                        cacheTile           (const QString& type, int x, int y, int z, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
     void                        cacheTile           (const QString& type, const QString& hash, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
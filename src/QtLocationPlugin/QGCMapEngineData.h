@@ -289,17 +289,26 @@ public:
         : QGCMapTask(QGCMapTask::taskUpdateTileDownloadState)
         , _setID(setID)
         , _state(state)
-        , _hash(hash)
+        , _hashes({ hash })
+    {}
+
+    //-- Updates all tiles in the list in one transaction
+    QGCUpdateTileDownloadStateTask(qulonglong setID, QGCTile::TyleState state, const QStringList& hashes)
+        : QGCMapTask(QGCMapTask::taskUpdateTileDownloadState)
+        , _setID(setID)
+        , _state(state)
+        , _hashes(hashes)
     {}
 
-    QString             hash    () { return _hash; }
+    QString             hash    () { return _hashes.count() ? _hashes.first() : QString(); }
+    QStringList         hashes  () { return _hashes; }
     qulonglong          setID   () const{ return _setID; }
     QGCTile::TyleState  state   () { return _state; }
 
 private:
     qulonglong          _setID;
     QGCTile::TyleState  _state;
-    QString             _hash;
+    QStringList         _hashes;
 };
 
 //-----------------------------------------------------------------------------
@@ -19,7 +19,7 @@
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
 #include "QGCMapEngineManager.h"
-#include "QGCFileDownload.h"
+#include "QGCTileDownloadScheduler.h"
 #include "TerrainTile.h"
 
 #include <QSettings>
@@ -28,6 +28,8 @@
 QGC_LOGGING_CATEGORY(QGCCachedTileSetLog, "QGCCachedTileSetLog")
 
 #define TILE_BATCH_SIZE      256
+#define STATE_BATCH_SIZE     64
+#define STATE_FLUSH_MSECS    1000
 
 //-----------------------------------------------------------------------------
 QGCCachedTileSet::QGCCachedTileSet(const QString& name)
@@ -49,21 +51,24 @@ QGCCachedTileSet::QGCCachedTileSet(const QString& name)
     , _downloading(false)
     , _id(0)
     , _type("Invalid")
-    , _networkManager(nullptr)
+    , _scheduler(nullptr)
     , _errorCount(0)
     , _noMoreTiles(false)
     , _batchRequested(false)
     , _manager(nullptr)
     , _selected(false)
 {
-
+    _flushTimer.setSingleShot(true);
+    _flushTimer.setInterval(STATE_FLUSH_MSECS);
+    connect(&_flushTimer, &QTimer::timeout, this, &QGCCachedTileSet::_flushDownloadStates);
 }
 
 //-----------------------------------------------------------------------------
 QGCCachedTileSet::~QGCCachedTileSet()
 {
-    delete _networkManager;
-    _networkManager = nullptr;
+    _flushDownloadStates();
+    delete _scheduler;
+    _scheduler = nullptr;
 }
 
 //-----------------------------------------------------------------------------
@@ -167,6 +172,13 @@ QGCCachedTileSet::cancelDownloadTask()
 {
     if(_downloading) {
         _downloading = false;
+        //-- Aborted tiles stay in the downloading state until the download is resumed
+        if(_scheduler) {
+            _scheduler->abort();
+        }
+        qDeleteAll(_tilesToDownload);
+        _tilesToDownload.clear();
+        _flushDownloadStates();
         emit downloadingChanged();
     }
 }
@@ -180,13 +192,21 @@ QGCCachedTileSet::_tileListFetched(QList<QGCTile *> tiles)
     if(tiles.size() < TILE_BATCH_SIZE) {
         _noMoreTiles = true;
     }
-    if(!tiles.size()) {
+    //-- Download canceled while the list was fetched
+    if(!_downloading) {
+        qDeleteAll(tiles);
+        return;
+    }
+    //-- Nothing left to fetch and nothing downloading
+    if(!tiles.size() && (!_scheduler || !_scheduler->pendingCount())) {
         _doneWithDownload();
         return;
     }
-    //-- If this is the first time, create Network Manager
-    if (!_networkManager) {
-        _networkManager = new QNetworkAccessManager(this);
+    //-- If this is the first time, create the download scheduler
+    if (!_scheduler) {
+        _scheduler = new QGCTileDownloadScheduler(QGCMapEngine::concurrentDownloads(_type), this);
+        connect(_scheduler, &QGCTileDownloadScheduler::tileDownloaded, this, &QGCCachedTileSet::_tileDownloaded);
+        connect(_scheduler, &QGCTileDownloadScheduler::tileFailed, this, &QGCCachedTileSet::_tileFailed);
     }
     //-- Add tiles to the list
     _tilesToDownload += tiles;
@@ -197,6 +217,7 @@ QGCCachedTileSet::_tileListFetched(QList<QGCTile *> tiles)
 //-----------------------------------------------------------------------------
 void QGCCachedTileSet::_doneWithDownload()
 {
+    _flushDownloadStates();
     if(!_errorCount) {
         _totalTileCount = _savedTileCount;
         _totalTileSize  = _savedTileSize;
@@ -225,7 +246,10 @@ void QGCCachedTileSet::_doneWithDownload()
 //-----------------------------------------------------------------------------
 void QGCCachedTileSet::_prepareDownload()
 {
-    if(!_tilesToDownload.count()) {
+    if(!_downloading) {
+        return;
+    }
+    if(!_tilesToDownload.count() && !_scheduler->pendingCount()) {
         //-- Are we done?
         if(_noMoreTiles) {
             _doneWithDownload();
@@ -235,124 +259,92 @@ void QGCCachedTileSet::_prepareDownload()
         }
         return;
     }
-    //-- Prepare queue (QNetworkAccessManager has a limit for concurrent downloads)
-    for(int i = _replies.count(); i < QGCMapEngine::concurrentDownloads(_type); i++) {
-        if(_tilesToDownload.count()) {
-            QGCTile* tile = _tilesToDownload.first();
-            _tilesToDownload.removeFirst();
-            QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(tile->type(), tile->x(), tile->y(), tile->z(), _networkManager);
-            request.setAttribute(QNetworkRequest::User, tile->hash());
-#if !defined(__mobile__)
-            QNetworkProxy proxy = _networkManager->proxy();
-            QNetworkProxy tProxy;
-            tProxy.setType(QNetworkProxy::DefaultProxy);
-            _networkManager->setProxy(tProxy);
-#endif
-            QNetworkReply* reply = _networkManager->get(request);
-            reply->setParent(0);
-            QGCFileDownload::setIgnoreSSLErrorsIfNeeded(*reply);
-            connect(reply, &QNetworkReply::finished, this, &QGCCachedTileSet::_networkReplyFinished);
-            connect(reply, &QNetworkReply::errorOccurred, this, &QGCCachedTileSet::_networkReplyError);
-            _replies.insert(tile->hash(), reply);
-#if !defined(__mobile__)
-            _networkManager->setProxy(proxy);
-#endif
-            delete tile;
-            //-- Refill queue if running low
-            if(!_batchRequested && !_noMoreTiles && _tilesToDownload.count() < (QGCMapEngine::concurrentDownloads(_type) * 10)) {
-                //-- Request new batch of tiles
-                createDownloadTask();
-            }
-        }
+    //-- The scheduler decides how many requests run at a time. Hand it all tiles we have.
+    for(QGCTile* tile: _tilesToDownload) {
+        QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(tile->type(), tile->x(), tile->y(), tile->z(), _scheduler->networkManager());
+        _scheduler->enqueue(tile->hash(), request);
+        delete tile;
+    }
+    _tilesToDownload.clear();
+    //-- Fetch the next batch while this one downloads
+    if(!_batchRequested && !_noMoreTiles && _scheduler->pendingCount() < TILE_BATCH_SIZE) {
+        createDownloadTask();
     }
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCCachedTileSet::_networkReplyFinished()
+QGCCachedTileSet::_tileDownloaded(const QString& hash, const QByteArray& data)
 {
-    //-- Figure out which reply this is
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
-    if(!reply) {
-        qWarning() << "QGCMapEngineManager::networkReplyFinished() NULL Reply";
-        return;
+    qCDebug(QGCCachedTileSetLog) << "Tile fetched" << hash;
+    QByteArray image = data;
+    QString type = getQGCMapEngine()->tileHashToType(hash);
+    if (type == UrlFactory::kCopernicusElevationProviderKey) {
+        image = TerrainTile::serializeFromAirMapJson(image);
     }
-    if (reply->error() == QNetworkReply::NoError) {
-        //-- Get tile hash
-        const QString hash = reply->request().attribute(QNetworkRequest::User).toString();
-        if(!hash.isEmpty()) {
-            if(_replies.contains(hash)) {
-                _replies.remove(hash);
-            } else {
-                qWarning() << "QGCMapEngineManager::networkReplyFinished() Reply not in list: " << hash;
-            }
-            qCDebug(QGCCachedTileSetLog) << "Tile fetched" << hash;
-            QByteArray image = reply->readAll();
-            QString type = getQGCMapEngine()->tileHashToType(hash);
-            if (type == UrlFactory::kCopernicusElevationProviderKey) {
-                image = TerrainTile::serializeFromAirMapJson(image);
-            }
-            QString format = getQGCMapEngine()->urlFactory()->getImageFormat(type, image);
-            if(!format.isEmpty()) {
-                //-- Cache tile
-                getQGCMapEngine()->cacheTile(type, hash, image, format, _id);
-                QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, hash);
-                getQGCMapEngine()->addTask(task);
-                //-- Updated cached (downloaded) data
-                _savedTileSize += image.size();
-                _savedTileCount++;
-                emit savedTileSizeChanged();
-                emit savedTileCountChanged();
-                //-- Update estimate
-                if(_savedTileCount % 10 == 0) {
-                    quint32 avg = _savedTileSize / _savedTileCount;
-                    _totalTileSize  = avg * _totalTileCount;
-                    _uniqueTileSize = avg * _uniqueTileCount;
-                    emit totalTilesSizeChanged();
-                    emit uniqueTileSizeChanged();
-                }
-            }
-            //-- Setup a new download
-            _prepareDownload();
-        } else {
-            qWarning() << "QGCMapEngineManager::networkReplyFinished() Empty Hash";
+    QString format = getQGCMapEngine()->urlFactory()->getImageFormat(type, image);
+    if(!format.isEmpty()) {
+        //-- Cache tile
+        getQGCMapEngine()->cacheTile(type, hash, image, format, _id);
+        _completedHashes.append(hash);
+        //-- Updated cached (downloaded) data
+        _savedTileSize += image.size();
+        _savedTileCount++;
+        emit savedTileSizeChanged();
+        emit savedTileCountChanged();
+        //-- Update estimate
+        if(_savedTileCount % 10 == 0) {
+            quint32 avg = _savedTileSize / _savedTileCount;
+            _totalTileSize  = avg * _totalTileCount;
+            _uniqueTileSize = avg * _uniqueTileCount;
+            emit totalTilesSizeChanged();
+            emit uniqueTileSizeChanged();
         }
     }
-    reply->deleteLater();
+    if(_completedHashes.count() >= STATE_BATCH_SIZE) {
+        _flushDownloadStates();
+    } else if(!_flushTimer.isActive()) {
+        _flushTimer.start();
+    }
+    //-- Setup a new download
+    _prepareDownload();
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCCachedTileSet::_networkReplyError(QNetworkReply::NetworkError error)
+QGCCachedTileSet::_tileFailed(const QString& hash, QNetworkReply::NetworkError error, const QString& errorString)
 {
-    //-- Figure out which reply this is
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
-    if (!reply) {
-        return;
-    }
     //-- Update error count
     _errorCount++;
     emit errorCountChanged();
-    //-- Get tile hash
-    QString hash = reply->request().attribute(QNetworkRequest::User).toString();
-    qCDebug(QGCCachedTileSetLog) << "Error fetching tile" << reply->errorString();
-    if(!hash.isEmpty()) {
-        if(_replies.contains(hash)) {
-            _replies.remove(hash);
-        } else {
-            qWarning() << "QGCMapEngineManager::networkReplyError() Reply not in list: " << hash;
-        }
-        if (error != QNetworkReply::OperationCanceledError) {
-            qWarning() << "QGCMapEngineManager::networkReplyError() Error:" << reply->errorString();
-        }
-        QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, hash);
-        getQGCMapEngine()->addTask(task);
-    } else {
-        qWarning() << "QGCMapEngineManager::networkReplyError() Empty Hash";
+    if (error != QNetworkReply::OperationCanceledError) {
+        qWarning() << "QGCCachedTileSet::_tileFailed() Error:" << errorString;
+    }
+    _failedHashes.append(hash);
+    if(_failedHashes.count() >= STATE_BATCH_SIZE) {
+        _flushDownloadStates();
+    } else if(!_flushTimer.isActive()) {
+        _flushTimer.start();
     }
     //-- Setup a new download
     _prepareDownload();
-    reply->deleteLater();
+}
+
+//-----------------------------------------------------------------------------
+/// Completed tiles are removed from the download list and failed ones flagged, one task per state. The tiles
+/// themselves are saved as they arrive.
+void
+QGCCachedTileSet::_flushDownloadStates()
+{
+    _flushTimer.stop();
+    if(_completedHashes.count()) {
+        getQGCMapEngine()->addTask(new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, _completedHashes));
+        _completedHashes.clear();
+    }
+    if(_failedHashes.count()) {
+        getQGCMapEngine()->addTask(new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, _failedHashes));
+        _failedHashes.clear();
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -24,6 +24,7 @@
 #include <QHash>
 #include <QDateTime>
 #include <QImage>
+#include <QTimer>
 
 #include "QGCLoggingCategory.h"
 #include "QGCMapEngineData.h"
@@ -33,6 +34,7 @@ Q_DECLARE_LOGGING_CATEGORY(QGCCachedTileSetLog)
 
 class QGCTile;
 class QGCMapEngineManager;
+class QGCTileDownloadScheduler;
 
 //-----------------------------------------------------------------------------
 class QGCCachedTileSet : public QObject
@@ -151,8 +153,9 @@ signals:
 
 private slots:
     void _tileListFetched               (QList<QGCTile*> tiles);
-    void _networkReplyFinished          ();
-    void _networkReplyError             (QNetworkReply::NetworkError error);
+    void _tileDownloaded                (const QString& hash, const QByteArray& data);
+    void _tileFailed                    (const QString& hash, QNetworkReply::NetworkError error, const QString& errorString);
+    void _flushDownloadStates           ();
 
 private:
     void        _prepareDownload        ();
@@ -179,9 +182,12 @@ private:
     QDateTime   _creationDate;
     quint64     _id;
     QString _type;
-    QNetworkAccessManager*  _networkManager;
-    QHash<QString, QNetworkReply*> _replies;
+    QGCTileDownloadScheduler* _scheduler;
     quint32     _errorCount;
+    //-- Download states are written in batches
+    QStringList _completedHashes;
+    QStringList _failedHashes;
+    QTimer      _flushTimer;
     //-- Tile download
     QList<QGCTile *> _tilesToDownload;
     bool        _noMoreTiles;
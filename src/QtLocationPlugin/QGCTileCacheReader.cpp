@@ -0,0 +1,218 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileCacheReader.h"
+#include "QGCTileCacheWorker.h"
+#include "QGCTileMemoryCache.h"
+#include "QGCMapEngineData.h"
+#include "QGCTileStore.h"
+
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QThread>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+//-----------------------------------------------------------------------------
+QGCTileCacheReader::QGCTileCacheReader(QGCTileMemoryCache* memoryCache)
+    : _memoryCache(memoryCache)
+{
+    _threadPool.setMaxThreadCount(maxReaders);
+}
+
+//-----------------------------------------------------------------------------
+QGCTileCacheReader::~QGCTileCacheReader()
+{
+    suspend();
+    QWriteLocker storesLock(&_storesLock);
+    for(const auto& store: _stores) {
+        delete store.second;
+    }
+    _stores.clear();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileCacheReader::setDatabaseFile(const QString& path)
+{
+    QMutexLocker lock(&_mutex);
+    _databasePath = path;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileCacheReader::addStore(QGCTileStore* store, int providerHash)
+{
+    QWriteLocker storesLock(&_storesLock);
+    _stores.append(qMakePair(providerHash, store));
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileCacheReader::findMapped(const QString& hash, QByteArray& img, QString& format, QString& type)
+{
+    return _findInStores(hash, true, img, format, type);
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileCacheReader::fetch(QGCFetchTileTask* task)
+{
+    QMutexLocker lock(&_mutex);
+    if(_suspended || _databasePath.isEmpty()) {
+        return false;
+    }
+    _queue.enqueue(task);
+    if(_activeReaders < maxReaders && _activeReaders < _queue.count()) {
+        _activeReaders++;
+        _threadPool.start([this]() { _readTiles(); });
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileCacheReader::suspend()
+{
+    QMutexLocker lock(&_mutex);
+    _suspended = true;
+    lock.unlock();
+    //-- Readers leave once the queue is empty
+    _threadPool.waitForDone();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileCacheReader::resume()
+{
+    QMutexLocker lock(&_mutex);
+    _suspended = false;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileCacheReader::_readTiles()
+{
+    QMutexLocker lock(&_mutex);
+    const QString databasePath = _databasePath;
+    lock.unlock();
+
+    //-- Connections belong to the thread which opened them
+    const QString session = QStringLiteral("QGeoTileReaderSession_%1_%2").arg(reinterpret_cast<quintptr>(this)).arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", session);
+        db.setDatabaseName(databasePath);
+        //-- Private cache: in shared cache mode readers would wait for the writer's table locks, instead of reading
+        //   the last committed state from the WAL
+        {
+            QSqlQuery byID(db);
+            QSqlQuery byHash(db);
+            bool ready = db.open();
+            if(ready) {
+                ready = byID.prepare("SELECT hash, tile, format, type FROM Tiles WHERE tileID = ?") && byHash.prepare("SELECT hash, tile, format, type FROM Tiles WHERE hash = ?");
+            }
+            if(!ready) {
+                qWarning() << "Map Cache SQL error (open reader connection):" << db.lastError();
+            }
+            while(true) {
+                lock.relock();
+                if(_queue.isEmpty()) {
+                    _activeReaders--;
+                    break;
+                }
+                QGCFetchTileTask* task = _queue.dequeue();
+                lock.unlock();
+                _readTile(ready ? &byID : nullptr, ready ? &byHash : nullptr, task);
+            }
+            lock.unlock();
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(session);
+    QReadLocker storesLock(&_storesLock);
+    for(const auto& store: _stores) {
+        store.second->releaseThread();
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Looks the tile up by its key first, then by hash. Same as QGCCacheWorker::_selectTile.
+void
+QGCTileCacheReader::_readTile(QSqlQuery* byID, QSqlQuery* byHash, QGCFetchTileTask* task)
+{
+    const QString hash = task->hash();
+    QByteArray img;
+    QString format;
+    QString type;
+    //-- The tile may have been read by another reader meanwhile
+    bool found = _memoryCache->find(hash, img, format, type);
+    if(!found && _findInStores(hash, false, img, format, type)) {
+        _memoryCache->insert(hash, img, format, type);
+        found = true;
+    }
+    if(!found && byID && byHash) {
+        QSqlQuery* query = nullptr;
+        const quint64 key = QGCCacheWorker::tileKeyFromHash(hash);
+        if(key) {
+            byID->bindValue(0, key);
+            if(byID->exec() && byID->next() && byID->value(0).toString() == hash) {
+                query = byID;
+            }
+        }
+        if(!query) {
+            byHash->bindValue(0, hash);
+            if(byHash->exec() && byHash->next()) {
+                query = byHash;
+            }
+        }
+        if(query) {
+            img     = query->value(1).toByteArray();
+            format  = query->value(2).toString();
+            type    = query->value(3).toString();
+            _memoryCache->insert(hash, img, format, type);
+            found = true;
+        }
+        byID->finish();
+        byHash->finish();
+    }
+    if(found) {
+        qCDebug(QGCTileCacheLog) << "QGCTileCacheReader (Found) HASH:" << hash;
+        QGCCacheTile* tile = new QGCCacheTile(hash, img, format, type);
+        //-- Object created here must be moved to the task's thread to be used there
+        tile->moveToThread(task->thread());
+        task->setTileFetched(tile);
+    } else {
+        qCDebug(QGCTileCacheLog) << "QGCTileCacheReader (NOT in DB) HASH:" << hash;
+        task->setError("Tile not in cache database");
+    }
+    task->deleteLater();
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileCacheReader::_findInStores(const QString& hash, bool mapped, QByteArray& img, QString& format, QString& type)
+{
+    QReadLocker storesLock(&_storesLock);
+    if(_stores.isEmpty()) {
+        return false;
+    }
+    int providerHash, x, y, z;
+    if(!QGCTileStore::tileFromHash(hash, providerHash, x, y, z)) {
+        return false;
+    }
+    for(const auto& store: _stores) {
+        if(store.first == providerHash && store.second->isMapped() == mapped && store.second->findTile(x, y, z, img, format)) {
+            type = store.second->type();
+            return true;
+        }
+    }
+    return false;
+}
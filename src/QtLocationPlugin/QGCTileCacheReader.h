@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QQueue>
+#include <QReadWriteLock>
+#include <QString>
+#include <QThreadPool>
+
+class QGCFetchTileTask;
+class QGCTileMemoryCache;
+class QGCTileStore;
+class QSqlQuery;
+
+//-----------------------------------------------------------------------------
+/// Serves tile fetches from the tile cache database on a pool of reader threads, so fetches don't queue behind
+/// writes and long running jobs on QGCCacheWorker. Each busy reader thread has its own connection. The connection
+/// is closed when the thread runs out of fetches. Tiles read are added to the memory cache.
+///
+/// Tile stores (map packages) are looked up before the database. Memory mapped stores are answered on the calling
+/// thread through findMapped, others on the reader threads.
+class QGCTileCacheReader
+{
+public:
+    QGCTileCacheReader  (QGCTileMemoryCache* memoryCache);
+    ~QGCTileCacheReader ();
+
+    void    setDatabaseFile (const QString& path);
+
+    /// Takes ownership of the store. Stores are looked up in the order they were added.
+    ///     @param providerHash Provider part of the hashes of the store's map type
+    void    addStore        (QGCTileStore* store, int providerHash);
+
+    /// Looks the tile up in the memory mapped stores, without blocking
+    bool    findMapped      (const QString& hash, QByteArray& img, QString& format, QString& type);
+
+    /// Queues the fetch for a reader thread. The task is deleted once it signalled its result.
+    ///     @return false: readers are suspended, the task was not taken
+    bool    fetch           (QGCFetchTileTask* task);
+
+    /// Stops taking fetches and waits until all queued fetches are done and all connections are closed
+    void    suspend         ();
+    void    resume          ();
+
+    static constexpr int maxReaders = 4;
+
+private:
+    void    _readTiles      ();
+    void    _readTile       (QSqlQuery* byID, QSqlQuery* byHash, QGCFetchTileTask* task);
+    bool    _findInStores   (const QString& hash, bool mapped, QByteArray& img, QString& format, QString& type);
+
+    QGCTileMemoryCache*         _memoryCache;
+    QMutex                      _mutex;
+    QQueue<QGCFetchTileTask*>   _queue;
+    QString                     _databasePath;
+    int                         _activeReaders  = 0;
+    bool                        _suspended      = true;
+    QThreadPool                 _threadPool;
+    QReadWriteLock              _storesLock;
+    QList<QPair<int, QGCTileStore*>> _stores;   ///< Provider hash, store
+};
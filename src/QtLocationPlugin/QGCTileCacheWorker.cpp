@@ -18,6 +18,7 @@
 
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
+#include "QGCTileStore.h"
 
 #include <QVariant>
 #include <QtSql/QSqlQuery>
@@ -41,6 +42,22 @@ QGC_LOGGING_CATEGORY(QGCTileCacheLog, "QGCTileCacheLog")
 #define LONG_TIMEOUT        5
 #define SHORT_TIMEOUT       2
 
+//-- Statements prepared once per connection, indexed by QGCCacheWorker::Statement_t. Lookups return the hash in
+//   column 0 so a tileID hit can be checked against the requested hash.
+static const char* const kStatements[] = {
+    "INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)",
+    "INSERT INTO Tiles(tileID, hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?, ?)",
+    "INSERT INTO SetTiles(tileID, setID) VALUES(?, ?)",
+    "SELECT hash, tile, format, type FROM Tiles WHERE tileID = ?",
+    "SELECT hash, tile, format, type FROM Tiles WHERE hash = ?",
+    "SELECT hash, tileID FROM Tiles WHERE tileID = ?",
+    "SELECT hash, tileID FROM Tiles WHERE hash = ?",
+    "INSERT OR IGNORE INTO TilesDownload(setID, hash, type, x, y, z, state) VALUES(?, ?, ?, ?, ?, ?, ?)",
+    "UPDATE TilesDownload SET state = ? WHERE setID = ? AND hash = ?",
+    "DELETE FROM TilesDownload WHERE setID = ? AND hash = ?",
+    "DELETE FROM Tiles WHERE tileID = ?",
+};
+
 //-----------------------------------------------------------------------------
 QGCCacheWorker::QGCCacheWorker()
     : _db(nullptr)
@@ -54,6 +71,8 @@ QGCCacheWorker::QGCCacheWorker()
     , _lastUpdate(0)
     , _updateTimeout(SHORT_TIMEOUT)
     , _hostLookupID(0)
+    , _session(QStringLiteral("%1_%2").arg(kSession).arg(reinterpret_cast<quintptr>(this)))
+    , _reader(&_memoryCache)
 {
 }
 
@@ -67,6 +86,27 @@ void
 QGCCacheWorker::setDatabaseFile(const QString& path)
 {
     _databasePath = path;
+    _reader.setDatabaseFile(path);
+}
+
+//-----------------------------------------------------------------------------
+/// Tile hashes are "%010d%08d%08d%03d" of provider hash, x, y and z. The key packs the low 12 bits of the provider
+/// hash into bits 51-62, z into bits 46-50, x into bits 23-45 and y into bits 0-22. Keys are always >= 2^46 so they
+/// don't clash with the rowids of tiles stored by older versions. A tile whose key is already taken is stored with
+/// a regular rowid instead, which is why key lookups always verify the hash.
+quint64
+QGCCacheWorker::tileKeyFromHash(const QString& hash)
+{
+    int provider, x, y, z;
+    if(!QGCTileStore::tileFromHash(hash, provider, x, y, z)) {
+        return 0;
+    }
+    static const int kMaxXY = 1 << 23;
+    if(x < 0 || y < 0 || x >= kMaxXY || y >= kMaxXY || z < 0 || z > 31) {
+        return 0;
+    }
+    const quint64 key = (static_cast<quint64>(provider & 0xFFF) << 51) | (static_cast<quint64>(z) << 46) | (static_cast<quint64>(x) << 23) | static_cast<quint64>(y);
+    return key < (Q_UINT64_C(1) << 46) ? 0 : key;
 }
 
 //-----------------------------------------------------------------------------
@@ -85,6 +125,7 @@ QGCCacheWorker::quit()
     if(this->isRunning()) {
         _waitc.wakeAll();
     }
+    _reader.suspend();
 }
 
 //-----------------------------------------------------------------------------
@@ -97,6 +138,15 @@ QGCCacheWorker::enqueueTask(QGCMapTask* task)
         task->deleteLater();
         return false;
     }
+    if(task->type() == QGCMapTask::taskFetchTile) {
+        if(_fetchTile(static_cast<QGCFetchTileTask*>(task))) {
+            return true;
+        }
+    } else if(task->type() == QGCMapTask::taskCacheTile) {
+        //-- Make the tile available right away, the save may wait behind other tasks
+        QGCCacheTile* tile = static_cast<QGCSaveTileTask*>(task)->tile();
+        _memoryCache.insert(tile->hash(), tile->img(), tile->format(), tile->type());
+    }
     QMutexLocker lock(&_taskQueueMutex);
     _taskQueue.enqueue(task);
     lock.unlock(); // don't need to hold the mutex any more
@@ -127,9 +177,18 @@ QGCCacheWorker::run()
 
             // Don't need the lock while running the task.
             lock.unlock();
+            if(task->type() != QGCMapTask::taskCacheTile) {
+                _commitSaveBatch();
+            }
             _runTask(task);
             lock.relock();
             task->deleteLater();
+            //-- Keep grouping tile saves into the open transaction only while more saves are queued
+            if(_saveBatchCount && (_saveBatchCount >= _maxSaveBatch || !_taskQueue.count() || _taskQueue.head()->type() != QGCMapTask::taskCacheTile)) {
+                lock.unlock();
+                _commitSaveBatch();
+                lock.relock();
+            }
             //-- Check for update timeout
             size_t count = static_cast<size_t>(_taskQueue.count());
             if(count > 100) {
@@ -252,13 +311,159 @@ QGCCacheWorker::_deleteBingNoTileTiles()
     }
 }
 
+//-----------------------------------------------------------------------------
+/// Answers the fetch from memory or hands it to a reader thread
+///     @return false: readers are suspended, the fetch must go through the task queue
+bool
+QGCCacheWorker::_fetchTile(QGCFetchTileTask* task)
+{
+    QByteArray img;
+    QString format;
+    QString type;
+    if(_reader.findMapped(task->hash(), img, format, type) || _memoryCache.find(task->hash(), img, format, type)) {
+        QGCCacheTile* tile = new QGCCacheTile(task->hash(), img, format, type);
+        tile->moveToThread(task->thread());
+        //-- Signal the result later, like a fetch run on the worker thread
+        QMetaObject::invokeMethod(task, [task, tile]() {
+            task->setTileFetched(tile);
+            task->deleteLater();
+        }, Qt::QueuedConnection);
+        return true;
+    }
+    return _reader.fetch(task);
+}
+
+//-----------------------------------------------------------------------------
+QSqlQuery*
+QGCCacheWorker::_statement(Statement_t statement)
+{
+    static_assert(sizeof(kStatements) / sizeof(kStatements[0]) == StatementCount, "kStatements out of sync with Statement_t");
+    if(!_statements[statement]) {
+        QSqlQuery* query = new QSqlQuery(*_db);
+        if(!query->prepare(kStatements[statement])) {
+            qWarning() << "Map Cache SQL error (prepare statement):" << kStatements[statement] << query->lastError().text();
+            delete query;
+            return nullptr;
+        }
+        _statements[statement] = query;
+    }
+    return _statements[statement];
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_clearStatements()
+{
+    for(int i = 0; i < StatementCount; i++) {
+        delete _statements[i];
+        _statements[i] = nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_commitSaveBatch()
+{
+    if(_saveBatchCount) {
+        qCDebug(QGCTileCacheLog) << "_commitSaveBatch() tiles:" << _saveBatchCount;
+        _saveBatchCount = 0;
+        if(!_db->commit()) {
+            qWarning() << "Map Cache SQL error (commit saved tiles):" << _db->lastError();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+quint64
+QGCCacheWorker::_insertTile(const QString& hash, const QString& format, const QByteArray& img, const QVariant& type)
+{
+    const qint64 date = QDateTime::currentDateTime().toSecsSinceEpoch();
+    const quint64 key = tileKeyFromHash(hash);
+    if(key) {
+        QSqlQuery* query = _statement(StatementInsertTileWithID);
+        if(query) {
+            query->bindValue(0, key);
+            query->bindValue(1, hash);
+            query->bindValue(2, format);
+            query->bindValue(3, img);
+            query->bindValue(4, img.size());
+            query->bindValue(5, type);
+            query->bindValue(6, date);
+            if(query->exec()) {
+                return key;
+            }
+        }
+    }
+    //-- No key for this hash, the key is taken by another provider's tile or the tile is already there.
+    QSqlQuery* query = _statement(StatementInsertTile);
+    if(query) {
+        query->bindValue(0, hash);
+        query->bindValue(1, format);
+        query->bindValue(2, img);
+        query->bindValue(3, img.size());
+        query->bindValue(4, type);
+        query->bindValue(5, date);
+        if(query->exec()) {
+            return query->lastInsertId().toULongLong();
+        }
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_insertSetTile(quint64 tileID, quint64 setID)
+{
+    QSqlQuery* query = _statement(StatementInsertSetTile);
+    if(!query) {
+        return false;
+    }
+    query->bindValue(0, tileID);
+    query->bindValue(1, setID);
+    if(!query->exec()) {
+        qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query->lastError().text();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/// Looks the tile up by its key first, then by hash. On success query is positioned on the tile row, the caller
+/// must finish() it once the values are read.
+bool
+QGCCacheWorker::_selectTile(const QString& hash, Statement_t byID, Statement_t byHash, QSqlQuery*& query)
+{
+    const quint64 key = tileKeyFromHash(hash);
+    if(key) {
+        query = _statement(byID);
+        if(query) {
+            query->bindValue(0, key);
+            if(query->exec() && query->next() && query->value(0).toString() == hash) {
+                return true;
+            }
+            query->finish();
+        }
+    }
+    query = _statement(byHash);
+    if(query) {
+        query->bindValue(0, hash);
+        if(query->exec() && query->next()) {
+            return true;
+        }
+        query->finish();
+    }
+    query = nullptr;
+    return false;
+}
+
 //-----------------------------------------------------------------------------
 bool
 QGCCacheWorker::_findTileSetID(const QString name, quint64& setID)
 {
     QSqlQuery query(*_db);
-    QString s = QString("SELECT setID FROM TileSets WHERE name = \"%1\"").arg(name);
-    if(query.exec(s)) {
+    query.prepare("SELECT setID FROM TileSets WHERE name = ?");
+    query.addBindValue(name);
+    if(query.exec()) {
         if(query.next()) {
             setID = query.value(0).toULongLong();
             return true;
@@ -290,22 +495,15 @@ QGCCacheWorker::_saveTile(QGCMapTask *mtask)
 {
     if(_valid) {
         QGCSaveTileTask* task = static_cast<QGCSaveTileTask*>(mtask);
-        QSqlQuery query(*_db);
-        query.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-        query.addBindValue(task->tile()->hash());
-        query.addBindValue(task->tile()->format());
-        query.addBindValue(task->tile()->img());
-        query.addBindValue(task->tile()->img().size());
-        query.addBindValue(task->tile()->type());
-        query.addBindValue(QDateTime::currentDateTime().toSecsSinceEpoch());
-        if(query.exec()) {
-            quint64 tileID = query.lastInsertId().toULongLong();
+        //-- Saves are grouped into one transaction, committed by run()
+        if(!_saveBatchCount) {
+            _db->transaction();
+        }
+        _saveBatchCount++;
+        quint64 tileID = _insertTile(task->tile()->hash(), task->tile()->format(), task->tile()->img(), task->tile()->type());
+        if(tileID) {
             quint64 setID = task->tile()->set() == UINT64_MAX ? _getDefaultTileSet() : task->tile()->set();
-            QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-            query.prepare(s);
-            if(!query.exec()) {
-                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
-            }
+            _insertSetTile(tileID, setID);
             qCDebug(QGCTileCacheLog) << "_saveTile() HASH:" << task->tile()->hash();
         } else {
             //-- Tile was already there.
@@ -325,18 +523,16 @@ QGCCacheWorker::_getTile(QGCMapTask* mtask)
     }
     bool found = false;
     QGCFetchTileTask* task = static_cast<QGCFetchTileTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tile, format, type FROM Tiles WHERE hash = \"%1\"").arg(task->hash());
-    if(query.exec(s)) {
-        if(query.next()) {
-            const QByteArray& arrray   = query.value(0).toByteArray();
-            const QString& format  = query.value(1).toString();
-            const QString& type = query.value(2).toString();
-            qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) HASH:" << task->hash();
-            QGCCacheTile* tile = new QGCCacheTile(task->hash(), arrray, format, type);
-            task->setTileFetched(tile);
-            found = true;
-        }
+    QSqlQuery* query;
+    if(_selectTile(task->hash(), StatementSelectTileByID, StatementSelectTileByHash, query)) {
+        const QByteArray& arrray   = query->value(1).toByteArray();
+        const QString& format  = query->value(2).toString();
+        const QString& type = query->value(3).toString();
+        query->finish();
+        qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) HASH:" << task->hash();
+        QGCCacheTile* tile = new QGCCacheTile(task->hash(), arrray, format, type);
+        task->setTileFetched(tile);
+        found = true;
     }
     if(!found) {
         qCDebug(QGCTileCacheLog) << "_getTile() (NOT in DB) HASH:" << task->hash();
@@ -467,12 +663,10 @@ QGCCacheWorker::_updateTotals()
 quint64 QGCCacheWorker::_findTile(const QString hash)
 {
     quint64 tileID = 0;
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tileID FROM Tiles WHERE hash = \"%1\"").arg(hash);
-    if(query.exec(s)) {
-        if(query.next()) {
-            tileID = query.value(0).toULongLong();
-        }
+    QSqlQuery* query;
+    if(_selectTile(hash, StatementSelectTileIDByID, StatementSelectTileIDByHash, query)) {
+        tileID = query->value(1).toULongLong();
+        query->finish();
     }
     return tileID;
 }
@@ -520,27 +714,26 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
                         quint64 tileID = _findTile(hash);
                         if(!tileID) {
                             //-- Set to download
-                            query.prepare("INSERT OR IGNORE INTO TilesDownload(setID, hash, type, x, y, z, state) VALUES(?, ?, ?, ?, ? ,? ,?)");
-                            query.addBindValue(setID);
-                            query.addBindValue(hash);
-                            query.addBindValue(getQGCMapEngine()->urlFactory()->getQtMapIdFromProviderType(type));
-                            query.addBindValue(x);
-                            query.addBindValue(y);
-                            query.addBindValue(z);
-                            query.addBindValue(0);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into TilesDownload):" << query.lastError().text();
+                            QSqlQuery* downloadQuery = _statement(StatementInsertTileDownload);
+                            if(downloadQuery) {
+                                downloadQuery->bindValue(0, setID);
+                                downloadQuery->bindValue(1, hash);
+                                downloadQuery->bindValue(2, getQGCMapEngine()->urlFactory()->getQtMapIdFromProviderType(type));
+                                downloadQuery->bindValue(3, x);
+                                downloadQuery->bindValue(4, y);
+                                downloadQuery->bindValue(5, z);
+                                downloadQuery->bindValue(6, 0);
+                            }
+                            if(!downloadQuery || !downloadQuery->exec()) {
+                                qWarning() << "Map Cache SQL error (add tile into TilesDownload):" << (downloadQuery ? downloadQuery->lastError().text() : QString());
+                                _db->rollback();
                                 mtask->setError("Error creating tile set download list");
                                 return;
                             } else
                                 actual_count++;
                         } else {
                             //-- Tile already in the database. No need to dowload.
-                            QString s = QString("INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-                            query.prepare(s);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
-                            }
+                            _insertSetTile(tileID, setID);
                             qCDebug(QGCTileCacheLog) << "_createTileSet() Already Cached HASH:" << hash;
                         }
                     }
@@ -565,9 +758,28 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
     }
     QList<QGCTile*> tiles;
     QGCGetTileDownloadListTask* task = static_cast<QGCGetTileDownloadListTask*>(mtask);
+    const quint64 setID = task->setID();
     QSqlQuery query(*_db);
-    QString s = QString("SELECT hash, type, x, y, z FROM TilesDownload WHERE setID = %1 AND state = 0 LIMIT %2").arg(task->setID()).arg(task->count());
-    if(query.exec(s)) {
+    QSqlQuery inSetQuery(*_db);
+    QSqlQuery* updateQuery = _statement(StatementUpdateTileDownloadState);
+    QSqlQuery* deleteQuery = _statement(StatementDeleteTileDownload);
+    if(!updateQuery || !deleteQuery
+            || !query.prepare("SELECT hash, type, x, y, z FROM TilesDownload WHERE setID = ? AND state = 0 LIMIT ?")
+            || !inSetQuery.prepare("SELECT COUNT(*) FROM SetTiles WHERE tileID = ? AND setID = ?")) {
+        qWarning() << "Map Cache SQL error (prepare download list):" << query.lastError().text();
+        task->setTileListFetched(tiles);
+        return;
+    }
+    _db->transaction();
+    bool more = true;
+    while(more && tiles.count() < task->count()) {
+        const int requested = task->count() - tiles.count();
+        query.bindValue(0, setID);
+        query.bindValue(1, requested);
+        if(!query.exec()) {
+            break;
+        }
+        QList<QGCTile*> candidates;
         while(query.next()) {
             QGCTile* tile = new QGCTile;
             tile->setHash(query.value("hash").toString());
@@ -575,15 +787,42 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
             tile->setX(query.value("x").toInt());
             tile->setY(query.value("y").toInt());
             tile->setZ(query.value("z").toInt());
-            tiles.append(tile);
+            candidates.append(tile);
         }
-        for(int i = 0; i < tiles.size(); i++) {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 and hash = \"%3\"").arg(static_cast<int>(QGCTile::StateDownloading)).arg(task->setID()).arg(tiles[i]->hash());
-            if(!query.exec(s)) {
-                qWarning() << "Map Cache SQL error (set TilesDownload state):" << query.lastError().text();
+        query.finish();
+        more = candidates.count() == requested;
+        for(QGCTile* tile: candidates) {
+            //-- Tiles saved before their download state was updated (interrupted session) or fetched meanwhile
+            //   by other means don't need to be downloaded again.
+            const quint64 tileID = _findTile(tile->hash());
+            bool ok;
+            if(tileID) {
+                inSetQuery.bindValue(0, tileID);
+                inSetQuery.bindValue(1, setID);
+                if(inSetQuery.exec() && inSetQuery.next() && inSetQuery.value(0).toInt() == 0) {
+                    _insertSetTile(tileID, setID);
+                }
+                inSetQuery.finish();
+                deleteQuery->bindValue(0, setID);
+                deleteQuery->bindValue(1, tile->hash());
+                ok = deleteQuery->exec();
+                qCDebug(QGCTileCacheLog) << "_getTileDownloadList() Already Cached HASH:" << tile->hash();
+                delete tile;
+            } else {
+                updateQuery->bindValue(0, static_cast<int>(QGCTile::StateDownloading));
+                updateQuery->bindValue(1, setID);
+                updateQuery->bindValue(2, tile->hash());
+                ok = updateQuery->exec();
+                tiles.append(tile);
+            }
+            if(!ok) {
+                //-- The row would be selected again
+                qWarning() << "Map Cache SQL error (set TilesDownload state):" << updateQuery->lastError().text() << deleteQuery->lastError().text();
+                more = false;
             }
         }
     }
+    _db->commit();
     task->setTileListFetched(tiles);
 }
 
@@ -595,20 +834,36 @@ QGCCacheWorker::_updateTileDownloadState(QGCMapTask* mtask)
         return;
     }
     QGCUpdateTileDownloadStateTask* task = static_cast<QGCUpdateTileDownloadStateTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s;
-    if(task->state() == QGCTile::StateComplete) {
-        s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND hash = \"%2\"").arg(task->setID()).arg(task->hash());
-    } else {
-        if(task->hash() == "*") {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2").arg(static_cast<int>(task->state())).arg(task->setID());
-        } else {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND hash = \"%3\"").arg(static_cast<int>(task->state())).arg(task->setID()).arg(task->hash());
+    if(task->state() != QGCTile::StateComplete && task->hash() == "*") {
+        QSqlQuery query(*_db);
+        query.prepare("UPDATE TilesDownload SET state = ? WHERE setID = ?");
+        query.addBindValue(static_cast<int>(task->state()));
+        query.addBindValue(task->setID());
+        if(!query.exec()) {
+            qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
         }
+        return;
+    }
+    QSqlQuery* query = _statement(task->state() == QGCTile::StateComplete ? StatementDeleteTileDownload : StatementUpdateTileDownloadState);
+    if(!query) {
+        return;
     }
-    if(!query.exec(s)) {
-        qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
+    const QStringList hashes = task->hashes();
+    _db->transaction();
+    for(const QString& hash: hashes) {
+        if(task->state() == QGCTile::StateComplete) {
+            query->bindValue(0, task->setID());
+            query->bindValue(1, hash);
+        } else {
+            query->bindValue(0, static_cast<int>(task->state()));
+            query->bindValue(1, task->setID());
+            query->bindValue(2, hash);
+        }
+        if(!query->exec()) {
+            qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query->lastError().text();
+        }
     }
+    _db->commit();
 }
 
 //-----------------------------------------------------------------------------
@@ -625,17 +880,29 @@ QGCCacheWorker::_pruneCache(QGCMapTask* mtask)
     s = QString("SELECT tileID, size, hash FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1) ORDER BY DATE ASC LIMIT 128").arg(_getDefaultTileSet());
     qint64 amount = (qint64)task->amount();
     QList<quint64> tlist;
+    QStringList hlist;
     if(query.exec(s)) {
         while(query.next() && amount >= 0) {
             tlist << query.value(0).toULongLong();
+            hlist << query.value(2).toString();
             amount -= query.value(1).toULongLong();
-            qCDebug(QGCTileCacheLog) << "_pruneCache() HASH:" << query.value(2).toString();
+            qCDebug(QGCTileCacheLog) << "_pruneCache() HASH:" << hlist.last();
         }
-        while(tlist.count()) {
-            s = QString("DELETE FROM Tiles WHERE tileID = %1").arg(tlist[0]);
-            tlist.removeFirst();
-            if(!query.exec(s))
-                break;
+        query.finish();
+        QSqlQuery* deleteQuery = _statement(StatementDeleteTile);
+        if(deleteQuery) {
+            _db->transaction();
+            while(tlist.count()) {
+                deleteQuery->bindValue(0, tlist[0]);
+                tlist.removeFirst();
+                if(!deleteQuery->exec())
+                    break;
+            }
+            _db->commit();
+        }
+        //-- Pruned tiles must not keep being served from memory
+        for(const QString& hash: hlist) {
+            _memoryCache.remove(hash);
         }
         task->setPruned();
     }
@@ -650,6 +917,7 @@ QGCCacheWorker::_deleteTileSet(QGCMapTask* mtask)
     }
     QGCDeleteTileSetTask* task = static_cast<QGCDeleteTileSetTask*>(mtask);
     _deleteTileSet(task->setID());
+    _memoryCache.clear();
     task->setTileSetDeleted();
 }
 
@@ -680,9 +948,10 @@ QGCCacheWorker::_renameTileSet(QGCMapTask* mtask)
     }
     QGCRenameTileSetTask* task = static_cast<QGCRenameTileSetTask*>(mtask);
     QSqlQuery query(*_db);
-    QString s;
-    s = QString("UPDATE TileSets SET name = \"%1\" WHERE setID = %2").arg(task->newName()).arg(task->setID());
-    if(!query.exec(s)) {
+    query.prepare("UPDATE TileSets SET name = ? WHERE setID = ?");
+    query.addBindValue(task->newName());
+    query.addBindValue(task->setID());
+    if(!query.exec()) {
         task->setError("Error renaming tile set");
     }
 }
@@ -695,6 +964,10 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
         return;
     }
     QGCResetTask* task = static_cast<QGCResetTask*>(mtask);
+    //-- Prepared statements and reader connections keep the tables busy
+    _reader.suspend();
+    _memoryCache.clear();
+    _clearStatements();
     QSqlQuery query(*_db);
     QString s;
     s = QString("DROP TABLE Tiles");
@@ -706,6 +979,9 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
     s = QString("DROP TABLE TilesDownload");
     query.exec(s);
     _valid = _createDB(*_db);
+    if(_valid) {
+        _reader.resume();
+    }
     task->setResetCompleted();
 }
 
@@ -720,9 +996,13 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
     //-- If replacing, simply copy over it
     if(task->replace()) {
         //-- Close and delete old database
+        _reader.suspend();
+        _memoryCache.clear();
         _disconnectDB();
         QFile file(_databasePath);
         file.remove();
+        QFile::remove(_databasePath + "-wal");
+        QFile::remove(_databasePath + "-shm");
         //-- Copy given database
         QFile::copy(task->path(), _databasePath);
         task->setProgress(25);
@@ -823,19 +1103,10 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
                                 QByteArray img  = subQuery.value("tile").toByteArray();
                                 int type        = subQuery.value("type").toInt();
                                 //-- Save tile
-                                cQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                cQuery.addBindValue(hash);
-                                cQuery.addBindValue(format);
-                                cQuery.addBindValue(img);
-                                cQuery.addBindValue(img.size());
-                                cQuery.addBindValue(type);
-                                cQuery.addBindValue(QDateTime::currentDateTime().toSecsSinceEpoch());
-                                if(cQuery.exec()) {
+                                quint64 importTileID = _insertTile(hash, format, img, type);
+                                if(importTileID) {
                                     tilesSaved++;
-                                    quint64 importTileID = cQuery.lastInsertId().toULongLong();
-                                    QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(importTileID).arg(insertSetID);
-                                    cQuery.prepare(s);
-                                    cQuery.exec();
+                                    _insertSetTile(importTileID, insertSetID);
                                     currentCount++;
                                     if(tileCount) {
                                         int progress = (int)((double)currentCount / (double)tileCount * 100.0);
@@ -1019,6 +1290,13 @@ QGCCacheWorker::_init()
             _valid = _createDB(*_db);
             if(!_valid) {
                 _failed = true;
+            } else {
+                //-- Tiles which were being downloaded when the last session ended are pending again
+                QSqlQuery query(*_db);
+                query.prepare("UPDATE TilesDownload SET state = ? WHERE state = ?");
+                query.addBindValue(static_cast<int>(QGCTile::StatePending));
+                query.addBindValue(static_cast<int>(QGCTile::StateDownloading));
+                query.exec();
             }
         } else {
             qCritical() << "Map Cache SQL error (init() open db):" << _db->lastError();
@@ -1029,6 +1307,9 @@ QGCCacheWorker::_init()
         qCritical() << "Could not find suitable cache directory.";
         _failed = true;
     }
+    if(_valid) {
+        _reader.resume();
+    }
     _testInternet();
     return _failed;
 }
@@ -1037,10 +1318,18 @@ QGCCacheWorker::_init()
 bool
 QGCCacheWorker::_connectDB()
 {
-    _db.reset(new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession)));
+    _db.reset(new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _session)));
     _db->setDatabaseName(_databasePath);
     _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
     _valid = _db->open();
+    if(_valid) {
+        //-- Readers don't block on the writer and commits only append to the log
+        QSqlQuery query(*_db);
+        if(!query.exec("PRAGMA journal_mode=WAL")) {
+            qWarning() << "Map Cache SQL error (set WAL mode):" << query.lastError().text();
+        }
+        query.exec("PRAGMA synchronous=NORMAL");
+    }
     return _valid;
 }
 
@@ -1109,8 +1398,9 @@ QGCCacheWorker::_createDB(QSqlDatabase& db, bool createDefault)
     }
     //-- Create default tile set
     if(res && createDefault) {
-        QString s = QString("SELECT name FROM TileSets WHERE name = \"%1\"").arg(kDefaultSet);
-        if(query.exec(s)) {
+        query.prepare("SELECT name FROM TileSets WHERE name = ?");
+        query.addBindValue(kDefaultSet);
+        if(query.exec()) {
             if(!query.next()) {
                 query.prepare("INSERT INTO TileSets(name, defaultSet, date) VALUES(?, ?, ?)");
                 query.addBindValue(kDefaultSet);
@@ -1137,8 +1427,10 @@ void
 QGCCacheWorker::_disconnectDB()
 {
     if (_db) {
+        _commitSaveBatch();
+        _clearStatements();
         _db.reset();
-        QSqlDatabase::removeDatabase(kSession);
+        QSqlDatabase::removeDatabase(_session);
     }
 }
 
@@ -26,16 +26,32 @@
 #include <QWaitCondition>
 #include <QMutexLocker>
 #include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
 #include <QHostInfo>
 
 #include "QGCLoggingCategory.h"
+#include "QGCTileCacheReader.h"
+#include "QGCTileMemoryCache.h"
 
 Q_DECLARE_LOGGING_CATEGORY(QGCTileCacheLog)
 
 class QGCMapTask;
 class QGCCachedTileSet;
+class QGCFetchTileTask;
 
 //-----------------------------------------------------------------------------
+/// Runs all tile cache database access on its own thread.
+///
+/// The database is used in WAL mode. Statements used for tile I/O are prepared once per connection and reused.
+/// Consecutive tile saves are grouped into a single transaction of up to _maxSaveBatch tiles, which is committed
+/// before any other task runs. Tiles are stored with a tileID derived from provider/x/y/z (see tileKeyFromHash) so
+/// they can be looked up by integer primary key. Tiles stored without such a key (older databases, key collisions)
+/// are still found through their hash.
+///
+/// Tile fetches don't go through the task queue. They are answered from an in memory LRU of recent tiles or by
+/// QGCTileCacheReader threads with their own connections, so map panning isn't held up by saves, imports or exports.
+/// Readers are suspended while the database is replaced or reset. Tiles found in a QGCTileStore (map packages) take
+/// precedence over the memory cache and the database.
 class QGCCacheWorker : public QThread
 {
     Q_OBJECT
@@ -46,6 +62,13 @@ public:
     void    quit            ();
     bool    enqueueTask     (QGCMapTask* task);
     void    setDatabaseFile (const QString& path);
+    /// Memory budget of the hot tile cache, 0 disables it
+    void    setMemoryCacheBytes(qint64 maxBytes) { _memoryCache.setMaxBytes(maxBytes); }
+    /// Serves the store's tiles ahead of the database, takes ownership of the store
+    void    addTileStore    (QGCTileStore* store, int providerHash) { _reader.addStore(store, providerHash); }
+
+    /// @return Integer primary key for the tile hash, 0 if the hash can't be mapped to a key
+    static quint64 tileKeyFromHash(const QString& hash);
 
 protected:
     void    run             ();
@@ -72,6 +95,28 @@ private:
     void        _testInternet           ();
     void        _deleteBingNoTileTiles  ();
 
+    typedef enum {
+        StatementInsertTile,
+        StatementInsertTileWithID,
+        StatementInsertSetTile,
+        StatementSelectTileByID,
+        StatementSelectTileByHash,
+        StatementSelectTileIDByID,
+        StatementSelectTileIDByHash,
+        StatementInsertTileDownload,
+        StatementUpdateTileDownloadState,
+        StatementDeleteTileDownload,
+        StatementDeleteTile,
+        StatementCount
+    } Statement_t;
+
+    bool        _fetchTile              (QGCFetchTileTask* task);
+    QSqlQuery*  _statement              (Statement_t statement);
+    void        _clearStatements        ();
+    void        _commitSaveBatch        ();
+    quint64     _insertTile             (const QString& hash, const QString& format, const QByteArray& img, const QVariant& type);
+    bool        _selectTile             (const QString& hash, Statement_t byID, Statement_t byHash, QSqlQuery*& query);
+    bool        _insertSetTile          (quint64 tileID, quint64 setID);
     quint64     _findTile               (const QString hash);
     bool        _findTileSetID          (const QString name, quint64& setID);
     void        _updateSetTotals        (QGCCachedTileSet* set);
@@ -103,6 +148,13 @@ private:
     time_t                          _lastUpdate;
     int                             _updateTimeout;
     int                             _hostLookupID;
+    QString                         _session;                       ///< Database connection name, unique per worker
+    QSqlQuery*                      _statements[StatementCount] = {};
+    int                             _saveBatchCount = 0;            ///< Tiles saved in the open transaction
+    QGCTileMemoryCache              _memoryCache;
+    QGCTileCacheReader              _reader;
+
+    static const int                _maxSaveBatch   = 256;
 };
 
 #endif // QGC_TILE_CACHE_WORKER_H
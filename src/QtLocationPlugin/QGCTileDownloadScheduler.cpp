@@ -0,0 +1,193 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileDownloadScheduler.h"
+#include "QGCFileDownload.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+
+QGC_LOGGING_CATEGORY(QGCTileDownloadSchedulerLog, "QGCTileDownloadSchedulerLog")
+
+static const char* kRequestStartProperty   = "qgcRequestStart";
+static const char* kTileHashProperty       = "qgcTileHash";
+
+//-----------------------------------------------------------------------------
+QGCTileDownloadScheduler::QGCTileDownloadScheduler(int initialConcurrency, QObject* parent)
+    : QObject               (parent)
+    , _networkManager       (new QNetworkAccessManager(this))
+    , _initialConcurrency   (qBound(minConcurrency, initialConcurrency, maxConcurrency))
+{
+    _clock.start();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloadScheduler::enqueue(const QString& hash, QNetworkRequest request)
+{
+    //-- Keep-alive is the default. Let requests queue up on the open connections instead of waiting for a reply each.
+    request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+    request.setTransferTimeout(transferTimeoutMSecs);
+
+    const QString hostName = request.url().host();
+    Host_t& host = _hosts[hostName];
+    if(host.window == 0) {
+        host.window = _initialConcurrency;
+    }
+    host.queue.enqueue({ hash, request });
+    _pendingCount++;
+    _dispatch(hostName);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloadScheduler::abort()
+{
+    const QList<QNetworkReply*> replies = _replyHosts.keys();
+    _replyHosts.clear();
+    for(QNetworkReply* reply: replies) {
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        reply->deleteLater();
+    }
+    for(Host_t& host: _hosts) {
+        host.queue.clear();
+        host.inFlight = 0;
+    }
+    _pendingCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+int
+QGCTileDownloadScheduler::concurrency(const QString& host) const
+{
+    const auto it = _hosts.constFind(host);
+    return it == _hosts.constEnd() ? _initialConcurrency : static_cast<int>(it->window);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloadScheduler::_dispatch(const QString& hostName)
+{
+    Host_t& host = _hosts[hostName];
+    while(host.queue.count() && host.inFlight < static_cast<int>(host.window)) {
+        _start(hostName, host);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloadScheduler::_start(const QString& hostName, Host_t& host)
+{
+    const Request_t request = host.queue.dequeue();
+#if !defined(__mobile__)
+    QNetworkProxy proxy = _networkManager->proxy();
+    QNetworkProxy tProxy;
+    tProxy.setType(QNetworkProxy::DefaultProxy);
+    _networkManager->setProxy(tProxy);
+#endif
+    QNetworkReply* reply = _networkManager->get(request.request);
+#if !defined(__mobile__)
+    _networkManager->setProxy(proxy);
+#endif
+    QGCFileDownload::setIgnoreSSLErrorsIfNeeded(*reply);
+    reply->setProperty(kRequestStartProperty, _clock.elapsed());
+    reply->setProperty(kTileHashProperty, request.hash);
+    connect(reply, &QNetworkReply::finished, this, &QGCTileDownloadScheduler::_replyFinished);
+    _replyHosts[reply] = hostName;
+    host.inFlight++;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloadScheduler::_replyFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if(!reply || !_replyHosts.contains(reply)) {
+        return;
+    }
+    reply->deleteLater();
+    const QString hostName = _replyHosts.take(reply);
+    const QString hash = reply->property(kTileHashProperty).toString();
+    const double latencyMSecs = _clock.elapsed() - reply->property(kRequestStartProperty).toLongLong();
+
+    Host_t& host = _hosts[hostName];
+    host.inFlight--;
+    _pendingCount--;
+
+    const bool success = reply->error() == QNetworkReply::NoError;
+    if(success || _isCongestion(reply)) {
+        _updateWindow(host, success, latencyMSecs);
+    }
+    _dispatch(hostName);
+
+    if(success) {
+        emit tileDownloaded(hash, reply->readAll());
+    } else {
+        qCDebug(QGCTileDownloadSchedulerLog) << "Tile download failed" << hash << reply->errorString();
+        emit tileFailed(hash, reply->error(), reply->errorString());
+    }
+    if(!_pendingCount) {
+        emit idle();
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Only errors which say the host or the path to it is overloaded shrink the window. Missing tiles and other
+/// request errors come back just as fast with fewer requests in flight.
+bool
+QGCTileDownloadScheduler::_isCongestion(QNetworkReply* reply)
+{
+    switch(reply->error()) {
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::ProxyTimeoutError:
+        return true;
+    case QNetworkReply::OperationCanceledError:
+        //-- abort() disconnects before canceling, so this is the transfer timeout
+        return true;
+    default:
+        break;
+    }
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    return status == 429 || status >= 500;
+}
+
+//-----------------------------------------------------------------------------
+/// Additive increase, multiplicative decrease, like TCP congestion control. The window grows by one request per
+/// window of successes, so it doubles no faster than once per round trip.
+void
+QGCTileDownloadScheduler::_updateWindow(Host_t& host, bool success, double latencyMSecs)
+{
+    const double previousWindow = host.window;
+    if(success) {
+        if(host.latencyAverage == 0) {
+            host.latencyAverage = latencyMSecs;
+            host.latencyMin = latencyMSecs;
+        } else {
+            host.latencyAverage = (0.8 * host.latencyAverage) + (0.2 * latencyMSecs);
+            host.latencyMin = qMin(host.latencyMin, latencyMSecs);
+        }
+        const bool latencyInflated = host.latencyAverage > qMax(2.0 * host.latencyMin, host.latencyMin + latencyMarginMSecs);
+        if(++host.successes >= static_cast<int>(host.window)) {
+            host.successes = 0;
+            if(latencyInflated) {
+                host.window = qMax(static_cast<double>(minConcurrency), host.window * 0.75);
+            } else {
+                host.window = qMin(static_cast<double>(maxConcurrency), host.window + 1);
+            }
+        }
+    } else {
+        host.successes = 0;
+        host.window = qMax(static_cast<double>(minConcurrency), host.window / 2);
+    }
+    if(static_cast<int>(previousWindow) != static_cast<int>(host.window)) {
+        qCDebug(QGCTileDownloadSchedulerLog) << "Concurrency" << static_cast<int>(host.window) << "latency" << host.latencyAverage << "min" << host.latencyMin;
+    }
+}
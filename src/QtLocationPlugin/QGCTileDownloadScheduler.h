@@ -0,0 +1,91 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QQueue>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTileDownloadSchedulerLog)
+
+class QNetworkAccessManager;
+
+//-----------------------------------------------------------------------------
+/// Downloads tiles for offline tile sets.
+///
+/// Requests are queued per host and run over the host's keep-alive connections, pipelined where the server allows
+/// it. The number of requests in flight to a host adapts to the host: it grows by one per window of successful
+/// replies while latency stays near the lowest latency seen. It is cut by a quarter when latency inflates and halved
+/// on errors from an overloaded host: timeouts, connection resets, HTTP 429 and 5xx. Other errors leave it alone.
+class QGCTileDownloadScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    QGCTileDownloadScheduler(int initialConcurrency = defaultConcurrency, QObject* parent = nullptr);
+
+    QNetworkAccessManager* networkManager() { return _networkManager; }
+
+    void    enqueue         (const QString& hash, QNetworkRequest request);
+    /// Drops queued requests and aborts the ones in flight. Aborted requests are not signalled.
+    void    abort           ();
+
+    /// @return Number of requests queued or in flight
+    int     pendingCount    () const { return _pendingCount; }
+    /// @return Current limit of requests in flight to the host
+    int     concurrency     (const QString& host) const;
+
+    static constexpr int    defaultConcurrency  = 12;
+    static constexpr int    minConcurrency      = 2;
+    static constexpr int    maxConcurrency      = 32;
+    static constexpr int    latencyMarginMSecs  = 50;   ///< Latency within this margin of the lowest is not inflated
+    static constexpr int    transferTimeoutMSecs = 30000;
+
+signals:
+    void    tileDownloaded  (const QString& hash, const QByteArray& data);
+    void    tileFailed      (const QString& hash, QNetworkReply::NetworkError error, const QString& errorString);
+    /// Nothing queued or in flight anymore
+    void    idle            ();
+
+private slots:
+    void    _replyFinished  ();
+
+private:
+    typedef struct {
+        QString         hash;
+        QNetworkRequest request;
+    } Request_t;
+
+    typedef struct {
+        QQueue<Request_t>   queue;
+        int                 inFlight        = 0;
+        double              window          = 0;
+        double              latencyAverage  = 0;        ///< Exponential moving average, msecs
+        double              latencyMin      = 0;        ///< Lowest latency seen, msecs
+        int                 successes       = 0;        ///< Successes since the window last changed
+    } Host_t;
+
+    void    _dispatch       (const QString& hostName);
+    void    _start          (const QString& hostName, Host_t& host);
+    void    _updateWindow   (Host_t& host, bool success, double latencyMSecs);
+
+    static bool _isCongestion(QNetworkReply* reply);
+
+    QNetworkAccessManager*          _networkManager;
+    QElapsedTimer                   _clock;
+    int                             _initialConcurrency;
+    int                             _pendingCount   = 0;
+    QHash<QString, Host_t>          _hosts;
+    QHash<QNetworkReply*, QString>  _replyHosts;
+};
@@ -0,0 +1,96 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileMemoryCache.h"
+
+#include <QMutexLocker>
+
+//-----------------------------------------------------------------------------
+QGCTileMemoryCache::QGCTileMemoryCache(qint64 maxBytes)
+    : _maxBytes(0)
+{
+    setMaxBytes(maxBytes);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::setMaxBytes(qint64 maxBytes)
+{
+    //-- Shards are sized from the local copy, a concurrent setMaxBytes must not mix two budgets
+    const qint64 bytes = qMax(maxBytes, Q_INT64_C(0));
+    _maxBytes.store(bytes);
+    for(Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        shard.tiles.setMaxCost(bytes / shardCount);
+    }
+}
+
+//-----------------------------------------------------------------------------
+qint64
+QGCTileMemoryCache::bytes() const
+{
+    qint64 total = 0;
+    for(const Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        total += shard.tiles.totalCost();
+    }
+    return total;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileMemoryCache::find(const QString& hash, QByteArray& img, QString& format, QString& type)
+{
+    if(!_maxBytes.load()) {
+        return false;
+    }
+    Shard_t& shard = _shard(hash);
+    QMutexLocker lock(&shard.mutex);
+    const Tile_t* tile = shard.tiles.object(hash);
+    if(!tile) {
+        return false;
+    }
+    img     = tile->img;
+    format  = tile->format;
+    type    = tile->type;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::insert(const QString& hash, const QByteArray& img, const QString& format, const QString& type)
+{
+    if(!_maxBytes.load() || img.isEmpty()) {
+        return;
+    }
+    Shard_t& shard = _shard(hash);
+    QMutexLocker lock(&shard.mutex);
+    if(!shard.tiles.contains(hash)) {
+        shard.tiles.insert(hash, new Tile_t{ img, format, type }, img.size());
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::remove(const QString& hash)
+{
+    Shard_t& shard = _shard(hash);
+    QMutexLocker lock(&shard.mutex);
+    shard.tiles.remove(hash);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::clear()
+{
+    for(Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        shard.tiles.clear();
+    }
+}
@@ -0,0 +1,58 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QString>
+
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+/// In memory LRU of tile bytes in front of the tile cache database. Tiles are spread over shards by hash, each shard
+/// has its own lock and an equal part of the memory budget, so concurrent readers rarely contend. All methods are
+/// thread safe.
+class QGCTileMemoryCache
+{
+public:
+    QGCTileMemoryCache  (qint64 maxBytes = defaultMaxBytes);
+
+    /// A budget of 0 disables the cache
+    void    setMaxBytes (qint64 maxBytes);
+    qint64  maxBytes    () const { return _maxBytes.load(); }
+    qint64  bytes       () const;
+
+    bool    find        (const QString& hash, QByteArray& img, QString& format, QString& type);
+    /// Existing entries are kept, like the database keeps the first saved copy of a tile
+    void    insert      (const QString& hash, const QByteArray& img, const QString& format, const QString& type);
+    void    remove      (const QString& hash);
+    void    clear       ();
+
+    static constexpr int    shardCount      = 16;
+    static constexpr qint64 defaultMaxBytes = 32 * 1024 * 1024;
+
+private:
+    struct Tile_t {
+        QByteArray  img;
+        QString     format;
+        QString     type;
+    };
+
+    struct Shard_t {
+        mutable QMutex          mutex;
+        QCache<QString, Tile_t> tiles;      ///< Cost is in bytes
+    };
+
+    Shard_t& _shard(const QString& hash) { return _shards[qHash(hash) % shardCount]; }
+
+    Shard_t             _shards[shardCount];
+    std::atomic<qint64> _maxBytes;
+};
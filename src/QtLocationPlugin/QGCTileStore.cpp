@@ -0,0 +1,306 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileStore.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QtEndian>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+const char QGCTilePackStore::_magic[8] = { 'Q', 'G', 'C', 'T', 'I', 'L', 'E', 'S' };
+
+//-----------------------------------------------------------------------------
+QGCTileStore::QGCTileStore(const QString& path, const QString& type)
+    : _path(path)
+    , _type(type)
+{
+}
+
+//-----------------------------------------------------------------------------
+QGCTileStore*
+QGCTileStore::open(const QString& path, const QString& type, QString& errorString)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if(suffix == QLatin1String("qgctiles")) {
+        return QGCTilePackStore::open(path, type, errorString);
+    } else if(suffix == QLatin1String("mbtiles")) {
+        return QGCMBTilesStore::open(path, type, errorString);
+    }
+    errorString = QStringLiteral("Unknown tile store file type: %1").arg(suffix);
+    return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileStore::tileFromHash(const QString& hash, int& providerHash, int& x, int& y, int& z)
+{
+    //-- x, y and z have fixed widths at the end. The provider hash is padded to 10 characters, but a negative one of
+    //-- ten digits takes 11 with its sign.
+    static constexpr int kXYZLength = 8 + 8 + 3;
+    const int providerLength = hash.length() - kXYZLength;
+    if(providerLength != 10 && providerLength != 11) {
+        return false;
+    }
+    bool ok[4];
+    providerHash = hash.left(providerLength).toInt(&ok[0]);
+    x = hash.mid(providerLength, 8).toInt(&ok[1]);
+    y = hash.mid(providerLength + 8, 8).toInt(&ok[2]);
+    z = hash.mid(providerLength + 16, 3).toInt(&ok[3]);
+    return ok[0] && ok[1] && ok[2] && ok[3];
+}
+
+//-----------------------------------------------------------------------------
+QGCTilePackStore::QGCTilePackStore(const QString& path, const QString& type)
+    : QGCTileStore(path, type)
+    , _file(path)
+{
+}
+
+//-----------------------------------------------------------------------------
+QGCTilePackStore::~QGCTilePackStore()
+{
+    if(_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGCTilePackStore*
+QGCTilePackStore::open(const QString& path, const QString& type, QString& errorString)
+{
+    QScopedPointer<QGCTilePackStore> store(new QGCTilePackStore(path, type));
+    if(!store->_file.open(QFile::ReadOnly)) {
+        errorString = store->_file.errorString();
+        return nullptr;
+    }
+    store->_size = store->_file.size();
+    if(store->_size < static_cast<qint64>(sizeof(Header_t))) {
+        errorString = QStringLiteral("File too small for a tile pack");
+        return nullptr;
+    }
+    store->_data = store->_file.map(0, store->_size);
+    if(!store->_data) {
+        errorString = store->_file.errorString();
+        return nullptr;
+    }
+    //-- The mapping stays valid after the file is closed
+    store->_file.close();
+
+    const Header_t* header = reinterpret_cast<const Header_t*>(store->_data);
+    if(memcmp(header->magic, _magic, sizeof(_magic)) != 0) {
+        errorString = QStringLiteral("Not a tile pack");
+        return nullptr;
+    }
+    if(qFromLittleEndian(header->version) != version) {
+        errorString = QStringLiteral("Unsupported tile pack version: %1").arg(qFromLittleEndian(header->version));
+        return nullptr;
+    }
+    store->_tileCount = qFromLittleEndian(header->tileCount);
+    if(static_cast<qint64>(sizeof(Header_t)) + (static_cast<qint64>(store->_tileCount) * static_cast<qint64>(sizeof(Entry_t))) > store->_size) {
+        errorString = QStringLiteral("Tile pack index is truncated");
+        return nullptr;
+    }
+    store->_index = reinterpret_cast<const Entry_t*>(store->_data + sizeof(Header_t));
+    store->_format = QString::fromLatin1(header->format, static_cast<int>(strnlen(header->format, sizeof(header->format))));
+    return store.take();
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTilePackStore::write(const QString& path, const QString& format, const QMap<quint64, QByteArray>& tiles, QString& errorString)
+{
+    const QByteArray formatBytes = format.toLatin1();
+    Header_t header = {};
+    if(formatBytes.length() > static_cast<int>(sizeof(header.format))) {
+        errorString = QStringLiteral("Image format name too long: %1").arg(format);
+        return false;
+    }
+    memcpy(header.magic, _magic, sizeof(_magic));
+    memcpy(header.format, formatBytes.constData(), formatBytes.length());
+    header.version      = qToLittleEndian(version);
+    header.tileCount    = qToLittleEndian(static_cast<quint32>(tiles.count()));
+
+    //-- QMap iterates in key order, which is the order the index must have
+    QByteArray index;
+    index.reserve(tiles.count() * static_cast<int>(sizeof(Entry_t)));
+    quint64 offset = sizeof(Header_t) + (static_cast<quint64>(tiles.count()) * sizeof(Entry_t));
+    for(auto it = tiles.constBegin(); it != tiles.constEnd(); ++it) {
+        Entry_t entry = {};
+        entry.key       = qToLittleEndian(it.key());
+        entry.offset    = qToLittleEndian(offset);
+        entry.size      = qToLittleEndian(static_cast<quint32>(it.value().size()));
+        index.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        offset += static_cast<quint64>(it.value().size());
+    }
+
+    QSaveFile file(path);
+    if(!file.open(QFile::WriteOnly)) {
+        errorString = file.errorString();
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(index);
+    for(const QByteArray& data: tiles) {
+        file.write(data);
+    }
+    if(!file.commit()) {
+        errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTilePackStore::findTile(int x, int y, int z, QByteArray& data, QString& format)
+{
+    const quint64 key = tileKey(x, y, z);
+    const Entry_t* end = _index + _tileCount;
+    const Entry_t* entry = std::lower_bound(_index, end, key, [](const Entry_t& e, quint64 k) {
+        return qFromLittleEndian(e.key) < k;
+    });
+    if(entry == end || qFromLittleEndian(entry->key) != key) {
+        return false;
+    }
+    const quint64 offset = qFromLittleEndian(entry->offset);
+    const quint32 size = qFromLittleEndian(entry->size);
+    if(offset > static_cast<quint64>(_size) || size > static_cast<quint64>(_size) - offset) {
+        return false;
+    }
+    data = QByteArray::fromRawData(reinterpret_cast<const char*>(_data + offset), static_cast<int>(size));
+    format = _format;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+QGCMBTilesStore::QGCMBTilesStore(const QString& path, const QString& type, const QString& format)
+    : QGCTileStore(path, type)
+    , _format(format)
+{
+}
+
+//-----------------------------------------------------------------------------
+QGCMBTilesStore::~QGCMBTilesStore()
+{
+    //-- Threads normally release their connection once they are done with the store
+    for(const QString& connectionName: std::as_const(_connectionNames)) {
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGCMBTilesStore*
+QGCMBTilesStore::open(const QString& path, const QString& type, QString& errorString)
+{
+    if(!QFileInfo(path).isFile()) {
+        errorString = QStringLiteral("File not found");
+        return nullptr;
+    }
+    QScopedPointer<QGCMBTilesStore> store(new QGCMBTilesStore(path, type, QString()));
+    const QString connectionName = store->_connectionName();
+    QString format;
+    bool ok = store->_openConnection(connectionName, errorString);
+    if(ok) {
+        QSqlQuery query(QSqlDatabase::database(connectionName, false));
+        if(query.exec("SELECT value FROM metadata WHERE name = 'format'") && query.next()) {
+            format = query.value(0).toString();
+        }
+        ok = query.exec("SELECT 1 FROM tiles LIMIT 1");
+        if(!ok) {
+            errorString = query.lastError().text();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    if(!ok) {
+        return nullptr;
+    }
+    //-- The format entry is required by the spec, but isn't always there
+    store->_format = format.isEmpty() ? QStringLiteral("png") : format;
+    return store.take();
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCMBTilesStore::findTile(int x, int y, int z, QByteArray& data, QString& format)
+{
+    if(z < 0 || z > 30) {
+        return false;
+    }
+    const QString connectionName = _connectionName();
+    if(!QSqlDatabase::contains(connectionName)) {
+        QString errorString;
+        if(!_openConnection(connectionName, errorString)) {
+            qWarning() << "MBTiles open error:" << path() << errorString;
+        }
+        QMutexLocker lock(&_mutex);
+        _connectionNames.insert(connectionName);
+    }
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    if(!db.isOpen()) {
+        return false;
+    }
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if(!query.prepare("SELECT tile_data FROM tiles WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?")) {
+        return false;
+    }
+    query.addBindValue(z);
+    query.addBindValue(x);
+    query.addBindValue((1 << z) - 1 - y);
+    if(!query.exec() || !query.next()) {
+        return false;
+    }
+    data = query.value(0).toByteArray();
+    format = _format;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMBTilesStore::releaseThread()
+{
+    const QString connectionName = _connectionName();
+    QMutexLocker lock(&_mutex);
+    if(_connectionNames.remove(connectionName)) {
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCMBTilesStore::_connectionName() const
+{
+    return QStringLiteral("QGCMBTiles_%1_%2").arg(reinterpret_cast<quintptr>(this)).arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCMBTilesStore::_openConnection(const QString& connectionName, QString& errorString) const
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(path());
+    db.setConnectOptions("QSQLITE_OPEN_READONLY");
+    if(!db.open()) {
+        errorString = db.lastError().text();
+        return false;
+    }
+    QSqlQuery query(db);
+    query.exec(QStringLiteral("PRAGMA mmap_size = %1").arg(mmapBytes));
+    return true;
+}
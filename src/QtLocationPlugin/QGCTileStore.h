@@ -0,0 +1,143 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+//-----------------------------------------------------------------------------
+/// Read only source of tiles for a single map type, used in front of the tile cache database. Map packages built
+/// elsewhere are served from these stores without being imported. All methods are thread safe.
+class QGCTileStore
+{
+public:
+    QGCTileStore            (const QString& path, const QString& type);
+    virtual ~QGCTileStore   () {}
+
+    const QString&  path    () const { return _path; }
+    /// Map type the tiles belong to
+    const QString&  type    () const { return _type; }
+
+    /// Tile coordinates are XYZ, like the tile hash
+    ///     @return false: tile not in store
+    virtual bool    findTile        (int x, int y, int z, QByteArray& data, QString& format) = 0;
+
+    /// @return true: findTile only reads mapped memory, it may be called from any thread without blocking
+    virtual bool    isMapped        () const { return false; }
+
+    /// Releases anything findTile set up for the calling thread
+    virtual void    releaseThread   () {}
+
+    /// Opens a .mbtiles or .qgctiles file
+    ///     @return nullptr on error, see errorString
+    static QGCTileStore* open(const QString& path, const QString& type, QString& errorString);
+
+    /// Splits a tile hash, see QGCMapEngine::getTileHash
+    ///     @return false: not a tile hash
+    static bool tileFromHash(const QString& hash, int& providerHash, int& x, int& y, int& z);
+
+private:
+    QString _path;
+    QString _type;
+};
+
+//-----------------------------------------------------------------------------
+/// Packed tile file (.qgctiles): a header, an index of tile entries sorted by key and the tile data. The file is
+/// memory mapped, lookups are a binary search of the index and tiles are returned without copying. The returned
+/// bytes reference the mapping and must not be used after the store is deleted.
+///
+/// All values are little endian:
+///     Header_t    header
+///     Entry_t     index[header.tileCount]
+///     tile data, located by Entry_t::offset from the start of the file
+class QGCTilePackStore : public QGCTileStore
+{
+public:
+    ~QGCTilePackStore();
+
+    static QGCTilePackStore* open(const QString& path, const QString& type, QString& errorString);
+
+    /// Writes a pack of tiles which all have the same image format
+    ///     @param tiles Tile data by tileKey
+    static bool write(const QString& path, const QString& format, const QMap<quint64, QByteArray>& tiles, QString& errorString);
+
+    static quint64 tileKey(int x, int y, int z) {
+        return (static_cast<quint64>(z) << 48) | (static_cast<quint64>(x) << 24) | static_cast<quint64>(y);
+    }
+
+    quint32 tileCount() const { return _tileCount; }
+
+    // Overrides from QGCTileStore
+    bool findTile   (int x, int y, int z, QByteArray& data, QString& format) final;
+    bool isMapped   () const final { return true; }
+
+    static constexpr quint32 version = 1;
+
+private:
+    QGCTilePackStore(const QString& path, const QString& type);
+
+    struct Header_t {
+        char    magic[8];
+        quint32 version;
+        quint32 tileCount;
+        char    format[8];      ///< Nul padded
+        quint64 reserved;
+    };
+
+    struct Entry_t {
+        quint64 key;
+        quint64 offset;
+        quint32 size;
+        quint32 reserved;
+    };
+
+    static_assert(sizeof(Header_t) == 32, "Header_t must match the file layout");
+    static_assert(sizeof(Entry_t) == 24, "Entry_t must match the file layout");
+
+    static const char   _magic[8];
+
+    QFile               _file;
+    const uchar*        _data       = nullptr;
+    qint64              _size       = 0;
+    const Entry_t*      _index      = nullptr;
+    quint32             _tileCount  = 0;
+    QString             _format;
+};
+
+//-----------------------------------------------------------------------------
+/// MBTiles file. Opened read only with SQLite memory mapped I/O, one connection per calling thread. Tile rows are
+/// TMS, they are flipped from the XYZ coordinates of the tile hash.
+class QGCMBTilesStore : public QGCTileStore
+{
+public:
+    ~QGCMBTilesStore();
+
+    static QGCMBTilesStore* open(const QString& path, const QString& type, QString& errorString);
+
+    // Overrides from QGCTileStore
+    bool findTile       (int x, int y, int z, QByteArray& data, QString& format) final;
+    void releaseThread  () final;
+
+    static constexpr qint64 mmapBytes = 256 * 1024 * 1024;
+
+private:
+    QGCMBTilesStore(const QString& path, const QString& type, const QString& format);
+
+    QString _connectionName () const;
+    bool    _openConnection (const QString& connectionName, QString& errorString) const;
+
+    QString         _format;
+    QMutex          _mutex;
+    QSet<QString>   _connectionNames;
+};
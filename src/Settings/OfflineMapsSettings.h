@@ -22,6 +22,8 @@ public:
     DEFINE_SETTINGFACT(minZoomLevelDownload)
     DEFINE_SETTINGFACT(maxZoomLevelDownload)
     DEFINE_SETTINGFACT(maxTilesForDownload)
+    DEFINE_SETTINGFACT(terrainDEMDirectory)
+    DEFINE_SETTINGFACT(terrainDEMCacheMB)
 
 private:
 };
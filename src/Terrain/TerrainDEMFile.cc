@@ -0,0 +1,381 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainDEMFile.h"
+
+#include <QFileInfo>
+#include <QMap>
+#include <QRegularExpression>
+#include <QtEndian>
+#include <QtMath>
+
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(TerrainDEMLog, "TerrainDEMLog")
+
+namespace {
+    // TIFF tags
+    constexpr quint16 kTagImageWidth        = 256;
+    constexpr quint16 kTagImageLength       = 257;
+    constexpr quint16 kTagBitsPerSample     = 258;
+    constexpr quint16 kTagCompression       = 259;
+    constexpr quint16 kTagStripOffsets      = 273;
+    constexpr quint16 kTagSamplesPerPixel   = 277;
+    constexpr quint16 kTagRowsPerStrip      = 278;
+    constexpr quint16 kTagTileWidth         = 322;
+    constexpr quint16 kTagTileLength        = 323;
+    constexpr quint16 kTagTileOffsets       = 324;
+    constexpr quint16 kTagSampleFormat      = 339;
+    constexpr quint16 kTagModelPixelScale   = 33550;
+    constexpr quint16 kTagModelTiepoint     = 33922;
+    constexpr quint16 kTagGeoKeyDirectory   = 34735;
+    constexpr quint16 kTagGdalNoData        = 42113;
+
+    // GeoKeys
+    constexpr quint16 kGeoKeyModelType      = 1024;
+    constexpr quint16 kGeoKeyRasterType     = 1025;
+    constexpr quint16 kModelTypeProjected   = 1;
+    constexpr quint16 kRasterPixelIsPoint   = 2;
+
+    // HGT void value
+    constexpr qint16 kHGTVoid               = -32768;
+
+    /// Single IFD entry of a TIFF file
+    class TIFFEntry {
+    public:
+        TIFFEntry(void) = default;
+        TIFFEntry(const uchar* data, qint64 size, bool bigEndian, const uchar* entry)
+            : _bigEndian(bigEndian)
+        {
+            _type       = _read16(entry + 2);
+            _count      = _read32(entry + 4);
+            const int cBytes = _typeSize() * static_cast<int>(qMin<quint32>(_count, 0x7FFFFFF));
+            _values     = cBytes <= 4 ? entry + 8 : (_read32(entry + 8) + static_cast<qint64>(cBytes) <= size ? data + _read32(entry + 8) : nullptr);
+        }
+
+        bool    isValid (void) const { return _values != nullptr && _count > 0; }
+        quint32 count   (void) const { return _count; }
+
+        double value(quint32 index) const {
+            if (!isValid() || index >= _count) {
+                return qQNaN();
+            }
+            const uchar* p = _values + (index * _typeSize());
+            switch (_type) {
+            case 1:     return *p;                                              // BYTE
+            case 3:     return _read16(p);                                      // SHORT
+            case 4:     return _read32(p);                                      // LONG
+            case 8:     return static_cast<qint16>(_read16(p));                 // SSHORT
+            case 9:     return static_cast<qint32>(_read32(p));                 // SLONG
+            case 11: {                                                          // FLOAT
+                const quint32 bits = _read32(p);
+                float f;
+                memcpy(&f, &bits, sizeof(f));
+                return f;
+            }
+            case 12: {                                                          // DOUBLE
+                const quint64 bits = _bigEndian ? qFromBigEndian<quint64>(p) : qFromLittleEndian<quint64>(p);
+                double d;
+                memcpy(&d, &bits, sizeof(d));
+                return d;
+            }
+            default:
+                return qQNaN();
+            }
+        }
+
+        QByteArray string(void) const {
+            return isValid() && _type == 2 ? QByteArray(reinterpret_cast<const char*>(_values), static_cast<int>(_count)) : QByteArray();
+        }
+
+    private:
+        int _typeSize(void) const {
+            switch (_type) {
+            case 3: case 8:             return 2;
+            case 4: case 9: case 11:    return 4;
+            case 12:                    return 8;
+            default:                    return 1;
+            }
+        }
+        quint16 _read16(const uchar* p) const { return _bigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p); }
+        quint32 _read32(const uchar* p) const { return _bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p); }
+
+        bool            _bigEndian  = false;
+        quint16         _type       = 0;
+        quint32         _count      = 0;
+        const uchar*    _values     = nullptr;
+    };
+}
+
+TerrainDEMFile::~TerrainDEMFile()
+{
+    _file.close();  // Also unmaps
+}
+
+TerrainDEMFile* TerrainDEMFile::open(const QString& filename, QString& errorString)
+{
+    TerrainDEMFile* demFile = new TerrainDEMFile();
+
+    demFile->_filename = filename;
+    demFile->_file.setFileName(filename);
+    if (!demFile->_file.open(QIODevice::ReadOnly)) {
+        errorString = demFile->_file.errorString();
+        delete demFile;
+        return nullptr;
+    }
+    demFile->_size = demFile->_file.size();
+    demFile->_data = demFile->_size > 0 ? demFile->_file.map(0, demFile->_size) : nullptr;
+    if (!demFile->_data) {
+        errorString = QStringLiteral("Unable to map file");
+        delete demFile;
+        return nullptr;
+    }
+
+    const QString suffix = QFileInfo(filename).suffix().toLower();
+    bool success = false;
+    if (suffix == QStringLiteral("hgt")) {
+        success = demFile->_openHGT(errorString);
+    } else if (suffix == QStringLiteral("tif") || suffix == QStringLiteral("tiff")) {
+        success = demFile->_openTIFF(errorString);
+    } else {
+        errorString = QStringLiteral("Unsupported file type");
+    }
+    if (!success) {
+        delete demFile;
+        return nullptr;
+    }
+
+    qCDebug(TerrainDEMLog) << "Opened" << filename << "rows:cols" << demFile->_rows << demFile->_cols << "sw:ne" << demFile->south() << demFile->west() << demFile->north() << demFile->east();
+
+    return demFile;
+}
+
+bool TerrainDEMFile::_openHGT(QString& errorString)
+{
+    static const QRegularExpression regExp(QStringLiteral("^([NS])(\\d{2})([EW])(\\d{3})$"), QRegularExpression::CaseInsensitiveOption);
+
+    QRegularExpressionMatch match = regExp.match(QFileInfo(_filename).completeBaseName());
+    if (!match.hasMatch()) {
+        errorString = QStringLiteral("File name does not specify the tile location");
+        return false;
+    }
+
+    const int size = qRound(qSqrt(static_cast<double>(_size / 2)));
+    if (size < 2 || static_cast<qint64>(size) * size * 2 != _size) {
+        errorString = QStringLiteral("File size does not match a square grid");
+        return false;
+    }
+
+    const int south = match.captured(2).toInt() * (match.captured(1).compare(QStringLiteral("S"), Qt::CaseInsensitive) == 0 ? -1 : 1);
+    const int west  = match.captured(4).toInt() * (match.captured(3).compare(QStringLiteral("W"), Qt::CaseInsensitive) == 0 ? -1 : 1);
+
+    // Samples are on the one degree lines, so neighbouring files share their edge rows/cols
+    _rows           = size;
+    _cols           = size;
+    _latSpacing     = 1.0 / (size - 1);
+    _lonSpacing     = 1.0 / (size - 1);
+    _originLat      = south + 1;
+    _originLon      = west;
+    _bigEndian      = true;
+    _sampleFormat   = SampleInt16;
+    _bytesPerSample = 2;
+    _hasNoData      = true;
+    _noData         = kHGTVoid;
+    _chunkWidth     = size;
+    _chunkHeight    = size;
+    _chunksAcross   = 1;
+    _chunkOffsets   = { 0 };
+
+    return true;
+}
+
+bool TerrainDEMFile::_openTIFF(QString& errorString)
+{
+    if (_size < 8 || (memcmp(_data, "II", 2) && memcmp(_data, "MM", 2))) {
+        errorString = QStringLiteral("Not a TIFF file");
+        return false;
+    }
+    _bigEndian = memcmp(_data, "MM", 2) == 0;
+
+    auto read16 = [this](qint64 offset) { return _bigEndian ? qFromBigEndian<quint16>(_data + offset) : qFromLittleEndian<quint16>(_data + offset); };
+    auto read32 = [this](qint64 offset) { return _bigEndian ? qFromBigEndian<quint32>(_data + offset) : qFromLittleEndian<quint32>(_data + offset); };
+
+    if (read16(2) != 42) {
+        errorString = QStringLiteral("BigTIFF is not supported");
+        return false;
+    }
+
+    // Only the first image is used
+    const qint64 ifdOffset = read32(4);
+    if (ifdOffset + 2 > _size) {
+        errorString = QStringLiteral("Bad TIFF directory offset");
+        return false;
+    }
+    const int cEntries = read16(ifdOffset);
+    if (ifdOffset + 2 + (cEntries * 12) > _size) {
+        errorString = QStringLiteral("Bad TIFF directory");
+        return false;
+    }
+
+    QMap<quint16, TIFFEntry> entries;
+    for (int i=0; i<cEntries; i++) {
+        const uchar* entry = _data + ifdOffset + 2 + (i * 12);
+        entries[read16(ifdOffset + 2 + (i * 12))] = TIFFEntry(_data, _size, _bigEndian, entry);
+    }
+
+    auto tagValue = [&entries](quint16 tag, double defaultValue) {
+        return entries.contains(tag) && entries[tag].isValid() ? entries[tag].value(0) : defaultValue;
+    };
+
+    _cols = static_cast<int>(tagValue(kTagImageWidth, 0));
+    _rows = static_cast<int>(tagValue(kTagImageLength, 0));
+    const int bitsPerSample     = static_cast<int>(tagValue(kTagBitsPerSample, 1));
+    const int sampleFormat      = static_cast<int>(tagValue(kTagSampleFormat, 1));
+
+    if (_cols < 2 || _rows < 2) {
+        errorString = QStringLiteral("Bad image size");
+        return false;
+    }
+    if (tagValue(kTagCompression, 1) != 1) {
+        errorString = QStringLiteral("Compressed GeoTIFF is not supported");
+        return false;
+    }
+    if (tagValue(kTagSamplesPerPixel, 1) != 1) {
+        errorString = QStringLiteral("Only single band GeoTIFF is supported");
+        return false;
+    }
+    if (bitsPerSample == 16 && sampleFormat == 2) {
+        _sampleFormat = SampleInt16;
+    } else if (bitsPerSample == 16 && sampleFormat == 1) {
+        _sampleFormat = SampleUInt16;
+    } else if (bitsPerSample == 32 && sampleFormat == 3) {
+        _sampleFormat = SampleFloat32;
+    } else {
+        errorString = QStringLiteral("Unsupported sample format");
+        return false;
+    }
+    _bytesPerSample = bitsPerSample / 8;
+
+    // Chunk layout
+    TIFFEntry offsets;
+    if (entries.contains(kTagTileOffsets)) {
+        _chunkWidth     = static_cast<int>(tagValue(kTagTileWidth, 0));
+        _chunkHeight    = static_cast<int>(tagValue(kTagTileLength, 0));
+        offsets         = entries[kTagTileOffsets];
+    } else {
+        _chunkWidth     = _cols;
+        _chunkHeight    = static_cast<int>(qMin(tagValue(kTagRowsPerStrip, _rows), static_cast<double>(_rows)));
+        offsets         = entries.value(kTagStripOffsets);
+    }
+    if (_chunkWidth <= 0 || _chunkHeight <= 0) {
+        errorString = QStringLiteral("Bad strip or tile size");
+        return false;
+    }
+    _chunksAcross = (_cols + _chunkWidth - 1) / _chunkWidth;
+    const int cChunks = _chunksAcross * ((_rows + _chunkHeight - 1) / _chunkHeight);
+    if (!offsets.isValid() || static_cast<int>(offsets.count()) < cChunks) {
+        errorString = QStringLiteral("Missing strip or tile offsets");
+        return false;
+    }
+    _chunkOffsets.resize(cChunks);
+    for (int i=0; i<cChunks; i++) {
+        _chunkOffsets[i] = static_cast<quint64>(offsets.value(static_cast<quint32>(i)));
+    }
+
+    // Georeferencing
+    const TIFFEntry scale       = entries.value(kTagModelPixelScale);
+    const TIFFEntry tiepoint    = entries.value(kTagModelTiepoint);
+    if (!scale.isValid() || scale.count() < 2 || !tiepoint.isValid() || tiepoint.count() < 6) {
+        errorString = QStringLiteral("Missing GeoTIFF georeferencing");
+        return false;
+    }
+
+    bool pixelIsPoint = false;
+    const TIFFEntry geoKeys = entries.value(kTagGeoKeyDirectory);
+    if (geoKeys.isValid() && geoKeys.count() >= 4) {
+        const quint32 cKeys = static_cast<quint32>(geoKeys.value(3));
+        for (quint32 i=0; i<cKeys && (4 + (i * 4) + 3) < geoKeys.count(); i++) {
+            const quint16 keyId     = static_cast<quint16>(geoKeys.value(4 + (i * 4)));
+            const quint16 location  = static_cast<quint16>(geoKeys.value(4 + (i * 4) + 1));
+            const quint16 value     = static_cast<quint16>(geoKeys.value(4 + (i * 4) + 3));
+            if (location != 0) {
+                continue;
+            }
+            if (keyId == kGeoKeyModelType && value == kModelTypeProjected) {
+                errorString = QStringLiteral("Projected coordinate systems are not supported");
+                return false;
+            } else if (keyId == kGeoKeyRasterType) {
+                pixelIsPoint = value == kRasterPixelIsPoint;
+            }
+        }
+    }
+
+    _lonSpacing = scale.value(0);
+    _latSpacing = scale.value(1);
+    if (!(_lonSpacing > 0) || !(_latSpacing > 0)) {
+        errorString = QStringLiteral("Bad pixel scale");
+        return false;
+    }
+
+    // Tie point maps raster (i, j) to model (x, y). With PixelIsArea the model position is the corner of the pixel.
+    _pixelIsArea = !pixelIsPoint;
+    const double halfPixel = pixelIsPoint ? 0 : 0.5;
+    _originLon = tiepoint.value(3) + ((halfPixel - tiepoint.value(0)) * _lonSpacing);
+    _originLat = tiepoint.value(4) - ((halfPixel - tiepoint.value(1)) * _latSpacing);
+
+    const QByteArray noData = entries.value(kTagGdalNoData).string().trimmed();
+    if (!noData.isEmpty()) {
+        bool ok;
+        _noData     = noData.toFloat(&ok);
+        _hasNoData  = ok;
+    }
+
+    return true;
+}
+
+float TerrainDEMFile::_sample(int row, int col) const
+{
+    const int       chunk   = ((row / _chunkHeight) * _chunksAcross) + (col / _chunkWidth);
+    const quint64   offset  = _chunkOffsets[chunk] + (static_cast<quint64>(((row % _chunkHeight) * _chunkWidth) + (col % _chunkWidth)) * _bytesPerSample);
+
+    if (offset + _bytesPerSample > static_cast<quint64>(_size)) {
+        return qQNaN();
+    }
+
+    const uchar* p = _data + offset;
+    float value;
+    switch (_sampleFormat) {
+    case SampleInt16:
+        value = static_cast<qint16>(_bigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p));
+        break;
+    case SampleUInt16:
+        value = _bigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p);
+        break;
+    case SampleFloat32:
+    default:
+    {
+        const quint32 bits = _bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+        memcpy(&value, &bits, sizeof(value));
+        break;
+    }
+    }
+
+    return _hasNoData && value == _noData ? qQNaN() : value;
+}
+
+void TerrainDEMFile::readBlock(int firstRow, int firstCol, int rowCount, int colCount, float* samples) const
+{
+    for (int r=0; r<rowCount; r++) {
+        const int row = firstRow + r;
+        for (int c=0; c<colCount; c++) {
+            const int col = firstCol + c;
+            samples[(r * colCount) + c] = row < _rows && col < _cols ? _sample(row, col) : qQNaN();
+        }
+    }
+}
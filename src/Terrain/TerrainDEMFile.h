@@ -0,0 +1,102 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainDEMLog)
+
+/// Memory mapped digital elevation model file.
+///
+/// Supported formats:
+///     SRTM .hgt      Any square grid size, bounds taken from the file name (N47E008.hgt)
+///     GeoTIFF        Uncompressed, single band int16/uint16/float32, stripped or tiled, geographic (lat/lon) coordinates
+///
+/// Samples are addressed by row and column, row 0 is the northern most row. Nothing is decoded up front, samples are
+/// read from the mapping on request.
+class TerrainDEMFile
+{
+public:
+    ~TerrainDEMFile();
+
+    /// Opens and maps the specified file
+    ///     @return nullptr: not a supported DEM file, errorString set
+    static TerrainDEMFile* open(const QString& filename, QString& errorString);
+
+    const QString&  filename        (void) const { return _filename; }
+    int             rows            (void) const { return _rows; }
+    int             cols            (void) const { return _cols; }
+    double          latSpacing      (void) const { return _latSpacing; }
+    double          lonSpacing      (void) const { return _lonSpacing; }
+
+    /// @return Latitude of the center of row 0
+    double          originLat       (void) const { return _originLat; }
+    /// @return Longitude of the center of column 0
+    double          originLon       (void) const { return _originLon; }
+
+    /// Bounds of the sample centers
+    double          south           (void) const { return _originLat - ((_rows - 1) * _latSpacing); }
+    double          north           (void) const { return _originLat; }
+    double          west            (void) const { return _originLon; }
+    double          east            (void) const { return _originLon + ((_cols - 1) * _lonSpacing); }
+
+    /// @return true: location is covered by the file. A PixelIsArea raster also covers the outer half of its edge
+    ///         pixels, which return the edge sample.
+    bool contains(double latitude, double longitude) const {
+        const double latMargin = _pixelIsArea ? _latSpacing / 2 : 0;
+        const double lonMargin = _pixelIsArea ? _lonSpacing / 2 : 0;
+        return latitude >= south() - latMargin && latitude <= north() + latMargin && longitude >= west() - lonMargin && longitude <= east() + lonMargin;
+    }
+
+    /// Decodes a rectangular block of samples. Voids and samples outside the file are returned as NaN.
+    ///     @param samples Must hold rowCount * colCount values, returned row major
+    void readBlock(int firstRow, int firstCol, int rowCount, int colCount, float* samples) const;
+
+private:
+    TerrainDEMFile(void) = default;
+
+    typedef enum {
+        SampleInt16,
+        SampleUInt16,
+        SampleFloat32,
+    } SampleFormat_t;
+
+    bool    _openHGT    (QString& errorString);
+    bool    _openTIFF   (QString& errorString);
+    float   _sample     (int row, int col) const;
+
+    QString             _filename;
+    QFile               _file;
+    const uchar*        _data           = nullptr;
+    qint64              _size           = 0;
+    bool                _bigEndian      = false;
+    SampleFormat_t      _sampleFormat   = SampleInt16;
+    int                 _bytesPerSample = 2;
+    bool                _hasNoData      = false;
+    float               _noData         = 0;
+
+    int                 _rows           = 0;
+    int                 _cols           = 0;
+    double              _latSpacing     = 0;
+    double              _lonSpacing     = 0;
+    double              _originLat      = 0;
+    double              _originLon      = 0;
+    bool                _pixelIsArea    = false;    ///< Samples represent the area of a pixel, not the point at its center
+
+    // Samples are stored in chunks, which are the strips or tiles of a GeoTIFF. A .hgt file is a single chunk.
+    int                 _chunkWidth     = 0;
+    int                 _chunkHeight    = 0;
+    int                 _chunksAcross   = 0;
+    QVector<quint64>    _chunkOffsets;
+};
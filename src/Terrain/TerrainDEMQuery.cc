@@ -0,0 +1,317 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainDEMQuery.h"
+#include "TerrainDEMFile.h"
+#include "QGCApplication.h"
+#include "QGCToolbox.h"
+#include "SettingsManager.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtMath>
+
+#include <limits>
+#include <mutex>
+
+Q_GLOBAL_STATIC(TerrainDEMCache, _terrainDEMCache)
+
+TerrainDEMCache::TerrainDEMCache(void)
+{
+    _blocks.setMaxCost(static_cast<int>(defaultMaxMemoryBytes / 1024));
+}
+
+TerrainDEMCache::~TerrainDEMCache()
+{
+    _clear();
+}
+
+TerrainDEMCache* TerrainDEMCache::instance(void)
+{
+    TerrainDEMCache* demCache = _terrainDEMCache();
+
+    // The settings are read once, after that changes are tracked so lookups never touch the settings
+    if (qgcApp() && qgcApp()->toolbox() && qgcApp()->toolbox()->settingsManager()) {
+        static std::once_flag settingsOnce;
+        std::call_once(settingsOnce, [demCache]() {
+            OfflineMapsSettings*    offlineMapsSettings = qgcApp()->toolbox()->settingsManager()->offlineMapsSettings();
+            Fact*                   cacheMBFact         = offlineMapsSettings->terrainDEMCacheMB();
+            Fact*                   directoryFact       = offlineMapsSettings->terrainDEMDirectory();
+
+            demCache->setMaxMemoryBytes(cacheMBFact->rawValue().toLongLong() * 1024 * 1024);
+            demCache->setDirectory(directoryFact->rawValue().toString());
+
+            QObject::connect(cacheMBFact, &Fact::rawValueChanged, cacheMBFact, [demCache](QVariant value) { demCache->setMaxMemoryBytes(value.toLongLong() * 1024 * 1024); });
+            QObject::connect(directoryFact, &Fact::rawValueChanged, directoryFact, [demCache](QVariant value) {
+                demCache->setDirectory(value.toString());
+                TerrainPathProfileCache::instance()->clear();
+            });
+        });
+    }
+
+    return demCache;
+}
+
+void TerrainDEMCache::setDirectory(const QString& directory)
+{
+    QMutexLocker locker(&_mutex);
+
+    if (directory == _directory) {
+        return;
+    }
+
+    _clear();
+    _directory = directory;
+    if (directory.isEmpty()) {
+        return;
+    }
+
+    const QStringList nameFilters = { QStringLiteral("*.hgt"), QStringLiteral("*.tif"), QStringLiteral("*.tiff") };
+    const QFileInfoList fileInfos = QDir(directory).entryInfoList(nameFilters, QDir::Files, QDir::Name);
+    for (const QFileInfo& fileInfo: fileInfos) {
+        QString errorString;
+        TerrainDEMFile* demFile = TerrainDEMFile::open(fileInfo.absoluteFilePath(), errorString);
+        if (demFile) {
+            _files.append(demFile);
+        } else {
+            qCWarning(TerrainDEMLog) << "Skipping" << fileInfo.fileName() << errorString;
+        }
+    }
+
+    qCDebug(TerrainDEMLog) << "setDirectory" << directory << "files" << _files.count();
+}
+
+QString TerrainDEMCache::directory(void) const
+{
+    QMutexLocker locker(&_mutex);
+    return _directory;
+}
+
+int TerrainDEMCache::fileCount(void) const
+{
+    QMutexLocker locker(&_mutex);
+    return _files.count();
+}
+
+void TerrainDEMCache::setMaxMemoryBytes(qint64 maxMemoryBytes)
+{
+    QMutexLocker locker(&_mutex);
+
+    // The cache must be able to hold at least one block, QCache drops objects which cost more than the maximum
+    const qint64 blockKB = (blockSize * blockSize * static_cast<qint64>(sizeof(float))) / 1024;
+    const int maxCost = static_cast<int>(qBound(blockKB, maxMemoryBytes / 1024, static_cast<qint64>(std::numeric_limits<int>::max())));
+    if (maxCost != _blocks.maxCost()) {
+        _lastBlock = nullptr;
+        _blocks.setMaxCost(maxCost);
+    }
+}
+
+qint64 TerrainDEMCache::memoryBytes(void) const
+{
+    QMutexLocker locker(&_mutex);
+    return static_cast<qint64>(_blocks.totalCost()) * 1024;
+}
+
+bool TerrainDEMCache::coordinateHeights(const QList<QGeoCoordinate>& coordinates, QList<double>& heights)
+{
+    QMutexLocker locker(&_mutex);
+
+    if (_files.isEmpty()) {
+        return false;
+    }
+
+    QList<double> result;
+    result.reserve(coordinates.count());
+    for (const QGeoCoordinate& coordinate: coordinates) {
+        const double elevation = _elevation(coordinate.latitude(), coordinate.longitude());
+        if (qIsNaN(elevation)) {
+            return false;
+        }
+        result.append(elevation);
+    }
+
+    heights.append(result);
+    return true;
+}
+
+bool TerrainDEMCache::pathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double& distanceBetween, double& finalDistanceBetween, QList<double>& heights)
+{
+    const QList<QGeoCoordinate> coordinates = TerrainTileManager::pathQueryToCoords(fromCoord, toCoord, distanceBetween, finalDistanceBetween);
+    return coordinateHeights(coordinates, heights);
+}
+
+/// The carpet is sampled at the spacing of the DEM file covering the south west corner. Rows run south to north,
+/// samples within a row west to east.
+bool TerrainDEMCache::carpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly, double& minHeight, double& maxHeight, QList<QList<double>>& carpet)
+{
+    QMutexLocker locker(&_mutex);
+
+    const int fileIndex = _fileIndex(swCoord.latitude(), swCoord.longitude());
+    if (fileIndex < 0 || neCoord.latitude() < swCoord.latitude() || neCoord.longitude() < swCoord.longitude()) {
+        return false;
+    }
+
+    const TerrainDEMFile* demFile = _files[fileIndex];
+    const int rowCount = qFloor((neCoord.latitude() - swCoord.latitude()) / demFile->latSpacing()) + 1;
+    const int colCount = qFloor((neCoord.longitude() - swCoord.longitude()) / demFile->lonSpacing()) + 1;
+
+    QList<QList<double>> result;
+    double min = qInf();
+    double max = -qInf();
+    for (int row=0; row<rowCount; row++) {
+        const double latitude = swCoord.latitude() + (row * demFile->latSpacing());
+        QList<double> carpetRow;
+        if (!statsOnly) {
+            carpetRow.reserve(colCount);
+        }
+        for (int col=0; col<colCount; col++) {
+            const double elevation = _elevation(latitude, swCoord.longitude() + (col * demFile->lonSpacing()));
+            if (qIsNaN(elevation)) {
+                return false;
+            }
+            min = qMin(min, elevation);
+            max = qMax(max, elevation);
+            if (!statsOnly) {
+                carpetRow.append(elevation);
+            }
+        }
+        if (!statsOnly) {
+            result.append(carpetRow);
+        }
+    }
+
+    minHeight = min;
+    maxHeight = max;
+    carpet = result;
+    return true;
+}
+
+/// @return Index of the file containing the location, -1 for none
+int TerrainDEMCache::_fileIndex(double latitude, double longitude)
+{
+    if (_lastFileIndex < _files.count() && _files[_lastFileIndex]->contains(latitude, longitude)) {
+        return _lastFileIndex;
+    }
+    for (int i=0; i<_files.count(); i++) {
+        if (_files[i]->contains(latitude, longitude)) {
+            _lastFileIndex = i;
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// Bilinear interpolation between the four surrounding samples. Void samples are left out of the interpolation.
+///     @return NaN: location not covered or all surrounding samples are voids
+double TerrainDEMCache::_elevation(double latitude, double longitude)
+{
+    const int fileIndex = _fileIndex(latitude, longitude);
+    if (fileIndex < 0) {
+        return qQNaN();
+    }
+
+    const TerrainDEMFile* demFile = _files[fileIndex];
+    const double rowF = (demFile->originLat() - latitude) / demFile->latSpacing();
+    const double colF = (longitude - demFile->originLon()) / demFile->lonSpacing();
+    const int row0 = qBound(0, qFloor(rowF), qMax(0, demFile->rows() - 2));
+    const int col0 = qBound(0, qFloor(colF), qMax(0, demFile->cols() - 2));
+    const int row1 = qMin(row0 + 1, demFile->rows() - 1);
+    const int col1 = qMin(col0 + 1, demFile->cols() - 1);
+    const double rowFraction = qBound(0.0, rowF - row0, 1.0);
+    const double colFraction = qBound(0.0, colF - col0, 1.0);
+
+    const float samples[4] = {
+        _sample(fileIndex, row0, col0),
+        _sample(fileIndex, row0, col1),
+        _sample(fileIndex, row1, col0),
+        _sample(fileIndex, row1, col1),
+    };
+    const double weights[4] = {
+        (1.0 - rowFraction) * (1.0 - colFraction),
+        (1.0 - rowFraction) * colFraction,
+        rowFraction * (1.0 - colFraction),
+        rowFraction * colFraction,
+    };
+
+    double sum = 0;
+    double totalWeight = 0;
+    for (int i=0; i<4; i++) {
+        if (!qIsNaN(samples[i])) {
+            sum += samples[i] * weights[i];
+            totalWeight += weights[i];
+        }
+    }
+
+    if (totalWeight <= 0) {
+        return qQNaN();
+    }
+    return sum / totalWeight;
+}
+
+float TerrainDEMCache::_sample(int fileIndex, int row, int col)
+{
+    const int blockRow = row / blockSize;
+    const int blockCol = col / blockSize;
+    const quint64 key = _blockKey(fileIndex, blockRow, blockCol);
+
+    if (!_lastBlock || key != _lastBlockKey) {
+        Block_t* block = _blocks.object(key);
+        if (!block) {
+            block = new Block_t(blockSize * blockSize);
+            _files[fileIndex]->readBlock(blockRow * blockSize, blockCol * blockSize, blockSize, blockSize, block->data());
+            _blocks.insert(key, block, static_cast<int>((block->count() * sizeof(float)) / 1024));
+        }
+        _lastBlock = block;
+        _lastBlockKey = key;
+    }
+
+    return _lastBlock->at(((row % blockSize) * blockSize) + (col % blockSize));
+}
+
+void TerrainDEMCache::_clear(void)
+{
+    _lastBlock = nullptr;
+    _lastFileIndex = 0;
+    _blocks.clear();
+    qDeleteAll(_files);
+    _files.clear();
+}
+
+TerrainDEMQuery::TerrainDEMQuery(TerrainDEMCache* demCache, QObject* parent)
+    : TerrainQueryInterface (parent)
+    , _demCache             (demCache ? demCache : TerrainDEMCache::instance())
+{
+
+}
+
+void TerrainDEMQuery::requestCoordinateHeights(const QList<QGeoCoordinate>& coordinates)
+{
+    QList<double> heights;
+    const bool success = _demCache->coordinateHeights(coordinates, heights);
+    emit coordinateHeightsReceived(success, heights);
+}
+
+void TerrainDEMQuery::requestPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord)
+{
+    double distanceBetween = 0;
+    double finalDistanceBetween = 0;
+    QList<double> heights;
+    const bool success = _demCache->pathHeights(fromCoord, toCoord, distanceBetween, finalDistanceBetween, heights);
+    emit pathHeightsReceived(success, distanceBetween, finalDistanceBetween, heights);
+}
+
+void TerrainDEMQuery::requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly)
+{
+    double minHeight = qQNaN();
+    double maxHeight = qQNaN();
+    QList<QList<double>> carpet;
+    const bool success = _demCache->carpetHeights(swCoord, neCoord, statsOnly, minHeight, maxHeight, carpet);
+    emit carpetHeightsReceived(success, minHeight, maxHeight, carpet);
+}
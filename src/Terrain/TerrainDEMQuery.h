@@ -0,0 +1,90 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "TerrainQuery.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QVector>
+
+class TerrainDEMFile;
+
+/// Elevation lookups from the DEM files (.hgt, GeoTIFF) in a local directory.
+///
+/// Files are memory mapped when the directory is scanned. Samples are decoded in square blocks which are kept in a
+/// least recently used cache with a bounded memory budget, so repeated queries over the same area do not touch the
+/// mapping again. All methods are thread safe.
+class TerrainDEMCache
+{
+public:
+    TerrainDEMCache(void);
+    ~TerrainDEMCache();
+
+    /// @return Cache used by TerrainDEMQuery and TerrainOfflineAirMapQuery, configured from OfflineMapsSettings and
+    ///         updated when those settings change
+    static TerrainDEMCache* instance(void);
+
+    /// Scans the directory for DEM files. Does nothing if the directory is unchanged.
+    void    setDirectory    (const QString& directory);
+    QString directory       (void) const;
+
+    /// @return Number of DEM files found in the directory
+    int     fileCount       (void) const;
+
+    void    setMaxMemoryBytes(qint64 maxMemoryBytes);
+    qint64  memoryBytes     (void) const;
+
+    /// Appends the height of each coordinate to heights
+    ///     @return false: at least one coordinate is not covered by the DEM files, heights not returned
+    bool coordinateHeights  (const QList<QGeoCoordinate>& coordinates, QList<double>& heights);
+    bool pathHeights        (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double& distanceBetween, double& finalDistanceBetween, QList<double>& heights);
+    bool carpetHeights      (const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly, double& minHeight, double& maxHeight, QList<QList<double>>& carpet);
+
+    static constexpr int    blockSize               = 128;                  ///< Block is blockSize x blockSize samples
+    static constexpr qint64 defaultMaxMemoryBytes   = 64 * 1024 * 1024;
+
+private:
+    typedef QVector<float> Block_t;
+
+    int     _fileIndex      (double latitude, double longitude);
+    double  _elevation      (double latitude, double longitude);
+    float   _sample         (int fileIndex, int row, int col);
+    void    _clear          (void);
+
+    static quint64 _blockKey(int fileIndex, int blockRow, int blockCol) {
+        return (static_cast<quint64>(fileIndex) << 40) | (static_cast<quint64>(blockRow) << 20) | static_cast<quint64>(blockCol);
+    }
+
+    mutable QMutex              _mutex;
+    QString                     _directory;
+    QList<TerrainDEMFile*>      _files;
+    int                         _lastFileIndex  = 0;
+    QCache<quint64, Block_t>    _blocks;                ///< Cost is in KB
+    quint64                     _lastBlockKey   = 0;
+    Block_t*                    _lastBlock      = nullptr;
+};
+
+/// Offline terrain queries from local DEM files. Results are signalled before the request method returns.
+class TerrainDEMQuery : public TerrainQueryInterface {
+    Q_OBJECT
+
+public:
+    /// @param demCache Cache to query, nullptr for TerrainDEMCache::instance()
+    TerrainDEMQuery(TerrainDEMCache* demCache = nullptr, QObject* parent = nullptr);
+
+    // Overrides from TerrainQueryInterface
+    void requestCoordinateHeights   (const QList<QGeoCoordinate>& coordinates) final;
+    void requestPathHeights         (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord) final;
+    void requestCarpetHeights       (const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly) final;
+
+private:
+    TerrainDEMCache* _demCache;
+};
@@ -8,6 +8,7 @@
  ****************************************************************************/
 
 #include "TerrainQuery.h"
+#include "TerrainDEMQuery.h"
 #include "QGCMapEngine.h"
 #include "QGeoMapReplyQGC.h"
 #include "QGCFileDownload.h"
@@ -23,6 +24,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QTimer>
+#include <QtConcurrent>
 #include <QtLocation/private/qgeotilespec_p.h>
 #include <QtLocation/private/qgeotiledmapreply_p.h>
 
@@ -291,6 +293,12 @@ void TerrainOfflineAirMapQuery::requestCoordinateHeights(const QList<QGeoCoordin
         return;
     }
 
+    QList<double> heights;
+    if (TerrainDEMCache::instance()->coordinateHeights(coordinates, heights)) {
+        _signalCoordinateHeights(true /* success */, heights);
+        return;
+    }
+
     _terrainTileManager->addCoordinateQuery(this, coordinates);
 }
 
@@ -301,6 +309,14 @@ void TerrainOfflineAirMapQuery::requestPathHeights(const QGeoCoordinate& fromCoo
         return;
     }
 
+    double          distanceBetween;
+    double          finalDistanceBetween;
+    QList<double>   heights;
+    if (TerrainDEMCache::instance()->pathHeights(fromCoord, toCoord, distanceBetween, finalDistanceBetween, heights)) {
+        _signalPathHeights(true /* success */, distanceBetween, finalDistanceBetween, heights);
+        return;
+    }
+
     _terrainTileManager->addPathQuery(this, fromCoord, toCoord);
 }
 
@@ -311,10 +327,15 @@ void TerrainOfflineAirMapQuery::requestCarpetHeights(const QGeoCoordinate& swCoo
         return;
     }
 
-    // TODO
-    Q_UNUSED(swCoord);
-    Q_UNUSED(neCoord);
-    Q_UNUSED(statsOnly);
+    // Carpets are only available from local DEM files
+    double                  minHeight;
+    double                  maxHeight;
+    QList<QList<double>>    carpet;
+    if (TerrainDEMCache::instance()->carpetHeights(swCoord, neCoord, statsOnly, minHeight, maxHeight, carpet)) {
+        _signalCarpetHeights(true /* success */, minHeight, maxHeight, carpet);
+        return;
+    }
+
     qWarning() << "Carpet queries are currently not supported from offline air map data";
 }
 
@@ -375,6 +396,7 @@ QList<QGeoCoordinate> TerrainTileManager::pathQueryToCoords(const QGeoCoordinate
     double latDiff  = toCoord.latitude() - lat;
     double lonDiff  = toCoord.longitude() - lon;
 
+    coordinates.reserve(static_cast<int>(steps) + 2);
     if (steps == 0) {
         coordinates.append(fromCoord);
         coordinates.append(toCoord);
@@ -426,26 +448,44 @@ void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInt
 /// Either returns altitudes from cache or queues database request
 ///     @param[out] error true: altitude not returned due to error, false: altitudes returned
 /// @return true: altitude returned (check error as well), false: database query queued (altitudes not returned)
-bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error)
+bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error, bool downloadMissing)
 {
     error = false;
 
-    for (const QGeoCoordinate& coordinate: coordinates) {
-        QString tileHash = _getTileHash(coordinate);
-        qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates hash:coordinate" << tileHash << coordinate;
+    const int       count = coordinates.count();
+    QVector<double> latitudes(count);
+    QVector<double> longitudes(count);
+    QVector<quint64> tileKeys(count);
+    for (int i=0; i<count; i++) {
+        latitudes[i]    = coordinates[i].latitude();
+        longitudes[i]   = coordinates[i].longitude();
+        tileKeys[i]     = _getTileKey(latitudes[i], longitudes[i]);
+    }
 
-        _tilesMutex.lock();
-        if (_tiles.contains(tileHash)) {
-            double elevation = _tiles[tileHash].elevation(coordinate);
-            if (qIsNaN(elevation)) {
-                error = true;
-                qCWarning(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates Internal Error: missing elevation in tile cache";
-            } else {
-                qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates returning elevation from tile cache" << elevation;
-            }
-            altitudes.push_back(elevation);
-        } else {
-            if (_state != State::Downloading) {
+    // Neighbouring coordinates are almost always in the same tile, so look up each run of them once. Tiles share their
+    // data, so the lookups are copied out and the elevations evaluated without holding the lock.
+    typedef struct {
+        int         start;
+        int         end;
+        TerrainTile tile;
+    } TileRun_t;
+    QVector<TileRun_t> tileRuns;
+
+    _tilesMutex.lock();
+    int runStart = 0;
+    while (runStart < count) {
+        const quint64   tileKey = tileKeys[runStart];
+        int             runEnd  = runStart + 1;
+        while (runEnd < count && tileKeys[runEnd] == tileKey) {
+            runEnd++;
+        }
+
+        auto tileIt = _tiles.constFind(tileKey);
+        if (tileIt == _tiles.constEnd()) {
+            _tilesMutex.unlock();
+
+            const QGeoCoordinate& coordinate = coordinates[runStart];
+            if (downloadMissing && _state != State::Downloading) {
                 QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(
                     kMapType, getQGCMapEngine()->urlFactory()->long2tileX(kMapType, coordinate.longitude(), 1),
                     getQGCMapEngine()->urlFactory()->lat2tileY(kMapType, coordinate.latitude(), 1),
@@ -461,11 +501,27 @@ bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate>&
                 connect(reply, &QGeoTiledMapReplyQGC::terrainDone, this, &TerrainTileManager::_terrainDone);
                 _state = State::Downloading;
             }
-            _tilesMutex.unlock();
-
             return false;
         }
-        _tilesMutex.unlock();
+
+        tileRuns.append({ runStart, runEnd, *tileIt });
+        runStart = runEnd;
+    }
+    _tilesMutex.unlock();
+
+    // Elevations are appended to whatever the caller already has in the list
+    const int firstAltitude = altitudes.count();
+    altitudes.resize(firstAltitude + count);
+    for (const TileRun_t& tileRun: tileRuns) {
+        tileRun.tile.elevations(&latitudes[tileRun.start], &longitudes[tileRun.start], tileRun.end - tileRun.start, &altitudes[firstAltitude + tileRun.start]);
+    }
+
+    for (int i=firstAltitude; i<altitudes.count(); i++) {
+        if (qIsNaN(altitudes[i])) {
+            error = true;
+            qCWarning(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates Internal Error: missing elevation in tile cache";
+            break;
+        }
     }
 
     return true;
@@ -497,7 +553,7 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
 
     // remove from download queue
     QGeoTileSpec spec = reply->tileSpec();
-    QString hash = getQGCMapEngine()->getTileHash(kMapType, spec.x(), spec.y(), spec.zoom());
+    const quint64 tileKey = _tileKey(spec.x(), spec.y());
 
     // handle potential errors
     if (error != QNetworkReply::NoError) {
@@ -515,17 +571,18 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
 
     qCDebug(TerrainQueryLog) << "Received some bytes of terrain data: " << responseBytes.size();
 
-    TerrainTile* terrainTile = new TerrainTile(responseBytes);
-    if (terrainTile->isValid()) {
+    TerrainTile terrainTile(responseBytes);
+    if (terrainTile.isValid()) {
         _tilesMutex.lock();
-        if (!_tiles.contains(hash)) {
-            _tiles.insert(hash, *terrainTile);
-        } else {
-            delete terrainTile;
+        const bool newTile = !_tiles.contains(tileKey);
+        if (newTile) {
+            _tiles.insert(tileKey, terrainTile);
         }
         _tilesMutex.unlock();
+        if (newTile) {
+            emit tileLoaded();
+        }
     } else {
-        delete terrainTile;
         qCWarning(TerrainQueryLog) << "Received invalid tile";
     }
     reply->deleteLater();
@@ -561,16 +618,10 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
     }
 }
 
-QString TerrainTileManager::_getTileHash(const QGeoCoordinate& coordinate)
+/// Same tiling as CopernicusElevationProvider::long2tileX/lat2tileY, without the provider lookup for each coordinate
+quint64 TerrainTileManager::_getTileKey(double latitude, double longitude)
 {
-    QString ret = getQGCMapEngine()->getTileHash(
-        kMapType,
-        getQGCMapEngine()->urlFactory()->long2tileX(kMapType, coordinate.longitude(), 1),
-        getQGCMapEngine()->urlFactory()->lat2tileY(kMapType, coordinate.latitude(), 1),
-        1);
-    qCDebug(TerrainQueryVerboseLog) << "Computing unique tile hash for " << coordinate << ret;
-
-    return ret;
+    return _tileKey(qFloor((longitude + 180.0) / TerrainTile::tileSizeDegrees), qFloor((latitude + 90.0) / TerrainTile::tileSizeDegrees));
 }
 
 TerrainAtCoordinateBatchManager::TerrainAtCoordinateBatchManager(void)
@@ -724,6 +775,11 @@ void TerrainAtCoordinateQuery::requestData(const QList<QGeoCoordinate>& coordina
 
 bool TerrainAtCoordinateQuery::getAltitudesForCoordinates(const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error)
 {
+    if (TerrainDEMCache::instance()->coordinateHeights(coordinates, altitudes)) {
+        error = false;
+        return true;
+    }
+
     return _terrainTileManager->getAltitudesForCoordinates(coordinates, altitudes, error);
 }
 
@@ -763,7 +819,8 @@ TerrainPolyPathQuery::TerrainPolyPathQuery(bool autoDelete)
     : _autoDelete   (autoDelete)
     , _pathQuery    (false /* autoDelete */)
 {
-    connect(&_pathQuery, &TerrainPathQuery::terrainDataReceived, this, &TerrainPolyPathQuery::_terrainDataReceived);
+    connect(&_sampleWatcher,    &QFutureWatcher<SampledSegment_t>::finished,    this, &TerrainPolyPathQuery::_segmentsSampled);
+    connect(&_pathQuery,        &TerrainPathQuery::terrainDataReceived,         this, &TerrainPolyPathQuery::_terrainDataReceived);
 }
 
 void TerrainPolyPathQuery::requestData(const QVariantList& polyPath)
@@ -781,10 +838,75 @@ void TerrainPolyPathQuery::requestData(const QList<QGeoCoordinate>& polyPath)
 {
     qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::requestData count" << polyPath.count();
 
-    // Kick off first request
     _rgCoords = polyPath;
+    _rgPathHeightInfo.clear();
+    _sampleSegments.clear();
+    _pendingSegments.clear();
     _curIndex = 0;
-    _pathQuery.requestData(_rgCoords[0], _rgCoords[1]);
+
+    if (_rgCoords.count() < 2) {
+        qCWarning(TerrainQueryLog) << "TerrainPolyPathQuery::requestData Internal Error - path must have at least two coordinates";
+        _finish(false /* success */);
+        return;
+    }
+
+    // Reuse the profiles of segments which have not changed since they were last queried
+    TerrainPathProfileCache* profileCache = TerrainPathProfileCache::instance();
+    _rgPathHeightInfo.resize(_rgCoords.count() - 1);
+    for (int i=0; i<_rgPathHeightInfo.count(); i++) {
+        if (!profileCache->lookup(_rgCoords[i], _rgCoords[i+1], _rgPathHeightInfo[i])) {
+            _sampleSegments.append(i);
+        }
+    }
+
+    qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::requestData cached:sample" << _rgPathHeightInfo.count() - _sampleSegments.count() << _sampleSegments.count();
+
+    if (_sampleSegments.isEmpty()) {
+        _finish(true /* success */);
+        return;
+    }
+
+    // The lambda must not reference this, the query may be deleted before sampling completes
+    const QList<QGeoCoordinate> rgCoords = _rgCoords;
+    TerrainDEMCache*            demCache = TerrainDEMCache::instance();
+    _sampleWatcher.setFuture(QtConcurrent::mapped(_sampleSegments, [rgCoords, demCache](int segment) {
+        SampledSegment_t sampledSegment;
+        sampledSegment.success = TerrainPathProfileCache::samplePath(rgCoords[segment], rgCoords[segment + 1], demCache, sampledSegment.pathHeightInfo);
+        return sampledSegment;
+    }));
+}
+
+void TerrainPolyPathQuery::_segmentsSampled(void)
+{
+    TerrainPathProfileCache* profileCache = TerrainPathProfileCache::instance();
+
+    for (int i=0; i<_sampleSegments.count(); i++) {
+        const int               segment         = _sampleSegments[i];
+        const SampledSegment_t  sampledSegment  = _sampleWatcher.resultAt(i);
+
+        if (sampledSegment.success) {
+            _rgPathHeightInfo[segment] = sampledSegment.pathHeightInfo;
+            profileCache->insert(_rgCoords[segment], _rgCoords[segment + 1], sampledSegment.pathHeightInfo);
+        } else {
+            _pendingSegments.append(segment);
+        }
+    }
+    _sampleSegments.clear();
+
+    qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_segmentsSampled pending" << _pendingSegments.count();
+
+    if (_pendingSegments.isEmpty()) {
+        _finish(true /* success */);
+    } else {
+        _curIndex = 0;
+        _requestPendingSegment();
+    }
+}
+
+void TerrainPolyPathQuery::_requestPendingSegment(void)
+{
+    const int segment = _pendingSegments[_curIndex];
+    _pathQuery.requestData(_rgCoords[segment], _rgCoords[segment + 1]);
 }
 
 void TerrainPolyPathQuery::_terrainDataReceived(bool success, const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo)
@@ -792,25 +914,109 @@ void TerrainPolyPathQuery::_terrainDataReceived(bool success, const TerrainPathQ
     qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_terrainDataReceived success:_curIndex" << success << _curIndex;
 
     if (!success) {
-        _rgPathHeightInfo.clear();
-        emit terrainDataReceived(false /* success */, _rgPathHeightInfo);
+        _finish(false /* success */);
         return;
     }
 
-    _rgPathHeightInfo.append(pathHeightInfo);
+    const int segment = _pendingSegments[_curIndex];
+    _rgPathHeightInfo[segment] = pathHeightInfo;
+    TerrainPathProfileCache::instance()->insert(_rgCoords[segment], _rgCoords[segment + 1], pathHeightInfo);
 
-    if (++_curIndex >= _rgCoords.count() - 1) {
-        // We've finished all requests
-        qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_terrainDataReceived complete";
-        emit terrainDataReceived(true /* success */, _rgPathHeightInfo);
-        if (_autoDelete) {
-            deleteLater();
-        }
+    if (++_curIndex >= _pendingSegments.count()) {
+        _finish(true /* success */);
     } else {
-        _pathQuery.requestData(_rgCoords[_curIndex], _rgCoords[_curIndex+1]);
+        _requestPendingSegment();
     }
 }
 
+void TerrainPolyPathQuery::_finish(bool success)
+{
+    if (success) {
+        qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_finish complete";
+    } else {
+        _rgPathHeightInfo.clear();
+    }
+    emit terrainDataReceived(success, _rgPathHeightInfo);
+    if (_autoDelete) {
+        deleteLater();
+    }
+}
+
+Q_GLOBAL_STATIC(TerrainPathProfileCache, _terrainPathProfileCache)
+
+TerrainPathProfileCache::TerrainPathProfileCache(void)
+{
+    _profiles.setMaxCost(maxCachedHeights);
+
+    TerrainTileManager* tileManager = _terrainTileManager();
+    QObject::connect(tileManager, &TerrainTileManager::tileLoaded, tileManager, [this]() { clear(); });
+}
+
+TerrainPathProfileCache* TerrainPathProfileCache::instance(void)
+{
+    return _terrainPathProfileCache();
+}
+
+TerrainPathProfileCache::SegmentKey_t TerrainPathProfileCache::_segmentKey(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord)
+{
+    return {
+        static_cast<qint32>(qRound(fromCoord.latitude() * 1e7)),
+        static_cast<qint32>(qRound(fromCoord.longitude() * 1e7)),
+        static_cast<qint32>(qRound(toCoord.latitude() * 1e7)),
+        static_cast<qint32>(qRound(toCoord.longitude() * 1e7)),
+    };
+}
+
+bool TerrainPathProfileCache::lookup(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, TerrainPathQuery::PathHeightInfo_t& pathHeightInfo)
+{
+    QMutexLocker locker(&_mutex);
+
+    const TerrainPathQuery::PathHeightInfo_t* cachedPathHeightInfo = _profiles.object(_segmentKey(fromCoord, toCoord));
+    if (cachedPathHeightInfo) {
+        pathHeightInfo = *cachedPathHeightInfo;
+        return true;
+    }
+    return false;
+}
+
+void TerrainPathProfileCache::insert(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo)
+{
+    QMutexLocker locker(&_mutex);
+
+    _profiles.insert(_segmentKey(fromCoord, toCoord), new TerrainPathQuery::PathHeightInfo_t(pathHeightInfo), qMax(1, static_cast<int>(pathHeightInfo.heights.count())));
+}
+
+void TerrainPathProfileCache::clear(void)
+{
+    QMutexLocker locker(&_mutex);
+    _profiles.clear();
+}
+
+int TerrainPathProfileCache::count(void)
+{
+    QMutexLocker locker(&_mutex);
+    return static_cast<int>(_profiles.count());
+}
+
+bool TerrainPathProfileCache::samplePath(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, TerrainDEMCache* demCache, TerrainPathQuery::PathHeightInfo_t& pathHeightInfo)
+{
+    if (qgcApp()->runningUnitTests()) {
+        const UnitTestTerrainQuery::PathHeightInfo_t unitTestPathHeightInfo = UnitTestTerrainQuery::_requestPathHeights(fromCoord, toCoord);
+        pathHeightInfo.distanceBetween      = unitTestPathHeightInfo.distanceBetween;
+        pathHeightInfo.finalDistanceBetween = unitTestPathHeightInfo.finalDistanceBetween;
+        pathHeightInfo.heights              = unitTestPathHeightInfo.rgHeights;
+        return !pathHeightInfo.heights.isEmpty();
+    }
+
+    if (demCache && demCache->pathHeights(fromCoord, toCoord, pathHeightInfo.distanceBetween, pathHeightInfo.finalDistanceBetween, pathHeightInfo.heights)) {
+        return true;
+    }
+
+    bool error;
+    const QList<QGeoCoordinate> coordinates = TerrainTileManager::pathQueryToCoords(fromCoord, toCoord, pathHeightInfo.distanceBetween, pathHeightInfo.finalDistanceBetween);
+    return _terrainTileManager->getAltitudesForCoordinates(coordinates, pathHeightInfo.heights, error, false /* downloadMissing */) && !error;
+}
+
 const QGeoCoordinate UnitTestTerrainQuery::pointNemo{-48.875556, -123.392500};
 const UnitTestTerrainQuery::Flat10Region UnitTestTerrainQuery::flat10Region{{
       pointNemo,
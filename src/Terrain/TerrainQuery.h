@@ -14,6 +14,9 @@
 #include "QGCLoggingCategory.h"
 
 #include <QObject>
+#include <QCache>
+#include <QFutureWatcher>
+#include <QMutex>
 #include <QGeoCoordinate>
 #include <QGeoRectangle>
 #include <QNetworkAccessManager>
@@ -24,6 +27,7 @@ Q_DECLARE_LOGGING_CATEGORY(TerrainQueryLog)
 Q_DECLARE_LOGGING_CATEGORY(TerrainQueryVerboseLog)
 
 class TerrainAtCoordinateQuery;
+class TerrainDEMCache;
 
 /// Base class for offline/online terrain queries
 class TerrainQueryInterface : public QObject
@@ -117,10 +121,17 @@ public:
 
     void addCoordinateQuery         (TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& coordinates);
     void addPathQuery               (TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate& startPoint, const QGeoCoordinate& endPoint);
-    bool getAltitudesForCoordinates (const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error);
+    /// Returns altitudes from the cached tiles. Thread safe if downloadMissing is false.
+    ///     @param downloadMissing true: start downloading the first missing tile
+    /// @return false: not all tiles are cached, altitudes not returned
+    bool getAltitudesForCoordinates (const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error, bool downloadMissing = true);
 
     static QList<QGeoCoordinate> pathQueryToCoords(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double& distanceBetween, double& finalDistanceBetween);
 
+signals:
+    /// Signalled when a newly downloaded tile has been added to the cached tiles
+    void tileLoaded(void);
+
 private slots:
     void _terrainDone(QByteArray responseBytes, QNetworkReply::NetworkError error);
 
@@ -145,14 +156,18 @@ private:
     } QueuedRequestInfo_t;
 
     void    _tileFailed                         (void);
-    QString _getTileHash                        (const QGeoCoordinate& coordinate);
+
+    static quint64 _tileKey                     (int x, int y) { return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y); }
+    static quint64 _getTileKey                  (double latitude, double longitude);
 
     QList<QueuedRequestInfo_t>  _requestQueue;
     State                       _state = State::Idle;
     QNetworkAccessManager       _networkManager;
 
     QMutex                      _tilesMutex;
-    QHash<QString, TerrainTile> _tiles;
+    QHash<quint64, TerrainTile> _tiles;                     ///< Key: _tileKey of the tile x/y
+
+    friend class TerrainDEMBenchmark;
 };
 
 /// Used internally by TerrainAtCoordinateQuery to batch coordinate requests together
@@ -268,6 +283,12 @@ private:
 
 Q_DECLARE_METATYPE(TerrainPathQuery::PathHeightInfo_t)
 
+/// Terrain queries for the paths between each coordinate of a poly path.
+///
+/// Segment profiles are first taken from TerrainPathProfileCache. The remaining segments are sampled on the global thread
+/// pool from terrain data which is available locally. Only segments which still need tiles to be downloaded go through
+/// TerrainPathQuery one after the other. Editing a single vertex of a large path therefore only samples the segments
+/// touching that vertex.
 class TerrainPolyPathQuery : public QObject
 {
     Q_OBJECT
@@ -287,16 +308,72 @@ signals:
     void terrainDataReceived(bool success, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo);
 
 private slots:
-    void _terrainDataReceived(bool success, const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo);
+    void _segmentsSampled       (void);
+    void _terrainDataReceived   (bool success, const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo);
 
 private:
+    typedef struct {
+        bool                                success;
+        TerrainPathQuery::PathHeightInfo_t  pathHeightInfo;
+    } SampledSegment_t;
+
+    void _requestPendingSegment (void);
+    void _finish                (bool success);
+
     bool                                        _autoDelete;
-    int                                         _curIndex = 0;
+    int                                         _curIndex = 0;          ///< Index into _pendingSegments
     QList<QGeoCoordinate>                       _rgCoords;
-    QList<TerrainPathQuery::PathHeightInfo_t>   _rgPathHeightInfo;
+    QList<TerrainPathQuery::PathHeightInfo_t>   _rgPathHeightInfo;      ///< One entry per segment
+    QList<int>                                  _sampleSegments;        ///< Segments being sampled on the thread pool
+    QList<int>                                  _pendingSegments;       ///< Segments which need downloaded terrain data
+    QFutureWatcher<SampledSegment_t>            _sampleWatcher;
     TerrainPathQuery                            _pathQuery;
 };
 
+/// Terrain height profiles of path segments, shared by all TerrainPolyPathQuery instances. Profiles are keyed on the segment
+/// end points quantized to 1e-7 degrees (~1cm). Bounded to maxCachedHeights height values, least recently used first out.
+class TerrainPathProfileCache
+{
+public:
+    TerrainPathProfileCache(void);
+
+    /// Profiles are cleared when a terrain tile is downloaded or the DEM directory changes, since either can change the
+    /// heights of segments which were already sampled.
+    static TerrainPathProfileCache* instance(void);
+
+    bool    lookup  (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, TerrainPathQuery::PathHeightInfo_t& pathHeightInfo);
+    void    insert  (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo);
+    void    clear   (void);
+    int     count   (void);
+
+    /// Samples the segment from terrain data which is available without a download: DEM files or cached tiles. Thread safe.
+    ///     @param demCache DEM files to use, nullptr for none
+    /// @return false: terrain data not available locally
+    static bool samplePath(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, TerrainDEMCache* demCache, TerrainPathQuery::PathHeightInfo_t& pathHeightInfo);
+
+    static constexpr int maxCachedHeights = 4 * 1024 * 1024;
+
+private:
+    struct SegmentKey_t {
+        qint32 fromLat;
+        qint32 fromLon;
+        qint32 toLat;
+        qint32 toLon;
+
+        bool operator==(const SegmentKey_t& other) const {
+            return fromLat == other.fromLat && fromLon == other.fromLon && toLat == other.toLat && toLon == other.toLon;
+        }
+        friend size_t qHash(const SegmentKey_t& key, size_t seed = 0) {
+            return qHashMulti(seed, key.fromLat, key.fromLon, key.toLat, key.toLon);
+        }
+    };
+
+    static SegmentKey_t _segmentKey(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord);
+
+    QMutex                                                      _mutex;
+    QCache<SegmentKey_t, TerrainPathQuery::PathHeightInfo_t>    _profiles;  ///< Cost is the number of heights
+};
+
 /// @brief Provides unit test terrain query responses.
 /// @details It provides preset, emulated, 1 arc-second (SRTM1) resolution regions that are either
 /// flat or sloped in a fashion that aids testing terrain-sensitive functionality. All emulated
@@ -353,6 +430,8 @@ public:
 
     UnitTestTerrainQuery(TerrainQueryInterface* parent = nullptr);
 
+    friend class TerrainPathProfileCache;
+
     // Overrides from TerrainQueryInterface
     void requestCoordinateHeights   (const QList<QGeoCoordinate>& coordinates) override;
     void requestPathHeights         (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord) override;
@@ -366,7 +445,7 @@ private:
         double                  finalDistanceBetween;
     } PathHeightInfo_t;
 
-    QList<double> _requestCoordinateHeights(const QList<QGeoCoordinate>& coordinates);
-    PathHeightInfo_t _requestPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord);
+    static QList<double> _requestCoordinateHeights(const QList<QGeoCoordinate>& coordinates);
+    static PathHeightInfo_t _requestPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord);
 };
 
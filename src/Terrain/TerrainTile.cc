@@ -18,6 +18,8 @@
 #include <QDataStream>
 #include <QtMath>
 
+#include <cstring>
+
 QGC_LOGGING_CATEGORY(TerrainTileLog, "TerrainTileLog");
 
 const char*  TerrainTile::_jsonStatusKey        = "status";
@@ -33,13 +35,20 @@ const char*  TerrainTile::_jsonCarpetKey        = "carpet";
 
 TerrainTile::TerrainTile(const QByteArray& byteArray)
 {
+    int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
+    int cTileBytesAvailable = byteArray.size();
+
+    if (cTileBytesAvailable < cTileHeaderBytes) {
+        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for TileInfo_s header";
+        return;
+    }
+
     // Copy tile info
-    _tileInfo = *reinterpret_cast<const TileInfo_t*>(byteArray.constData());
+    memcpy(&_tileInfo, byteArray.constData(), sizeof(TileInfo_t));
 
     // Check feasibility
-    if ((_tileInfo.neLon - _tileInfo.swLon) < 0.0 || (_tileInfo.neLat - _tileInfo.swLat) < 0.0) {
+    if ((_tileInfo.neLon - _tileInfo.swLon) < 0.0 || (_tileInfo.neLat - _tileInfo.swLat) < 0.0 || _tileInfo.gridSizeLat <= 0 || _tileInfo.gridSizeLon <= 0) {
         qCWarning(TerrainTileLog) << this << "Tile extent is infeasible";
-        _isValid = false;
         return;
     }
 
@@ -52,33 +61,14 @@ TerrainTile::TerrainTile(const QByteArray& byteArray)
     qCDebug(TerrainTileLog) << this << "TileInfo: min, max, avg: " << _tileInfo.minElevation << _tileInfo.maxElevation << _tileInfo.avgElevation;
     qCDebug(TerrainTileLog) << this << "TileInfo: cell size:     " << _cellSizeLat << _cellSizeLon;
 
-    int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
-    int cTileBytesAvailable = byteArray.size();
-
-    if (cTileBytesAvailable < cTileHeaderBytes) {
-        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for TileInfo_s header";
-        return;
-    }
-
     int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * _tileInfo.gridSizeLat * _tileInfo.gridSizeLon;
     if (cTileBytesAvailable < cTileHeaderBytes + cTileDataBytes) {
         qCWarning(TerrainTileLog) << "Terrain tile binary data too small for tile data";
         return;
     }
 
-    _elevationData.resize(_tileInfo.gridSizeLat);
-    for (int k = 0; k < _tileInfo.gridSizeLat; k++) {
-        _elevationData[k].resize(_tileInfo.gridSizeLon);
-    }
-
-    int valueIndex = 0;
-    const int16_t* pTileData = reinterpret_cast<const int16_t*>(&reinterpret_cast<const uint8_t*>(byteArray.constData())[cTileHeaderBytes]);
-    for (int i = 0; i < _tileInfo.gridSizeLat; i++) {
-        for (int j = 0; j < _tileInfo.gridSizeLon; j++) {
-            _elevationData[i][j] = pTileData[valueIndex++];
-        }
-    }
-
+    // Implicitly shared, no copy of the elevation data is made
+    _tileData = byteArray;
     _isValid = true;
 }
 
@@ -94,41 +84,74 @@ double TerrainTile::elevation(const QGeoCoordinate& coordinate) const
         return qQNaN();
     }
 
-    const double latDeltaSw = coordinate.latitude() - _tileInfo.swLat;
-    const double lonDeltaSw = coordinate.longitude() - _tileInfo.swLon;
-
-    const int16_t latIndex = qFloor(latDeltaSw / _cellSizeLat);
-    const int16_t lonIndex = qFloor(lonDeltaSw / _cellSizeLon);
+    const int latIndex = qFloor((coordinate.latitude() - _tileInfo.swLat) / _cellSizeLat);
+    const int lonIndex = qFloor((coordinate.longitude() - _tileInfo.swLon) / _cellSizeLon);
 
-    const bool latIndexInvalid = latIndex < 0 || latIndex > (_tileInfo.gridSizeLat - 1);
-    const bool lonIndexInvalid = lonIndex < 0 || lonIndex > (_tileInfo.gridSizeLon - 1);
-
-    if (latIndexInvalid || lonIndexInvalid) {
+    if (latIndex < 0 || latIndex >= _tileInfo.gridSizeLat || lonIndex < 0 || lonIndex >= _tileInfo.gridSizeLon) {
         qCWarning(TerrainTileLog) << this << "Internal error: coordinate" << coordinate << "outside tile bounds";
         return qQNaN();
     }
 
-    if (latIndex >= _elevationData.size() || lonIndex >= _elevationData[latIndex].size()) {
-        qCWarning(TerrainTileLog).noquote() << this << "Internal error: _elevationData size inconsistent _tileInfo << coordinate" << coordinate 
-            << "\n\t_tillIndo.gridSizeLat: " << _tileInfo.gridSizeLat << " _tileInfo.gridSizeLon: " << _tileInfo.gridSizeLon
-            << "\n\t_data.size(): " << _elevationData.size() << " _elevationData[latIndex].size(): " << _elevationData[latIndex].size();
-        return qQNaN();
-    }
-    const auto elevation = _elevationData[latIndex][lonIndex];
+    return static_cast<double>(_elevationData()[(latIndex * _tileInfo.gridSizeLon) + lonIndex]);
+}
 
-    // Print warning if elevation is outside min/max of tile meta data
-    if (elevation < _tileInfo.minElevation) {
-        qCWarning(TerrainTileLog) << this << "Warning: elevation read is below min elevation in tile:" << elevation << "<" << _tileInfo.minElevation;
-    }
-    else if (elevation > _tileInfo.maxElevation) {
-        qCWarning(TerrainTileLog) << this << "Warning: elevation read is above max elevation in tile:" << elevation << ">" << _tileInfo.maxElevation;
+void TerrainTile::elevations(const double* latitudes, const double* longitudes, int count, double* elevations, bool bilinear) const
+{
+    if (!_isValid) {
+        qCWarning(TerrainTileLog) << this << "Request for elevations, but tile is invalid.";
+        for (int i=0; i<count; i++) {
+            elevations[i] = qQNaN();
+        }
+        return;
     }
 
-#ifdef QT_DEBUG
-    qCDebug(TerrainTileLog) << this << "latIndex, lonIndex:" << latIndex << lonIndex << "elevation:" << elevation;
-#endif
+    const int16_t*  data            = _elevationData();
+    const int       gridSizeLat     = _tileInfo.gridSizeLat;
+    const int       gridSizeLon     = _tileInfo.gridSizeLon;
+    const double    maxLatIndex     = gridSizeLat - 1;
+    const double    maxLonIndex     = gridSizeLon - 1;
+    const double    invCellSizeLat  = 1.0 / _cellSizeLat;
+    const double    invCellSizeLon  = 1.0 / _cellSizeLon;
+    const double    nan             = qQNaN();
+
+    if (!bilinear) {
+        for (int i=0; i<count; i++) {
+            const double    latPos  = (latitudes[i] - _tileInfo.swLat) * invCellSizeLat;
+            const double    lonPos  = (longitudes[i] - _tileInfo.swLon) * invCellSizeLon;
+            const bool      inside  = latPos >= 0 && latPos < gridSizeLat && lonPos >= 0 && lonPos < gridSizeLon;
+            const int       latIndex = static_cast<int>(qBound(0.0, latPos, maxLatIndex));
+            const int       lonIndex = static_cast<int>(qBound(0.0, lonPos, maxLonIndex));
+
+            elevations[i] = inside ? static_cast<double>(data[(latIndex * gridSizeLon) + lonIndex]) : nan;
+        }
+        return;
+    }
 
-    return static_cast<double>(elevation);
+    for (int i=0; i<count; i++) {
+        // Grid values are at the cell centers. Positions are in grid units relative to the south west cell center.
+        const double latPos = ((latitudes[i] - _tileInfo.swLat) * invCellSizeLat) - 0.5;
+        const double lonPos = ((longitudes[i] - _tileInfo.swLon) * invCellSizeLon) - 0.5;
+
+        // Coordinates in the outer half cell of the tile are clamped to the edge values
+        const bool      inside  = latPos >= -0.5 && latPos <= maxLatIndex + 0.5 && lonPos >= -0.5 && lonPos <= maxLonIndex + 0.5;
+        const double    latC    = qBound(0.0, latPos, maxLatIndex);
+        const double    lonC    = qBound(0.0, lonPos, maxLonIndex);
+        const int       lat0    = static_cast<int>(latC);
+        const int       lon0    = static_cast<int>(lonC);
+        const int       lat1    = qMin(lat0 + 1, gridSizeLat - 1);
+        const int       lon1    = qMin(lon0 + 1, gridSizeLon - 1);
+        const double    latF    = latC - lat0;
+        const double    lonF    = lonC - lon0;
+
+        const double    sw      = data[(lat0 * gridSizeLon) + lon0];
+        const double    se      = data[(lat0 * gridSizeLon) + lon1];
+        const double    nw      = data[(lat1 * gridSizeLon) + lon0];
+        const double    ne      = data[(lat1 * gridSizeLon) + lon1];
+        const double    south   = sw + ((se - sw) * lonF);
+        const double    north   = nw + ((ne - nw) * lonF);
+
+        elevations[i] = inside ? south + ((north - south) * latF) : nan;
+    }
 }
 
 QByteArray TerrainTile::serializeFromAirMapJson(const QByteArray& input)
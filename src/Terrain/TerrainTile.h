@@ -4,6 +4,7 @@
 #include "QGCLoggingCategory.h"
 
 #include <QGeoCoordinate>
+#include <QByteArray>
 #include <QList>
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainTileLog)
@@ -12,6 +13,9 @@ Q_DECLARE_LOGGING_CATEGORY(TerrainTileLog)
  * @brief The TerrainTile class
  *
  * Implements an interface for https://developers.airmap.com/v2.0/docs/elevation-api
+ *
+ * Elevations are not copied out of the serialized tile. The tile keeps a reference to the blob it was created from
+ * and reads the row major elevation grid which follows the header in place.
  */
 
 class TerrainTile
@@ -42,6 +46,18 @@ public:
     */
     double elevation(const QGeoCoordinate& coordinate) const;
 
+    /**
+    * Evaluates the elevations at the given coordinates. By default this returns the value of the grid cell containing
+    * each coordinate, the same as elevation(). The loops are free of branches so the compiler can vectorize them.
+    *
+    * @param latitudes  Latitudes of the coordinates
+    * @param longitudes Longitudes of the coordinates
+    * @param count      Number of coordinates
+    * @param elevations Returned elevations, NaN for coordinates outside the tile
+    * @param bilinear   true: interpolate between the values at the surrounding cell centers
+    */
+    void elevations(const double* latitudes, const double* longitudes, int count, double* elevations, bool bilinear = false) const;
+
     /**
     * Accessor for the minimum elevation of the tile
     *
@@ -85,11 +101,14 @@ private:
         int16_t gridSizeLon;
     } TileInfo_t;
 
+    /// Row major elevation grid, gridSizeLat rows of gridSizeLon values
+    const int16_t* _elevationData(void) const { return reinterpret_cast<const int16_t*>(_tileData.constData() + sizeof(TileInfo_t)); }
+
     TileInfo_t              _tileInfo;
-    QList<QList<int16_t>>   _elevationData; // 2D elevation data array
-    double                  _cellSizeLat;   /// data grid size in latitude direction
-    double                  _cellSizeLon;   /// data grid size in longitude direction
-    bool                    _isValid;       /// data loaded is valid
+    QByteArray              _tileData;              /// serialized tile, shared with the cache
+    double                  _cellSizeLat    = 0;    /// data grid size in latitude direction
+    double                  _cellSizeLon    = 0;    /// data grid size in longitude direction
+    bool                    _isValid        = false;/// data loaded is valid
 
     // Json keys
     static const char*  _jsonStatusKey;
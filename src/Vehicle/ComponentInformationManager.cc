@@ -357,8 +357,14 @@ QString RequestMetaDataTypeStateMachine::_downloadCompleteJsonWorker(const QStri
     return outputFileName;
 }
 
-void RequestMetaDataTypeStateMachine::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg)
+void RequestMetaDataTypeStateMachine::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg, int downloadId)
 {
+    if (downloadId != _ftpDownloadId) {
+        // Some other download running on the same FTPManager
+        return;
+    }
+    _ftpDownloadId = 0;
+
     qCDebug(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_ftpDownloadComplete fileName:errorMsg" << fileName << errorMsg;
 
     disconnect(_compInfo->vehicle->ftpManager(), &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadComplete);
@@ -375,8 +381,12 @@ void RequestMetaDataTypeStateMachine::_ftpDownloadComplete(const QString& fileNa
     advance();
 }
 
-void RequestMetaDataTypeStateMachine::_ftpDownloadProgress(float progress)
+void RequestMetaDataTypeStateMachine::_ftpDownloadProgress(float progress, int downloadId)
 {
+    if (downloadId != _ftpDownloadId) {
+        return;
+    }
+
     int elapsedSec = _downloadStartTime.elapsed() / 1000;
     float totalDownloadTime = elapsedSec / progress;
     // abort download if it's too slow (e.g. over telemetry link) and use the fallback.
@@ -384,7 +394,7 @@ void RequestMetaDataTypeStateMachine::_ftpDownloadProgress(float progress)
     const int maxDownloadTimeSec = 40;
     if (elapsedSec > 10 && progress < 0.5 && totalDownloadTime > maxDownloadTimeSec) {
         qCDebug(ComponentInformationManagerLog) << "Slow download, aborting. Total time (s):" << totalDownloadTime;
-        _compInfo->vehicle->ftpManager()->cancel();
+        _compInfo->vehicle->ftpManager()->cancel(_ftpDownloadId);
     }
 }
 
@@ -420,7 +430,8 @@ void RequestMetaDataTypeStateMachine::_requestFile(const QString& cacheFileTag,
             qCDebug(ComponentInformationManagerLog) << "Downloading json" << uri;
             if (_uriIsMAVLinkFTP(uri)) {
                 connect(ftpManager, &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadComplete);
-                if (ftpManager->download(MAV_COMP_ID_AUTOPILOT1, uri, QStandardPaths::writableLocation(QStandardPaths::TempLocation))) {
+                _ftpDownloadId = ftpManager->download(MAV_COMP_ID_AUTOPILOT1, uri, QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+                if (_ftpDownloadId) {
                     _downloadStartTime.start();
                     connect(ftpManager, &FTPManager::commandProgress, this, &RequestMetaDataTypeStateMachine::_ftpDownloadProgress);
                 } else {
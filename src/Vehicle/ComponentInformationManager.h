@@ -42,8 +42,8 @@ public:
     void            statesCompleted (void) const final;
 
 private slots:
-    void    _ftpDownloadComplete                (const QString& file, const QString& errorMsg);
-    void    _ftpDownloadProgress                (float progress);
+    void    _ftpDownloadComplete                (const QString& file, const QString& errorMsg, int downloadId);
+    void    _ftpDownloadProgress                (float progress, int downloadId);
     void    _httpDownloadComplete               (QString remoteFile, QString localFile, QString errorMsg);
     QString _downloadCompleteJsonWorker         (const QString& jsonFileName);
     void _downloadAndTranslationComplete(QString translatedJsonTempFile, QString errorMsg);
@@ -73,6 +73,7 @@ private:
     bool                            _currentFileValidCrc        = false;
 
     QElapsedTimer                   _downloadStartTime;
+    int                             _ftpDownloadId              = 0;    ///< FTPManager download id, 0 for none
 
     static const StateFn  _rgStates[];
     static const int      _cStates;
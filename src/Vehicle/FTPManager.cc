@@ -21,162 +21,160 @@ QGC_LOGGING_CATEGORY(FTPManagerLog, "FTPManagerLog")
 
 const char* FTPManager::mavlinkFTPScheme = "mftp";
 
-FTPManager::FTPManager(Vehicle* vehicle)
-    : QObject   (vehicle)
-    , _vehicle  (vehicle)
+/// @return true: seqNumber1 comes after seqNumber2, taking wrap around into account
+static bool _seqNumberAfter(uint16_t seqNumber1, uint16_t seqNumber2)
 {
-    _ackOrNakTimeoutTimer.setSingleShot(true);
+    return static_cast<int16_t>(seqNumber1 - seqNumber2) > 0;
+}
+
+FTPManager::FTPManager(Vehicle* vehicle)
+    : QObject               (vehicle)
+    , _vehicle              (vehicle)
     // Mock link responds immediately if at all, speed up unit tests with faster timoue
-    _ackOrNakTimeoutTimer.setInterval(qgcApp()->runningUnitTests() ? 10 : _ackOrNakTimeoutMsecs);
+    , _ackOrNakTimeoutMsecs (qgcApp()->runningUnitTests() ? 10 : _defaultAckOrNakTimeoutMsecs)
+{
+    // A single timer checks all outstanding requests of all sessions
+    _ackOrNakTimeoutTimer.setSingleShot(false);
+    _ackOrNakTimeoutTimer.setInterval(qMax(1, _ackOrNakTimeoutMsecs / 2));
     connect(&_ackOrNakTimeoutTimer, &QTimer::timeout, this, &FTPManager::_ackOrNakTimeout);
-    
+    _clock.start();
+
     // Make sure we don't have bad structure packing
     Q_ASSERT(sizeof(MavlinkFTP::RequestHeader) == 12);
 }
 
-bool FTPManager::download(uint8_t fromCompId, const QString& fromURI, const QString& toDir, const QString& fileName, bool checksize)
+int FTPManager::download(uint8_t fromCompId, const QString& fromURI, const QString& toDir, const QString& fileName, bool checksize)
 {
     qCDebug(FTPManagerLog) << "download fromURI:" << fromURI << "to:" << toDir << "fromCompId:" << fromCompId;
 
-    if (!_rgStateMachine.isEmpty()) {
-        qCDebug(FTPManagerLog) << "Cannot download. Already in another operation";
-        return false;
-    }
-
-    static const StateFunctions_t rgDownloadStateMachine[] = {
-        { &FTPManager::_openFileROBegin,            &FTPManager::_openFileROAckOrNak,           &FTPManager::_openFileROTimeout },
-        { &FTPManager::_burstReadFileBegin,         &FTPManager::_burstReadFileAckOrNak,        &FTPManager::_burstReadFileTimeout },
-        { &FTPManager::_fillMissingBlocksBegin,     &FTPManager::_fillMissingBlocksAckOrNak,    &FTPManager::_fillMissingBlocksTimeout },
-        { &FTPManager::_resetSessionsBegin,         &FTPManager::_resetSessionsAckOrNak,        &FTPManager::_resetSessionsTimeout },
-        { &FTPManager::_downloadCompleteNoError,    nullptr,                                    nullptr },
-    };
-    for (size_t i=0; i<sizeof(rgDownloadStateMachine)/sizeof(rgDownloadStateMachine[0]); i++) {
-        _rgStateMachine.append(rgDownloadStateMachine[i]);
-    }
-
-    _downloadState.reset();
-    _downloadState.toDir.setPath(toDir);
-    _downloadState.checksize = checksize;
-
-    if (!_parseURI(fromCompId, fromURI, _downloadState.fullPathOnVehicle, _ftpCompId)) {
+    QString fullPathOnVehicle;
+    uint8_t compId;
+    if (!_parseURI(fromCompId, fromURI, fullPathOnVehicle, compId)) {
         qCWarning(FTPManagerLog) << "_parseURI failed";
-        return false;
+        return 0;
     }
 
+    Download_t* download = new Download_t;
+    download->id                = _nextDownloadId++;
+    download->compId            = compId;
+    download->fullPathOnVehicle = fullPathOnVehicle;
+    download->toDir.setPath(toDir);
+    download->checksize         = checksize;
+
     // We need to strip off the file name from the fully qualified path. We can't use the usual QDir
     // routines because this path does not exist locally.
     int lastDirSlashIndex;
-    for (lastDirSlashIndex=_downloadState.fullPathOnVehicle.size()-1; lastDirSlashIndex>=0; lastDirSlashIndex--) {
-        if (_downloadState.fullPathOnVehicle[lastDirSlashIndex] == '/') {
+    for (lastDirSlashIndex=fullPathOnVehicle.size()-1; lastDirSlashIndex>=0; lastDirSlashIndex--) {
+        if (fullPathOnVehicle[lastDirSlashIndex] == '/') {
             break;
         }
     }
     lastDirSlashIndex++; // move past slash
 
     if (fileName.isEmpty()) {
-        _downloadState.fileName = _downloadState.fullPathOnVehicle.right(_downloadState.fullPathOnVehicle.size() - lastDirSlashIndex);
+        download->fileName = fullPathOnVehicle.right(fullPathOnVehicle.size() - lastDirSlashIndex);
     } else {
-        _downloadState.fileName = fileName;
+        download->fileName = fileName;
     }
 
-    qCDebug(FTPManagerLog) << "_downloadState.fullPathOnVehicle:_downloadState.fileName" << _downloadState.fullPathOnVehicle << _downloadState.fileName;
-
-    _startStateMachine();
+    qCDebug(FTPManagerLog) << "download id:fullPathOnVehicle:fileName" << download->id << download->fullPathOnVehicle << download->fileName;
 
-    return true;
-}
-
-void FTPManager::cancel()
-{
-    if (!_downloadState.inProgress()) {
-        return;
+    _downloads.append(download);
+    if (!_ackOrNakTimeoutTimer.isActive()) {
+        _ackOrNakTimeoutTimer.start();
     }
+    _startQueuedDownloads();
 
-    _ackOrNakTimeoutTimer.stop();
-    _rgStateMachine.clear();
-    static const StateFunctions_t rgTerminateStateMachine[] = {
-        { &FTPManager::_terminateSessionBegin,       &FTPManager::_terminateSessionAckOrNak,     &FTPManager::_terminateSessionTimeout },
-        { &FTPManager::_terminateComplete,               nullptr,                                    nullptr },
-    };
-    for (size_t i=0; i<sizeof(rgTerminateStateMachine)/sizeof(rgTerminateStateMachine[0]); i++) {
-        _rgStateMachine.append(rgTerminateStateMachine[i]);
-    }
-    _downloadState.retryCount = 0;
-    _startStateMachine();
+    return download->id;
 }
 
-void FTPManager::_terminateSessionBegin(void)
+void FTPManager::cancel(int downloadId)
 {
-    MavlinkFTP::Request request{};
-    request.hdr.session = _downloadState.sessionId;
-    request.hdr.opcode  = MavlinkFTP::kCmdTerminateSession;
-    _sendRequestExpectAck(&request);
-}
+    const QList<Download_t*> downloads = _downloads;
 
-void FTPManager::_terminateSessionAckOrNak(const MavlinkFTP::Request *ackOrNak)
-{
-    MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
-    if (requestOpCode != MavlinkFTP::kCmdTerminateSession) {
-        qCDebug(FTPManagerLog) << "_terminateSessionAckOrNak: Ack disregarding ack for incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
-        return;
-    }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_terminateSessionAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
-        return;
-    }
+    for (Download_t* download: downloads) {
+        if (downloadId != 0 && download->id != downloadId) {
+            continue;
+        }
+        if (!_downloads.contains(download)) {
+            // Completed as a side effect of a previous cancel
+            continue;
+        }
 
-    _ackOrNakTimeoutTimer.stop();
-    _advanceStateMachine();
+        switch (download->state) {
+        case StateQueued:
+            _downloadComplete(download, tr("Aborted"));
+            break;
+        case StateOpening:
+            // Session is closed once we know its id
+            download->errorMsg = tr("Aborted");
+            break;
+        case StateReading:
+            _terminateSession(download, tr("Aborted"));
+            break;
+        case StateTerminating:
+            if (download->errorMsg.isEmpty()) {
+                download->errorMsg = tr("Aborted");
+            }
+            break;
+        }
+    }
 }
 
-void FTPManager::_terminateSessionTimeout(void)
+int FTPManager::_activeSessionCount(uint8_t compId) const
 {
-    if (++_downloadState.retryCount > _maxRetry) {
-        qCDebug(FTPManagerLog) << QString("_terminateSessionTimeout retries exceeded");
-        _downloadComplete(tr("Download failed"));
-    } else {
-        // Try again
-        qCDebug(FTPManagerLog) << QString("_terminateSessionTimeout: retrying - retryCount(%1)").arg(_downloadState.retryCount);
-        _terminateSessionBegin();
+    int count = 0;
+    for (const Download_t* download: _downloads) {
+        if (download->compId == compId && download->state != StateQueued) {
+            count++;
+        }
     }
-
+    return count;
 }
 
-void FTPManager::_terminateComplete(void)
+/// Opens sessions for queued downloads while their component has sessions available
+void FTPManager::_startQueuedDownloads(void)
 {
-    _downloadComplete("Aborted");
+    for (Download_t* download: _downloads) {
+        if (download->state == StateQueued && _activeSessionCount(download->compId) < _sessionLimit.value(download->compId, _maxSessionsPerComponent)) {
+            download->retryCount = 0;
+            _openFileRO(download);
+        }
+    }
 }
 
-/// Closes out a download session by writing the file and doing cleanup.
+/// Closes out a download by closing the file and doing cleanup.
 ///     @param errorMsg Error message, empty if no error
-void FTPManager::_downloadComplete(const QString& errorMsg)
+void FTPManager::_downloadComplete(Download_t* download, const QString& errorMsg)
 {
-    qCDebug(FTPManagerLog) << QString("_downloadComplete: errorMsg(%1)").arg(errorMsg);
-    
-    QString downloadFilePath    = _downloadState.toDir.absoluteFilePath(_downloadState.fileName);
-    QString error               = errorMsg;
-
-    _ackOrNakTimeoutTimer.stop();
-    _rgStateMachine.clear();
-    _currentStateMachineIndex = -1;
-    if (_downloadState.file.isOpen()) {
-        _downloadState.file.close();
+    qCDebug(FTPManagerLog) << QString("_downloadComplete: id(%1) errorMsg(%2)").arg(download->id).arg(errorMsg);
+
+    const QString   downloadFilePath    = download->toDir.absoluteFilePath(download->fileName);
+    const int       downloadId          = download->id;
+
+    if (download->file.isOpen()) {
+        download->file.close();
         if (!errorMsg.isEmpty()) {
-            _downloadState.file.remove();
+            download->file.remove();
         }
     }
 
-    emit downloadComplete(downloadFilePath, errorMsg);
+    _downloads.removeOne(download);
+    delete download;
+
+    if (_downloads.isEmpty()) {
+        _ackOrNakTimeoutTimer.stop();
+    }
+
+    emit downloadComplete(downloadFilePath, errorMsg, downloadId);
+
+    // A session may have freed up
+    _startQueuedDownloads();
 }
 
 void FTPManager::_mavlinkMessageReceived(const mavlink_message_t& message)
 {
-    if (message.msgid != MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL ||
-            message.sysid != _vehicle->id() || message.compid != _ftpCompId) {
-        return;
-    }
-
-    if (_currentStateMachineIndex == -1) {
+    if (message.msgid != MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL || message.sysid != _vehicle->id() || _downloads.isEmpty()) {
         return;
     }
 
@@ -188,40 +186,146 @@ void FTPManager::_mavlinkMessageReceived(const mavlink_message_t& message)
     if (data.target_system != qgcId) {
         return;
     }
-    
-    MavlinkFTP::Request* request = (MavlinkFTP::Request*)&data.payload[0];
 
-    // Ignore old/reordered packets (handle wrap-around properly)
-    uint16_t actualIncomingSeqNumber = request->hdr.seqNumber;
-    if ((uint16_t)((_expectedIncomingSeqNumber - 1) - actualIncomingSeqNumber) < (std::numeric_limits<uint16_t>::max()/2)) {
-        qCDebug(FTPManagerLog) << "_mavlinkMessageReceived: Received old packet seqNum expected:actual" << _expectedIncomingSeqNumber << actualIncomingSeqNumber
-                               << "hdr.opcode:hdr.req_opcode" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) <<  MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.req_opcode));
+    const MavlinkFTP::Request*  request         = (const MavlinkFTP::Request*)&data.payload[0];
+    const uint8_t               compId          = message.compid;
+    const uint16_t              seqNumber       = request->hdr.seqNumber;
+    const MavlinkFTP::OpCode_t  requestOpCode   = static_cast<MavlinkFTP::OpCode_t>(request->hdr.req_opcode);
 
-        return;
+    qCDebug(FTPManagerLog) << "_mavlinkMessageReceived: hdr.opcode:hdr.req_opcode:seqNumber:session"
+                           << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) <<  MavlinkFTP::opCodeToString(requestOpCode)
+                           << seqNumber << request->hdr.session;
+
+    // Keep our outgoing sequence numbers ahead of anything the component has used, so they are never mistaken for a resend
+    if (!_nextSeqNumber.contains(compId) || _seqNumberAfter(seqNumber + 1, _nextSeqNumber[compId])) {
+        _nextSeqNumber[compId] = seqNumber + 1;
     }
 
-    qCDebug(FTPManagerLog) << "_mavlinkMessageReceived: hdr.opcode:hdr.req_opcode:seqNumber"
-                           << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) <<  MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.req_opcode))
-                           << request->hdr.seqNumber;
+    for (Download_t* download: _downloads) {
+        if (download->compId != compId) {
+            continue;
+        }
+
+        switch (requestOpCode) {
+        case MavlinkFTP::kCmdOpenFileRO:
+            if (download->state == StateOpening && static_cast<uint16_t>(download->requestSeqNumber + 1) == seqNumber) {
+                _openFileROAckOrNak(download, request);
+                return;
+            }
+            break;
+        case MavlinkFTP::kCmdBurstReadFile:
+            if (download->state == StateReading && download->sessionId == request->hdr.session) {
+                _burstReadFileAckOrNak(download, request);
+                return;
+            }
+            break;
+        case MavlinkFTP::kCmdReadFile:
+            if (download->state == StateReading && download->sessionId == request->hdr.session) {
+                _readFileAckOrNak(download, request);
+                return;
+            }
+            break;
+        case MavlinkFTP::kCmdTerminateSession:
+            if (download->state == StateTerminating && static_cast<uint16_t>(download->requestSeqNumber + 1) == seqNumber) {
+                _terminateSessionAckOrNak(download, request);
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+    }
 
-    (this->*_rgStateMachine[_currentStateMachineIndex].ackNakFn)(request);
+    qCDebug(FTPManagerLog) << "_mavlinkMessageReceived: Disregarding response with no matching request - seqNumber:session" << seqNumber << request->hdr.session;
 }
 
-void FTPManager::_startStateMachine(void)
+/// Checks all outstanding requests of all sessions for timeouts
+void FTPManager::_ackOrNakTimeout(void)
 {
-    _currentStateMachineIndex = -1;
-    _advanceStateMachine();
+    const qint64                now         = _clock.elapsed();
+    const QList<Download_t*>    downloads   = _downloads;
+
+    for (Download_t* download: downloads) {
+        if (!_downloads.contains(download)) {
+            // Completed while handling a previous timeout
+            continue;
+        }
+
+        switch (download->state) {
+        case StateQueued:
+            break;
+
+        case StateOpening:
+            if (now - download->requestSentMSecs > _timeoutMSecs(download, download->retryCount)) {
+                if (++download->retryCount > _maxRetry) {
+                    qCDebug(FTPManagerLog) << "_ackOrNakTimeout: OpenFileRO retries exceeded" << download->id;
+                    _downloadComplete(download, tr("Download failed"));
+                } else {
+                    // Same sequence number so the server can resend its response if only the response was lost
+                    qCDebug(FTPManagerLog) << "_ackOrNakTimeout: OpenFileRO retrying - retryCount" << download->retryCount;
+                    _openFileRO(download);
+                }
+            }
+            break;
+
+        case StateReading:
+            if (download->burstActive && now - download->requestSentMSecs > _timeoutMSecs(download, download->retryCount)) {
+                if (++download->retryCount > _maxRetry) {
+                    qCDebug(FTPManagerLog) << "_ackOrNakTimeout: burst retries exceeded" << download->id;
+                    _terminateSession(download, tr("Download failed"));
+                    break;
+                }
+                qCDebug(FTPManagerLog) << QString("_ackOrNakTimeout: burst retrying - retryCount(%1) offset(%2)").arg(download->retryCount).arg(download->burstOffset);
+                _burstReadFile(download, true /* retry */);
+            }
+            for (auto it = download->reads.begin(); it != download->reads.end(); it++) {
+                Read_t& read = it.value();
+                if (now - read.sentMSecs <= _timeoutMSecs(download, read.retryCount)) {
+                    continue;
+                }
+                if (++read.retryCount > _maxRetry) {
+                    qCDebug(FTPManagerLog) << "_ackOrNakTimeout: read retries exceeded offset" << it.key();
+                    _terminateSession(download, tr("Download failed"));
+                    break;
+                }
+
+                MavlinkFTP::Request request{};
+                request.hdr.session = download->sessionId;
+                request.hdr.opcode  = MavlinkFTP::kCmdReadFile;
+                request.hdr.offset  = it.key();
+                request.hdr.size    = read.size;
+                read.seqNumber      = _sendRequest(download->compId, &request);
+                read.sentMSecs      = now;
+                qCDebug(FTPManagerLog) << QString("_ackOrNakTimeout: read retrying - retryCount(%1) offset(%2)").arg(read.retryCount).arg(it.key());
+            }
+            break;
+
+        case StateTerminating:
+            if (now - download->requestSentMSecs > _timeoutMSecs(download, download->retryCount)) {
+                if (++download->retryCount > _maxRetry) {
+                    // The data is all there, so a lost terminate does not fail the download
+                    qCDebug(FTPManagerLog) << "_ackOrNakTimeout: TerminateSession retries exceeded" << download->id;
+                    _downloadComplete(download, download->errorMsg);
+                } else {
+                    _terminateSession(download, download->errorMsg);
+                }
+            }
+            break;
+        }
+    }
 }
 
-void FTPManager::_advanceStateMachine(void)
+int FTPManager::_timeoutMSecs(const Download_t* download, int retryCount) const
 {
-    _currentStateMachineIndex++;
-    (this->*_rgStateMachine[_currentStateMachineIndex].beginFn)();
+    // Back off on each retry so a slow link is not flooded with resends
+    const int timeout = qMax(_ackOrNakTimeoutMsecs, static_cast<int>(2 * download->rttMSecs));
+    return timeout << qMin(retryCount, 4);
 }
 
-void FTPManager::_ackOrNakTimeout(void)
+void FTPManager::_updateRtt(Download_t* download, qint64 sentMSecs)
 {
-    (this->*_rgStateMachine[_currentStateMachineIndex].timeoutFn)();
+    const double sample = qMax(1.0, static_cast<double>(_clock.elapsed() - sentMSecs));
+    download->rttMSecs = download->rttMSecs == 0 ? sample : (0.875 * download->rttMSecs) + (0.125 * sample);
 }
 
 void FTPManager::_fillRequestDataWithString(MavlinkFTP::Request* request, const QString& str)
@@ -247,349 +351,308 @@ QString FTPManager::_errorMsgFromNak(const MavlinkFTP::Request* nak)
     return errorMsg;
 }
 
-void FTPManager::_openFileROBegin(void)
+void FTPManager::_openFileRO(Download_t* download)
 {
     MavlinkFTP::Request request{};
     request.hdr.session = 0;
     request.hdr.opcode  = MavlinkFTP::kCmdOpenFileRO;
     request.hdr.offset  = 0;
     request.hdr.size    = 0;
-    _fillRequestDataWithString(&request, _downloadState.fullPathOnVehicle);
-    _sendRequestExpectAck(&request);
-}
+    _fillRequestDataWithString(&request, download->fullPathOnVehicle);
 
-void FTPManager::_openFileROTimeout(void)
-{
-    qCDebug(FTPManagerLog) << "_openFileROTimeout";
-    _downloadComplete(tr("Download failed"));
+    download->state             = StateOpening;
+    download->requestSeqNumber  = _sendRequest(download->compId, &request, download->retryCount ? download->requestSeqNumber : -1);
+    download->requestSentMSecs  = _clock.elapsed();
 }
 
-void FTPManager::_openFileROAckOrNak(const MavlinkFTP::Request* ackOrNak)
+void FTPManager::_openFileROAckOrNak(Download_t* download, const MavlinkFTP::Request* ackOrNak)
 {
-    MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
-    if (requestOpCode != MavlinkFTP::kCmdOpenFileRO) {
-        qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack disregarding ack for incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
-        return;
-    }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
-        return;
-    }
-
-    _ackOrNakTimeoutTimer.stop();
-
     if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
-        qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack  - sessionId:openFileLength" << ackOrNak->hdr.session << ackOrNak->openFileLength;
+        qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack - id:sessionId:openFileLength" << download->id << ackOrNak->hdr.session << ackOrNak->openFileLength;
 
         if (ackOrNak->hdr.size != sizeof(uint32_t)) {
             qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack ack->hdr.size != sizeof(uint32_t)" << ackOrNak->hdr.size << sizeof(uint32_t);
-            _downloadComplete(tr("Download failed"));
+            _downloadComplete(download, tr("Download failed"));
             return;
         }
 
-        _downloadState.sessionId        = ackOrNak->hdr.session;
-        _downloadState.fileSize         = ackOrNak->openFileLength;
-        _downloadState.expectedOffset   = 0;
+        _updateRtt(download, download->requestSentMSecs);
+        download->state         = StateReading;
+        download->sessionId     = ackOrNak->hdr.session;
+        download->fileSize      = ackOrNak->openFileLength;
+        download->burstOffset   = 0;
+
+        if (!download->errorMsg.isEmpty()) {
+            // Cancelled while opening
+            _terminateSession(download, download->errorMsg);
+            return;
+        }
 
-        _downloadState.file.setFileName(_downloadState.toDir.filePath(_downloadState.fileName));
-        if (_downloadState.file.open(QFile::WriteOnly | QFile::Truncate)) {
-            _advanceStateMachine();
+        download->file.setFileName(download->toDir.filePath(download->fileName));
+        if (download->file.open(QFile::WriteOnly | QFile::Truncate)) {
+            _burstReadFile(download, false /* retry */);
         } else {
-            qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack _downloadState.file open failed" << _downloadState.file.errorString();
-            _downloadComplete(tr("Download failed"));
+            qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack file open failed" << download->file.errorString();
+            _terminateSession(download, tr("Download failed"));
         }
     } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
-        qCDebug(FTPManagerLog) << "_handlOpenFileROAck: Nak -" << _errorMsgFromNak(ackOrNak);
-        _downloadComplete(tr("Download failed") + ": " + _errorMsgFromNak(ackOrNak));
+        MavlinkFTP::ErrorCode_t errorCode   = static_cast<MavlinkFTP::ErrorCode_t>(ackOrNak->data[0]);
+        int                     otherCount  = _activeSessionCount(download->compId) - 1;
+
+        if (errorCode == MavlinkFTP::kErrNoSessionsAvailable && otherCount > 0) {
+            // Component supports fewer sessions than we tried to use. Wait for one of the others to finish.
+            qCDebug(FTPManagerLog) << "_openFileROAckOrNak: No sessions available, limiting component to" << otherCount;
+            _sessionLimit[download->compId] = otherCount;
+            download->state = StateQueued;
+            return;
+        }
+
+        qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
+        _downloadComplete(download, tr("Download failed") + ": " + _errorMsgFromNak(ackOrNak));
     }
 }
 
-void FTPManager::_burstReadFileWorker(bool firstRequest)
+void FTPManager::_burstReadFile(Download_t* download, bool retry)
 {
-    qCDebug(FTPManagerLog) << "_burstReadFileWorker: starting burst at offset:firstRequest:retryCount" << _downloadState.expectedOffset << firstRequest << _downloadState.retryCount;
+    qCDebug(FTPManagerLog) << "_burstReadFile: starting burst at offset:retry:retryCount" << download->burstOffset << retry << download->retryCount;
 
     MavlinkFTP::Request request{};
-    request.hdr.session = _downloadState.sessionId;
+    request.hdr.session = download->sessionId;
     request.hdr.opcode  = MavlinkFTP::kCmdBurstReadFile;
-    request.hdr.offset  = _downloadState.expectedOffset;
+    request.hdr.offset  = download->burstOffset;
     request.hdr.size    = sizeof(request.data);
 
-    if (firstRequest) {
-        _downloadState.retryCount = 0;
-    } else {
-        // Must used same sequence number as previous request
-        _expectedIncomingSeqNumber -= 2;
+    if (!retry) {
+        download->retryCount = 0;
     }
 
-    _sendRequestExpectAck(&request);
+    download->burstActive       = true;
+    download->requestSeqNumber  = _sendRequest(download->compId, &request);
+    download->burstSeqNumber    = download->requestSeqNumber + 1;
+    download->requestSentMSecs  = _clock.elapsed();
 }
 
-void FTPManager::_burstReadFileBegin(void)
+void FTPManager::_burstReadFileAckOrNak(Download_t* download, const MavlinkFTP::Request* ackOrNak)
 {
-    _burstReadFileWorker(true /* firstRequestr */);
-}
-
-void FTPManager::_burstReadFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
-{
-    MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
-
-    if (requestOpCode != MavlinkFTP::kCmdBurstReadFile) {
-        qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
-        return;
-    }
-    if (ackOrNak->hdr.session != _downloadState.sessionId) {
-        qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: Disregarding due to incorrect session id actual:expected" << ackOrNak->hdr.session << _downloadState.sessionId;
+    if (!download->burstActive || _seqNumberAfter(download->burstSeqNumber, ackOrNak->hdr.seqNumber)) {
+        qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: Disregarding stale burst response seqNumber:expected" << ackOrNak->hdr.seqNumber << download->burstSeqNumber;
         return;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    download->requestSentMSecs = _clock.elapsed();
 
     if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
-        if (ackOrNak->hdr.seqNumber < _expectedIncomingSeqNumber) {
-            qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: Disregarding Ack due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
-            return;
-        }
-
         qCDebug(FTPManagerLog) << QString("_burstReadFileAckOrNak: Ack offset(%1) size(%2) burstComplete(%3)").arg(ackOrNak->hdr.offset).arg(ackOrNak->hdr.size).arg(ackOrNak->hdr.burstComplete);
 
-        if (ackOrNak->hdr.offset != _downloadState.expectedOffset) {
-            if (ackOrNak->hdr.offset > _downloadState.expectedOffset) {
-                // There is a hole in our data, record it as missing and continue on
-                MissingData_t missingData;
-                missingData.offset          = _downloadState.expectedOffset;
-                missingData.cBytesMissing   = ackOrNak->hdr.offset - _downloadState.expectedOffset;
-                _downloadState.rgMissingData.append(missingData);
-                qCDebug(FTPManagerLog) << "_handleBurstReadFileAck: adding missing data offset:cBytesMissing" << missingData.offset << missingData.cBytesMissing;
-            } else {
-                // Offset is past what we have already seen, disregard and wait for something usefule
-                _ackOrNakTimeoutTimer.start();
-                qCDebug(FTPManagerLog) << "_handleBurstReadFileAck: received offset less than expected offset received:expected" << ackOrNak->hdr.offset << _downloadState.expectedOffset;
-                return;
-            }
+        if (ackOrNak->hdr.offset < download->burstOffset) {
+            qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: received offset less than expected offset received:expected" << ackOrNak->hdr.offset << download->burstOffset;
+            return;
+        }
+        if (ackOrNak->hdr.offset > download->burstOffset) {
+            // There is a hole in the burst, re-request it right away while the burst keeps going
+            _addMissing(download, download->burstOffset, ackOrNak->hdr.offset - download->burstOffset);
         }
 
-        _downloadState.file.seek(ackOrNak->hdr.offset);
-        int bytesWritten = _downloadState.file.write((const char*)ackOrNak->data, ackOrNak->hdr.size);
-        if (bytesWritten != ackOrNak->hdr.size) {
-            _downloadComplete(tr("Download failed: Error saving file"));
+        if (!_writeData(download, ackOrNak)) {
             return;
         }
-        _downloadState.bytesWritten += ackOrNak->hdr.size;
-        _downloadState.expectedOffset = ackOrNak->hdr.offset + ackOrNak->hdr.size;
+        download->burstOffset       = ackOrNak->hdr.offset + ackOrNak->hdr.size;
+        download->burstSeqNumber    = ackOrNak->hdr.seqNumber + 1;
+        download->retryCount        = 0;
 
         if (ackOrNak->hdr.burstComplete) {
             // The current burst is done, request next one in offset sequence
-            _expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber;
-            _burstReadFileWorker(true /* firstRequest */);
-        } else {
-            // Still within a burst, next ack should come automatically
-            _expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber + 1;
-            _ackOrNakTimeoutTimer.start();
+            _burstReadFile(download, false /* retry */);
         }
 
+        _fillMissingBlocks(download);
+
         // Emit progress last, as cancel could be called in there
-        if (_downloadState.fileSize != 0) {
-            emit commandProgress((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize);
-        }
+        _emitProgress(download);
     } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
         MavlinkFTP::ErrorCode_t errorCode = static_cast<MavlinkFTP::ErrorCode_t>(ackOrNak->data[0]);
 
         if (errorCode == MavlinkFTP::kErrEOF) {
-            // Burst sequence has gone through the whole file
-            if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-                qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: EOF Nak"
-                    "with incorrect sequence nr actual:expected"
-                    << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
-                /* We have received the EOF Nak but out of sequence, i.e. data is missing */
-                _expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber;
-                _burstReadFileWorker(true); /* Retry from last expected offset */
-            } else {
-                qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak EOF";
-                _advanceStateMachine();
+            if (ackOrNak->hdr.seqNumber != download->burstSeqNumber) {
+                // We have received the EOF Nak but out of sequence, the end of the burst is missing
+                qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: EOF Nak with incorrect sequence nr actual:expected" << ackOrNak->hdr.seqNumber << download->burstSeqNumber;
+                _burstReadFile(download, false /* retry */);
+                return;
             }
-        } else { /* Don't care is this is out of sequence */
+
+            qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak EOF";
+            download->burstActive   = false;
+            download->eofReached    = true;
+            if (download->checksize && download->burstOffset < download->fileSize) {
+                _addMissing(download, download->burstOffset, download->fileSize - download->burstOffset);
+            }
+            _fillMissingBlocks(download);
+            _checkReadComplete(download);
+        } else {
             qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
-            _downloadComplete(tr("Download failed"));
+            _terminateSession(download, tr("Download failed"));
         }
     }
 }
 
-void FTPManager::_burstReadFileTimeout(void)
+void FTPManager::_readFileAckOrNak(Download_t* download, const MavlinkFTP::Request* ackOrNak)
 {
-    if (++_downloadState.retryCount > _maxRetry) {
-        qCDebug(FTPManagerLog) << QString("_burstReadFileTimeout retries exceeded");
-        _downloadComplete(tr("Download failed"));
-    } else {
-        // Try again
-        qCDebug(FTPManagerLog) << QString("_burstReadFileTimeout: retrying - retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(_downloadState.expectedOffset);
-        _burstReadFileWorker(false /* firstReqeust */);
-    }
-}
-
-void FTPManager::_fillMissingBlocksWorker(bool firstRequest)
-{
-    if (_downloadState.rgMissingData.count()) {
-        MavlinkFTP::Request request{};
-        MissingData_t&      missingData = _downloadState.rgMissingData.first();
-
-        uint32_t cBytesToRead = qMin((uint32_t)sizeof(request.data), missingData.cBytesMissing);
+    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
+        auto it = download->reads.find(ackOrNak->hdr.offset);
+        if (it == download->reads.end()) {
+            qCDebug(FTPManagerLog) << "_readFileAckOrNak: Disregarding Ack for offset with no outstanding read" << ackOrNak->hdr.offset;
+            return;
+        }
 
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksBegin: offset:cBytesToRead" << missingData.offset << cBytesToRead;
+        const Read_t read = it.value();
+        download->reads.erase(it);
+        if (read.retryCount == 0) {
+            _updateRtt(download, read.sentMSecs);
+        }
 
-        request.hdr.session                 = _downloadState.sessionId;
-        request.hdr.opcode                  = MavlinkFTP::kCmdReadFile;
-        request.hdr.offset                  = missingData.offset;
-        request.hdr.size                    = cBytesToRead;
+        qCDebug(FTPManagerLog) << "_readFileAckOrNak: Ack offset:size" << ackOrNak->hdr.offset << ackOrNak->hdr.size;
 
-        if (firstRequest) {
-            _downloadState.retryCount = 0;
-        } else {
-            // Must used same sequence number as previous request
-            _expectedIncomingSeqNumber -= 2;
+        if (ackOrNak->hdr.size > read.size) {
+            qCDebug(FTPManagerLog) << "_readFileAckOrNak: Ack larger than requested" << ackOrNak->hdr.size << read.size;
+            _terminateSession(download, tr("Download failed"));
+            return;
+        }
+        if (!_writeData(download, ackOrNak)) {
+            return;
+        }
+        if (ackOrNak->hdr.size < read.size) {
+            _addMissing(download, ackOrNak->hdr.offset + ackOrNak->hdr.size, read.size - ackOrNak->hdr.size);
+        }
+    } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
+        // Naks don't carry the offset, match them up by sequence number
+        auto it = download->reads.begin();
+        while (it != download->reads.end() && static_cast<uint16_t>(it.value().seqNumber + 1) != ackOrNak->hdr.seqNumber) {
+            it++;
+        }
+        if (it == download->reads.end()) {
+            qCDebug(FTPManagerLog) << "_readFileAckOrNak: Disregarding Nak with no outstanding read" << ackOrNak->hdr.seqNumber;
+            return;
         }
-        _downloadState.expectedOffset = request.hdr.offset;
 
-        _sendRequestExpectAck(&request);
-    } else {
-        // We should have the full file now
-        if (_downloadState.checksize == false || _downloadState.bytesWritten == _downloadState.fileSize) {
-            _advanceStateMachine();
+        MavlinkFTP::ErrorCode_t errorCode = static_cast<MavlinkFTP::ErrorCode_t>(ackOrNak->data[0]);
+        if (errorCode == MavlinkFTP::kErrEOF && !download->checksize) {
+            // File is shorter than what we asked for
+            qCDebug(FTPManagerLog) << "_readFileAckOrNak: EOF offset" << it.key();
+            download->reads.erase(it);
         } else {
-            qCDebug(FTPManagerLog) << "_fillMissingBlocksWorker: no missing blocks but file still incomplete - bytesWritten:fileSize" << _downloadState.bytesWritten << _downloadState.fileSize;
-            _downloadComplete(tr("Download failed"));
+            qCDebug(FTPManagerLog) << "_readFileAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
+            _terminateSession(download, tr("Download failed"));
+            return;
         }
     }
+
+    _fillMissingBlocks(download);
+    _checkReadComplete(download);
+
+    // Emit progress last, as cancel could be called in there
+    if (download->state == StateReading) {
+        _emitProgress(download);
+    }
 }
 
-void FTPManager::_fillMissingBlocksBegin(void)
+void FTPManager::_addMissing(Download_t* download, uint32_t offset, uint32_t cBytes)
 {
-    _fillMissingBlocksWorker(true /* firstRequest */);
+    qCDebug(FTPManagerLog) << "_addMissing: offset:cBytesMissing" << offset << cBytes;
+    download->missing[offset] = cBytes;
 }
 
-void FTPManager::_fillMissingBlocksAckOrNak(const MavlinkFTP::Request* ackOrNak)
+/// Requests missing blocks until the read window is full
+void FTPManager::_fillMissingBlocks(Download_t* download)
 {
-    MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
+    while (download->state == StateReading && download->reads.count() < _maxReadsInFlight && !download->missing.isEmpty()) {
+        auto            it              = download->missing.begin();
+        const uint32_t  offset          = it.key();
+        const uint32_t  cBytesMissing   = it.value();
+        download->missing.erase(it);
 
-    if (requestOpCode != MavlinkFTP::kCmdReadFile) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
-        return;
-    }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
-        return;
-    }
-    if (ackOrNak->hdr.session != _downloadState.sessionId) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect session id actual:expected" << ackOrNak->hdr.session << _downloadState.sessionId;
-        return;
-    }
-
-    _ackOrNakTimeoutTimer.stop();
-
-    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Ack offset:size" << ackOrNak->hdr.offset << ackOrNak->hdr.size;
-
-        if (ackOrNak->hdr.offset != _downloadState.expectedOffset) {
-            if (++_downloadState.retryCount > _maxRetry) {
-                qCDebug(FTPManagerLog) << QString("_fillMissingBlocksAckOrNak: offset mismatch, retries exceeded");
-                _downloadComplete(tr("Download failed"));
-                return;
-            }
-
-            // Ask for current offset again
-            qCDebug(FTPManagerLog) << QString("_fillMissingBlocksAckOrNak: Ack offset mismatch retry, retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(_downloadState.expectedOffset);
-            _fillMissingBlocksWorker(false /* firstReqeust */);
-            return;
-        }
-
-        _downloadState.file.seek(ackOrNak->hdr.offset);
-        int bytesWritten = _downloadState.file.write((const char*)ackOrNak->data, ackOrNak->hdr.size);
-        if (bytesWritten != ackOrNak->hdr.size) {
-            _downloadComplete(tr("Download failed: Error saving file"));
-            return;
-        }
-        _downloadState.bytesWritten += ackOrNak->hdr.size;
-
-        MissingData_t& missingData = _downloadState.rgMissingData.first();
-        missingData.offset += ackOrNak->hdr.size;
-        missingData.cBytesMissing -= ackOrNak->hdr.size;
-        if (missingData.cBytesMissing == 0) {
-            // This block is finished, remove it
-            _downloadState.rgMissingData.takeFirst();
+        MavlinkFTP::Request request{};
+        const uint32_t cBytesToRead = qMin(static_cast<uint32_t>(sizeof(request.data)), cBytesMissing);
+        if (cBytesMissing > cBytesToRead) {
+            download->missing[offset + cBytesToRead] = cBytesMissing - cBytesToRead;
         }
 
-        // Move on to fill in possible next hole
-        _fillMissingBlocksWorker(true /* firstReqeust */);
-
-        // Emit progress last, as cancel could be called in there
-        if (_downloadState.fileSize != 0) {
-            emit commandProgress((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize);
-        }
-    } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
-        MavlinkFTP::ErrorCode_t errorCode = static_cast<MavlinkFTP::ErrorCode_t>(ackOrNak->data[0]);
+        qCDebug(FTPManagerLog) << "_fillMissingBlocks: offset:cBytesToRead" << offset << cBytesToRead;
 
-        if (errorCode == MavlinkFTP::kErrEOF) {
-            qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak EOF";
-            if (_downloadState.checksize == false || _downloadState.bytesWritten == _downloadState.fileSize) {
-                // We've successfully complete filling in all missing blocks
-                _advanceStateMachine();
-                return;
-            }
-        }
+        request.hdr.session = download->sessionId;
+        request.hdr.opcode  = MavlinkFTP::kCmdReadFile;
+        request.hdr.offset  = offset;
+        request.hdr.size    = cBytesToRead;
 
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
-        _downloadComplete(tr("Download failed"));
+        Read_t read;
+        read.size       = cBytesToRead;
+        read.retryCount = 0;
+        read.sentMSecs  = _clock.elapsed();
+        read.seqNumber  = _sendRequest(download->compId, &request);
+        download->reads[offset] = read;
     }
-
 }
 
-void FTPManager::_fillMissingBlocksTimeout(void)
+void FTPManager::_checkReadComplete(Download_t* download)
 {
-    if (++_downloadState.retryCount > _maxRetry) {
-        qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout retries exceeded");
-        _downloadComplete(tr("Download failed"));
+    if (download->state != StateReading || !download->eofReached || download->burstActive || !download->missing.isEmpty() || !download->reads.isEmpty()) {
+        return;
+    }
+
+    // We should have the full file now
+    if (download->checksize && download->bytesWritten != download->fileSize) {
+        qCDebug(FTPManagerLog) << "_checkReadComplete: no missing blocks but file still incomplete - bytesWritten:fileSize" << download->bytesWritten << download->fileSize;
+        _terminateSession(download, tr("Download failed"));
     } else {
-        // Ask for current offset again
-        qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout: retrying - retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(_downloadState.expectedOffset);
-        _fillMissingBlocksWorker(false /* firstReqeust */);
+        _terminateSession(download, QString());
     }
 }
 
-void FTPManager::_resetSessionsBegin(void)
+bool FTPManager::_writeData(Download_t* download, const MavlinkFTP::Request* ack)
 {
-    MavlinkFTP::Request request{};
-    request.hdr.opcode  = MavlinkFTP::kCmdResetSessions;
-    request.hdr.size    = 0;
-    _sendRequestExpectAck(&request);
+    download->file.seek(ack->hdr.offset);
+    int bytesWritten = download->file.write((const char*)ack->data, ack->hdr.size);
+    if (bytesWritten != ack->hdr.size) {
+        _terminateSession(download, tr("Download failed: Error saving file"));
+        return false;
+    }
+    download->bytesWritten += ack->hdr.size;
+    return true;
 }
 
-void FTPManager::_resetSessionsAckOrNak(const MavlinkFTP::Request* ackOrNak)
+void FTPManager::_emitProgress(Download_t* download)
 {
-    MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
-
-    if (requestOpCode != MavlinkFTP::kCmdResetSessions) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
-        return;
+    if (download->fileSize != 0) {
+        emit commandProgress((float)(download->bytesWritten) / (float)download->fileSize, download->id);
     }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_resetSessionsAckOrNak: Disregarding due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
-        return;
+}
+
+/// Closes our session on the component. Only our own session is closed since other downloads may be using the component.
+///     @param errorMsg Error to report once the session is closed, empty for success
+void FTPManager::_terminateSession(Download_t* download, const QString& errorMsg)
+{
+    if (download->state != StateTerminating) {
+        download->retryCount = 0;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    download->state             = StateTerminating;
+    download->errorMsg          = errorMsg;
+    download->burstActive       = false;
+    download->reads.clear();
+    download->missing.clear();
 
-    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
-        qCDebug(FTPManagerLog) << "_resetSessionsAckOrNak: Ack";
-        _advanceStateMachine();
-    } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
-        qCDebug(FTPManagerLog) << "_resetSessionsAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
-        _downloadComplete(QString());
-    }
+    MavlinkFTP::Request request{};
+    request.hdr.session = download->sessionId;
+    request.hdr.opcode  = MavlinkFTP::kCmdTerminateSession;
+    download->requestSeqNumber = _sendRequest(download->compId, &request, download->retryCount ? download->requestSeqNumber : -1);
+    download->requestSentMSecs = _clock.elapsed();
 }
 
-void FTPManager::_resetSessionsTimeout(void)
+void FTPManager::_terminateSessionAckOrNak(Download_t* download, const MavlinkFTP::Request* ackOrNak)
 {
-    qCDebug(FTPManagerLog) << "_resetSessionsTimeout";
-    _downloadComplete(QString());
+    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
+        qCDebug(FTPManagerLog) << "_terminateSessionAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
+    }
+    _downloadComplete(download, download->errorMsg);
 }
 
 void FTPManager::_emitErrorMessage(const QString& msg)
@@ -598,21 +661,25 @@ void FTPManager::_emitErrorMessage(const QString& msg)
     emit commandError(msg);
 }
 
-void FTPManager::_sendRequestExpectAck(MavlinkFTP::Request* request)
+/// Sends the request to the component
+///     @param seqNumber Sequence number to use for a resend, -1 to use the next one
+/// @return Sequence number the request was sent with
+uint16_t FTPManager::_sendRequest(uint8_t compId, MavlinkFTP::Request* request, int seqNumber)
 {
-    _ackOrNakTimeoutTimer.start();
-    
+    if (seqNumber == -1) {
+        seqNumber = _nextSeqNumber.value(compId, 0);
+        _nextSeqNumber[compId] = static_cast<uint16_t>(seqNumber + 2);  // Skip over the sequence number of the response
+    }
+    request->hdr.seqNumber = static_cast<uint16_t>(seqNumber);
+
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
 
     if (weakLink.expired()) {
-        qCDebug(FTPManagerLog) << "_sendRequestExpectAck No primary link. Allowing timeout to fail sequence.";
+        qCDebug(FTPManagerLog) << "_sendRequest No primary link. Allowing timeout to fail sequence.";
     } else {
         SharedLinkInterfacePtr sharedLink = weakLink.lock();
 
-        request->hdr.seqNumber = _expectedIncomingSeqNumber + 1;    // Outgoing is 1 past last incoming
-        _expectedIncomingSeqNumber += 2;
-
-        qCDebug(FTPManagerLog) << "_sendRequestExpectAck opcode:" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) << "seqNumber:" << request->hdr.seqNumber;
+        qCDebug(FTPManagerLog) << "_sendRequest opcode:" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) << "seqNumber:" << request->hdr.seqNumber << "session:" << request->hdr.session;
 
         mavlink_message_t message;
         mavlink_msg_file_transfer_protocol_pack_chan(qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
@@ -621,10 +688,12 @@ void FTPManager::_sendRequestExpectAck(MavlinkFTP::Request* request)
                                                      &message,
                                                      0,                                                     // Target network, 0=broadcast?
                                                      _vehicle->id(),
-                                                     _ftpCompId,
+                                                     compId,
                                                      (uint8_t*)request);                                    // Payload
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
     }
+
+    return request->hdr.seqNumber;
 }
 
 bool FTPManager::_parseURI(uint8_t fromCompId, const QString& uri, QString& parsedURI, uint8_t& compId)
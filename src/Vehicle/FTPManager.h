@@ -12,7 +12,10 @@
 #include <QObject>
 #include <QDir>
 #include <QTimer>
-#include <QQueue>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMap>
+#include <QList>
 
 #include "QGCLoggingCategory.h"
 #include "QGCMAVLink.h"
@@ -21,12 +24,19 @@ Q_DECLARE_LOGGING_CATEGORY(FTPManagerLog)
 
 class Vehicle;
 
+/// MAVLink FTP client.
+///
+/// Any number of downloads can be requested at the same time. Each download runs in its own FTP session, with up to
+/// _maxSessionsPerComponent sessions open against a single component. Downloads which can't get a session wait in a
+/// queue until one frees up. Within a session the file is streamed with burst reads. Holes in a burst are re-requested
+/// with individual reads as soon as they are seen, with up to _maxReadsInFlight reads outstanding while the burst
+/// keeps going. Data is written to the output file as it arrives.
 class FTPManager : public QObject
 {
     Q_OBJECT
 
     friend class Vehicle;
-    
+
 public:
     FTPManager(Vehicle* vehicle);
 
@@ -41,117 +51,115 @@ public:
     ///                       and the indicated filesize from MAVFTP fileopen response is ignored.
     ///                       This is used for the APM parameter download where the filesize is wrong due to
     ///                       a dynamic file creation on the vehicle.
-    /// @return true: download has started, false: error, no download
+    /// @return Id of the download which is passed to downloadComplete and commandProgress, 0: error, no download
     /// Signals downloadComplete, commandError, commandProgress
-    bool download(uint8_t fromCompId, const QString& fromURI, const QString& toDir, const QString& fileName="", bool checksize = true);
+    int download(uint8_t fromCompId, const QString& fromURI, const QString& toDir, const QString& fileName="", bool checksize = true);
+
+    /// Cancel the specified download, or all downloads if downloadId is 0.
+    /// This will emit downloadComplete() for each download which was in progress
+    void cancel(int downloadId = 0);
 
-    /// Cancel the current operation
-    /// This will emit downloadComplete() when done, and if there's currently a download in progress
-    void cancel();
+    /// @return Number of downloads which are transferring or waiting for a session
+    int activeDownloadCount(void) const { return _downloads.count(); }
 
     static const char* mavlinkFTPScheme;
 
 signals:
-    void downloadComplete(const QString& file, const QString& errorMsg);
-    
+    void downloadComplete(const QString& file, const QString& errorMsg, int downloadId);
+
     // Signals associated with all commands
-    
+
     /// Signalled after a command has completed
     void commandComplete(void);
-    
+
     void commandError(const QString& msg);
-    
+
     /// Signalled during a lengthy command to show progress
     ///     @param value Amount of progress: 0.0 = none, 1.0 = complete
-    void commandProgress(float value);
-	
+    void commandProgress(float value, int downloadId);
+
 private slots:
     void _ackOrNakTimeout(void);
 
 private:
-    typedef void (FTPManager::*StateBeginFn)            (void);
-    typedef void (FTPManager::*StateAckNakFn)    (const MavlinkFTP::Request* ackOrNak);
-    typedef void (FTPManager::*StateTimeoutFn)          (void);
-
-    struct StateFunctions_t {
-        StateBeginFn    beginFn;
-        StateAckNakFn   ackNakFn;
-        StateTimeoutFn  timeoutFn;
-    };
-
-    struct MissingData_t {
-        uint32_t offset;
-        uint32_t cBytesMissing;
+    typedef enum {
+        StateQueued,        ///< Waiting for a free session
+        StateOpening,       ///< OpenFileRO sent
+        StateReading,       ///< Burst and gap fill reads
+        StateTerminating,   ///< TerminateSession sent
+    } State_t;
+
+    struct Read_t {
+        uint16_t    seqNumber;
+        uint32_t    size;
+        qint64      sentMSecs;
+        int         retryCount;
     };
 
-    struct DownloadState_t {
-        uint8_t                 sessionId;
-        uint32_t                expectedOffset;         ///< offset which should be coming next
-        uint32_t                bytesWritten;
-        QList<MissingData_t>    rgMissingData;
-        QString                 fullPathOnVehicle;      ///< Fully qualified path to file on vehicle
-        QDir                    toDir;                  ///< Directory to download file to
-        QString                 fileName;               ///< Filename (no path) for download file
-        uint32_t                fileSize;               ///< Size of file being downloaded
-        QFile                   file;
-        int                     retryCount;
-        bool                    checksize;
-
-        bool inProgress() const { return fileSize > 0; }
-
-        void reset() {
-            sessionId       = 0;
-            expectedOffset  = 0;
-            bytesWritten    = 0;
-            retryCount      = 0;
-            fileSize        = 0;
-            fullPathOnVehicle.clear();
-            fileName.clear();
-            rgMissingData.clear();
-            file.close();
-        }
+    struct Download_t {
+        int                         id;
+        uint8_t                     compId;
+        QString                     fullPathOnVehicle;      ///< Fully qualified path to file on vehicle
+        QDir                        toDir;                  ///< Directory to download file to
+        QString                     fileName;               ///< Filename (no path) for download file
+        bool                        checksize;
+        State_t                     state           = StateQueued;
+        uint8_t                     sessionId       = 0;
+        uint32_t                    fileSize        = 0;    ///< Size of file being downloaded
+        uint32_t                    bytesWritten    = 0;
+        QFile                       file;
+
+        // Outstanding open, burst or terminate request
+        uint16_t                    requestSeqNumber    = 0;
+        qint64                      requestSentMSecs    = 0;
+        int                         retryCount          = 0;
+
+        uint32_t                    burstOffset     = 0;    ///< Offset the current burst continues from
+        uint16_t                    burstSeqNumber  = 0;    ///< Sequence number expected for next burst packet
+        bool                        burstActive     = false;
+        bool                        eofReached      = false;
+
+        QMap<uint32_t, uint32_t>    missing;                ///< Holes not yet re-requested, Key: offset, Value: byte count
+        QMap<uint32_t, Read_t>      reads;                  ///< Outstanding gap fill reads, Key: offset
+        double                      rttMSecs        = 0;    ///< Smoothed round trip time, 0 for no samples yet
+        QString                     errorMsg;               ///< Set when cancelled, reported once the session is closed
     };
 
-
-    void    _mavlinkMessageReceived     (const mavlink_message_t& message);
-    void    _startStateMachine          (void);
-    void    _advanceStateMachine        (void);
-    void    _openFileROBegin            (void);
-    void    _openFileROAckOrNak         (const MavlinkFTP::Request* ackOrNak);
-    void    _openFileROTimeout          (void);
-    void    _burstReadFileBegin         (void);
-    void    _burstReadFileAckOrNak      (const MavlinkFTP::Request* ackOrNak);
-    void    _burstReadFileTimeout       (void);
-    void    _fillMissingBlocksBegin     (void);
-    void    _fillMissingBlocksAckOrNak  (const MavlinkFTP::Request* ackOrNak);
-    void    _fillMissingBlocksTimeout   (void);
-    void    _resetSessionsBegin         (void);
-    void    _resetSessionsAckOrNak      (const MavlinkFTP::Request* ackOrNak);
-    void    _resetSessionsTimeout       (void);
-    QString _errorMsgFromNak            (const MavlinkFTP::Request* nak);
-    void    _sendRequestExpectAck       (MavlinkFTP::Request* request);
-    void    _downloadCompleteNoError    (void) { _downloadComplete(QString()); }
-    void    _downloadComplete           (const QString& errorMsg);
-    void    _emitErrorMessage           (const QString& msg);
-    void    _fillRequestDataWithString(MavlinkFTP::Request* request, const QString& str);
-    void    _fillMissingBlocksWorker    (bool firstRequest);
-    void    _burstReadFileWorker        (bool firstRequest);
-    bool    _parseURI                   (uint8_t fromCompId, const QString& uri, QString& parsedURI, uint8_t& compId);
-
-    void    _terminateSessionBegin      (void);
-    void    _terminateSessionAckOrNak   (const MavlinkFTP::Request* ackOrNak);
-    void    _terminateSessionTimeout    (void);
-    void    _terminateComplete          (void);
+    void        _mavlinkMessageReceived     (const mavlink_message_t& message);
+    void        _startQueuedDownloads       (void);
+    void        _openFileRO                 (Download_t* download);
+    void        _openFileROAckOrNak         (Download_t* download, const MavlinkFTP::Request* ackOrNak);
+    void        _burstReadFile              (Download_t* download, bool retry);
+    void        _burstReadFileAckOrNak      (Download_t* download, const MavlinkFTP::Request* ackOrNak);
+    void        _readFileAckOrNak           (Download_t* download, const MavlinkFTP::Request* ackOrNak);
+    void        _fillMissingBlocks          (Download_t* download);
+    void        _addMissing                 (Download_t* download, uint32_t offset, uint32_t cBytes);
+    void        _checkReadComplete          (Download_t* download);
+    void        _terminateSession           (Download_t* download, const QString& errorMsg);
+    void        _terminateSessionAckOrNak   (Download_t* download, const MavlinkFTP::Request* ackOrNak);
+    bool        _writeData                  (Download_t* download, const MavlinkFTP::Request* ack);
+    void        _emitProgress               (Download_t* download);
+    void        _updateRtt                  (Download_t* download, qint64 sentMSecs);
+    int         _timeoutMSecs               (const Download_t* download, int retryCount) const;
+    int         _activeSessionCount         (uint8_t compId) const;
+    QString     _errorMsgFromNak            (const MavlinkFTP::Request* nak);
+    uint16_t    _sendRequest                (uint8_t compId, MavlinkFTP::Request* request, int seqNumber = -1);
+    void        _downloadComplete           (Download_t* download, const QString& errorMsg);
+    void        _emitErrorMessage           (const QString& msg);
+    void        _fillRequestDataWithString  (MavlinkFTP::Request* request, const QString& str);
+    bool        _parseURI                   (uint8_t fromCompId, const QString& uri, QString& parsedURI, uint8_t& compId);
 
     Vehicle*                _vehicle;
-    uint8_t                 _ftpCompId = MAV_COMP_ID_AUTOPILOT1;
-    QList<StateFunctions_t> _rgStateMachine;
-    DownloadState_t         _downloadState;
+    QList<Download_t*>      _downloads;                 ///< In request order
+    QMap<uint8_t, uint16_t> _nextSeqNumber;             ///< Key: component id, Value: sequence number for next outgoing request
+    QMap<uint8_t, int>      _sessionLimit;              ///< Key: component id, Value: session limit learned from kErrNoSessionsAvailable
     QTimer                  _ackOrNakTimeoutTimer;
-    int                     _currentStateMachineIndex   = -1;
-    uint16_t                _expectedIncomingSeqNumber  = 0;
-    
-    static const int _ackOrNakTimeoutMsecs  = 1000;
-    static const int _maxRetry              = 3;
+    QElapsedTimer           _clock;
+    int                     _nextDownloadId             = 1;
+    int                     _ackOrNakTimeoutMsecs;
+
+    static const int _defaultAckOrNakTimeoutMsecs   = 1000;
+    static const int _maxRetry                      = 3;
+    static const int _maxSessionsPerComponent       = 3;
+    static const int _maxReadsInFlight              = 8;
 };
-
@@ -17,6 +17,7 @@
 #include "QGCCorePlugin.h"
 #include "QGCOptions.h"
 #include "LinkManager.h"
+#include "FactGroupUpdateScheduler.h"
 
 #if defined (Q_OS_IOS) || defined(Q_OS_ANDROID)
 #include "MobileScreenMgr.h"
@@ -63,6 +64,12 @@ void MultiVehicleManager::setToolbox(QGCToolbox *toolbox)
         _gcsHeartbeatTimer.start();
     }
 
+    Fact* telemetryDisplayRate = _toolbox->settingsManager()->appSettings()->telemetryDisplayRate();
+    FactGroupUpdateScheduler::instance()->setFrameRate(telemetryDisplayRate->rawValue().toInt());
+    connect(telemetryDisplayRate, &Fact::rawValueChanged, this, [](QVariant value) {
+        FactGroupUpdateScheduler::instance()->setFrameRate(value.toInt());
+    });
+
     _offlineEditingVehicle = new Vehicle(Vehicle::MAV_AUTOPILOT_TRACK, Vehicle::MAV_TYPE_TRACK, _firmwarePluginManager, this);
 }
 
@@ -10,6 +10,25 @@
 #include "TrajectoryPoints.h"
 #include "Vehicle.h"
 
+#include <QPointF>
+#include <QtMath>
+
+#include <limits>
+
+/// @return Distance from point to the segment between start and end
+static double _distanceToSegment(const QPointF& point, const QPointF& start, const QPointF& end)
+{
+    const QPointF   segment         = end - start;
+    const double    lengthSquared   = QPointF::dotProduct(segment, segment);
+    double          fraction        = 0;
+
+    if (lengthSquared > 0) {
+        fraction = qBound(0.0, QPointF::dotProduct(point - start, segment) / lengthSquared, 1.0);
+    }
+    const QPointF offset = point - (start + (segment * fraction));
+    return qSqrt(QPointF::dotProduct(offset, offset));
+}
+
 TrajectoryPoints::TrajectoryPoints(Vehicle* vehicle, QObject* parent)
     : QObject       (parent)
     , _vehicle      (vehicle)
@@ -17,6 +36,48 @@ TrajectoryPoints::TrajectoryPoints(Vehicle* vehicle, QObject* parent)
 {
 }
 
+double TrajectoryPoints::levelTolerance(int level)
+{
+    return level <= 0 ? 0 : _distanceTolerance * (1 << (2 * level));
+}
+
+void TrajectoryPoints::setResolution(double resolution)
+{
+    if (resolution != _resolution) {
+        const int oldLevel = _level();
+        _resolution = resolution;
+        emit resolutionChanged(_resolution);
+        if (_level() != oldLevel) {
+            _updateListedCount();
+            emit pointsReset();
+        }
+    }
+}
+
+/// @return Coarsest simplification level whose error isn't visible at the current resolution
+int TrajectoryPoints::_level(void) const
+{
+    int level = 0;
+    while (level < levelCount - 1 && levelTolerance(level + 1) <= _resolution) {
+        level++;
+    }
+    return level;
+}
+
+QVariantList TrajectoryPoints::list(void) const
+{
+    const double tolerance = levelTolerance(_level());
+
+    QVariantList points;
+    for (int i=0; i<_points.count(); i++) {
+        // Points which haven't been simplified yet are always part of the trail
+        if (i >= _simplifiedCount || _points[i].tolerance >= tolerance) {
+            points.append(QVariant::fromValue(_unpackPoint(_points[i])));
+        }
+    }
+    return points;
+}
+
 void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
 {
     // The goal of this algorithm is to limit the number of trajectory points whic represent the vehicle path.
@@ -33,22 +94,168 @@ void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
                 // The new position IS NOT colinear with the last segment. Append the new position to the list.
                 _lastAzimuth = _lastPoint.azimuthTo(coordinate);
                 _lastPoint = coordinate;
-                _points.append(QVariant::fromValue(coordinate));
-                emit pointAdded(coordinate);
+                _append(coordinate);
             } else {
                 // The new position IS colinear with the last segment. Don't add a new point, just update
                 // the last point to be the new position.
                 _lastPoint = coordinate;
-                _points[_points.count() - 1] = QVariant::fromValue(coordinate);
+                _points.last() = _packPoint(coordinate);
                 emit updateLastPoint(coordinate);
             }
         }
     } else {
         // Add the very first trajectory point to the list
         _lastPoint = coordinate;
-        _points.append(QVariant::fromValue(coordinate));
-        emit pointAdded(coordinate);
+        _append(coordinate);
+    }
+}
+
+void TrajectoryPoints::_append(const QGeoCoordinate& coordinate)
+{
+    _points.append(_packPoint(coordinate));
+    emit pointAdded(coordinate);
+
+    // The last point can still move, so a block is only simplified once there is a point after it
+    if (_points.count() >= qMax(0, _simplifiedCount - 1) + blockSize + 2) {
+        _simplifyBlock();
+    }
+    if (_points.count() > maxPoints) {
+        _compact();
+        _updateListedCount();
+        emit pointsReset();
+    }
+}
+
+/// Assigns the Douglas-Peucker tolerance to the points of the next block. The ends of the block are always kept, so
+/// only the inner points of the block can drop out of list() and just that range is signalled through pointsReplaced.
+void TrajectoryPoints::_simplifyBlock(void)
+{
+    const int first = qMax(0, _simplifiedCount - 1);
+    const int last  = first + blockSize;
+
+    // A flat projection around the start of the block is accurate enough for the distances involved
+    const Point_t&  origin              = _points[first];
+    const double    metersPerDegE7Lat   = 111319.49 * 1e-7;
+    const double    metersPerDegE7Lon   = metersPerDegE7Lat * qCos(qDegreesToRadians(origin.latitude * 1e-7));
+    QVector<QPointF> positions(blockSize + 1);
+    for (int i=0; i<=blockSize; i++) {
+        const Point_t& point = _points[first + i];
+        qint64 lonDelta = static_cast<qint64>(point.longitude) - origin.longitude;
+        if (lonDelta > 1800000000LL) {
+            lonDelta -= 3600000000LL;
+        } else if (lonDelta < -1800000000LL) {
+            lonDelta += 3600000000LL;
+        }
+        positions[i] = QPointF(lonDelta * metersPerDegE7Lon, (static_cast<qint64>(point.latitude) - origin.latitude) * metersPerDegE7Lat);
     }
+
+    struct Segment_t {
+        int     start;
+        int     end;
+        float   tolerance;
+    };
+
+    // A point keeps at most the tolerance of the segment it splits, so each level is a subset of the finer ones
+    _points[first].tolerance    = std::numeric_limits<float>::max();
+    _points[last].tolerance     = std::numeric_limits<float>::max();
+    QVector<Segment_t> segments = { { 0, blockSize, std::numeric_limits<float>::max() } };
+    while (!segments.isEmpty()) {
+        const Segment_t segment = segments.takeLast();
+        if (segment.end - segment.start < 2) {
+            continue;
+        }
+
+        int     splitIndex      = segment.start + 1;
+        double  splitDistance   = -1;
+        for (int i=segment.start+1; i<segment.end; i++) {
+            const double distance = _distanceToSegment(positions[i], positions[segment.start], positions[segment.end]);
+            if (distance > splitDistance) {
+                splitDistance = distance;
+                splitIndex = i;
+            }
+        }
+
+        const float tolerance = qMin(segment.tolerance, static_cast<float>(splitDistance));
+        _points[first + splitIndex].tolerance = tolerance;
+        segments.append({ segment.start, splitIndex, tolerance });
+        segments.append({ splitIndex, segment.end, tolerance });
+    }
+
+    // The start of the block is the last listed point of the previous block, or the first point of the trail
+    const int       listFirst       = _simplifiedCount == 0 ? 1 : _listedCount;
+    const double    levelTolerance  = TrajectoryPoints::levelTolerance(_level());
+    QVariantList    coordinates;
+    for (int i=first+1; i<last; i++) {
+        if (_points[i].tolerance >= levelTolerance) {
+            coordinates.append(QVariant::fromValue(_unpackPoint(_points[i])));
+        }
+    }
+
+    _simplifiedCount    = last + 1;
+    _listedCount        = listFirst + coordinates.count() + 1;
+    if (coordinates.count() != blockSize - 1) {
+        emit pointsReplaced(listFirst, blockSize - 1, coordinates);
+    }
+}
+
+/// Bounds storage. The newer half of the trail keeps its detail, the older half is simplified with the finest level
+/// which gets the trail below 3/4 of maxPoints. If that isn't enough the oldest points are dropped.
+void TrajectoryPoints::_compact(void)
+{
+    const int oldCount      = _simplifiedCount / 2;
+    const int newCount      = _points.count() - oldCount;
+    const int targetCount   = maxPoints * 3 / 4;
+
+    int level       = 1;
+    int keptCount   = 0;
+    for (; level < levelCount; level++) {
+        keptCount = 0;
+        for (int i=0; i<oldCount; i++) {
+            if (_points[i].tolerance >= levelTolerance(level)) {
+                keptCount++;
+            }
+        }
+        if (keptCount + newCount <= targetCount) {
+            break;
+        }
+    }
+    const double    tolerance   = levelTolerance(qMin(level, levelCount - 1));
+    const int       dropCount   = qMax(0, keptCount + newCount - targetCount);
+
+    int j = 0;
+    int oldIndex = 0;
+    for (int i=0; i<oldCount; i++) {
+        if (_points[i].tolerance >= tolerance && oldIndex++ >= dropCount) {
+            _points[j++] = _points[i];
+        }
+    }
+    for (int i=oldCount; i<_points.count(); i++) {
+        _points[j++] = _points[i];
+    }
+    _simplifiedCount -= _points.count() - j;
+    _points.resize(j);
+}
+
+void TrajectoryPoints::_updateListedCount(void)
+{
+    const double tolerance = levelTolerance(_level());
+
+    _listedCount = 0;
+    for (int i=0; i<_simplifiedCount; i++) {
+        if (_points[i].tolerance >= tolerance) {
+            _listedCount++;
+        }
+    }
+}
+
+TrajectoryPoints::Point_t TrajectoryPoints::_packPoint(const QGeoCoordinate& coordinate)
+{
+    return { qRound(coordinate.latitude() * 1e7), qRound(coordinate.longitude() * 1e7), std::numeric_limits<float>::max() };
+}
+
+QGeoCoordinate TrajectoryPoints::_unpackPoint(const Point_t& point)
+{
+    return QGeoCoordinate(point.latitude * 1e-7, point.longitude * 1e-7);
 }
 
 void TrajectoryPoints::start(void)
@@ -65,6 +272,8 @@ void TrajectoryPoints::stop(void)
 void TrajectoryPoints::clear(void)
 {
     _points.clear();
+    _simplifiedCount = 0;
+    _listedCount = 0;
     _lastPoint = QGeoCoordinate();
     _lastAzimuth = qQNaN();
     emit pointsCleared();
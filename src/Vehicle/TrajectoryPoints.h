@@ -12,9 +12,18 @@
 #include "QmlObjectListModel.h"
 
 #include <QGeoCoordinate>
+#include <QVector>
 
 class Vehicle;
 
+/// Flight trail of a vehicle.
+///
+/// Points are stored packed as int32 degE7 latitude/longitude. Once a block of points is no longer at the end of the
+/// trail, each of its points is assigned the Douglas-Peucker tolerance at which it would be dropped. list() returns
+/// the trail simplified for the current map resolution, so the number of points drawn follows the zoom level instead
+/// of the flight duration. Storage is bounded to maxPoints by dropping the finest detail of the oldest part of the
+/// trail first. Simplifying a block only signals the range of list() it replaced, the whole list only changes with the
+/// simplification level or when storage is compacted.
 class TrajectoryPoints : public QObject
 {
     Q_OBJECT
@@ -22,27 +31,63 @@ class TrajectoryPoints : public QObject
 public:
     TrajectoryPoints(Vehicle* vehicle, QObject* parent = nullptr);
 
-    Q_INVOKABLE QVariantList list(void) const { return _points; }
+    Q_PROPERTY(double resolution READ resolution WRITE setResolution NOTIFY resolutionChanged)  ///< Map resolution in meters per pixel
+
+    /// @return Trail simplified for the current resolution
+    Q_INVOKABLE QVariantList list(void) const;
+
+    double  resolution      (void) const { return _resolution; }
+    void    setResolution   (double resolution);
+
+    /// @return Number of points held, regardless of resolution
+    int     count           (void) const { return _points.count(); }
 
     void start  (void);
     void stop   (void);
 
+    static constexpr int maxPoints  = 20000;
+    static constexpr int blockSize  = 256;  ///< Points simplified together
+    static constexpr int levelCount = 8;    ///< Simplification levels, each with 4 times the tolerance of the previous
+
+    /// @return Douglas-Peucker tolerance in meters of the simplification level, 0 for the full trail
+    static double levelTolerance(int level);
+
 public slots:
     void clear  (void);
 
 signals:
-    void pointAdded     (QGeoCoordinate coordinate);
-    void updateLastPoint(QGeoCoordinate coordinate);
-    void pointsCleared  (void);
+    void pointAdded         (QGeoCoordinate coordinate);
+    void updateLastPoint    (QGeoCoordinate coordinate);
+    void pointsCleared      (void);
+    void pointsReplaced     (int first, int count, QVariantList coordinates); ///< count points of list() from first were replaced, never by more points
+    void pointsReset        (void);                         ///< Points other than the last one changed, list() must be reloaded
+    void resolutionChanged  (double resolution);
 
 private slots:
     void _vehicleCoordinateChanged(QGeoCoordinate coordinate);
 
 private:
-    Vehicle*        _vehicle;
-    QVariantList    _points;
-    QGeoCoordinate  _lastPoint;
-    double          _lastAzimuth;
+    struct Point_t {
+        qint32  latitude;                   ///< degE7
+        qint32  longitude;                  ///< degE7
+        float   tolerance;                  ///< Largest Douglas-Peucker tolerance which keeps the point, meters
+    };
+
+    void            _append             (const QGeoCoordinate& coordinate);
+    void            _simplifyBlock      (void);
+    void            _compact            (void);
+    void            _updateListedCount  (void);
+    int             _level              (void) const;
+    static Point_t  _packPoint          (const QGeoCoordinate& coordinate);
+    static QGeoCoordinate _unpackPoint  (const Point_t& point);
+
+    Vehicle*            _vehicle;
+    QVector<Point_t>    _points;
+    int                 _simplifiedCount =  0;          ///< Points at the start of _points whose tolerance is known
+    int                 _listedCount =      0;          ///< Points of the first _simplifiedCount which list() returns
+    double              _resolution =       0;
+    QGeoCoordinate      _lastPoint;
+    double              _lastAzimuth;
 
     static constexpr double _distanceTolerance = 2.0;
     static constexpr double _azimuthTolerance = 1.5;
@@ -141,7 +141,7 @@ Vehicle::Vehicle(LinkInterface*             link,
     _mavlink = _toolbox->mavlinkProtocol();
     qCDebug(VehicleLog) << "Link started with Mavlink " << (_mavlink->getCurrentVersion() >= 200 ? "V2" : "V1");
 
-    connect(_mavlink, &MAVLinkProtocol::messageReceived,        this, &Vehicle::_mavlinkMessageReceived);
+    connect(_mavlink, &MAVLinkProtocol::messageBatchReceived,   this, &Vehicle::_mavlinkMessageBatchReceived);
     connect(_mavlink, &MAVLinkProtocol::mavlinkMessageStatus,   this, &Vehicle::_mavlinkMessageStatus);
 
     connect(this, &Vehicle::flightModeChanged,          this, &Vehicle::_handleFlightModeChanged);
@@ -378,6 +378,9 @@ void Vehicle::_commonInit()
 
     // Build FactGroup object model
 
+    // The message dispatch table is rebuilt on next use whenever a FactGroup is added, batteries are added dynamically
+    connect(this, &FactGroup::factGroupNamesChanged, this, [this]() { _factGroupMessageHandlersDirty = true; });
+
     _addFact(&_rollFact,                _rollFactName);
     _addFact(&_pitchFact,               _pitchFactName);
     _addFact(&_headingFact,             _headingFactName);
@@ -555,22 +558,54 @@ void Vehicle::resetCounters()
     _heardFrom          = false;
 }
 
-void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+void Vehicle::_mavlinkMessageBatchReceived(LinkInterface* link, const MAVLinkMessageBatch& batch)
 {
     // If the link is already running at Mavlink V2 set our max proto version to it.
     unsigned mavlinkVersion = _mavlink->getCurrentVersion();
     if (_maxProtoVersion != mavlinkVersion && mavlinkVersion >= 200) {
         _maxProtoVersion = mavlinkVersion;
-        qCDebug(VehicleLog) << "_mavlinkMessageReceived Link already running Mavlink v2. Setting _maxProtoVersion" << _maxProtoVersion;
+        qCDebug(VehicleLog) << "_mavlinkMessageBatchReceived Link already running Mavlink v2. Setting _maxProtoVersion" << _maxProtoVersion;
     }
 
-    if (message.sysid != _id && message.sysid != 0) {
-        // We allow RADIO_STATUS messages which come from a link the vehicle is using to pass through and be handled
-        if (!(message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _vehicleLinkManager->containsLink(link))) {
-            return;
+    // Messages for other vehicles are filtered out here, before paying for the per message copy below
+    for (const mavlink_message_t& message : batch) {
+        if (message.sysid != _id && message.sysid != 0) {
+            // We allow RADIO_STATUS messages which come from a link the vehicle is using to pass through and be handled
+            if (!(message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _vehicleLinkManager->containsLink(link))) {
+                continue;
+            }
+        }
+        QElapsedTimer dispatchTimer;
+        dispatchTimer.start();
+        _mavlinkMessageReceived(link, message);
+
+        MessageDispatchStats_t& stats = _messageDispatchStats[message.msgid];
+        stats.count++;
+        stats.nsecs += static_cast<quint64>(dispatchTimer.nsecsElapsed());
+    }
+}
+
+void Vehicle::_updateFactGroupMessageHandlers()
+{
+    _factGroupMessageHandlers.clear();
+    _factGroupAllMessageHandlers.clear();
+
+    for (FactGroup* factGroup : factGroups()) {
+        const QList<uint32_t>& msgids = factGroup->handledMessageIds();
+        if (msgids.isEmpty()) {
+            _factGroupAllMessageHandlers.append(factGroup);
+        } else {
+            for (uint32_t msgid : msgids) {
+                _factGroupMessageHandlers[msgid].append(factGroup);
+            }
         }
     }
 
+    _factGroupMessageHandlersDirty = false;
+}
+
+void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+{
     // We give the link manager first whack since it it reponsible for adding new links
     _vehicleLinkManager->mavlinkMessageReceived(link, message);
 
@@ -623,10 +658,19 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     // Battery fact groups are created dynamically as new batteries are discovered
     VehicleBatteryFactGroup::handleMessageForFactGroupCreation(this, message);
 
-    // Let the fact groups take a whack at the mavlink traffic
-    for (FactGroup* factGroup : factGroups()) {
+    // Let the fact groups take a whack at the mavlink traffic, only the ones which registered for this message are called
+    if (_factGroupMessageHandlersDirty) {
+        _updateFactGroupMessageHandlers();
+    }
+    for (FactGroup* factGroup : _factGroupAllMessageHandlers) {
         factGroup->handleMessage(this, message);
     }
+    auto handlersIt = _factGroupMessageHandlers.constFind(message.msgid);
+    if (handlersIt != _factGroupMessageHandlers.constEnd()) {
+        for (FactGroup* factGroup : *handlersIt) {
+            factGroup->handleMessage(this, message);
+        }
+    }
 
     switch (message.msgid) {
     case MAVLINK_MSG_ID_HOME_POSITION:
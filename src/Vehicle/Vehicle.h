@@ -16,6 +16,7 @@
 #include <QTime>
 #include <QQueue>
 #include <QSharedPointer>
+#include <QHash>
 
 #include "FactGroup.h"
 #include "QGCMAVLink.h"
@@ -634,6 +635,16 @@ public:
     uint            messagesReceived            () const{ return _messagesReceived; }
     uint            messagesSent                () const{ return _messagesSent; }
     uint            messagesLost                () const{ return _messagesLost; }
+
+    typedef struct {
+        quint64 count;      ///< Number of messages dispatched
+        quint64 nsecs;      ///< Total time spent handling them
+    } MessageDispatchStats_t;
+
+    /// @return Dispatch counts and handling time keyed by message id
+    const QHash<uint32_t, MessageDispatchStats_t>& messageDispatchStats() const { return _messageDispatchStats; }
+    void resetMessageDispatchStats() { _messageDispatchStats.clear(); }
+
     bool            flying                      () const { return _flying; }
     bool            landing                     () const { return _landing; }
     bool            guidedMode                  () const;
@@ -1060,7 +1071,7 @@ signals:
     void logData                        (uint32_t ofs, uint16_t id, uint8_t count, const uint8_t* data);
 
 private slots:
-    void _mavlinkMessageReceived            (LinkInterface* link, mavlink_message_t message);
+    void _mavlinkMessageBatchReceived       (LinkInterface* link, const MAVLinkMessageBatch& batch);
     void _sendMessageMultipleNext           ();
     void _parametersReady                   (bool parametersReady);
     void _remoteControlRSSIChanged          (uint8_t rssi);
@@ -1094,6 +1105,8 @@ private slots:
     void _altitudeAboveTerrainReceived      (bool sucess, QList<double> heights);
 
 private:
+    void _mavlinkMessageReceived        (LinkInterface* link, mavlink_message_t message);
+    void _updateFactGroupMessageHandlers();
     void _loadJoystickSettings          ();
     void _activeVehicleChanged          (Vehicle* newActiveVehicle);
     void _captureJoystick               ();
@@ -1279,6 +1292,11 @@ private:
     uint                _messagesSent = 0;
     uint                _messagesLost = 0;
     uint8_t             _messageSeq = 0;
+
+    QHash<uint32_t, QList<FactGroup*>>          _factGroupMessageHandlers;          ///< FactGroups keyed by the message ids they handle
+    QList<FactGroup*>                           _factGroupAllMessageHandlers;       ///< FactGroups which handle every message
+    bool                                        _factGroupMessageHandlersDirty = true;
+    QHash<uint32_t, MessageDispatchStats_t>     _messageDispatchStats;
     uint8_t             _compID = 0;
     bool                _heardFrom = false;
 
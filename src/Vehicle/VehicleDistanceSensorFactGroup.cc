@@ -25,6 +25,8 @@ VehicleDistanceSensorFactGroup::VehicleDistanceSensorFactGroup(QObject* parent)
     , _minDistanceFact      (0, _minDistanceFactName,       FactMetaData::valueTypeDouble)
     , _maxDistanceFact      (0, _maxDistanceFactName,       FactMetaData::valueTypeDouble)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_DISTANCE_SENSOR });
+
     _addFact(&_rotationNoneFact,        _rotationNoneFactName);
     _addFact(&_rotationYaw45Fact,       _rotationYaw45FactName);
     _addFact(&_rotationYaw90Fact,       _rotationYaw90FactName);
@@ -22,6 +22,8 @@ VehicleEFIFactGroup::VehicleEFIFactGroup(QObject* parent)
     , _throttleOutFact      (0, _throttleOutFactName,       FactMetaData::valueTypeFloat)
     , _ptCompFact           (0, _ptCompFactName,            FactMetaData::valueTypeFloat)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_EFI_STATUS });
+
     _addFact(&_healthFact,          _healthFactName);
     _addFact(&_ecuIndexFact,        _ecuIndexFactName);
     _addFact(&_rpmFact,             _rpmFactName);
@@ -29,6 +29,8 @@ VehicleEscStatusFactGroup::VehicleEscStatusFactGroup(QObject* parent)
     , _voltageThirdFact                 (0, _voltageThirdFactName,                  FactMetaData::valueTypeFloat)
     , _voltageFourthFact                (0, _voltageFourthFactName,                 FactMetaData::valueTypeFloat)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_ESC_STATUS });
+
     _addFact(&_indexFact,                       _indexFactName);
 
     _addFact(&_rpmFirstFact,                    _rpmFirstFactName);
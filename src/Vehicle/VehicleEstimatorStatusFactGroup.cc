@@ -33,6 +33,8 @@ VehicleEstimatorStatusFactGroup::VehicleEstimatorStatusFactGroup(QObject* parent
     , _horizPosAccuracyFact             (0, _horizPosAccuracyFactName,              FactMetaData::valueTypeFloat)
     , _vertPosAccuracyFact              (0, _vertPosAccuracyFactName,               FactMetaData::valueTypeFloat)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_ESTIMATOR_STATUS });
+
     _addFact(&_goodAttitudeEstimateFact,        _goodAttitudeEstimateFactName);
     _addFact(&_goodHorizVelEstimateFact,        _goodHorizVelEstimateFactName);
     _addFact(&_goodVertVelEstimateFact,         _goodVertVelEstimateFactName);
@@ -12,7 +12,10 @@
 #include "QGCGeo.h"
 
 VehicleGPS2FactGroup::VehicleGPS2FactGroup(QObject* parent)
-    : VehicleGPSFactGroup(parent) {}
+    : VehicleGPSFactGroup(parent)
+{
+    _setHandledMessageIds({ MAVLINK_MSG_ID_GPS2_RAW });
+}
 
 void VehicleGPS2FactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_message_t& message)
 {
@@ -16,6 +16,8 @@ VehicleGeneratorFactGroup::VehicleGeneratorFactGroup(QObject* parent)
     , _runtimeFact              (0, _runtimeFactName,               FactMetaData::valueTypeUint32)
     , _timeMaintenanceFact      (0, _timeMaintenanceFactName,       FactMetaData::valueTypeInt32)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_GENERATOR_STATUS });
+
     _addFact(&_statusFact,              _statusFactName);
     _addFact(&_genSpeedFact,            _genSpeedFactName);
     _addFact(&_batteryCurrentFact,      _batteryCurrentFactName);
@@ -16,7 +16,9 @@ VehicleHygrometerFactGroup::VehicleHygrometerFactGroup(QObject* parent)
     , _hygroTempFact             (0, _hygroTempFactName,         FactMetaData::valueTypeDouble)
     , _hygroHumiFact             (0, _hygroHumiFactName,         FactMetaData::valueTypeDouble)
     , _hygroIDFact               (0, _hygroIDFactName,           FactMetaData::valueTypeUint16)
-{   
+{
+    _setHandledMessageIds({ MAVLINK_MSG_ID_HYGROMETER_SENSOR });
+
     _addFact(&_hygroTempFact,               _hygroTempFactName);
     _addFact(&_hygroHumiFact,               _hygroHumiFactName);
     _addFact(&_hygroIDFact,                 _hygroIDFactName);
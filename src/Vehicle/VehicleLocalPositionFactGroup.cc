@@ -21,6 +21,8 @@ VehicleLocalPositionFactGroup::VehicleLocalPositionFactGroup(QObject* parent)
     , _vyFact   (0, _vyFactName,    FactMetaData::valueTypeDouble)
     , _vzFact   (0, _vzFactName,    FactMetaData::valueTypeDouble)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_LOCAL_POSITION_NED });
+
     _addFact(&_xFact,      _xFactName);
     _addFact(&_yFact,      _yFactName);
     _addFact(&_zFact,      _zFactName);
@@ -21,6 +21,8 @@ VehicleSetpointFactGroup::VehicleSetpointFactGroup(QObject* parent)
     , _pitchRateFact(0, _pitchRateFactName, FactMetaData::valueTypeDouble)
     , _yawRateFact  (0, _yawRateFactName,   FactMetaData::valueTypeDouble)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_ATTITUDE_TARGET });
+
     _addFact(&_rollFact,        _rollFactName);
     _addFact(&_pitchFact,       _pitchFactName);
     _addFact(&_yawFact,         _yawFactName);
@@ -19,6 +19,8 @@ VehicleVibrationFactGroup::VehicleVibrationFactGroup(QObject* parent)
     , _clipCount2Fact   (0, _clipCount2FactName,    FactMetaData::valueTypeUint32)
     , _clipCount3Fact   (0, _clipCount3FactName,    FactMetaData::valueTypeUint32)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_VIBRATION });
+
     _addFact(&_xAxisFact,       _xAxisFactName);
     _addFact(&_yAxisFact,       _yAxisFactName);
     _addFact(&_zAxisFact,       _zAxisFactName);
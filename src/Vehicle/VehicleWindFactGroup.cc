@@ -18,6 +18,15 @@ VehicleWindFactGroup::VehicleWindFactGroup(QObject* parent)
     , _speedFact        (0, _speedFactName,         FactMetaData::valueTypeDouble)
     , _verticalSpeedFact(0, _verticalSpeedFactName, FactMetaData::valueTypeDouble)
 {
+    _setHandledMessageIds({
+        MAVLINK_MSG_ID_WIND_COV,
+#if !defined(NO_ARDUPILOT_DIALECT)
+        MAVLINK_MSG_ID_WIND,
+#endif
+        MAVLINK_MSG_ID_HIGH_LATENCY,
+        MAVLINK_MSG_ID_HIGH_LATENCY2,
+    });
+
     _addFact(&_directionFact,       _directionFactName);
     _addFact(&_speedFact,           _speedFactName);
     _addFact(&_verticalSpeedFact,   _verticalSpeedFactName);
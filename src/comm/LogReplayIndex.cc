@@ -0,0 +1,268 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogReplayIndex.h"
+#include "QGCMAVLink.h"
+#include "QGCLoggingCategory.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDataStream>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QtEndian>
+
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(LogReplayIndexLog, "LogReplayIndexLog")
+
+quint64 LogReplayIndex::parseTimestamp(const uchar* bytes)
+{
+    quint64 timestamp = qFromBigEndian<quint64>(bytes);
+    quint64 currentTimestamp = ((quint64)QDateTime::currentMSecsSinceEpoch()) * 1000;
+
+    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
+    // little endian, so switch it.
+    if (timestamp > currentTimestamp) {
+        timestamp = qbswap(timestamp);
+    }
+
+    return timestamp;
+}
+
+int LogReplayIndex::frameLength(const uchar* frame, qint64 available)
+{
+    int         headerLen;
+    int         signatureLen = 0;
+    uint32_t    msgid;
+
+    if (available < 1) {
+        return 0;
+    }
+
+    if (frame[0] == MAVLINK_STX_MAVLINK1) {
+        headerLen = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+        if (available < headerLen) {
+            return 0;
+        }
+        msgid = frame[5];
+    } else if (frame[0] == MAVLINK_STX) {
+        headerLen = MAVLINK_CORE_HEADER_LEN + 1;
+        if (available < headerLen) {
+            return 0;
+        }
+        uint8_t incompatFlags = frame[2];
+        if (incompatFlags & ~MAVLINK_IFLAG_SIGNED) {
+            return 0;
+        }
+        if (incompatFlags & MAVLINK_IFLAG_SIGNED) {
+            signatureLen = MAVLINK_SIGNATURE_BLOCK_LEN;
+        }
+        msgid = frame[7] | (frame[8] << 8) | (frame[9] << 16);
+    } else {
+        return 0;
+    }
+
+    const int payloadLen    = frame[1];
+    const int totalLen      = headerLen + payloadLen + MAVLINK_NUM_CHECKSUM_BYTES + signatureLen;
+    if (available < totalLen) {
+        return 0;
+    }
+
+    // Same rules as mavlink_parse_char: unknown messages can't be checked so they are not accepted
+    const mavlink_msg_entry_t* msgEntry = mavlink_get_msg_entry(msgid);
+    if (!msgEntry) {
+        return 0;
+    }
+    uint16_t crc = crc_calculate(frame + 1, static_cast<uint16_t>(headerLen - 1 + payloadLen));
+    crc_accumulate(msgEntry->crc_extra, &crc);
+    if (frame[headerLen + payloadLen] != (crc & 0xFF) || frame[headerLen + payloadLen + 1] != (crc >> 8)) {
+        return 0;
+    }
+
+    return totalLen;
+}
+
+qint64 LogReplayIndex::nextRecord(const uchar* data, qint64 size, qint64 offset)
+{
+    for (qint64 pos = offset; pos + cbTimestamp < size; pos++) {
+        if (frameLength(data + pos + cbTimestamp, size - pos - cbTimestamp)) {
+            return pos;
+        }
+    }
+    return -1;
+}
+
+bool LogReplayIndex::build(const uchar* data, qint64 size, const std::atomic<bool>* canceled)
+{
+    bool    firstRecord         = true;
+    quint64 lastIndexedUSecs    = 0;
+    qint64  pos                 = nextRecord(data, size, 0);
+
+    _entries.clear();
+    _startTimeUSecs = 0;
+    _endTimeUSecs   = 0;
+
+    int     recordCount         = 0;
+
+    while (pos >= 0 && pos + cbTimestamp < size) {
+        if (canceled && (++recordCount % 4096) == 0 && canceled->load()) {
+            qCDebug(LogReplayIndexLog) << "build canceled";
+            _entries.clear();
+            return false;
+        }
+
+        int frameLen = frameLength(data + pos + cbTimestamp, size - pos - cbTimestamp);
+        if (!frameLen) {
+            // Corrupt record, resync on the next valid one
+            pos = nextRecord(data, size, pos + 1);
+            continue;
+        }
+
+        quint64 timestamp = parseTimestamp(data + pos);
+        if (firstRecord) {
+            firstRecord         = false;
+            _startTimeUSecs     = timestamp;
+            lastIndexedUSecs    = timestamp;
+            _entries.append({ pos, timestamp });
+        } else if (timestamp >= lastIndexedUSecs + kIndexIntervalUSecs) {
+            lastIndexedUSecs = timestamp;
+            _entries.append({ pos, timestamp });
+        }
+        _endTimeUSecs = timestamp;
+
+        pos += cbTimestamp + frameLen;
+    }
+
+    qCDebug(LogReplayIndexLog) << "build entries:start:end" << _entries.count() << _startTimeUSecs << _endTimeUSecs;
+
+    return !_entries.isEmpty();
+}
+
+bool LogReplayIndex::scanTimeRange(const uchar* data, qint64 size, quint64& startTimeUSecs, quint64& endTimeUSecs)
+{
+    qint64 pos = nextRecord(data, size, 0);
+    if (pos < 0) {
+        return false;
+    }
+    startTimeUSecs  = parseTimestamp(data + pos);
+    endTimeUSecs    = startTimeUSecs;
+
+    pos = nextRecord(data, size, qMax(pos, size - _tailScanBytes));
+    while (pos >= 0 && pos + cbTimestamp < size) {
+        endTimeUSecs = parseTimestamp(data + pos);
+        pos = nextRecord(data, size, pos + cbTimestamp + frameLength(data + pos + cbTimestamp, size - pos - cbTimestamp));
+    }
+
+    return true;
+}
+
+qint64 LogReplayIndex::recordOffsetForTime(quint64 timeUSecs) const
+{
+    if (_entries.isEmpty()) {
+        return 0;
+    }
+
+    auto it = std::upper_bound(_entries.cbegin(), _entries.cend(), timeUSecs, [](quint64 time, const Entry_t& entry) {
+        return time < entry.timestampUSecs;
+    });
+    if (it == _entries.cbegin()) {
+        return it->offset;
+    }
+    return (it - 1)->offset;
+}
+
+/// Index files live in the cache directory, keyed by the path of the log, so nothing is written next to the user's logs
+QString LogReplayIndex::_indexFilename(const QString& logFilename)
+{
+    QString absolutePath = QFileInfo(logFilename).absoluteFilePath();
+    QString hash = QCryptographicHash::hash(absolutePath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    QDir    cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/LogReplayIndex"));
+
+    return cacheDir.filePath(hash + QStringLiteral(".idx"));
+}
+
+bool LogReplayIndex::load(const QString& logFilename, qint64 logSize, qint64 logModifiedMSecs)
+{
+    const QString   indexFilename = _indexFilename(logFilename);
+    QFile           indexFile(indexFilename);
+    if (!indexFile.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&indexFile);
+    quint32     magic, version;
+    qint64      savedLogSize, savedLogModified;
+    qint32      entryCount;
+
+    stream >> magic >> version >> savedLogSize >> savedLogModified;
+    if (magic != _indexFileMagic || version != _indexFileVersion || savedLogSize != logSize || savedLogModified != logModifiedMSecs) {
+        qCDebug(LogReplayIndexLog) << "Ignoring stale index" << indexFilename;
+        return false;
+    }
+
+    stream >> _startTimeUSecs >> _endTimeUSecs >> entryCount;
+    if (stream.status() != QDataStream::Ok || entryCount <= 0) {
+        return false;
+    }
+
+    // The count comes from the file, a corrupt one must not size the allocation. There can't be more entries than
+    // records in the log, or than the rest of the index file holds.
+    const qint64 cbEntry            = sizeof(qint64) + sizeof(quint64);
+    const qint64 cbSmallestRecord   = cbTimestamp + MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + MAVLINK_NUM_CHECKSUM_BYTES;
+    const qint64 maxLogEntries      = logSize / cbSmallestRecord;
+    const qint64 maxFileEntries     = (indexFile.size() - indexFile.pos()) / cbEntry;
+    if (entryCount > maxLogEntries || entryCount > maxFileEntries) {
+        qCWarning(LogReplayIndexLog) << "Ignoring corrupt index" << indexFilename << entryCount;
+        return false;
+    }
+
+    _entries.resize(entryCount);
+    for (Entry_t& entry: _entries) {
+        stream >> entry.offset >> entry.timestampUSecs;
+        if (entry.offset < 0 || entry.offset >= logSize) {
+            // Offsets are used to read the mapped log
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+    }
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(LogReplayIndexLog) << "Ignoring corrupt index" << indexFilename;
+        _entries.clear();
+        return false;
+    }
+
+    qCDebug(LogReplayIndexLog) << "Loaded index" << indexFilename << _entries.count();
+    return true;
+}
+
+bool LogReplayIndex::save(const QString& logFilename, qint64 logSize, qint64 logModifiedMSecs) const
+{
+    const QString indexFilename = _indexFilename(logFilename);
+    QDir().mkpath(QFileInfo(indexFilename).absolutePath());
+
+    QFile indexFile(indexFilename);
+    if (indexFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        QDataStream stream(&indexFile);
+        stream << _indexFileMagic << _indexFileVersion << logSize << logModifiedMSecs;
+        stream << _startTimeUSecs << _endTimeUSecs << static_cast<qint32>(_entries.count());
+        for (const Entry_t& entry: _entries) {
+            stream << entry.offset << entry.timestampUSecs;
+        }
+        if (stream.status() == QDataStream::Ok) {
+            return true;
+        }
+        indexFile.remove();
+    }
+
+    qCWarning(LogReplayIndexLog) << "Unable to save index for" << logFilename << indexFilename;
+    return false;
+}
@@ -0,0 +1,80 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QLoggingCategory>
+
+#include <atomic>
+
+Q_DECLARE_LOGGING_CATEGORY(LogReplayIndexLog)
+
+/// Sparse time index over a memory mapped telemetry log.
+///
+/// A tlog is a sequence of records, each an 8 byte big endian timestamp followed by a single MAVLink frame.
+/// The index remembers the file offset of one record per kIndexIntervalUSecs of log time, which is enough
+/// to seek to any timestamp by walking at most one interval worth of records. Once built, the index is saved
+/// to a sidecar file in the cache directory so the log only has to be scanned once.
+class LogReplayIndex
+{
+public:
+    /// Builds the index by walking every record in the log
+    ///     @param canceled Checked while walking the log, the build stops once it is set
+    ///     @return false: log contains no valid records or the build was canceled
+    bool build(const uchar* data, qint64 size, const std::atomic<bool>* canceled = nullptr);
+
+    /// Loads a previously saved index, which is only accepted if it was built from the same log file
+    bool load(const QString& logFilename, qint64 logSize, qint64 logModifiedMSecs);
+
+    /// Saves the index to the cache directory
+    bool save(const QString& logFilename, qint64 logSize, qint64 logModifiedMSecs) const;
+
+    /// Finds the time span of the log without building the index. Only the first record and the tail of the log
+    /// are read.
+    ///     @return false: log contains no valid records
+    static bool scanTimeRange(const uchar* data, qint64 size, quint64& startTimeUSecs, quint64& endTimeUSecs);
+
+    quint64 startTimeUSecs  (void) const { return _startTimeUSecs; }
+    quint64 endTimeUSecs    (void) const { return _endTimeUSecs; }
+    int     count           (void) const { return _entries.count(); }
+
+    /// @return Offset of the last indexed record at or before the specified time
+    qint64 recordOffsetForTime(quint64 timeUSecs) const;
+
+    /// @return Length of the valid MAVLink frame which starts at frame, 0 if there isn't one
+    static int frameLength(const uchar* frame, qint64 available);
+
+    /// @return Offset of the first record at or after offset which contains a valid frame, -1 for none
+    static qint64 nextRecord(const uchar* data, qint64 size, qint64 offset);
+
+    /// Parses a BigEndian quint64 timestamp
+    /// @return A Unix timestamp in microseconds UTC
+    static quint64 parseTimestamp(const uchar* bytes);
+
+    static constexpr int        cbTimestamp         = sizeof(quint64);
+    static constexpr quint64    kIndexIntervalUSecs = 100000;   ///< Log time between index entries
+
+private:
+    typedef struct {
+        qint64  offset;
+        quint64 timestampUSecs;
+    } Entry_t;
+
+    static QString _indexFilename(const QString& logFilename);
+
+    QVector<Entry_t>    _entries;
+    quint64             _startTimeUSecs = 0;
+    quint64             _endTimeUSecs   = 0;
+
+    static constexpr quint32 _indexFileMagic    = 0x58494C54;   ///< "TLIX"
+    static constexpr quint32 _indexFileVersion  = 1;
+    static constexpr qint64  _tailScanBytes     = 64 * 1024;    ///< Tail of the log searched by scanTimeRange
+};
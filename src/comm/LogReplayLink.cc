@@ -15,6 +15,7 @@
 #include <QFileInfo>
 #include <QtEndian>
 #include <QSignalSpy>
+#include <QtConcurrent>
 
 const char*  LogReplayLinkConfiguration::_logFilenameKey = "logFilename";
 
@@ -65,7 +66,6 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr& config)
     : LinkInterface              (config)
     , _logReplayConfig           (qobject_cast<LogReplayLinkConfiguration*>(config.get()))
     , _connected                 (false)
-    , _mavlinkChannel            (0)
     , _logCurrentTimeUSecs       (0)
     , _logStartTimeUSecs         (0)
     , _logEndTimeUSecs           (0)
@@ -75,6 +75,8 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr& config)
     , _playbackStartLogTimeUSecs (0)
     , _mavlink                   (nullptr)
     , _logFileSize               (0)
+    , _logData                   (nullptr)
+    , _logPos                    (-1)
 {
     if (!_logReplayConfig) {
         qWarning() << "Internal error";
@@ -83,8 +85,10 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr& config)
     _errorTitle = tr("Log Replay Error");
     
     _readTickTimer.moveToThread(this);
+    _indexWatcher.moveToThread(this);
     
     QObject::connect(&_readTickTimer, &QTimer::timeout,                 this, &LogReplayLink::_readNextLogEntry);
+    QObject::connect(&_indexWatcher, &QFutureWatcher<LogReplayIndex>::finished, this, &LogReplayLink::_indexBuilt);
     QObject::connect(this, &LogReplayLink::_playOnThread,               this, &LogReplayLink::_play);
     QObject::connect(this, &LogReplayLink::_pauseOnThread,              this, &LogReplayLink::_pause);
     QObject::connect(this, &LogReplayLink::_setPlaybackSpeedOnThread,   this, &LogReplayLink::_setPlaybackSpeed);
@@ -140,6 +144,7 @@ void LogReplayLink::run(void)
     exec();
     
     _readTickTimer.stop();
+    _closeLogFile();
 }
 
 void LogReplayLink::_replayError(const QString& errorMsg)
@@ -154,116 +159,13 @@ void LogReplayLink::_writeBytes(const QByteArray bytes)
     Q_UNUSED(bytes);
 }
 
-/// Parses a BigEndian quint64 timestamp
-/// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
-quint64 LogReplayLink::_parseTimestamp(const QByteArray& bytes)
-{
-    quint64 timestamp = qFromBigEndian(*((quint64*)(bytes.constData())));
-    quint64 currentTimestamp = ((quint64)QDateTime::currentMSecsSinceEpoch()) * 1000;
-    
-    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
-    // little endian, so switch it.
-    if (timestamp > currentTimestamp) {
-        timestamp = qbswap(timestamp);
-    }
-    
-    return timestamp;
-}
-
-/// Reads the next mavlink message from the log
-///     @param bytes[output] Bytes for mavlink message
-/// @return Unix timestamp in microseconds UTC for NEXT mavlink message or 0 if no message found
-quint64 LogReplayLink::_readNextMavlinkMessage(QByteArray& bytes)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-
-    bytes.clear();
-
-    while (_logFile.getChar(&nextByte)) { // Loop over every byte
-        mavlink_message_t message;
-        bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, &message, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            // This is the possible beginning of a mavlink message, clear any partial bytes
-            bytes.clear();
-        }
-        bytes.append(nextByte);
-
-        if (messageFound) {
-            // Return the timestamp for the next message
-            QByteArray rawTime = _logFile.read(cbTimestamp);
-            return _parseTimestamp(rawTime);
-        }
-    }
-
-    return 0;
-}
-
-/// Seeks to the beginning of the next successfully parsed mavlink message in the log file.
-///     @param nextMsg[output] Parsed next message that was found
-/// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
-quint64 LogReplayLink::_seekToNextMavlinkMessage(mavlink_message_t* nextMsg)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-    qint64              messageStartPos = -1;
-
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    while (_logFile.getChar(&nextByte)) {
-        bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, nextMsg, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            // This is the possible beginning of a mavlink message
-            messageStartPos = _logFile.pos() - 1;
-        }
-        
-        // If we've found a message, jump back to the start of the message, grab the timestamp,
-        // and go back to the end of this file.
-        if (messageFound && messageStartPos != -1) {
-            _logFile.seek(messageStartPos - cbTimestamp);
-            QByteArray rawTime = _logFile.read(cbTimestamp);
-            return _parseTimestamp(rawTime);
-        }
-    }
-    
-    return 0;
-}
-
-quint64 LogReplayLink::_findLastTimestamp(void)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-    quint64             lastTimestamp = 0;
-    mavlink_message_t   msg;
-
-    // We read through the entire file looking for the last good timestamp. This can be somewhat slow, but trying to work from the
-    // end of the file can be way slower due to all the seeking back and forth required. So instead we take the simple reliable approach.
-
-    _logFile.reset();
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    while (_logFile.bytesAvailable() > cbTimestamp) {
-        lastTimestamp = _parseTimestamp(_logFile.read(cbTimestamp));
-
-        bool endOfMessage = false;
-        while (!endOfMessage && _logFile.getChar(&nextByte)) {
-            endOfMessage = mavlink_parse_char(_mavlinkChannel, nextByte, &msg, &status);
-        }
-    }
-
-    return lastTimestamp;
-}
-
 bool LogReplayLink::_loadLogFile(void)
 {
-    QString errorMsg;
-    QString logFilename = _logReplayConfig->logFilename();
-    QFileInfo logFileInfo;
-    int logDurationSecondsTotal;
-    quint64 startTimeUSecs;
-    quint64 endTimeUSecs;
+    QString     errorMsg;
+    QString     logFilename = _logReplayConfig->logFilename();
+    QFileInfo   logFileInfo(logFilename);
+    qint64      logModifiedMSecs;
+    bool        indexLoaded;
 
     if (_logFile.isOpen()) {
         errorMsg = tr("Attempt to load new log while log being played");
@@ -275,38 +177,123 @@ bool LogReplayLink::_loadLogFile(void)
         errorMsg = tr("Unable to open log file: '%1', error: %2").arg(logFilename).arg(_logFile.errorString());
         goto Error;
     }
-    logFileInfo.setFile(logFilename);
-    _logFileSize = logFileInfo.size();
-    
-    startTimeUSecs = _parseTimestamp(_logFile.read(cbTimestamp));
-    endTimeUSecs = _findLastTimestamp();
+    _logFileSize = _logFile.size();
+    _logData = _logFile.map(0, _logFileSize);
+    if (!_logData) {
+        errorMsg = tr("Unable to map log file: '%1', error: %2").arg(logFilename).arg(_logFile.errorString());
+        goto Error;
+    }
+
+    // The index is only built the first time a log is played, after that it comes from the sidecar file
+    logModifiedMSecs = logFileInfo.lastModified().toMSecsSinceEpoch();
+    indexLoaded = _index.load(logFilename, _logFileSize, logModifiedMSecs);
+    if (indexLoaded) {
+        _logStartTimeUSecs  = _index.startTimeUSecs();
+        _logEndTimeUSecs    = _index.endTimeUSecs();
+    } else if (!LogReplayIndex::scanTimeRange(_logData, _logFileSize, _logStartTimeUSecs, _logEndTimeUSecs)) {
+        _logStartTimeUSecs  = 0;
+        _logEndTimeUSecs    = 0;
+    }
 
-    if (endTimeUSecs <= startTimeUSecs) {
+    if (_logEndTimeUSecs <= _logStartTimeUSecs) {
         errorMsg = tr("The log file '%1' is corrupt or empty.").arg(logFilename);
         goto Error;
     }
 
     // Remember the start and end time so we can move around this _logFile with the slider.
-    _logEndTimeUSecs = endTimeUSecs;
-    _logStartTimeUSecs = startTimeUSecs;
-    _logDurationUSecs = endTimeUSecs - startTimeUSecs;
-    _logCurrentTimeUSecs = startTimeUSecs;
+    _logDurationUSecs = _logEndTimeUSecs - _logStartTimeUSecs;
 
-    // Reset our log file so when we go to read it for the first time, we start at the beginning.
-    _logFile.reset();
+    if (indexLoaded) {
+        _seekable = true;
+    } else {
+        // Playback doesn't need the index, so it starts right away while the index is built
+        const uchar*        data        = _logData;
+        const qint64        size        = _logFileSize;
+        std::atomic<bool>*  canceled    = &_indexCanceled;
+
+        _indexCanceled = false;
+        _indexWatcher.setFuture(QtConcurrent::run([data, size, canceled, logFilename, logModifiedMSecs]() {
+            LogReplayIndex index;
+            if (index.build(data, size, canceled)) {
+                index.save(logFilename, size, logModifiedMSecs);
+            }
+            return index;
+        }));
+    }
+    emit seekableChanged(_seekable);
 
-    logDurationSecondsTotal = (_logDurationUSecs) / 1000000;
-    
-    emit logFileStats(logDurationSecondsTotal);
+    // Position on the first record so when we go to read it for the first time, we start at the beginning.
+    _resetPlaybackToBeginning();
+
+    emit logFileStats(static_cast<int>(_logDurationUSecs / 1000000));
     
     return true;
     
 Error:
+    _closeLogFile();
+    _replayError(errorMsg);
+    return false;
+}
+
+void LogReplayLink::_closeLogFile(void)
+{
+    // The index build reads the mapped log, so it has to stop before the log is unmapped
+    _indexCanceled = true;
+    _indexWatcher.waitForFinished();
+    if (_seekable) {
+        _seekable = false;
+        emit seekableChanged(false);
+    }
+
+    if (_logData) {
+        _logFile.unmap(const_cast<uchar*>(_logData));
+        _logData = nullptr;
+    }
     if (_logFile.isOpen()) {
         _logFile.close();
     }
-    _replayError(errorMsg);
-    return false;
+    _logPos = -1;
+}
+
+void LogReplayLink::_indexBuilt(void)
+{
+    if (_indexCanceled || !_logData) {
+        return;
+    }
+
+    LogReplayIndex index = _indexWatcher.result();
+    if (index.count() == 0) {
+        qCWarning(LogReplayIndexLog) << "Unable to index log, seeking is not available";
+        return;
+    }
+
+    // The index walked every record, so its time span replaces the one from the quick scan
+    _index              = index;
+    _logStartTimeUSecs  = _index.startTimeUSecs();
+    _logEndTimeUSecs    = qMax(_index.endTimeUSecs(), _logStartTimeUSecs + 1);
+    _logDurationUSecs   = _logEndTimeUSecs - _logStartTimeUSecs;
+    emit logFileStats(static_cast<int>(_logDurationUSecs / 1000000));
+
+    _seekable = true;
+    emit seekableChanged(true);
+}
+
+/// Positions playback on the first record with a timestamp at or after the specified time
+void LogReplayLink::_seekToTime(quint64 timeUSecs)
+{
+    _logPos = LogReplayIndex::nextRecord(_logData, _logFileSize, _index.recordOffsetForTime(timeUSecs));
+
+    // The index is sparse, walk forward through at most one index interval of records
+    while (!_atEnd()) {
+        quint64 recordTimeUSecs = LogReplayIndex::parseTimestamp(_logData + _logPos);
+        if (recordTimeUSecs >= timeUSecs) {
+            _logCurrentTimeUSecs = recordTimeUSecs;
+            return;
+        }
+        int frameLen = LogReplayIndex::frameLength(_logData + _logPos + LogReplayIndex::cbTimestamp, _logFileSize - _logPos - LogReplayIndex::cbTimestamp);
+        _logPos = LogReplayIndex::nextRecord(_logData, _logFileSize, _logPos + LogReplayIndex::cbTimestamp + frameLen);
+    }
+    _logCurrentTimeUSecs = _logEndTimeUSecs;
 }
 
 /// This function will read the next available log entry. It will then start
@@ -317,25 +304,34 @@ void LogReplayLink::_readNextLogEntry(void)
 {
     QByteArray bytes;
 
-    // Now parse MAVLink messages, grabbing their timestamps as we go. We stop once we
-    // have at least 3ms until the next one.
+    // Now gather MAVLink frames, grabbing their timestamps as we go. We stop once we
+    // have at least 3ms until the next one, then send all of them as a single block.
 
     // We track what the next execution time should be in milliseconds, which we use to set
     // the next timer interrupt.
     int timeToNextExecutionMSecs = 0;
 
-    while (timeToNextExecutionMSecs < 3) {
-        // Read the next mavlink message from the log
-        qint64 nextTimeUSecs = _readNextMavlinkMessage(bytes);
-        emit bytesReceived(this, bytes);
-        emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
+    while (timeToNextExecutionMSecs < 3 && bytes.size() < _maxBlockBytes) {
+        if (_atEnd()) {
+            break;
+        }
 
-        if (_logFile.atEnd()) {
-            _finishPlayback();
-            return;
+        // Frames are copied straight out of the mapped file, the index build already validated them
+        const uchar*    frame       = _logData + _logPos + LogReplayIndex::cbTimestamp;
+        int             frameLen    = LogReplayIndex::frameLength(frame, _logFileSize - _logPos - LogReplayIndex::cbTimestamp);
+        bytes.append(reinterpret_cast<const char*>(frame), frameLen);
+
+        _logPos = LogReplayIndex::nextRecord(_logData, _logFileSize, _logPos + LogReplayIndex::cbTimestamp + frameLen);
+        if (_atEnd()) {
+            break;
         }
 
-        _logCurrentTimeUSecs = nextTimeUSecs;
+        _logCurrentTimeUSecs = LogReplayIndex::parseTimestamp(_logData + _logPos);
+
+        if (_playbackSpeed <= 0) {
+            // As fast as possible, only limited by the block size
+            continue;
+        }
 
         // Calculate how long we should wait in real time until parsing this message.
         // We pace ourselves relative to the start time of playback to fix any drift (initially set in play())
@@ -347,10 +343,21 @@ void LogReplayLink::_readNextLogEntry(void)
         timeToNextExecutionMSecs = desiredCurrentTimeMSecs - currentTimeMSecs;
     }
 
+    if (!bytes.isEmpty()) {
+        emit bytesReceived(this, bytes);
+    }
+    emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
+
+    if (_atEnd()) {
+        _logCurrentTimeUSecs = _logEndTimeUSecs;
+        _finishPlayback();
+        return;
+    }
+
     _signalCurrentLogTimeSecs();
 
     // And schedule the next execution of this function.
-    _readTickTimer.start(timeToNextExecutionMSecs);
+    _readTickTimer.start(qMax(timeToNextExecutionMSecs, 0));
 }
 
 void LogReplayLink::_play(void)
@@ -361,7 +368,7 @@ void LogReplayLink::_play(void)
 #endif
     
     // Make sure we aren't at the end of the file, if we are, reset to the beginning and play from there.
-    if (_logFile.atEnd()) {
+    if (_atEnd()) {
         _resetPlaybackToBeginning();
     }
     
@@ -386,8 +393,8 @@ void LogReplayLink::_pause(void)
 
 void LogReplayLink::_resetPlaybackToBeginning(void)
 {
-    if (_logFile.isOpen()) {
-        _logFile.reset();
+    if (_logData) {
+        _logPos = LogReplayIndex::nextRecord(_logData, _logFileSize, 0);
     }
     
     // And since we haven't starting playback, clear the time of initial playback and the current timestamp.
@@ -414,45 +421,17 @@ void LogReplayLink::movePlayhead(qreal percentComplete)
         percentComplete = 100;
     }
     
-    qreal percentCompleteMult = percentComplete / 100.0;
-    
-    // But if we have a timestamped MAVLink log, then actually aim to hit that percentage in terms of
-    // time through the file.
-    qint64 newFilePos = (qint64)(percentCompleteMult * (qreal)_logFile.size());
-
-    // Now seek to the appropriate position, failing gracefully if we can't.
-    if (!_logFile.seek(newFilePos)) {
-        _replayError(tr("Unable to seek to new position"));
+    if (!_logData || !_seekable) {
         return;
     }
 
-    // But we do align to the next MAVLink message for consistency.
-    mavlink_message_t dummy;
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
-
-    // Now calculate the current file location based on time.
-    qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
-
-    // Calculate the effective baud rate of the file in bytes/s.
-    qreal baudRate = _logFile.size() / (qreal)_logDurationUSecs / 1e6;
-
-    // And the desired time is:
-    qreal desiredTimeUSecs = percentCompleteMult * _logDurationUSecs;
-
-    // And now jump the necessary number of bytes in the proper direction
-    qint64 offset = (newRelativeTimeUSecs - desiredTimeUSecs) * baudRate;
-    if (!_logFile.seek(_logFile.pos() + offset)) {
-        _replayError(tr("Unable to seek to new position"));
-        return;
-    }
-
-    // And scan until we reach the start of a MAVLink message. We make sure to record this timestamp for
-    // smooth jumping around the file.
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
+    // Seek straight to the requested time through the index
+    quint64 desiredTimeUSecs = _logStartTimeUSecs + static_cast<quint64>((percentComplete / 100.0) * _logDurationUSecs);
+    _seekToTime(desiredTimeUSecs);
     _signalCurrentLogTimeSecs();
 
     // Now update the UI with our actual final position.
-    newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
+    qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
     percentComplete = (newRelativeTimeUSecs / _logDurationUSecs) * 100;
     emit playbackPercentCompleteChanged(percentComplete);
 }
@@ -486,6 +465,7 @@ LogReplayLinkController::LogReplayLinkController(void)
     , _percentComplete  (0)
     , _playheadSecs     (0)
     , _playbackSpeed    (1)
+    , _seekable         (false)
 {
 }
 
@@ -498,11 +478,13 @@ void LogReplayLinkController::setLink(LogReplayLink* link)
         _percentComplete = 0;
         _playheadTime.clear();
         _totalTime.clear();
+        _seekable = false;
         _link = nullptr;
         emit isPlayingChanged(false);
         emit percentCompleteChanged(0);
         emit playheadTimeChanged(QString());
         emit totalTimeChanged(QString());
+        emit seekableChanged(false);
         emit linkChanged(nullptr);
     }
 
@@ -516,9 +498,13 @@ void LogReplayLinkController::setLink(LogReplayLink* link)
         connect(_link, &LogReplayLink::playbackPercentCompleteChanged,    this, &LogReplayLinkController::_playbackPercentCompleteChanged);
         connect(_link, &LogReplayLink::currentLogTimeSecs,                this, &LogReplayLinkController::_currentLogTimeSecs);
         connect(_link, &LogReplayLink::disconnected,                      this, &LogReplayLinkController::_linkDisconnected);
+        connect(_link, &LogReplayLink::seekableChanged,                   this, &LogReplayLinkController::_seekableChanged);
 
         connect(this, &LogReplayLinkController::playbackSpeedChanged, _link, &LogReplayLink::setPlaybackSpeed);
 
+        // The index may have been loaded before the link got here
+        _seekableChanged(_link->seekable());
+
         emit linkChanged(_link);
     }
 }
@@ -581,6 +567,14 @@ void LogReplayLinkController::_linkDisconnected(void)
     setLink(nullptr);
 }
 
+void LogReplayLinkController::_seekableChanged(bool seekable)
+{
+    if (_seekable != seekable) {
+        _seekable = seekable;
+        emit seekableChanged(_seekable);
+    }
+}
+
 QString LogReplayLinkController::_secondsToHMS(int seconds)
 {
     int secondsPart  = seconds;
@@ -10,9 +10,13 @@
 #pragma once
 
 #include "MAVLinkProtocol.h"
+#include "LogReplayIndex.h"
 
 #include <QTimer>
 #include <QFile>
+#include <QFutureWatcher>
+
+#include <atomic>
 
 class LinkManager;
 
@@ -48,6 +52,9 @@ private:
 };
 
 /// Pseudo link that reads a telemetry log and feeds it into the application.
+/// The log is memory mapped and seeks go through a LogReplayIndex, so neither depends on the log size. The first
+/// time a log is played the index is built on the thread pool while playback runs, seeking is only available once
+/// it is done.
 class LogReplayLink : public LinkInterface
 {
     Q_OBJECT
@@ -59,6 +66,9 @@ public:
     /// @return true: log is currently playing, false: log playback is paused
     bool isPlaying(void) { return _readTickTimer.isActive(); }
 
+    /// @return true: log index is available, movePlayhead can be used
+    bool seekable(void) const { return _seekable; }
+
     void play           (void) { emit _playOnThread(); }
     void pause          (void) { emit _pauseOnThread(); }
     void movePlayhead   (qreal percentComplete);
@@ -69,7 +79,7 @@ public:
     void disconnect (void) override;
 
 public slots:
-    /// Sets the acceleration factor: -100: 0.01X, 0: 1.0X, 100: 100.0X
+    /// Sets the acceleration factor: 0.1: 0.1X, 1: 1.0X, 100: 100.0X. 0 or less plays back as fast as possible.
     void setPlaybackSpeed(qreal playbackSpeed) { emit _setPlaybackSpeedOnThread(playbackSpeed); }
 
 signals:
@@ -79,6 +89,7 @@ signals:
     void playbackAtEnd                  (void);
     void playbackPercentCompleteChanged (qreal percentComplete);
     void currentLogTimeSecs             (int secs);
+    void seekableChanged                (bool seekable);
 
     // Internal signals
     void _playOnThread              (void);
@@ -93,6 +104,7 @@ private slots:
     void _play              (void);
     void _pause             (void);
     void _setPlaybackSpeed  (qreal playbackSpeed);
+    void _indexBuilt        (void);
 
 private:
 
@@ -100,11 +112,10 @@ private:
     bool _connect(void) override;
 
     void    _replayError                (const QString& errorMsg);
-    quint64 _parseTimestamp             (const QByteArray& bytes);
-    quint64 _seekToNextMavlinkMessage   (mavlink_message_t* nextMsg);
-    quint64 _findLastTimestamp          (void);
-    quint64 _readNextMavlinkMessage     (QByteArray& bytes);
+    void    _seekToTime                 (quint64 timeUSecs);
+    bool    _atEnd                      (void) const { return _logPos < 0 || _logPos + LogReplayIndex::cbTimestamp >= _logFileSize; }
     bool    _loadLogFile                (void);
+    void    _closeLogFile               (void);
     void    _finishPlayback             (void);
     void    _resetPlaybackToBeginning   (void);
     void    _signalCurrentLogTimeSecs   (void);
@@ -115,7 +126,6 @@ private:
     LogReplayLinkConfiguration* _logReplayConfig;
 
     bool    _connected;
-    uint8_t _mavlinkChannel;
     QTimer  _readTickTimer;      ///< Timer which signals a read of next log record
 
     QString _errorTitle; ///< Title for communicatorError signals
@@ -131,9 +141,16 @@ private:
 
     MAVLinkProtocol*    _mavlink;
     QFile               _logFile;
-    quint64             _logFileSize;
+    qint64              _logFileSize;
+    const uchar*        _logData;       ///< Memory mapped log file
+    qint64              _logPos;        ///< Offset of the next record to play, -1 for none
+    LogReplayIndex      _index;
+
+    QFutureWatcher<LogReplayIndex>  _indexWatcher;
+    std::atomic<bool>               _indexCanceled  { false };  ///< Stops the background index build
+    std::atomic<bool>               _seekable       { false };
 
-    static const int cbTimestamp = sizeof(quint64);
+    static constexpr int _maxBlockBytes = 64 * 1024;   ///< Upper limit for the bytes sent through a single bytesReceived
 };
 
 class LogReplayLinkController : public QObject
@@ -147,12 +164,14 @@ public:
     Q_PROPERTY(QString          totalTime       MEMBER _totalTime                                   NOTIFY totalTimeChanged)
     Q_PROPERTY(QString          playheadTime    MEMBER _playheadTime                                NOTIFY playheadTimeChanged)
     Q_PROPERTY(qreal            playbackSpeed   MEMBER _playbackSpeed                               NOTIFY playbackSpeedChanged)
+    Q_PROPERTY(bool             seekable        READ seekable                                       NOTIFY seekableChanged)
 
     LogReplayLinkController(void);
 
     LogReplayLink*  link            (void) { return _link; }
     bool            isPlaying       (void) const{ return _isPlaying; }
     qreal           percentComplete (void) const{ return _percentComplete; }
+    bool            seekable        (void) const{ return _seekable; }
 
     void setLink            (LogReplayLink* link);
     void setIsPlaying       (bool isPlaying);
@@ -165,6 +184,7 @@ signals:
     void playheadTimeChanged    (QString playheadTime);
     void totalTimeChanged       (QString totalTime);
     void playbackSpeedChanged   (qreal playbackSpeed);
+    void seekableChanged        (bool seekable);
 
 private slots:
     void _logFileStats                   (int logDurationSecs);
@@ -174,6 +194,7 @@ private slots:
     void _playbackPercentCompleteChanged (qreal percentComplete);
     void _currentLogTimeSecs             (int secs);
     void _linkDisconnected               (void);
+    void _seekableChanged                (bool seekable);
 
 private:
     QString _secondsToHMS(int seconds);
@@ -185,5 +206,6 @@ private:
     QString         _playheadTime;
     QString         _totalTime;
     qreal           _playbackSpeed;
+    bool            _seekable;
 };
 
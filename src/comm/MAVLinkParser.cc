@@ -0,0 +1,164 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkParser.h"
+#include "MAVLinkProtocol.h"
+#include "LinkInterface.h"
+#include "QGCLoggingCategory.h"
+
+QGC_LOGGING_CATEGORY(MAVLinkParserLog, "MAVLinkParserLog")
+
+MAVLinkParser::MAVLinkParser(uint8_t mavlinkChannel)
+    : _mavlinkChannel(mavlinkChannel)
+{
+    memset(&_message,   0, sizeof(_message));
+    memset(&_status,    0, sizeof(_status));
+    memset(&_parseBuffer, 0, sizeof(_parseBuffer));
+    memset(&_parseStatus, 0, sizeof(_parseStatus));
+    memset(_lastIndex,  0, sizeof(_lastIndex));
+    reset();
+}
+
+void MAVLinkParser::reset(void)
+{
+    _totalReceiveCounter    = 0;
+    _totalLossCounter       = 0;
+    _runningLossPercent     = 0.0f;
+    memset(_firstMessage, 1, sizeof(_firstMessage));
+}
+
+void MAVLinkParser::parse(const QByteArray& bytes, MAVLinkMessageBatch& batch)
+{
+    const uint8_t*  data    = reinterpret_cast<const uint8_t*>(bytes.constData());
+    const int       size    = bytes.size();
+
+    for (int position = 0; position < size; position++) {
+        const uint8_t result = mavlink_frame_char_buffer(&_parseBuffer, &_parseStatus, data[position], &_message, &_status);
+        if (result == MAVLINK_FRAMING_OK) {
+            _updateLossStatistics(_message);
+            batch.append(_message);
+        } else if (result == MAVLINK_FRAMING_BAD_CRC || result == MAVLINK_FRAMING_BAD_SIGNATURE) {
+            // Same recovery as mavlink_parse_char: drop the frame and restart on this byte if it starts a new one
+            _parseStatus.parse_error++;
+            _parseStatus.msg_received   = MAVLINK_FRAMING_INCOMPLETE;
+            _parseStatus.parse_state    = MAVLINK_PARSE_STATE_IDLE;
+            if (data[position] == MAVLINK_STX) {
+                _parseStatus.parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+                _parseBuffer.len = 0;
+                mavlink_start_checksum(&_parseBuffer);
+            }
+        }
+    }
+}
+
+void MAVLinkParser::_updateLossStatistics(const mavlink_message_t& message)
+{
+    uint8_t lastSeq     = _lastIndex[message.sysid][message.compid];
+    uint8_t expectedSeq = lastSeq + 1;
+
+    _totalReceiveCounter++;
+
+    // Determine what the next expected sequence number is, accounting for
+    // never having seen a message for this system/component pair.
+    if (_firstMessage[message.sysid][message.compid]) {
+        _firstMessage[message.sysid][message.compid] = 0;
+        expectedSeq = message.seq;
+    }
+
+    // And if we didn't encounter that sequence number, record the error
+    if (message.seq != expectedSeq) {
+        int lostMessages = 0;
+        //-- Account for overflow during packet loss
+        if (message.seq < expectedSeq) {
+            lostMessages = (message.seq + 255) - expectedSeq;
+        } else {
+            lostMessages = message.seq - expectedSeq;
+        }
+        _totalLossCounter += static_cast<uint64_t>(lostMessages);
+    }
+
+    _lastIndex[message.sysid][message.compid] = message.seq;
+
+    // Calculate new loss ratio
+    uint64_t totalSent = _totalReceiveCounter + _totalLossCounter;
+    float receiveLossPercent = static_cast<float>(static_cast<double>(_totalLossCounter) / static_cast<double>(totalSent));
+    receiveLossPercent *= 100.0f;
+    _runningLossPercent = (receiveLossPercent * 0.5f) + (_runningLossPercent * 0.5f);
+}
+
+MAVLinkParserWorker::MAVLinkParserWorker(LinkInterface* link, MAVLinkProtocol* protocol)
+    : QObject   (nullptr)
+    , _link     (link)
+    , _protocol (protocol)
+    , _parser   (link->mavlinkChannel())
+{
+
+}
+
+void MAVLinkParserWorker::resetMetadata(void)
+{
+    _parser.reset();
+    _decodedFirstMessage = false;
+}
+
+void MAVLinkParserWorker::receiveBytes(LinkInterface* link, QByteArray bytes)
+{
+    if (link != _link) {
+        return;
+    }
+
+    uint64_t            previousReceived = _parser.totalReceived();
+    MAVLinkMessageBatch batch;
+
+    _parser.parse(bytes, batch);
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    if (!_decodedFirstMessage) {
+        _decodedFirstMessage = true;
+        if (!_parser.incomingMavlink1()) {
+            // The outbound version is part of the channel status used by the send path, so the main thread switches it
+            emit incomingMavlink2(_link);
+        }
+    }
+
+    _forwardMessages(batch);
+
+    // Update MAVLink status every 32 packets
+    if ((previousReceived >> 5) != (_parser.totalReceived() >> 5)) {
+        uint64_t totalReceived  = _parser.totalReceived();
+        uint64_t totalLoss      = _parser.totalLoss();
+        emit mavlinkMessageStatus(batch.last().sysid, totalReceived + totalLoss, totalReceived, totalLoss, _parser.runningLossPercent());
+    }
+
+    emit messagesDecoded(_link, batch);
+}
+
+void MAVLinkParserWorker::_forwardMessages(const MAVLinkMessageBatch& batch)
+{
+    SharedLinkInterfacePtr forwardingLink;
+    SharedLinkInterfacePtr forwardingSupportLink;
+
+    _protocol->forwardingLinks(forwardingLink, forwardingSupportLink);
+    if (!forwardingLink && !forwardingSupportLink) {
+        return;
+    }
+
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    for (const mavlink_message_t& message : batch) {
+        int len = mavlink_msg_to_send_buffer(buf, &message);
+        if (forwardingLink) {
+            forwardingLink->writeBytesThreadSafe((const char*)buf, len);
+        }
+        if (forwardingSupportLink) {
+            forwardingSupportLink->writeBytesThreadSafe((const char*)buf, len);
+        }
+    }
+}
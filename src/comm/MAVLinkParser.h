@@ -0,0 +1,86 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QLoggingCategory>
+
+#include "QGCMAVLink.h"
+
+class LinkInterface;
+class MAVLinkProtocol;
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkParserLog)
+
+/// Decodes the byte stream of a single link into MAVLink messages and keeps the receive/loss statistics for it.
+/// The parse state is held by the parser instead of the MAVLink channel status, which belongs to the send path.
+/// Not thread safe, each instance must only be used from a single thread at a time.
+class MAVLinkParser
+{
+public:
+    MAVLinkParser(uint8_t mavlinkChannel);
+
+    /// Decodes all complete frames in bytes and appends them to batch in arrival order. Partial frames are
+    /// kept in the channel parse state and completed by the next call.
+    void parse(const QByteArray& bytes, MAVLinkMessageBatch& batch);
+
+    /// Resets receive/loss statistics
+    void reset(void);
+
+    uint8_t     mavlinkChannel      (void) const { return _mavlinkChannel; }
+    bool        incomingMavlink1    (void) const { return _parseStatus.flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1; }  ///< Last decoded frame was mavlink 1.0
+    uint64_t    totalReceived       (void) const { return _totalReceiveCounter; }
+    uint64_t    totalLoss           (void) const { return _totalLossCounter; }
+    float       runningLossPercent  (void) const { return _runningLossPercent; }
+
+private:
+    void _updateLossStatistics(const mavlink_message_t& message);
+
+    uint8_t             _mavlinkChannel;
+    mavlink_message_t   _message;
+    mavlink_status_t    _status;
+    mavlink_message_t   _parseBuffer;                   ///< Frame being decoded
+    mavlink_status_t    _parseStatus;                   ///< Parse state for _parseBuffer
+    uint8_t             _lastIndex[256][256];           ///< Last received sequence ID for each system/component pair
+    uint8_t             _firstMessage[256][256];        ///< First message flag for each system/component pair
+    uint64_t            _totalReceiveCounter    = 0;    ///< The total number of successfully received messages
+    uint64_t            _totalLossCounter       = 0;    ///< Total messages lost during transmission
+    float               _runningLossPercent     = 0;    ///< Loss rate
+};
+
+/// Runs the MAVLinkParser for a link on its own thread. Loss accounting and forwarding happen on that thread as well,
+/// only the decoded messages are handed over to the main thread through messagesDecoded.
+class MAVLinkParserWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    MAVLinkParserWorker(LinkInterface* link, MAVLinkProtocol* protocol);
+
+    LinkInterface* link(void) { return _link; }
+
+public slots:
+    void receiveBytes   (LinkInterface* link, QByteArray bytes);
+    void resetMetadata  (void);
+
+signals:
+    void messagesDecoded        (LinkInterface* link, MAVLinkMessageBatch batch);
+    void mavlinkMessageStatus   (int uasId, uint64_t totalSent, uint64_t totalReceived, uint64_t totalLoss, float lossPercent);
+    void incomingMavlink2       (LinkInterface* link);
+
+private:
+    void _forwardMessages(const MAVLinkMessageBatch& batch);
+
+    LinkInterface*      _link;
+    MAVLinkProtocol*    _protocol;
+    MAVLinkParser       _parser;
+    bool                _decodedFirstMessage = false;
+};
@@ -19,6 +19,7 @@
 #include <QMetaType>
 #include <QDir>
 #include <QFileInfo>
+#include <QMetaMethod>
 
 #include "MAVLinkProtocol.h"
 #include "LinkManager.h"
@@ -28,8 +29,10 @@
 #include "QGCLoggingCategory.h"
 #include "MultiVehicleManager.h"
 #include "SettingsManager.h"
+#include "MAVLinkParser.h"
 
 Q_DECLARE_METATYPE(mavlink_message_t)
+Q_DECLARE_METATYPE(MAVLinkMessageBatch)
 
 QGC_LOGGING_CATEGORY(MAVLinkProtocolLog, "MAVLinkProtocolLog")
 
@@ -43,8 +46,6 @@ const char* MAVLinkProtocol::_logFileExtension      = "mavlink";            ///<
 MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , m_enable_version_check(true)
-    , _message({})
-    , _status({})
     , versionMismatchIgnore(false)
     , systemId(255)
     , _current_version(100)
@@ -56,16 +57,16 @@ MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     , _linkMgr(nullptr)
     , _multiVehicleManager(nullptr)
 {
-    memset(totalReceiveCounter, 0, sizeof(totalReceiveCounter));
-    memset(totalLossCounter,    0, sizeof(totalLossCounter));
-    memset(runningLossPercent,  0, sizeof(runningLossPercent));
-    memset(firstMessage,        1, sizeof(firstMessage));
-    memset(&_status,            0, sizeof(_status));
-    memset(&_message,           0, sizeof(_message));
+    _tlogStatsTimer.setInterval(1000);
+    connect(&_tlogStatsTimer,   &QTimer::timeout,                   this, &MAVLinkProtocol::tlogStatsChanged);
+    connect(&_tlogWriter,       &MAVLinkTLogWriter::writeError,     this, &MAVLinkProtocol::_tlogWriteError, Qt::QueuedConnection);
 }
 
 MAVLinkProtocol::~MAVLinkProtocol()
 {
+    for (LinkInterface* link: _parserThreads.keys()) {
+        stopParsingLink(link);
+    }
     storeSettings();
     _closeLogFile();
 }
@@ -96,6 +97,7 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    _multiVehicleManager =   _toolbox->multiVehicleManager();
 
    qRegisterMetaType<mavlink_message_t>("mavlink_message_t");
+   qRegisterMetaType<MAVLinkMessageBatch>("MAVLinkMessageBatch");
 
    loadSettings();
 
@@ -109,6 +111,9 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleAdded, this, &MAVLinkProtocol::_vehicleCountChanged);
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkProtocol::_vehicleCountChanged);
 
+   connect(_app->toolbox()->settingsManager()->appSettings()->forwardMavlink(), &Fact::rawValueChanged, this, &MAVLinkProtocol::updateForwardingLinks);
+   connect(_linkMgr, &LinkManager::mavlinkSupportForwardingEnabledChanged, this, &MAVLinkProtocol::updateForwardingLinks);
+
    emit versionCheckChanged(m_enable_version_check);
 }
 
@@ -139,251 +144,206 @@ void MAVLinkProtocol::storeSettings()
 
 void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 {
-    int channel = link->mavlinkChannel();
-    totalReceiveCounter[channel] = 0;
-    totalLossCounter[channel]    = 0;
-    runningLossPercent[channel]  = 0.0f;
-    for(int i = 0; i < 256; i++) {
-        firstMessage[channel][i] =  1;
+    if (_parserThreads.contains(link)) {
+        QMetaObject::invokeMethod(_parserThreads[link].worker, &MAVLinkParserWorker::resetMetadata, Qt::QueuedConnection);
     }
     link->setDecodedFirstMavlinkPacket(false);
 }
 
-/**
- * This method parses all outcoming bytes and log a MAVLink packet.
- * @param link The interface to read from
- * @see LinkInterface
- **/
+void MAVLinkProtocol::startParsingLink(LinkInterface* link)
+{
+    if (_parserThreads.contains(link)) {
+        qCWarning(MAVLinkProtocolLog) << "startParsingLink: parser already running for link";
+        return;
+    }
 
-void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b){
+    ParserThread_t parserThread;
 
-    uint8_t bytes_time[sizeof(quint64)];
+    parserThread.worker = new MAVLinkParserWorker(link, this);
+    parserThread.thread = new QThread();
+    parserThread.thread->setObjectName(QStringLiteral("MAVLinkParser:%1").arg(link->linkConfiguration()->name()));
+    parserThread.worker->moveToThread(parserThread.thread);
 
-    Q_UNUSED(link);
-    if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
+    // Bytes are decoded on the worker thread, only the decoded messages come back to the main thread
+    connect(link,                   &LinkInterface::bytesReceived,              parserThread.worker,    &MAVLinkParserWorker::receiveBytes);
+    connect(parserThread.worker,    &MAVLinkParserWorker::messagesDecoded,      this,                   &MAVLinkProtocol::_messagesDecoded);
+    connect(parserThread.worker,    &MAVLinkParserWorker::incomingMavlink2,     this,                   &MAVLinkProtocol::_incomingMavlink2);
+    connect(parserThread.worker,    &MAVLinkParserWorker::mavlinkMessageStatus, this,                   &MAVLinkProtocol::mavlinkMessageStatus);
+
+    _parserThreads[link] = parserThread;
+    parserThread.thread->start();
+}
+
+void MAVLinkProtocol::stopParsingLink(LinkInterface* link)
+{
+    if (!_parserThreads.contains(link)) {
+        return;
+    }
 
-        quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
+    ParserThread_t parserThread = _parserThreads.take(link);
 
-        qToBigEndian(time,bytes_time);
+    disconnect(link, &LinkInterface::bytesReceived, parserThread.worker, &MAVLinkParserWorker::receiveBytes);
+    parserThread.thread->quit();
+    parserThread.thread->wait();
 
-        b.insert(0,QByteArray((const char*)bytes_time,sizeof(bytes_time)));
+    // The thread is no longer running so the worker can be deleted from here. Batches already queued to the
+    // main thread are dropped by _messagesDecoded once the link is gone.
+    delete parserThread.worker;
+    delete parserThread.thread;
+}
 
-        int len = b.length();
+void MAVLinkProtocol::updateForwardingLinks(void)
+{
+    SharedLinkInterfacePtr forwardingLink;
+    SharedLinkInterfacePtr forwardingSupportLink;
 
-        if(_tempLogFile.write(b) != len)
-        {
-            // If there's an error logging data, raise an alert and stop logging.
-            emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-            _stopLogging();
-            _logSuspendError = true;
-        }
+    if (_app->toolbox()->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool()) {
+        forwardingLink = _linkMgr->mavlinkForwardingLink();
+    }
+    if (_linkMgr->mavlinkSupportForwardingEnabled()) {
+        forwardingSupportLink = _linkMgr->mavlinkForwardingSupportLink();
     }
 
+    QMutexLocker locker(&_forwardingLinksMutex);
+    _forwardingLink         = forwardingLink;
+    _forwardingSupportLink  = forwardingSupportLink;
+}
+
+void MAVLinkProtocol::forwardingLinks(SharedLinkInterfacePtr& forwardingLink, SharedLinkInterfacePtr& forwardingSupportLink)
+{
+    QMutexLocker locker(&_forwardingLinksMutex);
+    forwardingLink          = _forwardingLink.lock();
+    forwardingSupportLink   = _forwardingSupportLink.lock();
 }
 
 /**
- * This method parses all incoming bytes and constructs a MAVLink packet.
- * It can handle multiple links in parallel, as each link has it's own buffer/
- * parsing state machine.
+ * This method parses all outcoming bytes and log a MAVLink packet.
  * @param link The interface to read from
  * @see LinkInterface
  **/
 
+void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b)
+{
+    Q_UNUSED(link);
+    if (!_logSuspendError && !_logSuspendReplay && _tlogWriter.writing()) {
+        _tlogWriter.writeBytes(b.constData(), b.size());
+    }
+}
+
 void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
 {
-    // Since receiveBytes signals cross threads we can end up with signals in the queue
-    // that come through after the link is disconnected. For these we just drop the data
-    // since the link is closed.
+    if (!_parserThreads.contains(link)) {
+        qCDebug(MAVLinkProtocolLog) << "receiveBytes: no parser for link" << b.size() << "bytes dropped";
+        return;
+    }
+    MAVLinkParserWorker* worker = _parserThreads[link].worker;
+    QMetaObject::invokeMethod(worker, [worker, link, b]() { worker->receiveBytes(link, b); }, Qt::QueuedConnection);
+}
+
+void MAVLinkProtocol::_incomingMavlink2(LinkInterface* link)
+{
     SharedLinkInterfacePtr linkPtr = _linkMgr->sharedLinkInterfacePointerForLink(link, true);
     if (!linkPtr) {
-        qCDebug(MAVLinkProtocolLog) << "receiveBytes: link gone!" << b.size() << " bytes arrived too late";
         return;
     }
 
-    uint8_t mavlinkChannel = link->mavlinkChannel();
-
-    for (int position = 0; position < b.size(); position++) {
-        if (mavlink_parse_char(mavlinkChannel, static_cast<uint8_t>(b[position]), &_message, &_status)) {
-            // Got a valid message
-            if (!link->decodedFirstMavlinkPacket()) {
-                link->setDecodedFirstMavlinkPacket(true);
-                mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-                if (!(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    qCDebug(MAVLinkProtocolLog) << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                    mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-                    // Set all links to v2
-                    setVersion(200);
-                }
-            }
-
-            //-----------------------------------------------------------------
-            // MAVLink Status
-            uint8_t lastSeq = lastIndex[_message.sysid][_message.compid];
-            uint8_t expectedSeq = lastSeq + 1;
-            // Increase receive counter
-            totalReceiveCounter[mavlinkChannel]++;
-            // Determine what the next expected sequence number is, accounting for
-            // never having seen a message for this system/component pair.
-            if(firstMessage[_message.sysid][_message.compid]) {
-                firstMessage[_message.sysid][_message.compid] = 0;
-                lastSeq     = _message.seq;
-                expectedSeq = _message.seq;
-            }
-            // And if we didn't encounter that sequence number, record the error
-            //int foo = 0;
-            if (_message.seq != expectedSeq)
-            {
-                //foo = 1;
-                int lostMessages = 0;
-                //-- Account for overflow during packet loss
-                if(_message.seq < expectedSeq) {
-                    lostMessages = (_message.seq + 255) - expectedSeq;
-                } else {
-                    lostMessages = _message.seq - expectedSeq;
-                }
-                // Log how many were lost
-                totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
-            }
-
-            // And update the last sequence number for this system/component pair
-            lastIndex[_message.sysid][_message.compid] = _message.seq;;
-            // Calculate new loss ratio
-            uint64_t totalSent = totalReceiveCounter[mavlinkChannel] + totalLossCounter[mavlinkChannel];
-            float receiveLossPercent = static_cast<float>(static_cast<double>(totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
-            receiveLossPercent *= 100.0f;
-            receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLossPercent[mavlinkChannel] * 0.5f);
-            runningLossPercent[mavlinkChannel] = receiveLossPercent;
-
-            //qDebug() << foo << _message.seq << expectedSeq << lastSeq << totalLossCounter[mavlinkChannel] << totalReceiveCounter[mavlinkChannel] << totalSentCounter[mavlinkChannel] << "(" << _message.sysid << _message.compid << ")";
-
-            //-----------------------------------------------------------------
-            // MAVLink forwarding
-            bool forwardingEnabled = _app->toolbox()->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool();
-            if (forwardingEnabled) {
-                SharedLinkInterfacePtr forwardingLink = _linkMgr->mavlinkForwardingLink();
-
-                if (forwardingLink) {
-                    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-                    int len = mavlink_msg_to_send_buffer(buf, &_message);
-                    forwardingLink->writeBytesThreadSafe((const char*)buf, len);
-                }
-            }
-
-            // MAVLink forwarding support
-            bool forwardingSupportEnabled = _linkMgr->mavlinkSupportForwardingEnabled();
-            if (forwardingSupportEnabled) {
-                SharedLinkInterfacePtr forwardingSupportLink = _linkMgr->mavlinkForwardingSupportLink();
+    mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(link->mavlinkChannel());
+    if (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1) {
+        qCDebug(MAVLinkProtocolLog) << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << link->mavlinkChannel() << mavlinkStatus->flags;
+        // Set all links to v2
+        setVersion(200);
+    }
+}
 
-                if (forwardingSupportLink) {
-                    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-                    int len = mavlink_msg_to_send_buffer(buf, &_message);
-                    forwardingSupportLink->writeBytesThreadSafe((const char*)buf, len);
-                }
-            }
+/**
+ * Called on the main thread with all the messages the link's parser worker decoded from a single read.
+ * The messages have already been counted and forwarded by the worker.
+ * @param link The interface the messages arrived on
+ * @see MAVLinkParserWorker
+ **/
+void MAVLinkProtocol::_messagesDecoded(LinkInterface* link, MAVLinkMessageBatch batch)
+{
+    // Since the batches are queued across threads we can end up with batches in the queue
+    // that come through after the link is disconnected. For these we just drop the data
+    // since the link is closed.
+    SharedLinkInterfacePtr linkPtr = _linkMgr->sharedLinkInterfacePointerForLink(link, true);
+    if (!linkPtr) {
+        qCDebug(MAVLinkProtocolLog) << "_messagesDecoded: link gone!" << batch.count() << " messages arrived too late";
+        return;
+    }
 
-            //-----------------------------------------------------------------
-            // Log data
-            if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-                uint8_t buf[MAVLINK_MAX_PACKET_LEN+sizeof(quint64)];
-
-                // Write the uint64 time in microseconds in big endian format before the message.
-                // This timestamp is saved in UTC time. We are only saving in ms precision because
-                // getting more than this isn't possible with Qt without a ton of extra code.
-                quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-                qToBigEndian(time, buf);
-
-                // Then write the message to the buffer
-                int len = mavlink_msg_to_send_buffer(buf + sizeof(quint64), &_message);
-
-                // Determine how many bytes were written by adding the timestamp size to the message size
-                len += sizeof(quint64);
-
-                // Now write this timestamp/message pair to the log.
-                QByteArray b(reinterpret_cast<const char*>(buf), len);
-                if(_tempLogFile.write(b) != len)
-                {
-                    // If there's an error logging data, raise an alert and stop logging.
-                    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-                    _stopLogging();
-                    _logSuspendError = true;
-                }
-
-                // Check for the vehicle arming going by. This is used to trigger log save.
-                if (!_vehicleWasArmed && _message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                    mavlink_heartbeat_t state;
-                    mavlink_msg_heartbeat_decode(&_message, &state);
-                    if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
-                        _vehicleWasArmed = true;
-                    }
-                }
-            }
+    if (!link->decodedFirstMavlinkPacket()) {
+        link->setDecodedFirstMavlinkPacket(true);
+    }
 
-            if (_message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                _startLogging();
-                mavlink_heartbeat_t heartbeat;
-                mavlink_msg_heartbeat_decode(&_message, &heartbeat);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, heartbeat.autopilot, heartbeat.type);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
-                _startLogging();
-                mavlink_high_latency_t highLatency;
-                mavlink_msg_high_latency_decode(&_message, &highLatency);
-                // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
-                _startLogging();
-                mavlink_high_latency2_t highLatency2;
-                mavlink_msg_high_latency2_decode(&_message, &highLatency2);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, highLatency2.autopilot, highLatency2.type);
-            }
+    // Legacy per message delivery is only paid for if someone is still listening to it
+    static const QMetaMethod messageReceivedSignal = QMetaMethod::fromSignal(&MAVLinkProtocol::messageReceived);
+    const bool emitPerMessage = isSignalConnected(messageReceivedSignal);
+
+    for (const mavlink_message_t& message : batch) {
+        _logMessage(message);
+
+        if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            _startLogging();
+            mavlink_heartbeat_t heartbeat;
+            mavlink_msg_heartbeat_decode(&message, &heartbeat);
+            emit vehicleHeartbeatInfo(link, message.sysid, message.compid, heartbeat.autopilot, heartbeat.type);
+        } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
+            _startLogging();
+            // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
+            emit vehicleHeartbeatInfo(link, message.sysid, message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
+        } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
+            _startLogging();
+            mavlink_high_latency2_t highLatency2;
+            mavlink_msg_high_latency2_decode(&message, &highLatency2);
+            emit vehicleHeartbeatInfo(link, message.sysid, message.compid, highLatency2.autopilot, highLatency2.type);
+        }
 
-#if 0
-            // Given the current state of SiK Radio firmwares there is no way to make the code below work.
-            // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
-            // packet even if the vehicle is sending Mavlink 2.
-
-            // Detect if we are talking to an old radio not supporting v2
-            mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-            if (_message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
-                if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
-                && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    _radio_version_mismatch_count++;
-                }
-            }
+        if (emitPerMessage) {
+            emit messageReceived(link, message);
+        }
 
-            if (_radio_version_mismatch_count == 5) {
-                // Warn the user if the radio continues to send v1 while the link uses v2
-                emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
-                // Set to flag warning already shown
-                _radio_version_mismatch_count = -1;
-                // Flick link back to v1
-                qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-            }
-#endif
+        // Anyone handling the heartbeat info or message could close the connection, which deletes the link,
+        // so we check if it's expired
+        if (1 == linkPtr.use_count()) {
+            return;
+        }
+    }
 
-            // Update MAVLink status on every 32th packet
-            if ((totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
-                emit mavlinkMessageStatus(_message.sysid, totalSent, totalReceiveCounter[mavlinkChannel], totalLossCounter[mavlinkChannel], receiveLossPercent);
-            }
+    emit messageBatchReceived(link, batch);
+}
 
-            // The packet is emitted as a whole, as it is only 255 - 261 bytes short
-            // kind of inefficient, but no issue for a groundstation pc.
-            // It buys as reentrancy for the whole code over all threads
-            emit messageReceived(link, _message);
+void MAVLinkProtocol::_logMessage(const mavlink_message_t& message)
+{
+    if (_logSuspendError || _logSuspendReplay || !_tlogWriter.writing()) {
+        return;
+    }
 
-            // Anyone handling the message could close the connection, which deletes the link,
-            // so we check if it's expired
-            if (1 == linkPtr.use_count()) {
-                break;
-            }
+    // The writer timestamps the message and queues it, the actual file write happens on the writer thread
+    _tlogWriter.writeMessage(message);
 
-            // Reset message parsing
-            memset(&_status,  0, sizeof(_status));
-            memset(&_message, 0, sizeof(_message));
+    // Check for the vehicle arming going by. This is used to trigger log save.
+    if (!_vehicleWasArmed && message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        mavlink_heartbeat_t state;
+        mavlink_msg_heartbeat_decode(&message, &state);
+        if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
+            _vehicleWasArmed = true;
         }
     }
 }
 
+void MAVLinkProtocol::_tlogWriteError(void)
+{
+    if (!_tlogWriter.writing()) {
+        return;
+    }
+
+    // If there's an error logging data, raise an alert and stop logging.
+    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
+    _stopLogging();
+    _logSuspendError = true;
+}
+
 /**
  * @return The name of this protocol
  **/
@@ -429,6 +389,11 @@ void MAVLinkProtocol::_vehicleCountChanged(void)
 bool MAVLinkProtocol::_closeLogFile(void)
 {
     if (_tempLogFile.isOpen()) {
+        // Everything still queued goes to the file before it is looked at
+        _tlogWriter.stopWriting();
+        _tlogStatsTimer.stop();
+        emit tlogStatsChanged();
+
         if (_tempLogFile.size() == 0) {
             // Don't save zero byte files
             _tempLogFile.remove();
@@ -471,6 +436,8 @@ void MAVLinkProtocol::_startLogging(void)
             }
 
             qCDebug(MAVLinkProtocolLog) << "Temp log" << _tempLogFile.fileName();
+            _tlogWriter.startWriting(&_tempLogFile);
+            _tlogStatsTimer.start();
             emit checkTelemetrySavePath();
 
             _logSuspendError = false;
@@ -15,6 +15,7 @@
 #include <QTimer>
 #include <QFile>
 #include <QMap>
+#include <QThread>
 #include <QByteArray>
 #include <QLoggingCategory>
 
@@ -22,9 +23,11 @@
 #include "QGCMAVLink.h"
 #include "QGC.h"
 #include "QGCTemporaryFile.h"
+#include "MAVLinkTLogWriter.h"
 #include "QGCToolbox.h"
 
 class LinkManager;
+class MAVLinkParserWorker;
 class MultiVehicleManager;
 class QGCApplication;
 
@@ -44,6 +47,14 @@ public:
     MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox);
     ~MAVLinkProtocol();
 
+    Q_PROPERTY(quint64 tlogBytesWritten     READ tlogBytesWritten   NOTIFY tlogStatsChanged)    ///< Bytes written to the current telemetry log
+    Q_PROPERTY(int     tlogQueueDepth       READ tlogQueueDepth     NOTIFY tlogStatsChanged)    ///< Bytes queued for writing to the telemetry log
+    Q_PROPERTY(quint64 tlogDroppedMessages  READ tlogDroppedMessages NOTIFY tlogStatsChanged)   ///< Messages dropped because storage could not keep up
+
+    quint64 tlogBytesWritten    (void) const { return _tlogWriter.bytesWritten(); }
+    int     tlogQueueDepth      (void) const { return _tlogWriter.queueDepth(); }
+    quint64 tlogDroppedMessages (void) const { return _tlogWriter.droppedRecords(); }
+
     /** @brief Get the human-friendly name of this protocol */
     QString getName();
     /** @brief Get the system id of this application */
@@ -68,6 +79,18 @@ public:
      */
     virtual void resetMetadataForLink(LinkInterface *link);
 
+    /// Starts the parser worker thread for the link. All bytes received on the link are decoded on that thread.
+    void startParsingLink(LinkInterface* link);
+
+    /// Stops the parser worker thread for the link. Must be called before the link's mavlink channel is freed.
+    void stopParsingLink(LinkInterface* link);
+
+    /// Re-reads forwarding settings and links. Must be called on the main thread when either changes.
+    void updateForwardingLinks(void);
+
+    /// Returns the current forwarding links, which are null if forwarding is disabled. Thread safe.
+    void forwardingLinks(SharedLinkInterfacePtr& forwardingLink, SharedLinkInterfacePtr& forwardingSupportLink);
+
     /// Suspend/Restart logging during replay.
     void suspendLogForReplay(bool suspend);
 
@@ -78,7 +101,7 @@ public:
     virtual void setToolbox(QGCToolbox *toolbox);
 
 public slots:
-    /** @brief Receive bytes from a communication interface */
+    /** @brief Hand bytes to the parser worker of a communication interface */
     void receiveBytes(LinkInterface* link, QByteArray b);
 
     /** @brief Log bytes sent from a communication interface */
@@ -103,14 +126,6 @@ public slots:
 
 protected:
     bool        m_enable_version_check;                         ///< Enable checking of version match of MAV and QGC
-    uint8_t     lastIndex[256][256];                            ///< Store the last received sequence ID for each system/componenet pair
-    uint8_t     firstMessage[256][256];                         ///< First message flag
-    uint64_t    totalReceiveCounter[MAVLINK_COMM_NUM_BUFFERS];  ///< The total number of successfully received messages
-    uint64_t    totalLossCounter[MAVLINK_COMM_NUM_BUFFERS];     ///< Total messages lost during transmission.
-    float       runningLossPercent[MAVLINK_COMM_NUM_BUFFERS];   ///< Loss rate
-
-    mavlink_message_t _message;
-    mavlink_status_t _status;
 
     bool        versionMismatchIgnore;
     int         systemId;
@@ -121,8 +136,10 @@ signals:
     /// Heartbeat received on link
     void vehicleHeartbeatInfo(LinkInterface* link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType);
 
-    /** @brief Message received and directly copied via signal */
+    /** @brief Message received and directly copied via signal. Only emitted if something is connected to it, prefer messageBatchReceived. */
     void messageReceived(LinkInterface* link, mavlink_message_t message);
+    /** @brief All messages decoded from a single receiveBytes call, in arrival order */
+    void messageBatchReceived(LinkInterface* link, const MAVLinkMessageBatch& batch);
     /** @brief Emitted if version check is enabled / disabled */
     void versionCheckChanged(bool enabled);
     /** @brief Emitted if a message from the protocol should reach the user */
@@ -152,11 +169,17 @@ signals:
     /// Emitted when a telemetry log is started to save.
     void checkTelemetrySavePath(void);
 
+    void tlogStatsChanged(void);
+
 private slots:
-    void _vehicleCountChanged(void);
+    void _vehicleCountChanged   (void);
+    void _messagesDecoded       (LinkInterface* link, MAVLinkMessageBatch batch);
+    void _incomingMavlink2      (LinkInterface* link);
+    void _tlogWriteError        (void);
 
 private:
     bool _closeLogFile(void);
+    void _logMessage(const mavlink_message_t& message);
     void _startLogging(void);
     void _stopLogging(void);
 
@@ -164,11 +187,24 @@ private:
     bool _logSuspendReplay;     ///< true: Logging suspended due to replay
     bool _vehicleWasArmed;      ///< true: Vehicle was armed during log sequence
 
-    QGCTemporaryFile    _tempLogFile;            ///< File to log to
+    QGCTemporaryFile    _tempLogFile;            ///< File to log to, only written to through _tlogWriter
+    MAVLinkTLogWriter   _tlogWriter;
+    QTimer              _tlogStatsTimer;
     static const char*  _tempLogFileTemplate;    ///< Template for temporary log file
     static const char*  _logFileExtension;       ///< Extension for log files
 
     LinkManager*            _linkMgr;
     MultiVehicleManager*    _multiVehicleManager;
+
+    typedef struct {
+        QThread*                thread;
+        MAVLinkParserWorker*    worker;
+    } ParserThread_t;
+
+    QMap<LinkInterface*, ParserThread_t> _parserThreads;      ///< Per link parser workers, only accessed from the main thread
+
+    QMutex                  _forwardingLinksMutex;
+    WeakLinkInterfacePtr    _forwardingLink;                    ///< Protected by _forwardingLinksMutex
+    WeakLinkInterfacePtr    _forwardingSupportLink;             ///< Protected by _forwardingLinksMutex
 };
 
@@ -0,0 +1,171 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkTLogWriter.h"
+#include "QGCLoggingCategory.h"
+
+#include <QFile>
+#include <QDateTime>
+#include <QtEndian>
+
+QGC_LOGGING_CATEGORY(MAVLinkTLogWriterLog, "MAVLinkTLogWriterLog")
+
+MAVLinkTLogWriter::MAVLinkTLogWriter(QObject* parent)
+    : QThread   (parent)
+    , _buffer   (kBufferSize, Qt::Uninitialized)
+{
+
+}
+
+MAVLinkTLogWriter::~MAVLinkTLogWriter()
+{
+    stopWriting();
+}
+
+void MAVLinkTLogWriter::startWriting(QFile* file)
+{
+    if (_file) {
+        qCWarning(MAVLinkTLogWriterLog) << "startWriting called while already writing";
+        return;
+    }
+
+    {
+        QMutexLocker lock(&_mutex);
+        _file       = file;
+        _head       = 0;
+        _tail       = 0;
+        _pending    = 0;
+        _stop       = false;
+    }
+    _bytesWritten   = 0;
+    _droppedRecords = 0;
+    _queueDepth     = 0;
+
+    // The tlog format wants UTC timestamps. The wall clock is only sampled once here, from then on time comes from
+    // a monotonic clock so timestamps never go backwards and have microsecond resolution.
+    _startTimeUSecs = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
+    _monotonicTimer.start();
+
+    start();
+}
+
+void MAVLinkTLogWriter::stopWriting(void)
+{
+    if (!_file) {
+        return;
+    }
+
+    {
+        QMutexLocker lock(&_mutex);
+        _stop = true;
+        _dataAvailable.wakeOne();
+    }
+    wait();
+
+    qCDebug(MAVLinkTLogWriterLog) << "stopWriting bytesWritten:droppedRecords" << _bytesWritten << _droppedRecords;
+    _file = nullptr;
+}
+
+quint64 MAVLinkTLogWriter::timestampUSecs(void) const
+{
+    return _startTimeUSecs + static_cast<quint64>(_monotonicTimer.nsecsElapsed() / 1000);
+}
+
+bool MAVLinkTLogWriter::writeMessage(const mavlink_message_t& message)
+{
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    int     len = mavlink_msg_to_send_buffer(buf, &message);
+
+    return _enqueue(buf, len);
+}
+
+bool MAVLinkTLogWriter::writeBytes(const char* bytes, int length)
+{
+    return _enqueue(reinterpret_cast<const uint8_t*>(bytes), length);
+}
+
+bool MAVLinkTLogWriter::_enqueue(const uint8_t* bytes, int length)
+{
+    const int recordLength = static_cast<int>(sizeof(quint64)) + length;
+
+    QMutexLocker lock(&_mutex);
+
+    if (kBufferSize - _pending < recordLength) {
+        // Storage can't keep up. Drop instead of growing without bound.
+        _droppedRecords++;
+        return false;
+    }
+
+    // Timestamp is taken under the lock so records from multiple producers stay in time order in the file
+    uint8_t timestamp[sizeof(quint64)];
+    qToBigEndian(timestampUSecs(), timestamp);
+
+    auto copyIn = [this](const uint8_t* src, int len) {
+        int firstSpan = qMin(len, kBufferSize - _head);
+        memcpy(_buffer.data() + _head, src, static_cast<size_t>(firstSpan));
+        if (len > firstSpan) {
+            memcpy(_buffer.data(), src + firstSpan, static_cast<size_t>(len - firstSpan));
+        }
+        _head = (_head + len) % kBufferSize;
+    };
+    copyIn(timestamp, sizeof(timestamp));
+    copyIn(bytes, length);
+
+    _pending += recordLength;
+    _queueDepth = _pending;
+    if (_pending >= kGroupCommitSize) {
+        _dataAvailable.wakeOne();
+    }
+
+    return true;
+}
+
+void MAVLinkTLogWriter::run(void)
+{
+    QMutexLocker lock(&_mutex);
+
+    while (true) {
+        if (_pending < kGroupCommitSize && !_stop) {
+            _dataAvailable.wait(&_mutex, kGroupCommitMSecs);
+        }
+
+        // Producers only ever write into the free part of the ring, so the queued span can be written without holding the lock
+        const int   pending = _pending;
+        const int   tail    = _tail;
+        const bool  stop    = _stop;
+        lock.unlock();
+
+        bool success = true;
+        if (pending) {
+            const int firstSpan = qMin(pending, kBufferSize - tail);
+            success = _file->write(_buffer.constData() + tail, firstSpan) == firstSpan;
+            if (success && pending > firstSpan) {
+                success = _file->write(_buffer.constData(), pending - firstSpan) == pending - firstSpan;
+            }
+            if (success) {
+                success = _file->flush();
+                _bytesWritten += static_cast<quint64>(pending);
+            }
+        }
+
+        lock.relock();
+        _tail       = (tail + pending) % kBufferSize;
+        _pending    -= pending;
+        _queueDepth = _pending;
+
+        if (!success) {
+            qCWarning(MAVLinkTLogWriterLog) << "Write failed" << _file->errorString();
+            emit writeError();
+            return;
+        }
+        if (stop && _pending == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QLoggingCategory>
+
+#include <atomic>
+
+#include "QGCMAVLink.h"
+
+class QFile;
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkTLogWriterLog)
+
+/// Writes timestamped MAVLink frames to a tlog file from a background thread.
+///
+/// Producers copy records into a preallocated ring buffer and return immediately. The writer thread
+/// drains the buffer in large groups, so slow storage never blocks the receive path. If the buffer
+/// fills up, new records are dropped and counted instead of growing memory.
+class MAVLinkTLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    MAVLinkTLogWriter(QObject* parent = nullptr);
+    ~MAVLinkTLogWriter();
+
+    /// Starts writing to the already opened file. The file must not be touched by anyone else until stopWriting returns.
+    void startWriting(QFile* file);
+
+    /// Flushes everything which is queued to the file and stops the writer thread
+    void stopWriting(void);
+
+    bool writing(void) const { return _file != nullptr; }
+
+    /// Queues a message, prefixed with the current timestamp. Thread safe.
+    ///     @return false: message was dropped because the buffer is full
+    bool writeMessage(const mavlink_message_t& message);
+
+    /// Queues raw bytes, prefixed with the current timestamp. Thread safe.
+    ///     @return false: bytes were dropped because the buffer is full
+    bool writeBytes(const char* bytes, int length);
+
+    /// @return Monotonic UTC time in microseconds. Anchored to the wall clock when writing starts.
+    quint64 timestampUSecs(void) const;
+
+    quint64 bytesWritten    (void) const { return _bytesWritten; }
+    quint64 droppedRecords  (void) const { return _droppedRecords; }
+    int     queueDepth      (void) const { return _queueDepth; }
+
+    static constexpr int kBufferSize        = 4 * 1024 * 1024;  ///< Ring buffer size, upper bound on memory used for queued records
+    static constexpr int kGroupCommitSize   = 64 * 1024;        ///< Writer thread is woken up once this many bytes are queued
+    static constexpr int kGroupCommitMSecs  = 250;              ///< Queued bytes are written at least this often
+
+signals:
+    /// Emitted from the writer thread if writing to the file fails. Writing stops.
+    void writeError(void);
+
+protected:
+    void run(void) final;
+
+private:
+    bool _enqueue(const uint8_t* bytes, int length);
+
+    QFile*              _file = nullptr;
+    QByteArray          _buffer;
+    int                 _head = 0;          ///< Next write position for producers, protected by _mutex
+    int                 _tail = 0;          ///< Next read position for writer thread, protected by _mutex
+    int                 _pending = 0;       ///< Bytes queued between _tail and _head, protected by _mutex
+    bool                _stop = false;      ///< protected by _mutex
+    QMutex              _mutex;
+    QWaitCondition      _dataAvailable;
+    QElapsedTimer       _monotonicTimer;
+    quint64             _startTimeUSecs = 0;
+
+    std::atomic<quint64>    _bytesWritten   { 0 };
+    std::atomic<quint64>    _droppedRecords { 0 };
+    std::atomic<int>        _queueDepth     { 0 };
+};
@@ -15,6 +15,7 @@
 #include <QDebug>
 #include <QFile>
 #include <QMutexLocker>
+#include <QRandomGenerator>
 #include <QTimer>
 
 #include <string.h>
@@ -116,8 +117,8 @@ MockLink::MockLink(SharedLinkConfigurationPtr& config)
 MockLink::~MockLink(void)
 {
     disconnect();
-    if (!_logDownloadFilename.isEmpty()) {
-        QFile::remove(_logDownloadFilename);
+    for (const QString& filename: std::as_const(_logDownloadFilenames)) {
+        QFile::remove(filename);
     }
     qCDebug(MockLinkLog) << "~MockLink" << this;
 }
@@ -863,6 +864,8 @@ void MockLink::_paramRequestListWorker(void)
 
     if ((_failureMode == MockConfiguration::FailMissingParamOnInitialReqest || _failureMode == MockConfiguration::FailMissingParamOnAllRequests) && paramName == _failParam) {
         qCDebug(MockLinkLog) << "Skipping param send:" << paramName;
+    } else if (_paramLossRate > 0 && QRandomGenerator::global()->generateDouble() < _paramLossRate) {
+        qCDebug(MockLinkLog) << "Simulated loss of param send:" << paramName;
     } else {
 
         char paramId[MAVLINK_MSG_ID_PARAM_VALUE_LEN];
@@ -996,6 +999,11 @@ void MockLink::_handleParamRequestRead(const mavlink_message_t& msg)
         return;
     }
 
+    if (_paramLossRate > 0 && QRandomGenerator::global()->generateDouble() < _paramLossRate) {
+        qCDebug(MockLinkLog) << "Simulated loss of request read response" << paramId;
+        return;
+    }
+
     mavlink_msg_param_value_pack_chan(_vehicleSystemId,
                                       componentId,                                               // component id
                                       mavlinkChannel(),
@@ -1582,17 +1590,19 @@ void MockLink::_handleLogRequestList(const mavlink_message_t& msg)
         return;
     }
 
-    mavlink_message_t responseMsg;
-    mavlink_msg_log_entry_pack_chan(_vehicleSystemId,
-                                    _vehicleComponentId,
-                                    mavlinkChannel(),
-                                    &responseMsg,
-                                    _logDownloadLogId,       // log id
-                                    1,                       // num_logs
-                                    1,                       // last_log_num
-                                    0,                       // time_utc
-                                    _logDownloadFileSize);   // size
-    respondWithMavlinkMessage(responseMsg);
+    for (uint16_t id = 0; id < _logDownloadFileCount; id++) {
+        mavlink_message_t responseMsg;
+        mavlink_msg_log_entry_pack_chan(_vehicleSystemId,
+                                        _vehicleComponentId,
+                                        mavlinkChannel(),
+                                        &responseMsg,
+                                        id,                         // log id
+                                        _logDownloadFileCount,      // num_logs
+                                        _logDownloadFileCount - 1,  // last_log_num
+                                        0,                          // time_utc
+                                        _logDownloadFileSize);      // size
+        respondWithMavlinkMessage(responseMsg);
+    }
 }
 
 QString MockLink::_createRandomFile(uint32_t byteCount)
@@ -1619,15 +1629,15 @@ void MockLink::_handleLogRequestData(const mavlink_message_t& msg)
 
     mavlink_msg_log_request_data_decode(&msg, &request);
 
-    if (_logDownloadFilename.isEmpty()) {
-#ifdef UNITTEST_BUILD
-        _logDownloadFilename = _createRandomFile(_logDownloadFileSize);
-#endif
+    if (request.id >= _logDownloadFileCount) {
+        qCWarning(MockLinkLog) << "_handleLogRequestData unknown log id" << request.id;
+        return;
     }
 
-    if (request.id != 0) {
-        qCWarning(MockLinkLog) << "_handleLogRequestData id must be 0";
-        return;
+    if (!_logDownloadFilenames.contains(request.id)) {
+#ifdef UNITTEST_BUILD
+        _logDownloadFilenames[request.id] = _createRandomFile(_logDownloadFileSize);
+#endif
     }
 
     if (request.ofs > _logDownloadFileSize - 1) {
@@ -1635,7 +1645,8 @@ void MockLink::_handleLogRequestData(const mavlink_message_t& msg)
         return;
     }
 
-    // This will trigger _logDownloadWorker to send data
+    // This will trigger _logDownloadWorker to send data. Like a vehicle, a new request replaces the one in progress.
+    _logDownloadCurrentId = request.id;
     _logDownloadCurrentOffset = request.ofs;
     if (request.ofs + request.count > _logDownloadFileSize) {
         request.count = _logDownloadFileSize - request.ofs;
@@ -1646,29 +1657,39 @@ void MockLink::_handleLogRequestData(const mavlink_message_t& msg)
 void MockLink::_logDownloadWorker(void)
 {
     if (_logDownloadBytesRemaining != 0) {
-        QFile file(_logDownloadFilename);
+        QFile file(_logDownloadFilenames.value(_logDownloadCurrentId));
         if (file.open(QIODevice::ReadOnly)) {
-            uint8_t buffer[MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN];
-
-            qint64 bytesToRead = qMin(_logDownloadBytesRemaining, (uint32_t)MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            Q_ASSERT(file.seek(_logDownloadCurrentOffset));
-            Q_ASSERT(file.read((char *)buffer, bytesToRead) == bytesToRead);
-
-            qCDebug(MockLinkLog) << "_logDownloadWorker" << _logDownloadCurrentOffset << _logDownloadBytesRemaining;
-
-            mavlink_message_t responseMsg;
-            mavlink_msg_log_data_pack_chan(_vehicleSystemId,
-                                           _vehicleComponentId,
-                                           mavlinkChannel(),
-                                           &responseMsg,
-                                           _logDownloadLogId,
-                                           _logDownloadCurrentOffset,
-                                           bytesToRead,
-                                           &buffer[0]);
-            respondWithMavlinkMessage(responseMsg);
-
-            _logDownloadCurrentOffset += bytesToRead;
-            _logDownloadBytesRemaining -= bytesToRead;
+            for (int i = 0; i < _logDataPacketsPerTick && _logDownloadBytesRemaining != 0; i++) {
+                uint8_t buffer[MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN];
+
+                qint64 bytesToRead = qMin(_logDownloadBytesRemaining, (uint32_t)MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+                if (!file.seek(_logDownloadCurrentOffset) || file.read((char *)buffer, bytesToRead) != bytesToRead) {
+                    qCWarning(MockLinkLog) << "_logDownloadWorker read failed" << file.errorString();
+                    _logDownloadBytesRemaining = 0;
+                    break;
+                }
+
+                qCDebug(MockLinkLog) << "_logDownloadWorker" << _logDownloadCurrentOffset << _logDownloadBytesRemaining;
+
+                if (_logDataLossRate > 0 && QRandomGenerator::global()->generateDouble() < _logDataLossRate) {
+                    qCDebug(MockLinkLog) << "_logDownloadWorker simulating lost LOG_DATA" << _logDownloadCurrentOffset;
+                } else {
+                    mavlink_message_t responseMsg;
+                    mavlink_msg_log_data_pack_chan(_vehicleSystemId,
+                                                   _vehicleComponentId,
+                                                   mavlinkChannel(),
+                                                   &responseMsg,
+                                                   _logDownloadCurrentId,
+                                                   _logDownloadCurrentOffset,
+                                                   bytesToRead,
+                                                   &buffer[0]);
+                    respondWithMavlinkMessage(responseMsg);
+                }
+
+                _logDataBytesSent += bytesToRead;
+                _logDownloadCurrentOffset += bytesToRead;
+                _logDownloadBytesRemaining -= bytesToRead;
+            }
 
             file.close();
         } else {
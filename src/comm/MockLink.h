@@ -19,6 +19,8 @@
 #include "MockLinkFTP.h"
 #include "QGCMAVLink.h"
 
+#include <atomic>
+
 Q_DECLARE_LOGGING_CATEGORY(MockLinkLog)
 Q_DECLARE_LOGGING_CATEGORY(MockLinkVerboseLog)
 
@@ -113,6 +115,23 @@ public:
     void            setSendStatusText   (bool sendStatusText)                           { _sendStatusText = sendStatusText; }
     void            setFailureMode      (MockConfiguration::FailureMode_t failureMode)  { _failureMode = failureMode; }
 
+    /// Simulates a lossy link for parameter download by randomly dropping PARAM_VALUE responses
+    ///     @param lossRate Fraction of responses to drop, [0.0,1.0]
+    void setParamLossRate(double lossRate) { _paramLossRate = lossRate; }
+
+    /// Sets the simulated log files returned by LOG_REQUEST_LIST, must be called before a download is requested
+    void setLogDownloadFiles(uint16_t count, uint32_t size) { _logDownloadFileCount = count; _logDownloadFileSize = size; }
+
+    /// Simulates a lossy link for log download by randomly dropping LOG_DATA messages
+    ///     @param lossRate Fraction of messages to drop, [0.0,1.0]
+    void setLogDataLossRate(double lossRate) { _logDataLossRate = lossRate; }
+
+    /// Sets the number of LOG_DATA messages sent at each 500Hz tick, which sets the simulated link bandwidth
+    void setLogDataPacketsPerTick(int count) { _logDataPacketsPerTick = count; }
+
+    /// @return Bytes of LOG_DATA sent, including dropped messages
+    quint64 logDataBytesSent(void) const { return _logDataBytesSent; }
+
     /// APM stack has strange handling of the first item of the mission list. If it has no
     /// onboard mission items, sometimes it sends back a home position in position 0 and
     /// sometimes it doesn't. Don't ask. This option allows you to configure that behavior
@@ -149,8 +168,8 @@ public:
     /// Reset the state of the MissionItemHandler to no items, no transactions in progress.
     void resetMissionItemHandler(void) { _missionItemHandler.reset(); }
 
-    /// Returns the filename for the simulated log file. Only available after a download is requested.
-    QString logDownloadFile(void) { return _logDownloadFilename; }
+    /// Returns the filename for the simulated log file. Only available after a download of the log is requested.
+    QString logDownloadFile(uint16_t id = 0) { return _logDownloadFilenames.value(id); }
 
     Q_INVOKABLE void setCommLost                    (bool commLost)   { _commLost = commLost; }
     Q_INVOKABLE void simulateConnectionRemoved      (void);
@@ -305,13 +324,19 @@ private:
 
     int _currentParamRequestListComponentIndex; // Current component index for param request list workflow, -1 for no request in progress
     int _currentParamRequestListParamIndex;     // Current parameter index for param request list workflow
+    std::atomic<double> _paramLossRate { 0 };   // Fraction of PARAM_VALUE responses to drop, set from the test thread
 
-    static const uint16_t _logDownloadLogId = 0;        ///< Id of siumulated log file
-    static const uint32_t _logDownloadFileSize = 1000;  ///< Size of simulated log file
+    uint16_t    _logDownloadFileCount = 1;      ///< Number of simulated log files, ids start at 0
+    uint32_t    _logDownloadFileSize = 1000;    ///< Size of each simulated log file
 
-    QString     _logDownloadFilename;       ///< Filename for log download which is in progress
+    QMap<uint16_t, QString> _logDownloadFilenames;  ///< Simulated log files by id, created when first requested
+    uint16_t    _logDownloadCurrentId = 0;  ///< Log being sent
     uint32_t    _logDownloadCurrentOffset;  ///< Current offset we are sending from
     uint32_t    _logDownloadBytesRemaining; ///< Number of bytes still to send, 0 = send inactive
+    // Set and read from the test thread
+    std::atomic<double>     _logDataLossRate        { 0 };  ///< Fraction of LOG_DATA messages to drop
+    std::atomic<int>        _logDataPacketsPerTick  { 1 };  ///< LOG_DATA messages sent per 500Hz tick
+    std::atomic<quint64>    _logDataBytesSent       { 0 };
 
     QGeoCoordinate  _adsbVehicleCoordinate;
     double          _adsbAngle;
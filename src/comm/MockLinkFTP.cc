@@ -11,6 +11,8 @@
 #include "MockLinkFTP.h"
 #include "MockLink.h"
 
+#include <QTimer>
+
 const MockLinkFTP::ErrorMode_t MockLinkFTP::rgFailureModes[] = {
     MockLinkFTP::errModeNoResponse,
     MockLinkFTP::errModeNakResponse,
@@ -55,13 +57,13 @@ void MockLinkFTP::_listCommand(uint8_t senderSystemId, uint8_t senderComponentId
     // We only support root path
     path = (char *)&request->data[0];
     if (!path.isEmpty() && path != "/") {
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrFail, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
+        _sendNak(senderSystemId, senderComponentId, request->hdr.session, MavlinkFTP::kErrFail, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
         return;
     }
     
     // Offset requested is past the end of the list
     if (request->hdr.offset > (uint32_t)_fileList.size()) {
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
+        _sendNak(senderSystemId, senderComponentId, request->hdr.session, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
         return;
     }
     
@@ -86,14 +88,14 @@ void MockLinkFTP::_listCommand(uint8_t senderSystemId, uint8_t senderComponentId
         _sendResponse(senderSystemId, senderComponentId, &ackResponse, outgoingSeqNumber);
     } else if (_errMode == errModeNakSecondResponse) {
         // Nak error all subsequent requests
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrFail, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
+        _sendNak(senderSystemId, senderComponentId, request->hdr.session, MavlinkFTP::kErrFail, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
         return;
     } else if (_errMode == errModeNoSecondResponse) {
         // No response for all subsequent requests
         return;
     } else {
         // FIXME: Does not support directories that span multiple packets
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
+        _sendNak(senderSystemId, senderComponentId, request->hdr.session, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
     }
 }
 
@@ -111,43 +113,60 @@ void MockLinkFTP::_openCommand(uint8_t senderSystemId, uint8_t senderComponentId
     Q_UNUSED(cchPath); // Fix initialized-but-not-referenced warning on release builds
     path = (char *)request->data;
 
-    _currentFile.close();
-
-    QString sizePrefix = sizeFilenamePrefix;
-    if (path.startsWith(sizePrefix)) {
-        QString sizeString = path.right(path.length() - sizePrefix.length());
-        tmpFilename = _createTestTempFile(sizeString.toInt());
-    } else if (path == "/general.json") {
-        tmpFilename = ":MockLink/General.MetaData.json";
-    } else if (path == "/general.json.xz") {
-        tmpFilename = ":MockLink/General.MetaData.json.xz";
-    } else if (path == "/parameter.json") {
-        tmpFilename = ":MockLink/Parameter.MetaData.json";
-    } else if (path == "/parameter.json.xz") {
-        tmpFilename = ":MockLink/Parameter.MetaData.json.xz";
-    } else if (_BinParamFileEnabled && path == "@PARAM/param.pck") {
-        tmpFilename = ":MockLink/Arduplane.params.ftp.bin";
+    // A resent open, where the response was lost or is still on its way, gets the session it already has
+    uint8_t sessionId = _sessionOpenSeqNumbers.key(seqNumber, 0);
+    if (sessionId == 0) {
+        sessionId = 1;
+        while (_sessions.contains(sessionId)) {
+            sessionId++;
+        }
+    }
+    if (!_sessions.contains(sessionId) && _sessions.count() >= _maxSessions) {
+        _sendNak(senderSystemId, senderComponentId, 0, MavlinkFTP::kErrNoSessionsAvailable, outgoingSeqNumber, MavlinkFTP::kCmdOpenFileRO);
+        return;
     }
 
-    if (!tmpFilename.isEmpty()) {
-        _currentFile.setFileName(tmpFilename);
-        if (!_currentFile.open(QIODevice::ReadOnly)) {
-            _sendNakErrno(senderSystemId, senderComponentId, _currentFile.error(), outgoingSeqNumber, MavlinkFTP::kCmdOpenFileRO);
+    QFile* file = _sessions.value(sessionId, nullptr);
+    if (!file) {
+        QString sizePrefix = sizeFilenamePrefix;
+        if (path.startsWith(sizePrefix)) {
+            QString sizeString = path.right(path.length() - sizePrefix.length());
+            tmpFilename = _createTestTempFile(sizeString.toInt());
+        } else if (path == "/general.json") {
+            tmpFilename = ":MockLink/General.MetaData.json";
+        } else if (path == "/general.json.xz") {
+            tmpFilename = ":MockLink/General.MetaData.json.xz";
+        } else if (path == "/parameter.json") {
+            tmpFilename = ":MockLink/Parameter.MetaData.json";
+        } else if (path == "/parameter.json.xz") {
+            tmpFilename = ":MockLink/Parameter.MetaData.json.xz";
+        } else if (_BinParamFileEnabled && path == "@PARAM/param.pck") {
+            tmpFilename = ":MockLink/Arduplane.params.ftp.bin";
+        }
+
+        if (tmpFilename.isEmpty()) {
+            _sendNak(senderSystemId, senderComponentId, request->hdr.session, MavlinkFTP::kErrFailFileNotFound, outgoingSeqNumber, MavlinkFTP::kCmdOpenFileRO);
             return;
         }
-    } else {
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrFailFileNotFound, outgoingSeqNumber, MavlinkFTP::kCmdOpenFileRO);
-        return;
+
+        file = new QFile(tmpFilename);
+        if (!file->open(QIODevice::ReadOnly)) {
+            _sendNakErrno(senderSystemId, senderComponentId, 0, file->error(), outgoingSeqNumber, MavlinkFTP::kCmdOpenFileRO);
+            delete file;
+            return;
+        }
+        _sessions[sessionId]                = file;
+        _sessionOpenSeqNumbers[sessionId]   = seqNumber;
     }
     
     response.hdr.opcode     = MavlinkFTP::kRspAck;
     response.hdr.req_opcode = MavlinkFTP::kCmdOpenFileRO;
-    response.hdr.session    = _sessionId;
+    response.hdr.session    = sessionId;
     
     // Data contains file length
     response.hdr.size = sizeof(uint32_t);
     /* Ardupilot sends constant wrong file size for parameter file due to dynamic on the fly generation */
-    response.openFileLength = (path == "@PARAM/param.pck" ? 1024*1024 : _currentFile.size());
+    response.openFileLength = (path == "@PARAM/param.pck" ? 1024*1024 : file->size());
     
     _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
 }
@@ -156,9 +175,10 @@ void MockLinkFTP::_readCommand(uint8_t senderSystemId, uint8_t senderComponentId
 {
     MavlinkFTP::Request	response{};
     uint16_t			outgoingSeqNumber = _nextSeqNumber(seqNumber);
+    QFile*              file = _sessions.value(request->hdr.session, nullptr);
 
-    if (request->hdr.session != _sessionId) {
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrInvalidSession, outgoingSeqNumber, MavlinkFTP::kCmdReadFile);
+    if (!file) {
+        _sendNak(senderSystemId, senderComponentId, request->hdr.session, MavlinkFTP::kErrInvalidSession, outgoingSeqNumber, MavlinkFTP::kCmdReadFile);
         return;
     }
     
@@ -168,7 +188,7 @@ void MockLinkFTP::_readCommand(uint8_t senderSystemId, uint8_t senderComponentId
         // If we get here it means the client is requesting additional data past the first request
         if (_errMode == errModeNakSecondResponse) {
             // Nak error all subsequent requests
-            _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrFail, outgoingSeqNumber, MavlinkFTP::kCmdReadFile);
+            _sendNak(senderSystemId, senderComponentId, request->hdr.session, MavlinkFTP::kErrFail, outgoingSeqNumber, MavlinkFTP::kCmdReadFile);
             return;
         } else if (_errMode == errModeNoSecondResponse) {
             // No rsponse for all subsequent requests
@@ -176,20 +196,21 @@ void MockLinkFTP::_readCommand(uint8_t senderSystemId, uint8_t senderComponentId
         }
     }
     
-    if (readOffset >= _currentFile.size()) {
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdReadFile);
+    if (readOffset >= file->size()) {
+        _sendNak(senderSystemId, senderComponentId, request->hdr.session, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdReadFile);
         return;
     }
     
-    uint8_t cBytesToRead = (uint8_t)qMin((qint64)sizeof(response.data), _currentFile.size() - readOffset);
-    _currentFile.seek(readOffset);
-    QByteArray bytes = _currentFile.read(cBytesToRead);
+    qint64  cBytesRequested = request->hdr.size ? qMin((qint64)sizeof(response.data), (qint64)request->hdr.size) : (qint64)sizeof(response.data);
+    uint8_t cBytesToRead    = (uint8_t)qMin(cBytesRequested, file->size() - readOffset);
+    file->seek(readOffset);
+    QByteArray bytes = file->read(cBytesToRead);
     memcpy(response.data, bytes.constData(), cBytesToRead);
     
     // We should always have written something, otherwise there is something wrong with the code above
     Q_ASSERT(cBytesToRead);
     
-    response.hdr.session    = _sessionId;
+    response.hdr.session    = request->hdr.session;
     response.hdr.size       = cBytesToRead;
     response.hdr.offset     = request->hdr.offset;
     response.hdr.opcode     = MavlinkFTP::kRspAck;
@@ -202,9 +223,10 @@ void MockLinkFTP::_burstReadCommand(uint8_t senderSystemId, uint8_t senderCompon
 {
     uint16_t            outgoingSeqNumber = _nextSeqNumber(seqNumber);
     MavlinkFTP::Request response{};
+    QFile*              file = _sessions.value(request->hdr.session, nullptr);
 
-    if (request->hdr.session != _sessionId) {
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrFail, outgoingSeqNumber, MavlinkFTP::kCmdBurstReadFile);
+    if (!file) {
+        _sendNak(senderSystemId, senderComponentId, request->hdr.session, MavlinkFTP::kErrFail, outgoingSeqNumber, MavlinkFTP::kCmdBurstReadFile);
         return;
     }
     
@@ -212,18 +234,18 @@ void MockLinkFTP::_burstReadCommand(uint8_t senderSystemId, uint8_t senderCompon
     int         burstCount  = 1;
     uint32_t    burstOffset = request->hdr.offset;
 
-    while (burstOffset < _currentFile.size() && burstCount++ < burstMax) {
-        _currentFile.seek(burstOffset);
+    while (burstOffset < file->size() && burstCount++ < burstMax) {
+        file->seek(burstOffset);
 
-        uint8_t     cBytes  = (uint8_t)qMin((qint64)sizeof(response.data), _currentFile.size() - burstOffset);
-        QByteArray  bytes   = _currentFile.read(cBytes);
+        uint8_t     cBytes  = (uint8_t)qMin((qint64)sizeof(response.data), file->size() - burstOffset);
+        QByteArray  bytes   = file->read(cBytes);
 
         // We should always have written something, otherwise there is something wrong with the code above
         Q_ASSERT(cBytes);
 
         memcpy(response.data, bytes.constData(), cBytes);
 
-        response.hdr.session        = _sessionId;
+        response.hdr.session        = request->hdr.session;
         response.hdr.size           = cBytes;
         response.hdr.offset         = burstOffset;
         response.hdr.opcode         = MavlinkFTP::kRspAck;
@@ -236,9 +258,9 @@ void MockLinkFTP::_burstReadCommand(uint8_t senderSystemId, uint8_t senderCompon
         burstOffset += cBytes;
     }
 
-    if (burstOffset >= _currentFile.size()) {
+    if (burstOffset >= file->size()) {
         // Burst is fully complete
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdBurstReadFile);
+        _sendNak(senderSystemId, senderComponentId, request->hdr.session, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdBurstReadFile);
     }
 }
 
@@ -246,12 +268,13 @@ void MockLinkFTP::_terminateCommand(uint8_t senderSystemId, uint8_t senderCompon
 {
     uint16_t outgoingSeqNumber = _nextSeqNumber(seqNumber);
 
-    if (request->hdr.session != _sessionId) {
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrInvalidSession, outgoingSeqNumber, MavlinkFTP::kCmdTerminateSession);
+    if (!_sessions.contains(request->hdr.session)) {
+        _sendNak(senderSystemId, senderComponentId, request->hdr.session, MavlinkFTP::kErrInvalidSession, outgoingSeqNumber, MavlinkFTP::kCmdTerminateSession);
         return;
     }
     
-    _sendAck(senderSystemId, senderComponentId, outgoingSeqNumber, MavlinkFTP::kCmdTerminateSession);
+    _closeSession(request->hdr.session);
+    _sendAck(senderSystemId, senderComponentId, request->hdr.session, outgoingSeqNumber, MavlinkFTP::kCmdTerminateSession);
 
     emit terminateCommandReceived();
 }
@@ -260,13 +283,25 @@ void MockLinkFTP::_resetCommand(uint8_t senderSystemId, uint8_t senderComponentI
 {
     uint16_t outgoingSeqNumber = _nextSeqNumber(seqNumber);
     
-    _currentFile.close();
-    _currentFile.remove();
-    _sendAck(senderSystemId, senderComponentId, outgoingSeqNumber, MavlinkFTP::kCmdResetSessions);
+    for (uint8_t sessionId: _sessions.keys()) {
+        _closeSession(sessionId);
+    }
+    _sendAck(senderSystemId, senderComponentId, 0, outgoingSeqNumber, MavlinkFTP::kCmdResetSessions);
     
     emit resetCommandReceived();
 }
 
+void MockLinkFTP::_closeSession(uint8_t sessionId)
+{
+    QFile* file = _sessions.take(sessionId);
+    _sessionOpenSeqNumbers.remove(sessionId);
+    if (file) {
+        file->close();
+        file->remove();
+        delete file;
+    }
+}
+
 void MockLinkFTP::mavlinkMessageReceived(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL) {
@@ -285,14 +320,12 @@ void MockLinkFTP::mavlinkMessageReceived(const mavlink_message_t& message)
     MavlinkFTP::Request* request = (MavlinkFTP::Request*)&requestFTP.payload[0];
 
     // kCmdOpenFileRO and kCmdResetSessions don't support retry so we can't drop those
-    if (_randomDropsEnabled && request->hdr.opcode != MavlinkFTP::kCmdOpenFileRO && request->hdr.opcode != MavlinkFTP::kCmdResetSessions) {
-        if ((rand() % 5) == 0) {
-            qDebug() << "MockLinkFTP: Random drop of incoming packet";
-            return;
-        }
+    if (request->hdr.opcode != MavlinkFTP::kCmdOpenFileRO && request->hdr.opcode != MavlinkFTP::kCmdResetSessions && _randomDrop()) {
+        qDebug() << "MockLinkFTP: Random drop of incoming packet";
+        return;
     }
 
-    if (_lastReplyValid && request->hdr.seqNumber == _lastReplySequence - 1) {
+    if (_lastReplyValid && request->hdr.seqNumber == _lastReplySequence - 1 && request->hdr.opcode == _lastReplyReqOpCode) {
         // This is the same request as the one we replied to last. It means the (n)ack got lost, and the GCS
         // resent the request
         qDebug() << "MockLinkFTP: resending response";
@@ -309,7 +342,7 @@ void MockLinkFTP::mavlinkMessageReceived(const mavlink_message_t& message)
             return;
         } else if (_errMode == errModeNakResponse) {
             // Nak all requests, the actual error send back doesn't really matter as long as it's an error
-            _sendNak(message.sysid, message.compid, MavlinkFTP::kErrFail, outgoingSeqNumber, (MavlinkFTP::OpCode_t)request->hdr.opcode);
+            _sendNak(message.sysid, message.compid, request->hdr.session, MavlinkFTP::kErrFail, outgoingSeqNumber, (MavlinkFTP::OpCode_t)request->hdr.opcode);
             return;
         }
     }
@@ -349,44 +382,44 @@ void MockLinkFTP::mavlinkMessageReceived(const mavlink_message_t& message)
 
     default:
         // nack for all NYI opcodes
-        _sendNak(message.sysid, message.compid, MavlinkFTP::kErrUnknownCommand, outgoingSeqNumber, (MavlinkFTP::OpCode_t)request->hdr.opcode);
+        _sendNak(message.sysid, message.compid, request->hdr.session, MavlinkFTP::kErrUnknownCommand, outgoingSeqNumber, (MavlinkFTP::OpCode_t)request->hdr.opcode);
         break;
     }
 }
 
 /// @brief Sends an Ack
-void MockLinkFTP::_sendAck(uint8_t targetSystemId, uint8_t targetComponentId, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpcode)
+void MockLinkFTP::_sendAck(uint8_t targetSystemId, uint8_t targetComponentId, uint8_t sessionId, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpcode)
 {
     MavlinkFTP::Request ackResponse{};
     
     ackResponse.hdr.opcode      = MavlinkFTP::kRspAck;
     ackResponse.hdr.req_opcode  = reqOpcode;
-    ackResponse.hdr.session     = _sessionId;
+    ackResponse.hdr.session     = sessionId;
     ackResponse.hdr.size        = 0;
     
     _sendResponse(targetSystemId, targetComponentId, &ackResponse, seqNumber);
 }
 
-void MockLinkFTP::_sendNak(uint8_t targetSystemId, uint8_t targetComponentId, MavlinkFTP::ErrorCode_t error, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpcode)
+void MockLinkFTP::_sendNak(uint8_t targetSystemId, uint8_t targetComponentId, uint8_t sessionId, MavlinkFTP::ErrorCode_t error, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpcode)
 {
     MavlinkFTP::Request nakResponse{};
 
     nakResponse.hdr.opcode      = MavlinkFTP::kRspNak;
     nakResponse.hdr.req_opcode  = reqOpcode;
-    nakResponse.hdr.session     = _sessionId;
+    nakResponse.hdr.session     = sessionId;
     nakResponse.hdr.size        = 1;
     nakResponse.data[0]         = error;
     
     _sendResponse(targetSystemId, targetComponentId, &nakResponse, seqNumber);
 }
 
-void MockLinkFTP::_sendNakErrno(uint8_t targetSystemId, uint8_t targetComponentId, uint8_t nakErrno, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpcode)
+void MockLinkFTP::_sendNakErrno(uint8_t targetSystemId, uint8_t targetComponentId, uint8_t sessionId, uint8_t nakErrno, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpcode)
 {
     MavlinkFTP::Request nakResponse{};
 
     nakResponse.hdr.opcode      = MavlinkFTP::kRspNak;
     nakResponse.hdr.req_opcode  = reqOpcode;
-    nakResponse.hdr.session     = _sessionId;
+    nakResponse.hdr.session     = sessionId;
     nakResponse.hdr.size        = 2;
     nakResponse.data[0]         = MavlinkFTP::kErrFailErrno;
     nakResponse.data[1]         = nakErrno;
@@ -399,6 +432,7 @@ void MockLinkFTP::_sendResponse(uint8_t targetSystemId, uint8_t targetComponentI
 {
     request->hdr.seqNumber  = seqNumber;
     _lastReplySequence      = seqNumber;
+    _lastReplyReqOpCode     = request->hdr.req_opcode;
     _lastReplyValid         = true;
     
     mavlink_msg_file_transfer_protocol_pack_chan(_systemIdServer,               // System ID
@@ -411,14 +445,25 @@ void MockLinkFTP::_sendResponse(uint8_t targetSystemId, uint8_t targetComponentI
                                                  (uint8_t*)request);            // Payload
 
     // kCmdOpenFileRO and kCmdResetSessions don't support retry so we can't drop those
-    if (_randomDropsEnabled && request->hdr.req_opcode != MavlinkFTP::kCmdOpenFileRO && request->hdr.req_opcode != MavlinkFTP::kCmdResetSessions) {
-        if ((rand() % 5) == 0) {
-            qDebug() << "MockLinkFTP: Random drop of outgoing packet";
-            return;
-        }
+    if (request->hdr.req_opcode != MavlinkFTP::kCmdOpenFileRO && request->hdr.req_opcode != MavlinkFTP::kCmdResetSessions && _randomDrop()) {
+        qDebug() << "MockLinkFTP: Random drop of outgoing packet";
+        return;
     }
     
-    _mockLink->respondWithMavlinkMessage(_lastReply);
+    const int latencyMSecs = _responseLatencyMSecs;
+    if (latencyMSecs > 0) {
+        const mavlink_message_t message = _lastReply;
+        QTimer::singleShot(latencyMSecs, this, [this, message]() { _mockLink->respondWithMavlinkMessage(message); });
+    } else {
+        _mockLink->respondWithMavlinkMessage(_lastReply);
+    }
+}
+
+bool MockLinkFTP::_randomDrop(void) const
+{
+    // Uses rand() so that unit tests stay deterministic
+    const double lossRate = _lossRate;
+    return lossRate > 0 && (static_cast<double>(rand()) / RAND_MAX) < lossRate;
 }
 
 /// @brief Generates the next sequence number given an incoming sequence number. Handles generating
@@ -14,6 +14,9 @@
 
 #include <QStringList>
 #include <QFile>
+#include <QMap>
+
+#include <atomic>
 
 class MockLink;
 
@@ -53,9 +56,22 @@ public:
     /// Called to handle an FTP message
     void mavlinkMessageReceived(const mavlink_message_t& message);
 
-    void enableRandromDrops(bool enable) { _randomDropsEnabled = enable; }
+    void enableRandromDrops(bool enable) { _lossRate = enable ? 0.2 : 0; }
     void enableBinParamFile(bool enable) { _BinParamFileEnabled = enable; }
 
+    /// Sets the fraction of incoming requests and outgoing responses which are dropped. Opens and resets are never dropped.
+    void setLossRate(double lossRate) { _lossRate = lossRate; }
+
+    /// Delays each response by the specified amount to simulate a slow link
+    void setResponseLatencyMSecs(int latencyMSecs) { _responseLatencyMSecs = latencyMSecs; }
+
+    /// @return Number of sessions which are currently open
+    int sessionCount(void) const { return _sessions.count(); }
+
+    /// @return Maximum number of sessions which can be open at the same time
+    int maxSessions(void) const { return _maxSessions; }
+    void setMaxSessions(int maxSessions) { _maxSessions = maxSessions; }
+
     static const char* sizeFilenamePrefix;
 
 signals:
@@ -66,9 +82,9 @@ signals:
     void resetCommandReceived(void);
     
 private:
-    void        _sendAck                (uint8_t targetSystemId, uint8_t targetComponentId, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpCode);
-    void        _sendNak                (uint8_t targetSystemId, uint8_t targetComponentId, MavlinkFTP::ErrorCode_t error, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpCode);
-    void        _sendNakErrno           (uint8_t targetSystemId, uint8_t targetComponentId, uint8_t nakErrno, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpCode);
+    void        _sendAck                (uint8_t targetSystemId, uint8_t targetComponentId, uint8_t sessionId, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpCode);
+    void        _sendNak                (uint8_t targetSystemId, uint8_t targetComponentId, uint8_t sessionId, MavlinkFTP::ErrorCode_t error, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpCode);
+    void        _sendNakErrno           (uint8_t targetSystemId, uint8_t targetComponentId, uint8_t sessionId, uint8_t nakErrno, uint16_t seqNumber, MavlinkFTP::OpCode_t reqOpCode);
     void        _sendResponse           (uint8_t targetSystemId, uint8_t targetComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
     void        _listCommand            (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
     void        _openCommand            (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
@@ -77,6 +93,8 @@ private:
     void        _terminateCommand       (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
     void        _resetCommand           (uint8_t senderSystemId, uint8_t senderComponentId, uint16_t seqNumber);
     uint16_t    _nextSeqNumber          (uint16_t seqNumber);
+    bool        _randomDrop             (void) const;
+    void        _closeSession           (uint8_t sessionId);
     QString     _createTestTempFile     (int size);
     
     /// if request is a string, this ensures it's null-terminated
@@ -84,17 +102,19 @@ private:
 
     QStringList _fileList;  ///< List of files returned by List command
     
-    QFile                   _currentFile;
+    QMap<uint8_t, QFile*>   _sessions;                          ///< Open files, Key: session id
+    QMap<uint8_t, uint16_t> _sessionOpenSeqNumbers;             ///< Sequence number of the open request, Key: session id
+    int                     _maxSessions        = 3;
     ErrorMode_t             _errMode            = errModeNone;  ///< Currently set error mode, as specified by setErrorMode
     const uint8_t           _systemIdServer;                    ///< System ID for server
     const uint8_t           _componentIdServer;                 ///< Component ID for server
     MockLink*               _mockLink;                          ///< MockLink to communicate through
     bool                    _lastReplyValid     = false;
     uint16_t                _lastReplySequence  = 0;
+    uint8_t                 _lastReplyReqOpCode = MavlinkFTP::kCmdNone;
     mavlink_message_t       _lastReply;
-    bool                    _randomDropsEnabled = false;
+    std::atomic<double>     _lossRate           { 0 };          ///< Set from the test thread, read on the MockLink thread
+    std::atomic<int>        _responseLatencyMSecs { 0 };
     bool                    _BinParamFileEnabled = false;
-
-    static const uint8_t    _sessionId          = 1;    ///< We only support a single fixed session
 };
 
@@ -48,6 +48,10 @@ extern mavlink_status_t m_mavlink_status[MAVLINK_COMM_NUM_BUFFERS];
 #define PACKED_STRUCT( __Declaration__ ) __pragma( pack(push, 1) ) __Declaration__ __pragma( pack(pop) )
 #endif
 
+/// Contiguous, implicitly shared set of messages decoded from a single link read. Passing a batch around
+/// (including through queued signals) only bumps a reference count, the messages themselves are not copied.
+typedef QList<mavlink_message_t> MAVLinkMessageBatch;
+
 class QGCMAVLink : public QObject
 {
     Q_OBJECT
@@ -23,6 +23,7 @@
 #include "QGC.h"
 #include "QGCApplication.h"
 #include "AppMessages.h"
+#include "CmdLineOptParser.h"
 
 #include <iostream>
 
@@ -39,12 +40,15 @@
 #endif
 
 #ifdef QT_DEBUG
-    #include "CmdLineOptParser.h"
     #ifdef Q_OS_WIN
         #include <crtdbg.h>
     #endif
 #endif
 
+#ifndef __mobile__
+    #include "TLogAnalyzer.h"
+#endif
+
 #ifdef QGC_ENABLE_BLUETOOTH
 #include <QtBluetooth/QBluetoothSocket>
 #endif
@@ -218,6 +222,24 @@ void sigHandler(int s)
 int main(int argc, char *argv[])
 {
 #ifndef __mobile__
+    // Headless telemetry log analysis. This is handled before the run guard so it can be used while QGC is running.
+    bool    analyzeTLogs = false;
+    bool    analyzeFieldsFound = false;
+    bool    analyzeOutputFound = false;
+    QString analyzeTLogsArg;
+    QString analyzeFieldsArg;
+    QString analyzeOutputArg;
+    CmdLineOpt_t rgAnalyzeOptions[] = {
+        { "--analyze-tlogs",    &analyzeTLogs,          &analyzeTLogsArg },
+        { "--analyze-fields",   &analyzeFieldsFound,    &analyzeFieldsArg },
+        { "--analyze-output",   &analyzeOutputFound,    &analyzeOutputArg },
+    };
+    ParseCmdLineOptions(argc, argv, rgAnalyzeOptions, sizeof(rgAnalyzeOptions)/sizeof(rgAnalyzeOptions[0]), false);
+    if (analyzeTLogs) {
+        QCoreApplication analyzeApp(argc, argv);
+        return TLogAnalyzer::runCommandLine(analyzeTLogsArg, analyzeFieldsArg, analyzeOutputArg);
+    }
+
     // We make the runguard key different for custom and non custom
     // builds, so they can be executed together in the same device.
     // Stable and Daily have same QGC_APPLICATION_NAME so they would
@@ -119,6 +119,13 @@ SettingsPage {
             visible:            fact.visible
             property Fact _saveCsvTelemetry: _appSettings.saveCsvTelemetry
         }
+
+        LabelledFactTextField {
+            Layout.fillWidth:   true
+            label:              qsTr("Display update rate")
+            fact:               _appSettings.telemetryDisplayRate
+            visible:            fact.visible
+        }
     }
 
     SettingsGroupLayout {
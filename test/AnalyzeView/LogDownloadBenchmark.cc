@@ -0,0 +1,62 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogDownloadBenchmark.h"
+#include "LogDownloadController.h"
+#include "MockLink.h"
+
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+
+void LogDownloadBenchmark::_downloadRateBenchmark_data(void)
+{
+    QTest::addColumn<double>("lossRate");
+
+    QTest::newRow("0%") << 0.0;
+    QTest::newRow("1%") << 0.01;
+}
+
+/// Bytes/sec of log data written while downloading several logs with a single request
+void LogDownloadBenchmark::_downloadRateBenchmark(void)
+{
+    QFETCH(double, lossRate);
+
+    const uint16_t logCount = 3;
+    const uint32_t logSize  = 1024 * 1024;
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFiles(logCount, logSize);
+    _mockLink->setLogDataLossRate(lossRate);
+    _mockLink->setLogDataPacketsPerTick(10);
+
+    LogDownloadController controller;
+    controller.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(!controller.requestingList(), 10000);
+    QmlObjectListModel* model = controller.model();
+    QCOMPARE(model->count(), static_cast<int>(logCount));
+    for (int i = 0; i < model->count(); i++) {
+        model->value<QGCLogEntry*>(i)->setSelected(true);
+    }
+
+    QTemporaryDir downloadDir;
+    QVERIFY(downloadDir.isValid());
+    QElapsedTimer timer;
+    timer.start();
+    controller.downloadToDirectory(downloadDir.path());
+    QTRY_VERIFY_WITH_TIMEOUT(!controller.downloadingLogs(), 120000);
+    const qint64 elapsedMSecs = qMax(timer.elapsed(), Q_INT64_C(1));
+
+    QCOMPARE(controller.progress(), 1.0);
+    for (uint16_t id = 0; id < logCount; id++) {
+        QCOMPARE(model->value<QGCLogEntry*>(id)->status(), QStringLiteral("Downloaded"));
+    }
+
+    const qreal totalBytes = static_cast<qreal>(logCount) * logSize;
+    QTest::setBenchmarkResult(totalBytes * 1000.0 / elapsedMSecs, QTest::BytesPerSecond);
+}
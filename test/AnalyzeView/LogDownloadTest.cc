@@ -12,6 +12,7 @@
 #include "MockLink.h"
 
 #include <QDir>
+#include <QTemporaryDir>
 
 LogDownloadTest::LogDownloadTest(void)
 {
@@ -64,3 +65,48 @@ void LogDownloadTest::downloadTest(void)
 
     delete controller;
 }
+
+void LogDownloadTest::throughputTest(void)
+{
+    const uint16_t logCount = 3;
+    const uint32_t logSize  = 256 * 1024;
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFiles(logCount, logSize);
+    _mockLink->setLogDataLossRate(0.01);
+    _mockLink->setLogDataPacketsPerTick(10);
+
+    LogDownloadController* controller = new LogDownloadController();
+
+    controller->refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(!controller->requestingList(), 10000);
+    auto model = controller->model();
+    QCOMPARE(model->count(), static_cast<int>(logCount));
+    for (int i = 0; i < model->count(); i++) {
+        QGCLogEntry* entry = model->value<QGCLogEntry*>(i);
+        QVERIFY(entry->received());
+        QCOMPARE(entry->size(), logSize);
+        entry->setSelected(true);
+    }
+
+    // All selected logs are downloaded by a single request
+    QTemporaryDir downloadDir;
+    QVERIFY(downloadDir.isValid());
+    controller->downloadToDirectory(downloadDir.path());
+    QVERIFY(controller->downloadingLogs());
+    QTRY_VERIFY_WITH_TIMEOUT(!controller->downloadingLogs(), 60000);
+
+    QCOMPARE(controller->progress(), 1.0);
+    for (uint16_t id = 0; id < logCount; id++) {
+        QCOMPARE(model->value<QGCLogEntry*>(id)->status(), QStringLiteral("Downloaded"));
+        QString downloadFile = QDir(downloadDir.path()).filePath(QStringLiteral("log_%1_UnknownDate.ulg").arg(id));
+        QVERIFY(UnitTest::fileCompare(downloadFile, _mockLink->logDownloadFile(id)));
+    }
+
+    // Lost data is re-requested selectively, so not much more than the logs themselves is sent
+    const quint64 totalBytes = static_cast<quint64>(logCount) * logSize;
+    const quint64 sentBytes = _mockLink->logDataBytesSent();
+    QVERIFY(sentBytes < totalBytes + (totalBytes / 2));
+
+    delete controller;
+}
@@ -25,6 +25,7 @@ private slots:
     //void cleanup(void) { _cleanup(); }
 
     void downloadTest(void);
+    void throughputTest(void);
 
 private:
     // LogDownloadController signals
@@ -0,0 +1,90 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkChartSeriesTest.h"
+#include "MAVLinkChartSeries.h"
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+void MAVLinkChartSeriesTest::_testWrap(void)
+{
+    MAVLinkChartSeries series(4);
+
+    QCOMPARE(series.count(), 0);
+    QVERIFY(series.points().isEmpty());
+
+    for (int i = 0; i < 3; i++) {
+        series.append(i, i * 10);
+    }
+    QCOMPARE(series.count(), 3);
+    QCOMPARE(series.points(), QList<QPointF>({ QPointF(0, 0), QPointF(1, 10), QPointF(2, 20) }));
+
+    // Once full the oldest samples are overwritten, points are still returned oldest first
+    for (int i = 3; i < 7; i++) {
+        series.append(i, i * 10);
+    }
+    QCOMPARE(series.count(), 4);
+    QCOMPARE(series.points(), QList<QPointF>({ QPointF(3, 30), QPointF(4, 40), QPointF(5, 50), QPointF(6, 60) }));
+}
+
+void MAVLinkChartSeriesTest::_testMinMax(void)
+{
+    const int capacity = 16;
+    MAVLinkChartSeries series(capacity);
+    QList<qreal> values;
+
+    // Compare against a scan of the held values, well past the point where samples start being overwritten
+    QRandomGenerator generator(1234);
+    for (int i = 0; i < capacity * 20; i++) {
+        const qreal value = generator.bounded(200) - 100;
+        series.append(i, value);
+        values.append(value);
+        if (values.count() > capacity) {
+            values.removeFirst();
+        }
+        QCOMPARE(series.minimum(), *std::min_element(values.constBegin(), values.constEnd()));
+        QCOMPARE(series.maximum(), *std::max_element(values.constBegin(), values.constEnd()));
+    }
+
+    // Extremes which are overwritten drop out of the range
+    MAVLinkChartSeries spike(3);
+    spike.append(0, 1000);
+    spike.append(1, -1000);
+    spike.append(2, 5);
+    QCOMPARE(spike.maximum(), 1000.0);
+    QCOMPARE(spike.minimum(), -1000.0);
+    spike.append(3, 6);
+    QCOMPARE(spike.maximum(), 6.0);
+    QCOMPARE(spike.minimum(), -1000.0);
+    spike.append(4, 7);
+    QCOMPARE(spike.maximum(), 7.0);
+    QCOMPARE(spike.minimum(), 5.0);
+}
+
+void MAVLinkChartSeriesTest::_testClear(void)
+{
+    MAVLinkChartSeries series(4);
+
+    for (int i = 0; i < 6; i++) {
+        series.append(i, i);
+    }
+    series.clear();
+    QCOMPARE(series.count(), 0);
+    QCOMPARE(series.minimum(), 0.0);
+    QCOMPARE(series.maximum(), 0.0);
+    QVERIFY(series.points().isEmpty());
+
+    series.append(10, -3);
+    series.append(11, 2);
+    QCOMPARE(series.points(), QList<QPointF>({ QPointF(10, -3), QPointF(11, 2) }));
+    QCOMPARE(series.minimum(), -3.0);
+    QCOMPARE(series.maximum(), 2.0);
+}
@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TLogAnalyzerTest.h"
+#include "TLogAnalyzer.h"
+#include "LogReplayIndex.h"
+#include "LinkManager.h"
+#include "QGCApplication.h"
+
+#include <QTemporaryDir>
+#include <QtEndian>
+
+/// Writes a tlog with a heartbeat for each sequence number, from sysid 1 and the specified component
+bool TLogAnalyzerTest::_writeLog(const QString& filename, uint8_t compid, const QList<uint8_t>& sequence)
+{
+    LinkManager*    linkManager = qgcApp()->toolbox()->linkManager();
+    uint8_t         channel     = linkManager->allocateMavlinkChannel();
+    if (channel == LinkManager::invalidMavlinkChannel()) {
+        return false;
+    }
+
+    QFile logFile(filename);
+    if (!logFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        linkManager->freeMavlinkChannel(channel);
+        return false;
+    }
+
+    quint64 timestamp = 1600000000000000ULL;
+    for (int i=0; i<sequence.count(); i++) {
+        mavlink_message_t   msg;
+        uint8_t             buffer[LogReplayIndex::cbTimestamp + MAVLINK_MAX_PACKET_LEN];
+
+        // The sequence number comes from the channel status
+        mavlink_get_channel_status(channel)->current_tx_seq = sequence[i];
+        mavlink_msg_heartbeat_pack_chan(1, compid, channel, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, static_cast<uint32_t>(i), MAV_STATE_ACTIVE);
+
+        qToBigEndian<quint64>(timestamp, buffer);
+        const int len = mavlink_msg_to_send_buffer(buffer + LogReplayIndex::cbTimestamp, &msg);
+        logFile.write(reinterpret_cast<const char*>(buffer), LogReplayIndex::cbTimestamp + len);
+        timestamp += 100000;
+    }
+
+    linkManager->freeMavlinkChannel(channel);
+    return true;
+}
+
+bool TLogAnalyzerTest::_readCsv(const QString& filename, QList<QStringList>& rows)
+{
+    QFile csvFile(filename);
+    if (!csvFile.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    rows.clear();
+    for (const QByteArray& line: csvFile.readAll().split('\n')) {
+        if (!line.isEmpty()) {
+            rows.append(QString(line).split(QLatin1Char(',')));
+        }
+    }
+    return true;
+}
+
+void TLogAnalyzerTest::_testSequenceAccounting(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // 252 and 2 are skipped and count as lost. The second 253 is a duplicate and 252 shows up late, both count as out of
+    // order instead of as almost a full sequence of loss. Wrapping from 255 to 0 is not a gap.
+    const QList<uint8_t> sequence = { 250, 251, 253, 253, 254, 252, 255, 0, 1, 3, 4 };
+    const QString logFilename = tempDir.filePath(QStringLiteral("sequence.tlog"));
+    QVERIFY(_writeLog(logFilename, MAV_COMP_ID_AUTOPILOT1, sequence));
+
+    TLogAnalyzer    analyzer(tempDir.path());
+    QString         errorMessage;
+    QVERIFY(analyzer.analyze(QStringList(logFilename), errorMessage));
+
+    QList<QStringList> rows;
+    QVERIFY(_readCsv(tempDir.filePath(QStringLiteral("sequence.loss.csv")), rows));
+    QCOMPARE(rows.count(), 2);
+    QCOMPARE(rows[0], QStringList({ "sysid", "compid", "received", "lost", "out_of_order", "loss_percent" }));
+    QCOMPARE(rows[1][0], QStringLiteral("1"));
+    QCOMPARE(rows[1][1], QString::number(MAV_COMP_ID_AUTOPILOT1));
+    QCOMPARE(rows[1][2], QString::number(sequence.count()));
+    QCOMPARE(rows[1][3], QStringLiteral("2"));
+    QCOMPARE(rows[1][4], QStringLiteral("2"));
+
+    QVERIFY(_readCsv(tempDir.filePath(QStringLiteral("sequence.messages.csv")), rows));
+    QCOMPARE(rows.count(), 2);
+    QCOMPARE(rows[1][0], QString::number(MAVLINK_MSG_ID_HEARTBEAT));
+    QCOMPARE(rows[1][1], QStringLiteral("HEARTBEAT"));
+    QCOMPARE(rows[1][2], QString::number(sequence.count()));
+}
+
+void TLogAnalyzerTest::_testFieldSelection(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const QList<uint8_t> sequence = { 0, 1, 2, 3 };
+    const QString logFilename = tempDir.filePath(QStringLiteral("fields.tlog"));
+    QVERIFY(_writeLog(logFilename, MAV_COMP_ID_AUTOPILOT1, sequence));
+
+    TLogAnalyzer    analyzer(tempDir.path());
+    QString         errorMessage;
+    QVERIFY(!analyzer.addField(QStringLiteral("HEARTBEAT"), errorMessage));
+    QVERIFY(!analyzer.addField(QStringLiteral("NOT_A_MESSAGE.field"), errorMessage));
+    QVERIFY(!analyzer.addField(QStringLiteral("HEARTBEAT.not_a_field"), errorMessage));
+    QVERIFY(analyzer.addField(QStringLiteral("HEARTBEAT.custom_mode"), errorMessage));
+    QVERIFY(analyzer.analyze(QStringList(tempDir.path()), errorMessage));
+
+    // One row per message, custom_mode was set to the index of the message
+    QList<QStringList> rows;
+    QVERIFY(_readCsv(tempDir.filePath(QStringLiteral("fields.HEARTBEAT.csv")), rows));
+    QCOMPARE(rows.count(), sequence.count() + 1);
+    QCOMPARE(rows[0], QStringList({ "time_usec", "sysid", "compid", "custom_mode" }));
+    for (int i=0; i<sequence.count(); i++) {
+        QCOMPARE(rows[i + 1][3], QString::number(i));
+    }
+}
+
+void TLogAnalyzerTest::_testBatches(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // More logs than fit in a single batch, each log must still get only its own results
+    const int logCount = TLogAnalyzer::kBatchFiles + 5;
+    for (int i=0; i<logCount; i++) {
+        QList<uint8_t> sequence;
+        for (int j=0; j<=i % 4; j++) {
+            sequence.append(static_cast<uint8_t>(j));
+        }
+        QVERIFY(_writeLog(tempDir.filePath(QStringLiteral("batch%1.tlog").arg(i)), MAV_COMP_ID_AUTOPILOT1, sequence));
+    }
+
+    TLogAnalyzer    analyzer(tempDir.path());
+    QString         errorMessage;
+    QVERIFY(analyzer.analyze(QStringList(tempDir.path()), errorMessage));
+
+    for (int i=0; i<logCount; i++) {
+        QList<QStringList> rows;
+        QVERIFY(_readCsv(tempDir.filePath(QStringLiteral("batch%1.messages.csv").arg(i)), rows));
+        QCOMPARE(rows.count(), 2);
+        QCOMPARE(rows[1][2], QString::number(i % 4 + 1));
+    }
+}
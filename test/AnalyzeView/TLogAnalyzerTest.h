@@ -0,0 +1,27 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for TLogAnalyzer
+class TLogAnalyzerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testSequenceAccounting    (void);
+    void _testFieldSelection        (void);
+    void _testBatches               (void);
+
+private:
+    bool _writeLog          (const QString& filename, uint8_t compid, const QList<uint8_t>& sequence);
+    bool _readCsv           (const QString& filename, QList<QStringList>& rows);
+};
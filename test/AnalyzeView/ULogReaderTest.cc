@@ -0,0 +1,287 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ULogReaderTest.h"
+#include "ULogReader.h"
+#include "ULogParser.h"
+
+#include <QFile>
+
+QByteArray ULogReaderTest::_message(char type, const QByteArray& payload)
+{
+    QByteArray message;
+    _append(message, static_cast<quint16>(payload.size()));
+    message.append(type);
+    message.append(payload);
+    return message;
+}
+
+QByteArray ULogReaderTest::_format(const QByteArray& format)
+{
+    return _message('F', format);
+}
+
+QByteArray ULogReaderTest::_addLogged(quint8 multiId, quint16 msgId, const QByteArray& name)
+{
+    QByteArray payload;
+    _append(payload, multiId);
+    _append(payload, msgId);
+    payload.append(name);
+    return _message('A', payload);
+}
+
+QByteArray ULogReaderTest::_data(quint16 msgId, const QByteArray& data)
+{
+    QByteArray payload;
+    _append(payload, msgId);
+    payload.append(data);
+    return _message('D', payload);
+}
+
+/// test_topic data: v[0] = (x, -x), v[1] = (2x, -2x), a = (a, a + 1, a + 2), flag
+QByteArray ULogReaderTest::_testData(quint64 timestamp, float x, qint16 a, bool flag)
+{
+    QByteArray data;
+    _append(data, timestamp);
+    _append(data, x);
+    _append(data, -x);
+    _append(data, 2 * x);
+    _append(data, -2 * x);
+    for (qint16 i = 0; i < 3; i++) {
+        _append(data, static_cast<qint16>(a + i));
+    }
+    _append(data, static_cast<quint8>(0xAA));   // padding
+    _append(data, static_cast<quint8>(flag));
+    return data;
+}
+
+QString ULogReaderTest::_writeLog(const QString& fileName, const QByteArray& messages)
+{
+    QByteArray log("ULog\x01\x12\x35", 7);
+    _append(log, static_cast<quint8>(1));               // version
+    _append(log, static_cast<quint64>(123456789));      // timestamp
+    log.append(messages);
+
+    const QString path = _tempDir.filePath(fileName);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(log) != log.size()) {
+        return QString();
+    }
+    return path;
+}
+
+QByteArray ULogReaderTest::_testMessages(void)
+{
+    QByteArray flagBits(40, 0);
+    QByteArray messages;
+    messages += _message('B', flagBits);
+    // Nested type is defined after the type using it
+    messages += _format("test_topic:uint64_t timestamp;vec[2] v;int16_t[3] a;uint8_t _padding0;bool flag;");
+    messages += _format("vec:float x;float y;");
+    messages += _format("other_topic:uint64_t timestamp;uint32_t value;");
+    messages += _message('I', QByteArray("\x0b" "char[3] ver" "1.0", 15));
+
+    messages += _addLogged(0, 1, "test_topic");
+    messages += _addLogged(1, 2, "test_topic");
+    messages += _addLogged(0, 3, "other_topic");
+
+    messages += _data(1, _testData(1000, 1.5f, 10, true));
+    messages += _data(3, QByteArray(12, 0));
+    messages += _data(2, _testData(1001, 7.0f, -5, false));
+    messages += _data(1, _testData(2000, 2.5f, 20, false));
+
+    // Re-subscribed under a new id, data with the old id is no longer part of the topic
+    messages += _message('R', QByteArray("\x01\x00", 2));
+    messages += _data(1, _testData(9999, 99.0f, 99, true));
+    messages += _addLogged(0, 4, "test_topic");
+    messages += _data(4, _testData(3000, 3.5f, 30, true));
+
+    // Cut off message at the end of the log
+    messages += _data(4, _testData(4000, 4.5f, 40, true)).left(10);
+    return messages;
+}
+
+void ULogReaderTest::_testFormat(void)
+{
+    QVERIFY(_tempDir.isValid());
+    const QString path = _writeLog("format.ulg", _testMessages());
+    QVERIFY(!path.isEmpty());
+
+    ULogReader reader;
+    QString errorMessage;
+    QVERIFY2(reader.open(path, errorMessage), qPrintable(errorMessage));
+    QCOMPARE(reader.version(), static_cast<quint8>(1));
+    QCOMPARE(reader.startTimestamp(), static_cast<quint64>(123456789));
+
+    const ULogReader::Topic* topic = reader.topic("test_topic");
+    QVERIFY(topic);
+    const ULogReader::Format_t& format = topic->format();
+    QCOMPARE(format.size, 32);
+
+    // Nested fields are flattened, padding is left out but takes space
+    const QStringList names = { "timestamp", "v[0].x", "v[0].y", "v[1].x", "v[1].y", "a", "flag" };
+    const QList<int> offsets = { 0, 8, 12, 16, 20, 24, 31 };
+    QCOMPARE(format.fields.count(), names.count());
+    for (int i = 0; i < names.count(); i++) {
+        QCOMPARE(format.fields[i].name, names[i]);
+        QCOMPARE(format.fields[i].offset, offsets[i]);
+    }
+    const ULogReader::Field_t* a = format.field("a");
+    QVERIFY(a);
+    QCOMPARE(a->type, ULogReader::FieldTypeInt16);
+    QCOMPARE(a->size, 2);
+    QCOMPARE(a->arraySize, 3);
+    QVERIFY(!format.field("_padding0"));
+}
+
+void ULogReaderTest::_testTopics(void)
+{
+    QVERIFY(_tempDir.isValid());
+    const QString path = _writeLog("topics.ulg", _testMessages());
+    QVERIFY(!path.isEmpty());
+
+    ULogReader reader;
+    QString errorMessage;
+    QVERIFY2(reader.open(path, errorMessage), qPrintable(errorMessage));
+    QCOMPARE(reader.topics().count(), 3);
+    QVERIFY(reader.topic("other_topic"));
+    QCOMPARE(reader.topic("other_topic")->count(), 1);
+    QVERIFY(!reader.topic("other_topic", 1));
+
+    // Instance 0 spans both subscriptions, not the data logged while it was unsubscribed or the cut off message
+    const ULogReader::Topic* topic = reader.topic("test_topic");
+    QVERIFY(topic);
+    QCOMPARE(topic->multiId(), static_cast<quint8>(0));
+    QCOMPARE(topic->count(), 3);
+
+    const ULogReader::Format_t& format = topic->format();
+    const ULogReader::Field_t* x1 = format.field("v[1].x");
+    const ULogReader::Field_t* y0 = format.field("v[0].y");
+    const ULogReader::Field_t* a = format.field("a");
+    const ULogReader::Field_t* flag = format.field("flag");
+    const QList<quint64> timestamps = { 1000, 2000, 3000 };
+    const QList<float> xs = { 1.5f, 2.5f, 3.5f };
+    const QList<qint16> as = { 10, 20, 30 };
+    const QList<bool> flags = { true, false, true };
+    int i = 0;
+    for (const ULogReader::Sample sample: *topic) {
+        QCOMPARE(sample.size(), 32);
+        QCOMPARE(sample.timestamp(), timestamps[i]);
+        QCOMPARE(sample.value<float>(x1), 2 * xs[i]);
+        QCOMPARE(sample.value<float>(y0), -xs[i]);
+        QCOMPARE(sample.value<qint16>(a, 2), static_cast<qint16>(as[i] + 2));
+        QCOMPARE(sample.toDouble(a, 1), static_cast<double>(as[i] + 1));
+        QCOMPARE(sample.toDouble(flag), flags[i] ? 1.0 : 0.0);
+        // Out of range or wrong size reads are 0
+        QCOMPARE(sample.value<qint16>(a, 3), static_cast<qint16>(0));
+        QCOMPARE(sample.value<qint32>(a), 0);
+        i++;
+    }
+    QCOMPARE(i, 3);
+
+    const ULogReader::Topic* instance1 = reader.topic("test_topic", 1);
+    QVERIFY(instance1);
+    QCOMPARE(instance1->count(), 1);
+    QCOMPARE(instance1->sample(0).timestamp(), static_cast<quint64>(1001));
+    QCOMPARE(instance1->sample(0).value<qint16>(a), static_cast<qint16>(-5));
+
+    reader.close();
+    QVERIFY(!reader.isOpen());
+    QVERIFY(reader.topics().isEmpty());
+}
+
+void ULogReaderTest::_testTopicFilter(void)
+{
+    QVERIFY(_tempDir.isValid());
+    const QString path = _writeLog("filter.ulg", _testMessages());
+    QVERIFY(!path.isEmpty());
+
+    ULogReader reader;
+    QString errorMessage;
+    QVERIFY2(reader.open(path, errorMessage, QStringList("other_topic")), qPrintable(errorMessage));
+    QCOMPARE(reader.topics().count(), 1);
+    QVERIFY(reader.topic("other_topic"));
+    QVERIFY(!reader.topic("test_topic"));
+}
+
+void ULogReaderTest::_testBadLog(void)
+{
+    QVERIFY(_tempDir.isValid());
+    ULogReader reader;
+    QString errorMessage;
+
+    QVERIFY(!reader.open(_tempDir.filePath("missing.ulg"), errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+
+    const QString badMagic = _tempDir.filePath("magic.ulg");
+    QFile file(badMagic);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(64, 'x'));
+    file.close();
+    QVERIFY(!reader.open(badMagic, errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+    QVERIFY(!reader.isOpen());
+
+    // Incompatible flags other than appended data can't be read
+    QByteArray flagBits(40, 0);
+    flagBits[8] = 0x02;
+    const QString incompat = _writeLog("incompat.ulg", _message('B', flagBits));
+    QVERIFY(!reader.open(incompat, errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+}
+
+void ULogReaderTest::_testGeoTags(void)
+{
+    QVERIFY(_tempDir.isValid());
+    QByteArray messages;
+    messages += _format("camera_capture:uint64_t timestamp;uint64_t timestamp_utc;double lat;double lon;float alt;float ground_distance;float[4] q;uint32_t seq;int8_t result;uint8_t[3] _padding0;");
+    // Captures alternate between two instances of the topic
+    messages += _addLogged(0, 7, "camera_capture");
+    messages += _addLogged(1, 8, "camera_capture");
+    for (quint32 seq = 0; seq < 4; seq++) {
+        QByteArray data;
+        _append(data, static_cast<quint64>(2000000 * (seq + 1)));
+        _append(data, static_cast<quint64>(1600000000000000ULL + seq));
+        _append(data, 47.0 + seq);
+        _append(data, 190.0);
+        _append(data, 100.0f + seq);
+        _append(data, 50.0f);
+        for (int i = 0; i < 4; i++) {
+            _append(data, 0.5f);
+        }
+        _append(data, seq);
+        _append(data, static_cast<qint8>(1));
+        // Trailing padding isn't logged
+        messages += _data(seq % 2 ? 8 : 7, data);
+    }
+    const QString path = _writeLog("geotag.ulg", messages);
+    QVERIFY(!path.isEmpty());
+
+    ULogParser parser;
+    QList<GeoTagWorker::cameraFeedbackPacket> feedback;
+    QString errorMessage;
+    QVERIFY2(parser.getTagsFromLog(path, feedback, errorMessage), qPrintable(errorMessage));
+    QCOMPARE(feedback.count(), 4);
+    for (int i = 0; i < feedback.count(); i++) {
+        QCOMPARE(feedback[i].timestamp, 2.0 * (i + 1));
+        QCOMPARE(feedback[i].imageSequence, static_cast<uint32_t>(i));
+        QCOMPARE(feedback[i].latitude, 47.0 + i);
+        QCOMPARE(feedback[i].longitude, -170.0);
+        QCOMPARE(feedback[i].altitude, 100.0f + i);
+        QCOMPARE(feedback[i].groundDistance, 50.0f);
+        QCOMPARE(feedback[i].attitudeQuaternion[3], 0.5f);
+        QCOMPARE(feedback[i].captureResult, static_cast<uint8_t>(1));
+    }
+
+    // No camera_capture topic
+    const QString noTags = _writeLog("notags.ulg", _testMessages());
+    feedback.clear();
+    QVERIFY(!parser.getTagsFromLog(noTags, feedback, errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+}
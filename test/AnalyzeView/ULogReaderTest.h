@@ -0,0 +1,42 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+/// Unit test for ULogReader and the ULog geotagging parser, run against logs written by the test
+class ULogReaderTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testFormat        (void);
+    void _testTopics        (void);
+    void _testTopicFilter   (void);
+    void _testBadLog        (void);
+    void _testGeoTags       (void);
+
+private:
+    QString     _writeLog       (const QString& fileName, const QByteArray& messages);
+    QByteArray  _testMessages   (void);
+
+    static QByteArray _message  (char type, const QByteArray& payload);
+    static QByteArray _format   (const QByteArray& format);
+    static QByteArray _addLogged(quint8 multiId, quint16 msgId, const QByteArray& name);
+    static QByteArray _data     (quint16 msgId, const QByteArray& data);
+    static QByteArray _testData (quint64 timestamp, float x, qint16 a, bool flag);
+
+    template<typename T>
+    static void _append(QByteArray& bytes, T value) { bytes.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+    QTemporaryDir _tempDir;
+};
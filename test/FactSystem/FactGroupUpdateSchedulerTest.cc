@@ -0,0 +1,117 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupUpdateSchedulerTest.h"
+#include "FactGroupUpdateScheduler.h"
+#include "FactGroup.h"
+
+#include <QSignalSpy>
+
+namespace {
+
+/// Rate limited group with two facts
+class TestFactGroup : public FactGroup
+{
+public:
+    TestFactGroup(int updateRateMSecs)
+        : FactGroup (updateRateMSecs)
+        , value1    (0, QStringLiteral("value1"), FactMetaData::valueTypeDouble, this)
+        , value2    (0, QStringLiteral("value2"), FactMetaData::valueTypeDouble, this)
+    {
+        _addFact(&value1, QStringLiteral("value1"));
+        _addFact(&value2, QStringLiteral("value2"));
+    }
+
+    Fact value1;
+    Fact value2;
+};
+
+static constexpr int _updateRateMSecs = 100;
+
+}
+
+void FactGroupUpdateSchedulerTest::_testCoalescing(void)
+{
+    TestFactGroup   factGroup(_updateRateMSecs);
+    QSignalSpy      spyValue1(&factGroup.value1, &Fact::valueChanged);
+    QSignalSpy      spyValue2(&factGroup.value2, &Fact::valueChanged);
+
+    // Changes within an update interval are not signalled until the group is flushed
+    for (int i=1; i<=10; i++) {
+        factGroup.value1.setRawValue(i);
+    }
+    QCOMPARE(spyValue1.count(), 0);
+
+    // All of them go out as a single notification with the latest value
+    QVERIFY(spyValue1.wait(_updateRateMSecs * 5));
+    QTest::qWait(_updateRateMSecs * 3);
+    QCOMPARE(spyValue1.count(), 1);
+    QCOMPARE(spyValue1[0][0].toDouble(), 10.0);
+
+    // Facts which didn't change are not signalled
+    QCOMPARE(spyValue2.count(), 0);
+}
+
+void FactGroupUpdateSchedulerTest::_testIdleGroup(void)
+{
+    TestFactGroup   factGroup(_updateRateMSecs);
+    QSignalSpy      spyValue1(&factGroup.value1, &Fact::valueChanged);
+    QSignalSpy      spyValue2(&factGroup.value2, &Fact::valueChanged);
+
+    factGroup.value1.setRawValue(1);
+    QVERIFY(spyValue1.wait(_updateRateMSecs * 5));
+    spyValue1.clear();
+
+    // Once flushed a group without changes produces no notifications
+    QTest::qWait(_updateRateMSecs * 5);
+    QCOMPARE(spyValue1.count(), 0);
+    QCOMPARE(spyValue2.count(), 0);
+}
+
+void FactGroupUpdateSchedulerTest::_testSharedFrame(void)
+{
+    TestFactGroup   factGroup1(_updateRateMSecs);
+    TestFactGroup   factGroup2(_updateRateMSecs);
+    int             group1Notifications = 0;
+    int             group2Notifications = 0;
+
+    // Groups with the same rate are flushed from the same frame, so both have been signalled before control returns
+    // to the event loop
+    connect(&factGroup1.value1, &Fact::valueChanged, this, [&]() { group1Notifications++; });
+    connect(&factGroup2.value1, &Fact::valueChanged, this, [&]() { group2Notifications++; });
+    QSignalSpy spyValue1(&factGroup1.value1, &Fact::valueChanged);
+
+    factGroup1.value1.setRawValue(1);
+    factGroup2.value1.setRawValue(1);
+    QVERIFY(spyValue1.wait(_updateRateMSecs * 5));
+    QCOMPARE(group1Notifications, 1);
+    QCOMPARE(group2Notifications, 1);
+}
+
+void FactGroupUpdateSchedulerTest::_testLiveUpdates(void)
+{
+    TestFactGroup   factGroup(_updateRateMSecs);
+    QSignalSpy      spyValue1(&factGroup.value1, &Fact::valueChanged);
+
+    // Live groups bypass the scheduler and signal every change
+    factGroup.setLiveUpdates(true);
+    for (int i=1; i<=10; i++) {
+        factGroup.value1.setRawValue(i);
+    }
+    QCOMPARE(spyValue1.count(), 10);
+
+    // Back to rate limited
+    factGroup.setLiveUpdates(false);
+    spyValue1.clear();
+    factGroup.value1.setRawValue(20);
+    factGroup.value1.setRawValue(21);
+    QCOMPARE(spyValue1.count(), 0);
+    QVERIFY(spyValue1.wait(_updateRateMSecs * 5));
+    QCOMPARE(spyValue1.count(), 1);
+}
@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for FactGroupUpdateScheduler
+class FactGroupUpdateSchedulerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testCoalescing    (void);
+    void _testIdleGroup     (void);
+    void _testSharedFrame   (void);
+    void _testLiveUpdates   (void);
+};
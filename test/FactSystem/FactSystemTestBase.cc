@@ -19,6 +19,7 @@
 #include "MultiVehicleManager.h"
 #include "QGCApplication.h"
 #include "ParameterManager.h"
+#include "Fact.h"
 
 #include <QQuickItem>
 
@@ -116,3 +117,31 @@ void FactSystemTestBase::_qmlUpdate_test(void)
 #endif
 }
 
+
+/// Test signalling for Facts updated from telemetry at a deferred rate
+void FactSystemTestBase::_telemetryUpdate_test(void)
+{
+    Fact fact(0, QStringLiteral("test"), FactMetaData::valueTypeDouble);
+    fact.setSendValueChangedSignals(false);
+
+    QSignalSpy spyValue(&fact, &Fact::valueChanged);
+    QSignalSpy spyRawValue(&fact, &Fact::rawValueChanged);
+
+    // Value changes are held until the deferred signal is sent, and only the latest value is signalled
+    fact.setRawValue(1.0f);
+    fact.setRawValue(2.0f);
+    QCOMPARE(spyValue.count(), 0);
+    QCOMPARE(spyRawValue.count(), 2);
+    QVERIFY(fact.deferredValueChangeSignal());
+    fact.sendDeferredValueChangedSignal();
+    QCOMPARE(spyValue.count(), 1);
+    QCOMPARE(spyValue[0][0].toDouble(), 2.0);
+    QVERIFY(!fact.deferredValueChangeSignal());
+
+    // Unavailable telemetry is reported as NaN over and over, which isn't a change
+    fact.setRawValue(qQNaN());
+    spyRawValue.clear();
+    fact.setRawValue(qQNaN());
+    fact._containerSetRawValue(qQNaN());
+    QCOMPARE(spyRawValue.count(), 0);
+}
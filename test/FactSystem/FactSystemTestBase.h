@@ -33,6 +33,7 @@ protected:
     void _parameter_specific_component_id_test(void);
     void _qml_test(void);
     void _qmlUpdate_test(void);
+    void _telemetryUpdate_test(void);
     
     AutoPilotPlugin*                _plugin;
 };
@@ -33,6 +33,7 @@ private slots:
     void parameter_specific_component_id_test(void) { _parameter_specific_component_id_test(); }
     void qml_test(void) { _qml_test(); }
     void qmlUpdate_test(void) { _qmlUpdate_test(); }
+    void telemetryUpdate_test(void) { _telemetryUpdate_test(); }
 };
 
 #endif
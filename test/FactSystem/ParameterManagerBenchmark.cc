@@ -0,0 +1,129 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterManagerBenchmark.h"
+#include "ParameterManagerTest.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+#include "ParameterManager.h"
+#include "ParameterCacheFile.h"
+#include "MockLink.h"
+#include "QGC.h"
+
+#include <QTemporaryDir>
+#include <QDataStream>
+
+void ParameterManagerBenchmark::_lossBenchmark_data(void)
+{
+    QTest::addColumn<double>("lossRate");
+
+    QTest::newRow("0%")     << 0.0;
+    QTest::newRow("5%")     << 0.05;
+    QTest::newRow("10%")    << 0.1;
+    QTest::newRow("25%")    << 0.25;
+}
+
+/// Full parameter download time against simulated PARAM_VALUE loss rate
+void ParameterManagerBenchmark::_lossBenchmark(void)
+{
+    QFETCH(double, lossRate);
+
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QVERIFY(vehicleMgr);
+
+    QSignalSpy spyVehicle(vehicleMgr, &MultiVehicleManager::activeVehicleAvailableChanged);
+    QSignalSpy spyParamsReady(vehicleMgr, &MultiVehicleManager::parameterReadyVehicleAvailableChanged);
+
+    QBENCHMARK_ONCE {
+        Q_ASSERT(!_mockLink);
+        _mockLink = MockLink::startPX4MockLink(false);
+        _mockLink->setParamLossRate(lossRate);
+
+        QCOMPARE(spyVehicle.wait(5000), true);
+        QCOMPARE(spyParamsReady.wait(60000), true);
+    }
+
+    QCOMPARE(spyParamsReady.takeFirst().at(0).toBool(), true);
+    Vehicle* vehicle = vehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+    QCOMPARE(vehicle->parameterManager()->missingParameters(), false);
+
+    _disconnectMockLink();
+}
+
+void ParameterManagerBenchmark::_cacheLoadBenchmark_data(void)
+{
+    QTest::addColumn<bool>("mapped");
+
+    QTest::newRow("QDataStream")    << false;
+    QTest::newRow("mapped")         << true;
+}
+
+/// Compares loading a cached parameter set from the previous QDataStream format against the mapped binary format
+void ParameterManagerBenchmark::_cacheLoadBenchmark(void)
+{
+    typedef QPair<int, QVariant>            ParamTypeVal;
+    typedef QMap<QString, ParamTypeVal>     CacheMapName2ParamTypeVal;
+
+    QFETCH(bool, mapped);
+
+    const int paramCount = 1500;
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString filename = tempDir.filePath(mapped ? "cache.v3" : "cache.v2");
+
+    const QList<ParameterCacheFile::Entry_t> entries = ParameterManagerTest::cacheEntries(paramCount);
+    if (mapped) {
+        QString errorString;
+        QVERIFY2(ParameterCacheFile::write(filename, entries, errorString), qPrintable(errorString));
+    } else {
+        CacheMapName2ParamTypeVal streamMap;
+        for (const ParameterCacheFile::Entry_t& entry: entries) {
+            streamMap[entry.name] = ParamTypeVal(entry.type, entry.value);
+        }
+        QFile streamFile(filename);
+        QVERIFY(streamFile.open(QIODevice::WriteOnly));
+        QDataStream ds(&streamFile);
+        ds << streamMap;
+    }
+
+    quint32 crc = 0;
+
+    if (mapped) {
+        QBENCHMARK {
+            ParameterCacheFile cacheFile;
+            QVERIFY(cacheFile.open(filename));
+            crc = cacheFile.hash();
+            for (int i=0; i<cacheFile.count(); i++) {
+                const QString   name    = cacheFile.name(i);
+                const QVariant  value   = cacheFile.value(i);
+                Q_UNUSED(name);
+                Q_UNUSED(value);
+            }
+            QCOMPARE(cacheFile.count(), paramCount);
+        }
+    } else {
+        QBENCHMARK {
+            CacheMapName2ParamTypeVal cacheMap;
+            QFile streamFile(filename);
+            QVERIFY(streamFile.open(QIODevice::ReadOnly));
+            QDataStream ds(&streamFile);
+            ds >> cacheMap;
+            crc = 0;
+            for (auto it = cacheMap.constBegin(); it != cacheMap.constEnd(); it++) {
+                const QByteArray name = it.key().toLatin1();
+                crc = QGC::crc32(reinterpret_cast<const quint8*>(name.constData()), static_cast<unsigned>(name.length()), crc);
+                crc = QGC::crc32(reinterpret_cast<const quint8*>(it.value().second.constData()), static_cast<unsigned>(FactMetaData::typeToSize(static_cast<FactMetaData::ValueType_t>(it.value().first))), crc);
+            }
+            QCOMPARE(cacheMap.count(), paramCount);
+        }
+    }
+    Q_UNUSED(crc);
+}
@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Parameter load and cache benchmarks. These are registered standalone since a lossy download can take close to a
+/// minute.
+///     QGroundControl --unittest:ParameterManagerBenchmark
+class ParameterManagerBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _lossBenchmark_data(void);
+    void _lossBenchmark(void);
+    void _cacheLoadBenchmark_data(void);
+    void _cacheLoadBenchmark(void);
+};
@@ -13,6 +13,10 @@
 #include "QGCApplication.h"
 #include "ParameterManager.h"
 
+#include <QTemporaryDir>
+
+#include <algorithm>
+
 /// Test failure modes which should still lead to param load success
 void ParameterManagerTest::_noFailureWorker(MockConfiguration::FailureMode_t failureMode)
 {
@@ -231,3 +235,70 @@ void ParameterManagerTest::_FTPChangeParam()
     QCOMPARE(arguments.count(), 1);
     QCOMPARE(arguments.at(0).toFloat(), 0.0f);
 }
+
+/// Synthetic parameter set in the shape of a typical autopilot parameter list
+QList<ParameterCacheFile::Entry_t> ParameterManagerTest::cacheEntries(int count)
+{
+    QList<ParameterCacheFile::Entry_t> entries;
+
+    for (int i=0; i<count; i++) {
+        const QString name = QStringLiteral("PARAM_%1").arg(count - i, 5, 10, QLatin1Char('0'));
+        switch (i % 3) {
+        case 0:
+            entries.append({ name, FactMetaData::valueTypeFloat, QVariant::fromValue(static_cast<float>(i) / 3.0f), false });
+            break;
+        case 1:
+            entries.append({ name, FactMetaData::valueTypeInt32, QVariant::fromValue(static_cast<qint32>(-i)), false });
+            break;
+        default:
+            entries.append({ name, FactMetaData::valueTypeUint8, QVariant::fromValue(static_cast<uint>(i & 0xFF)), (i % 30) == 2 });
+            break;
+        }
+    }
+
+    return entries;
+}
+
+void ParameterManagerTest::_cacheFile(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString filename = tempDir.filePath("cache.v3");
+
+    QList<ParameterCacheFile::Entry_t> entries = cacheEntries(100);
+    QString errorString;
+    QVERIFY2(ParameterCacheFile::write(filename, entries, errorString), qPrintable(errorString));
+
+    ParameterCacheFile cacheFile;
+    QVERIFY(cacheFile.open(filename));
+    QCOMPARE(cacheFile.count(), entries.count());
+
+    // Names come back sorted, with the same hash the vehicle would compute over the sorted set
+    std::sort(entries.begin(), entries.end(), [](const ParameterCacheFile::Entry_t& a, const ParameterCacheFile::Entry_t& b) { return a.name < b.name; });
+    QCOMPARE(cacheFile.hash(), ParameterCacheFile::hash(entries));
+    for (int i=0; i<entries.count(); i++) {
+        QCOMPARE(cacheFile.name(i), entries[i].name);
+        QCOMPARE(cacheFile.type(i), entries[i].type);
+        QCOMPARE(cacheFile.value(i).toDouble(), entries[i].value.toDouble());
+        QCOMPARE(cacheFile.indexOf(entries[i].name), i);
+    }
+    QCOMPARE(cacheFile.indexOf("NOT_A_PARAM"), -1);
+
+    // Volatile parameters do not change the hash
+    const quint32 hash = ParameterCacheFile::hash(entries);
+    for (ParameterCacheFile::Entry_t& entry: entries) {
+        if (entry.volatileValue) {
+            entry.value = 42;
+        }
+    }
+    QCOMPARE(ParameterCacheFile::hash(entries), hash);
+    cacheFile.close();
+
+    // Corrupt files are rejected
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    file.seek(file.size() - 1);
+    file.write("?");
+    file.close();
+    QVERIFY(!cacheFile.open(filename));
+}
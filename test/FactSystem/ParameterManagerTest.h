@@ -15,11 +15,16 @@
 #include "MockLink.h"
 #include "MultiSignalSpy.h"
 #include "MockLink.h"
+#include "ParameterCacheFile.h"
 
 class ParameterManagerTest : public UnitTest
 {
     Q_OBJECT
-    
+
+public:
+    /// Synthetic parameter set in the shape of a typical autopilot parameter list
+    static QList<ParameterCacheFile::Entry_t> cacheEntries(int count);
+
 private slots:
     void _noFailure(void);
     void _requestListNoResponse(void);
@@ -27,6 +32,7 @@ private slots:
     void _requestListMissingParamFail(void);
     void _FTPnoFailure(void);
     void _FTPChangeParam(void);
+    void _cacheFile(void);
 
 
 private:
@@ -0,0 +1,151 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MissionControllerBenchmark.h"
+#include "MissionControllerTest.h"
+#include "PlanMasterController.h"
+#include "MissionController.h"
+#include "PlanUndoHistory.h"
+
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+
+QGC_LOGGING_CATEGORY(MissionControllerBenchmarkLog, "MissionControllerBenchmarkLog")
+
+void MissionControllerBenchmark::init(void)
+{
+    UnitTest::init();
+
+    _masterController = new PlanMasterController(MAV_AUTOPILOT_PX4, MAV_TYPE_QUADROTOR, this);
+    _masterController->setFlyView(false);
+    _masterController->start();
+    _missionController = _masterController->missionController();
+}
+
+void MissionControllerBenchmark::cleanup(void)
+{
+    delete _masterController;
+    _masterController   = nullptr;
+    _missionController  = nullptr;
+
+    UnitTest::cleanup();
+}
+
+/// Loads a plan written by MissionControllerTest::writeWaypointsFile, recalcs are done on return
+void MissionControllerBenchmark::_loadWaypoints(int cWaypoints)
+{
+    QTemporaryDir tempDir;
+    const QString filename = tempDir.filePath(QStringLiteral("%1Waypoints.waypoints").arg(cWaypoints));
+    QVERIFY(MissionControllerTest::writeWaypointsFile(filename, cWaypoints));
+
+    QElapsedTimer timer;
+    timer.start();
+    QSignalSpy spyDistance(_missionController, &MissionController::missionDistanceChanged);
+    _masterController->loadFromFile(filename);
+    QCOMPARE(_missionController->visualItems()->count(), cWaypoints + 1);
+    QVERIFY(spyDistance.wait(30000));
+    QTest::qWait(100);
+    qCDebug(MissionControllerBenchmarkLog) << "Loaded" << cWaypoints << "waypoints msecs:" << timer.elapsed();
+}
+
+void MissionControllerBenchmark::_flightStatusBenchmark_data(void)
+{
+    QTest::addColumn<int>("cWaypoints");
+    QTest::addColumn<bool>("editAtStart");
+
+    for (int cWaypoints: { 500, 1000, 5000 }) {
+        QTest::addRow("%d waypoints edit at end", cWaypoints)    << cWaypoints << false;
+        QTest::addRow("%d waypoints edit at start", cWaypoints)  << cWaypoints << true;
+    }
+}
+
+/// Time from an edit of a coordinate until the mission flight status is updated. Edits near the end of the plan only
+/// walk a few items, edits at the start walk all of them.
+void MissionControllerBenchmark::_flightStatusBenchmark(void)
+{
+    QFETCH(int,     cWaypoints);
+    QFETCH(bool,    editAtStart);
+
+    _loadWaypoints(cWaypoints);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    VisualMissionItem* item = _missionController->visualItems()->value<VisualMissionItem*>(editAtStart ? 2 : cWaypoints - 1);
+    QSignalSpy spyDistance(_missionController, &MissionController::missionDistanceChanged);
+    QBENCHMARK {
+        item->setCoordinate(item->coordinate().atDistanceAndAzimuth(10, 90));
+        QVERIFY(spyDistance.wait(10000));
+    }
+}
+
+void MissionControllerBenchmark::_undoBenchmark_data(void)
+{
+    QTest::addColumn<bool>("reportUndo");
+
+    QTest::newRow("capture")   << false;
+    QTest::newRow("undo")      << true;
+}
+
+/// Time to capture and undo a single edit of a large plan, reported per edit. Item states of the plan are shared between
+/// snapshots, so only the edited item is saved again and only that item is updated by the undo.
+void MissionControllerBenchmark::_undoBenchmark(void)
+{
+    QFETCH(bool, reportUndo);
+
+    const int cWaypoints    = 5000;
+    const int cCycles       = 1000;
+
+    _loadWaypoints(cWaypoints);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    PlanUndoHistory*    undoHistory = _masterController->undoHistory();
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    QCOMPARE(undoHistory->count(), 1);
+    QCOMPARE(undoHistory->itemStateCount(), cWaypoints);
+
+    QElapsedTimer   timer;
+    qint64          captureNSecs    = 0;
+    qint64          undoNSecs       = 0;
+    for (int cycle=0; cycle<cCycles; cycle++) {
+        const int           index           = 1 + ((cycle * 37) % cWaypoints);
+        VisualMissionItem*  item            = visualItems->value<VisualMissionItem*>(index);
+        const QGeoCoordinate oldCoordinate  = item->coordinate();
+
+        item->setCoordinate(oldCoordinate.atDistanceAndAzimuth(10, 90));
+        timer.start();
+        undoHistory->capture();
+        captureNSecs += timer.nsecsElapsed();
+
+        timer.start();
+        _masterController->undo();
+        undoNSecs += timer.nsecsElapsed();
+
+        QCOMPARE(visualItems->value<VisualMissionItem*>(index), item);
+        QCOMPARE(item->coordinate(), oldCoordinate);
+    }
+
+    // Undone edits don't pile up, at most the last undone item state is still held
+    QVERIFY(undoHistory->count() <= 2);
+    QVERIFY(undoHistory->itemStateCount() <= cWaypoints + 1);
+
+    // Edits without undo are bounded by the maximum number of snapshots
+    for (int i=0; i<PlanUndoHistory::maxSnapshots * 2; i++) {
+        VisualMissionItem* item = visualItems->value<VisualMissionItem*>(1 + ((i * 37) % cWaypoints));
+        item->setCoordinate(item->coordinate().atDistanceAndAzimuth(10, 90));
+        undoHistory->capture();
+    }
+    QCOMPARE(undoHistory->count(), static_cast<int>(PlanUndoHistory::maxSnapshots));
+    QVERIFY(undoHistory->itemStateCount() <= cWaypoints + PlanUndoHistory::maxSnapshots);
+
+    qCDebug(MissionControllerBenchmarkLog) << cCycles << "edits capture nsecs:" << captureNSecs << "undo nsecs:" << undoNSecs;
+    QTest::setBenchmarkResult(static_cast<qreal>(reportUndo ? undoNSecs : captureNSecs) / cCycles, QTest::WalltimeNanoseconds);
+}
@@ -0,0 +1,41 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MissionControllerBenchmarkLog)
+
+class PlanMasterController;
+class MissionController;
+
+/// Plan editing benchmarks against large plans. Registered standalone since loading the largest plans takes a while,
+/// run them with:
+///     QGroundControl --unittest:MissionControllerBenchmark
+class MissionControllerBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void init(void) final;
+    void cleanup(void) final;
+
+    void _flightStatusBenchmark_data(void);
+    void _flightStatusBenchmark     (void);
+    void _undoBenchmark_data        (void);
+    void _undoBenchmark             (void);
+
+private:
+    void _loadWaypoints(int cWaypoints);
+
+    PlanMasterController*   _masterController   = nullptr;
+    MissionController*      _missionController  = nullptr;
+};
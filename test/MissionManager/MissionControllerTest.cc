@@ -17,6 +17,9 @@
 #include "SettingsManager.h"
 #include "AppSettings.h"
 
+#include <QElapsedTimer>
+#include <QSignalSpy>
+
 MissionControllerTest::MissionControllerTest(void)
 {
     
@@ -288,3 +291,101 @@ void MissionControllerTest::_testGlobalAltMode(void)
         }
     }
 }
+
+bool MissionControllerTest::writeWaypointsFile(const QString& filename, int cWaypoints)
+{
+    QFile file(filename);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        return false;
+    }
+    QTextStream stream(&file);
+    stream << "QGC WPL 110\n";
+    QGeoCoordinate coord(47.6, -122.1);
+    for (int i=0; i<=cWaypoints; i++) {
+        // First line is the planned home position
+        stream << QStringLiteral("%1\t0\t3\t16\t0\t0\t0\t0\t%2\t%3\t50\t1\n").arg(i).arg(coord.latitude(), 0, 'f', 8).arg(coord.longitude(), 0, 'f', 8);
+        coord = coord.atDistanceAndAzimuth(100, i % 2 ? 30 : 60);
+    }
+    stream.flush();
+    return stream.status() == QTextStream::Ok;
+}
+
+/// Loads a plan written by writeWaypointsFile, recalcs are done on return
+void MissionControllerTest::_loadWaypoints(const QTemporaryDir& tempDir, int cWaypoints)
+{
+    const QString filename = tempDir.filePath(QStringLiteral("%1Waypoints.waypoints").arg(cWaypoints));
+    QVERIFY(writeWaypointsFile(filename, cWaypoints));
+
+    QSignalSpy spyDistance(_missionController, &MissionController::missionDistanceChanged);
+    _masterController->loadFromFile(filename);
+    QCOMPARE(_missionController->visualItems()->count(), cWaypoints + 1);
+    QVERIFY(spyDistance.wait(30000));
+    QTest::qWait(100);
+}
+
+/// Checks the flight status values of a plan loaded by _loadWaypoints
+void MissionControllerTest::_verifyFlightStatus(void)
+{
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+
+    // The first waypoint isn't linked to home, there is no takeoff
+    double distanceFromStart = 0;
+    for (int i=2; i<visualItems->count(); i++) {
+        VisualMissionItem* prevItem = visualItems->value<VisualMissionItem*>(i - 1);
+        VisualMissionItem* item = visualItems->value<VisualMissionItem*>(i);
+        const double distance = prevItem->coordinate().distanceTo(item->coordinate());
+        distanceFromStart += distance;
+        QCOMPARE(item->distance(), distance);
+        QCOMPARE(item->distanceFromStart(), distanceFromStart);
+    }
+    QCOMPARE(_missionController->missionDistance(), distanceFromStart);
+}
+
+/// @return Time from an edit of the item's coordinate until the mission flight status is updated
+qint64 MissionControllerTest::_editLatencyNSecs(int visualItemIndex)
+{
+    VisualMissionItem* item = _missionController->visualItems()->value<VisualMissionItem*>(visualItemIndex);
+    QSignalSpy spyDistance(_missionController, &MissionController::missionDistanceChanged);
+
+    QElapsedTimer timer;
+    timer.start();
+    item->setCoordinate(item->coordinate().atDistanceAndAzimuth(10, 90));
+    if (!spyDistance.wait(10000)) {
+        return -1;
+    }
+    return timer.nsecsElapsed();
+}
+
+void MissionControllerTest::_testIncrementalFlightStatus(void)
+{
+    QTemporaryDir tempDir;
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+    _loadWaypoints(tempDir, 20);
+    _verifyFlightStatus();
+
+    // Edits late in the plan leave the values of earlier items as they are, the rest must match a full recalc
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    QList<double> prevDistances;
+    for (int i=0; i<visualItems->count(); i++) {
+        prevDistances.append(visualItems->value<VisualMissionItem*>(i)->distanceFromStart());
+    }
+    QVERIFY(_editLatencyNSecs(15) > 0);
+    _verifyFlightStatus();
+    for (int i=0; i<15; i++) {
+        QCOMPARE(visualItems->value<VisualMissionItem*>(i)->distanceFromStart(), prevDistances[i]);
+    }
+    QVERIFY(visualItems->value<VisualMissionItem*>(15)->distanceFromStart() != prevDistances[15]);
+
+    // Edits early in the plan after late ones
+    QVERIFY(_editLatencyNSecs(2) > 0);
+    _verifyFlightStatus();
+    QVERIFY(_editLatencyNSecs(visualItems->count() - 1) > 0);
+    _verifyFlightStatus();
+
+    // Removing an item invalidates the saved states after it
+    _missionController->removeVisualItem(10);
+    QTest::qWait(100);
+    _verifyFlightStatus();
+    QVERIFY(_editLatencyNSecs(12) > 0);
+    _verifyFlightStatus();
+}
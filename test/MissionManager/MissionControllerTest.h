@@ -21,6 +21,7 @@
 #include "SimpleMissionItem.h"
 
 #include <QGeoCoordinate>
+#include <QTemporaryDir>
 
 class MissionControllerTest : public MissionControllerManagerTest
 {
@@ -29,6 +30,9 @@ class MissionControllerTest : public MissionControllerManagerTest
 public:
     MissionControllerTest(void);
 
+    /// Writes a "QGC WPL 110" plan of waypoints in a line heading north east, after the planned home position
+    static bool writeWaypointsFile(const QString& filename, int cWaypoints);
+
 private slots:
     void cleanup(void);
 
@@ -38,6 +42,7 @@ private slots:
     void _testGlobalAltMode             (void);
     void _testGimbalRecalc              (void);
     void _testVehicleYawRecalc          (void);
+    void _testIncrementalFlightStatus   (void);
 
 private:
 #if 0
@@ -53,6 +58,9 @@ private:
     void _testOfflineToOnlineWorker(MAV_AUTOPILOT firmwareType);
 #endif
     void _setupVisualItemSignals(VisualMissionItem* visualItem);
+    void _loadWaypoints(const QTemporaryDir& tempDir, int cWaypoints);
+    void _verifyFlightStatus(void);
+    qint64 _editLatencyNSecs(int visualItemIndex);
 
     // MissiomItems signals
 
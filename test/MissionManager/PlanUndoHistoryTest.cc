@@ -0,0 +1,195 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "PlanUndoHistoryTest.h"
+#include "PlanUndoHistory.h"
+#include "SurveyComplexItem.h"
+#include "QGCFencePolygon.h"
+
+const QGeoCoordinate PlanUndoHistoryTest::_startCoordinate(47.6, -122.1);
+
+PlanUndoHistoryTest::PlanUndoHistoryTest(void)
+{
+
+}
+
+void PlanUndoHistoryTest::init(void)
+{
+    UnitTest::init();
+
+    _masterController = new PlanMasterController(MAV_AUTOPILOT_PX4, MAV_TYPE_QUADROTOR, this);
+    _masterController->setFlyView(false);
+    _masterController->start();
+    _missionController = _masterController->missionController();
+    _undoHistory = _masterController->undoHistory();
+
+    QCOMPARE(_undoHistory->count(), 1);
+    QVERIFY(!_masterController->canUndo());
+    QVERIFY(!_masterController->canRedo());
+}
+
+void PlanUndoHistoryTest::cleanup(void)
+{
+    delete _masterController;
+    _masterController   = nullptr;
+    _missionController  = nullptr;
+    _undoHistory        = nullptr;
+
+    UnitTest::cleanup();
+}
+
+QList<VisualMissionItem*> PlanUndoHistoryTest::_insertWaypoints(int cWaypoints)
+{
+    QList<VisualMissionItem*> items;
+    QGeoCoordinate coord = _startCoordinate;
+    for (int i=0; i<cWaypoints; i++) {
+        items.append(_missionController->insertSimpleMissionItem(coord, -1));
+        coord = coord.atDistanceAndAzimuth(100, 45);
+    }
+    _undoHistory->capture();
+    return items;
+}
+
+void PlanUndoHistoryTest::_testSimpleItemUndoRedo(void)
+{
+    QList<VisualMissionItem*> items = _insertWaypoints(3);
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    QCOMPARE(visualItems->count(), 4);
+    QVERIFY(_masterController->canUndo());
+
+    const QGeoCoordinate oldCoordinate = items[1]->coordinate();
+    const QGeoCoordinate newCoordinate = oldCoordinate.atDistanceAndAzimuth(50, 90);
+    items[1]->setCoordinate(newCoordinate);
+    _undoHistory->capture();
+    QCOMPARE(_undoHistory->count(), 3);
+
+    // The changed item is updated in place, no items are replaced
+    _masterController->undo();
+    QCOMPARE(visualItems->count(), 4);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(1), items[0]);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(2), items[1]);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(3), items[2]);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(2)->coordinate(), oldCoordinate);
+    QVERIFY(_masterController->canRedo());
+    QVERIFY(_missionController->dirty());
+
+    _masterController->redo();
+    QCOMPARE(visualItems->count(), 4);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(1), items[0]);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(2), items[1]);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(3), items[2]);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(2)->coordinate(), newCoordinate);
+    QVERIFY(!_masterController->canRedo());
+
+    // A new change drops the redo
+    _masterController->undo();
+    visualItems->value<VisualMissionItem*>(3)->setCoordinate(_startCoordinate);
+    _undoHistory->capture();
+    QVERIFY(!_masterController->canRedo());
+    QCOMPARE(_undoHistory->count(), 3);
+
+    // Capturing without changes doesn't add a step
+    _undoHistory->capture();
+    QCOMPARE(_undoHistory->count(), 3);
+
+    // A new plan starts a new history
+    _masterController->removeAll();
+    QCOMPARE(_undoHistory->count(), 1);
+    QVERIFY(!_masterController->canUndo());
+}
+
+void PlanUndoHistoryTest::_testInsertRemoveUndo(void)
+{
+    QList<VisualMissionItem*> items = _insertWaypoints(3);
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    const QGeoCoordinate removedCoordinate = items[1]->coordinate();
+
+    _missionController->removeVisualItem(2);
+    _undoHistory->capture();
+    QCOMPARE(visualItems->count(), 3);
+
+    _masterController->undo();
+    QCOMPARE(visualItems->count(), 4);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(1), items[0]);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(3), items[2]);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(2)->coordinate(), removedCoordinate);
+    for (int i=1; i<visualItems->count(); i++) {
+        QCOMPARE(visualItems->value<VisualMissionItem*>(i)->sequenceNumber(), i);
+    }
+
+    _masterController->redo();
+    QCOMPARE(visualItems->count(), 3);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(1), items[0]);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(2), items[2]);
+
+    // Undo of an insert
+    _missionController->insertSimpleMissionItem(_startCoordinate.atDistanceAndAzimuth(500, 0), 1);
+    _undoHistory->capture();
+    QCOMPARE(visualItems->count(), 4);
+    _masterController->undo();
+    QCOMPARE(visualItems->count(), 3);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(1), items[0]);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(2), items[2]);
+
+    // Undo all the way back to the empty plan
+    while (_masterController->canUndo()) {
+        _masterController->undo();
+    }
+    QCOMPARE(visualItems->count(), 1);
+}
+
+void PlanUndoHistoryTest::_testSurveyUndo(void)
+{
+    SurveyComplexItem* surveyItem = qobject_cast<SurveyComplexItem*>(_missionController->insertComplexMissionItem(SurveyComplexItem::name, _startCoordinate, -1));
+    QVERIFY(surveyItem);
+    QList<QGeoCoordinate> vertices = {
+        _startCoordinate,
+        _startCoordinate.atDistanceAndAzimuth(500, 90),
+        _startCoordinate.atDistanceAndAzimuth(500, 90).atDistanceAndAzimuth(500, 0),
+        _startCoordinate.atDistanceAndAzimuth(500, 0),
+    };
+    surveyItem->surveyAreaPolygon()->appendVertices(vertices);
+    surveyItem->gridAngle()->setRawValue(0);
+    _undoHistory->capture();
+
+    const QVariantList oldTransectPoints = surveyItem->visualTransectPoints();
+    QVERIFY(!oldTransectPoints.isEmpty());
+
+    surveyItem->gridAngle()->setRawValue(45);
+    _undoHistory->capture();
+    QVERIFY(surveyItem->visualTransectPoints() != oldTransectPoints);
+
+    // Transects come back with the item without being regenerated
+    _masterController->undo();
+    SurveyComplexItem* restoredItem = _missionController->visualItems()->value<SurveyComplexItem*>(1);
+    QVERIFY(restoredItem);
+    QCOMPARE(restoredItem->gridAngle()->rawValue().toDouble(), 0.0);
+    QVERIFY(!restoredItem->transectsBuilding());
+    QCOMPARE(restoredItem->visualTransectPoints(), oldTransectPoints);
+}
+
+void PlanUndoHistoryTest::_testGeoFenceUndo(void)
+{
+    GeoFenceController* geoFenceController = _masterController->geoFenceController();
+    geoFenceController->addInclusionPolygon(_startCoordinate, _startCoordinate.atDistanceAndAzimuth(1000, 135));
+    _undoHistory->capture();
+    QCOMPARE(geoFenceController->polygons()->count(), 1);
+
+    QGCFencePolygon* polygon = geoFenceController->polygons()->value<QGCFencePolygon*>(0);
+    const QGeoCoordinate oldVertex = polygon->vertexCoordinate(0);
+    polygon->adjustVertex(0, oldVertex.atDistanceAndAzimuth(100, 0));
+    _undoHistory->capture();
+
+    _masterController->undo();
+    QCOMPARE(geoFenceController->polygons()->count(), 1);
+    QCOMPARE(geoFenceController->polygons()->value<QGCFencePolygon*>(0)->vertexCoordinate(0), oldVertex);
+
+    _masterController->undo();
+    QCOMPARE(geoFenceController->polygons()->count(), 0);
+}
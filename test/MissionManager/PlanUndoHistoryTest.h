@@ -0,0 +1,41 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "PlanMasterController.h"
+
+#include <QGeoCoordinate>
+
+class PlanUndoHistoryTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    PlanUndoHistoryTest(void);
+
+private slots:
+    void init(void) final;
+    void cleanup(void) final;
+
+    void _testSimpleItemUndoRedo    (void);
+    void _testInsertRemoveUndo      (void);
+    void _testSurveyUndo            (void);
+    void _testGeoFenceUndo          (void);
+
+private:
+    QList<VisualMissionItem*> _insertWaypoints(int cWaypoints);
+
+    PlanMasterController*   _masterController   = nullptr;
+    MissionController*      _missionController  = nullptr;
+    PlanUndoHistory*        _undoHistory        = nullptr;
+
+    static const QGeoCoordinate _startCoordinate;
+};
@@ -11,6 +11,8 @@
 #include "QGCApplication.h"
 #include "JsonHelper.h"
 
+#include <QSignalSpy>
+
 SurveyComplexItemTest::SurveyComplexItemTest(void)
 {
     _rgSurveySignals[surveyVisualTransectPointsChangedIndex] =    SIGNAL(visualTransectPointsChanged());
@@ -354,3 +356,54 @@ void SurveyComplexItemTest::_testHoverCaptureItemGeneration(void)
     _testItemGenerationWorker(false /* imagesInTurnaround */, true /* hasTurnaround */, true /* useConditionGate */, expectedCommands);
     _testItemGenerationWorker(false /* imagesInTurnaround */, true /* hasTurnaround */, false /* useConditionGate */, expectedCommands);
 }
+
+void SurveyComplexItemTest::_testAsyncTransects(void)
+{
+    // Expected transects come from synchronous rebuilds
+    const QList<double> rgGridAngles = { 10, 20, 30, 45 };
+    QList<QVariantList> rgExpectedPoints;
+    for (double gridAngle: rgGridAngles) {
+        _surveyItem->gridAngle()->setRawValue(gridAngle);
+        rgExpectedPoints.append(_surveyItem->visualTransectPoints());
+    }
+    _surveyItem->gridAngle()->setRawValue(0);
+    const QVariantList rgInitialPoints = _surveyItem->visualTransectPoints();
+
+    _surveyItem->_setBuildTransectsAsync(true);
+
+    QSignalSpy spyBuilding(_surveyItem, &SurveyComplexItem::transectsBuildingChanged);
+    QSignalSpy spyPoints(_surveyItem, &SurveyComplexItem::visualTransectPointsChanged);
+    auto waitForTransects = [this, &spyBuilding]() {
+        while (_surveyItem->transectsBuilding()) {
+            if (!spyBuilding.wait(5000)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // The last completed transects are shown until the job completes
+    _surveyItem->gridAngle()->setRawValue(rgGridAngles[0]);
+    QVERIFY(_surveyItem->transectsBuilding());
+    QCOMPARE(_surveyItem->visualTransectPoints(), rgInitialPoints);
+    QVERIFY(waitForTransects());
+    QCOMPARE(_surveyItem->visualTransectPoints(), rgExpectedPoints[0]);
+    QCOMPARE(spyPoints.count(), 1);
+
+    // Changes made while a job runs supersede it, only the latest settings are applied
+    spyPoints.clear();
+    for (int i=1; i<rgGridAngles.count(); i++) {
+        _surveyItem->gridAngle()->setRawValue(rgGridAngles[i]);
+    }
+    QVERIFY(waitForTransects());
+    QCOMPARE(_surveyItem->visualTransectPoints(), rgExpectedPoints.last());
+    QCOMPARE(spyPoints.count(), 1);
+
+    // Mission items are built from the transects for the current settings
+    _surveyItem->gridAngle()->setRawValue(rgGridAngles[1]);
+    QList<MissionItem*> items;
+    _surveyItem->appendMissionItems(items, this);
+    QVERIFY(!_surveyItem->transectsBuilding());
+    QCOMPARE(_surveyItem->visualTransectPoints(), rgExpectedPoints[1]);
+    qDeleteAll(items);
+}
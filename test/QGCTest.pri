@@ -24,15 +24,23 @@ ReleaseBuild {
         $$PWD/MissionManager \
         $$PWD/qgcunittest \
         $$PWD/QmlControls \
+        $$PWD/QtLocationPlugin \
+        $$PWD/Terrain \
         $$PWD/ui \
         $$PWD/Vehicle
 
     HEADERS += \
-        #$$PWD/AnalyzeView/LogDownloadTest.h \
+        $$PWD/AnalyzeView/LogDownloadBenchmark.h \
+        $$PWD/AnalyzeView/LogDownloadTest.h \
+        $$PWD/AnalyzeView/MAVLinkChartSeriesTest.h \
+        $$PWD/AnalyzeView/TLogAnalyzerTest.h \
+        $$PWD/AnalyzeView/ULogReaderTest.h \
         $$PWD/Audio/AudioOutputTest.h \
+        $$PWD/FactSystem/FactGroupUpdateSchedulerTest.h \
         $$PWD/FactSystem/FactSystemTestBase.h \
         $$PWD/FactSystem/FactSystemTestGeneric.h \
         $$PWD/FactSystem/FactSystemTestPX4.h \
+        $$PWD/FactSystem/ParameterManagerBenchmark.h \
         $$PWD/FactSystem/ParameterManagerTest.h \
         $$PWD/Geo/GeoTest.h \
         $$PWD/MissionManager/CameraCalcTest.h \
@@ -42,12 +50,14 @@ ReleaseBuild {
         $$PWD/MissionManager/LandingComplexItemTest.h \
         $$PWD/MissionManager/MissionCommandTreeEditorTest.h \
         $$PWD/MissionManager/MissionCommandTreeTest.h \
+        $$PWD/MissionManager/MissionControllerBenchmark.h \
         $$PWD/MissionManager/MissionControllerManagerTest.h \
         $$PWD/MissionManager/MissionControllerTest.h \
         $$PWD/MissionManager/MissionItemTest.h \
         $$PWD/MissionManager/MissionManagerTest.h \
         $$PWD/MissionManager/MissionSettingsTest.h \
         $$PWD/MissionManager/PlanMasterControllerTest.h \
+        $$PWD/MissionManager/PlanUndoHistoryTest.h \
         $$PWD/MissionManager/QGCMapPolygonTest.h \
         $$PWD/MissionManager/QGCMapPolylineTest.h \
         $$PWD/MissionManager/SectionTest.h \
@@ -66,22 +76,39 @@ ReleaseBuild {
         $$PWD/qgcunittest/ComponentInformationCacheTest.h \
         $$PWD/qgcunittest/ComponentInformationTranslationTest.h \
         $$PWD/qgcunittest/MavlinkLogTest.h \
+        $$PWD/qgcunittest/MAVLinkProtocolBenchmark.h \
+        $$PWD/qgcunittest/MAVLinkProtocolTest.h \
         $$PWD/qgcunittest/MultiSignalSpy.h \
         $$PWD/qgcunittest/MultiSignalSpyV2.h \
         $$PWD/qgcunittest/UnitTest.h \
+        $$PWD/QtLocationPlugin/QGCTileCacheWorkerBenchmark.h \
+        $$PWD/QtLocationPlugin/QGCTileCacheWorkerTest.h \
+        $$PWD/QtLocationPlugin/QGCTileDownloadSchedulerTest.h \
+        $$PWD/Terrain/TerrainDEMBenchmark.h \
+        $$PWD/Terrain/TerrainDEMTest.h \
+        $$PWD/Terrain/TerrainQueryTest.h \
+        $$PWD/Terrain/TerrainTileTest.h \
+        $$PWD/Vehicle/FTPManagerBenchmark.h \
         $$PWD/Vehicle/FTPManagerTest.h \
         $$PWD/Vehicle/InitialConnectTest.h \
         $$PWD/Vehicle/RequestMessageTest.h \
         $$PWD/Vehicle/SendMavCommandWithHandlerTest.h \
         $$PWD/Vehicle/SendMavCommandWithSignallingTest.h \
+        $$PWD/Vehicle/TrajectoryPointsTest.h \
         $$PWD/Vehicle/VehicleLinkManagerTest.h \
 
     SOURCES += \
-        #$$PWD/AnalyzeView/LogDownloadTest.cc \
+        $$PWD/AnalyzeView/LogDownloadBenchmark.cc \
+        $$PWD/AnalyzeView/LogDownloadTest.cc \
+        $$PWD/AnalyzeView/MAVLinkChartSeriesTest.cc \
+        $$PWD/AnalyzeView/TLogAnalyzerTest.cc \
+        $$PWD/AnalyzeView/ULogReaderTest.cc \
         $$PWD/Audio/AudioOutputTest.cc \
+        $$PWD/FactSystem/FactGroupUpdateSchedulerTest.cc \
         $$PWD/FactSystem/FactSystemTestBase.cc \
         $$PWD/FactSystem/FactSystemTestGeneric.cc \
         $$PWD/FactSystem/FactSystemTestPX4.cc \
+        $$PWD/FactSystem/ParameterManagerBenchmark.cc \
         $$PWD/FactSystem/ParameterManagerTest.cc \
         $$PWD/Geo/GeoTest.cc \
         $$PWD/MissionManager/CameraCalcTest.cc \
@@ -91,12 +118,14 @@ ReleaseBuild {
         $$PWD/MissionManager/LandingComplexItemTest.cc \
         $$PWD/MissionManager/MissionCommandTreeEditorTest.cc \
         $$PWD/MissionManager/MissionCommandTreeTest.cc \
+        $$PWD/MissionManager/MissionControllerBenchmark.cc \
         $$PWD/MissionManager/MissionControllerManagerTest.cc \
         $$PWD/MissionManager/MissionControllerTest.cc \
         $$PWD/MissionManager/MissionItemTest.cc \
         $$PWD/MissionManager/MissionManagerTest.cc \
         $$PWD/MissionManager/MissionSettingsTest.cc \
         $$PWD/MissionManager/PlanMasterControllerTest.cc \
+        $$PWD/MissionManager/PlanUndoHistoryTest.cc \
         $$PWD/MissionManager/QGCMapPolygonTest.cc \
         $$PWD/MissionManager/QGCMapPolylineTest.cc \
         $$PWD/MissionManager/SectionTest.cc \
@@ -115,15 +144,26 @@ ReleaseBuild {
         $$PWD/qgcunittest/ComponentInformationCacheTest.cc \
         $$PWD/qgcunittest/ComponentInformationTranslationTest.cc \
         $$PWD/qgcunittest/MavlinkLogTest.cc \
+        $$PWD/qgcunittest/MAVLinkProtocolBenchmark.cc \
+        $$PWD/qgcunittest/MAVLinkProtocolTest.cc \
         $$PWD/qgcunittest/MultiSignalSpy.cc \
         $$PWD/qgcunittest/MultiSignalSpyV2.cc \
         $$PWD/qgcunittest/UnitTest.cc \
+        $$PWD/QtLocationPlugin/QGCTileCacheWorkerBenchmark.cc \
+        $$PWD/QtLocationPlugin/QGCTileCacheWorkerTest.cc \
+        $$PWD/QtLocationPlugin/QGCTileDownloadSchedulerTest.cc \
+        $$PWD/Terrain/TerrainDEMBenchmark.cc \
+        $$PWD/Terrain/TerrainDEMTest.cc \
+        $$PWD/Terrain/TerrainQueryTest.cc \
+        $$PWD/Terrain/TerrainTileTest.cc \
         $$PWD/UnitTestList.cc \
+        $$PWD/Vehicle/FTPManagerBenchmark.cc \
         $$PWD/Vehicle/FTPManagerTest.cc \
         $$PWD/Vehicle/InitialConnectTest.cc \
         $$PWD/Vehicle/RequestMessageTest.cc \
         $$PWD/Vehicle/SendMavCommandWithHandlerTest.cc \
         $$PWD/Vehicle/SendMavCommandWithSignallingTest.cc \
+        $$PWD/Vehicle/TrajectoryPointsTest.cc \
         $$PWD/Vehicle/VehicleLinkManagerTest.cc \
 }
 
@@ -0,0 +1,75 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileCacheWorkerBenchmark.h"
+#include "QGCTileCacheWorkerTest.h"
+#include "QGCTileCacheWorker.h"
+#include "QGCTileMemoryCache.h"
+
+#include <QTemporaryDir>
+
+void QGCTileCacheWorkerBenchmark::_cacheBenchmark_data(void)
+{
+    QTest::addColumn<int>("operation");
+
+    QTest::newRow("save 5000 tiles")            << 0;
+    QTest::newRow("fetch 5000 tiles")           << 1;
+    QTest::newRow("memory fetch 5000 tiles")    << 2;
+}
+
+/// Time to save or fetch a fixed number of 4KB tiles. Database fetches go through the reader threads, memory fetches
+/// are served from the hot tile cache once it is warm.
+void QGCTileCacheWorkerBenchmark::_cacheBenchmark(void)
+{
+    QFETCH(int, operation);
+
+    const int           cTiles = 5000;
+    const QByteArray    tileImg(4096, 'x');
+
+    QTemporaryDir   tempDir;
+    QGCCacheWorker  worker;
+    worker.setMemoryCacheBytes(0);
+    QVERIFY(QGCTileCacheWorkerTest::startWorker(worker, tempDir));
+
+    if (operation == 0) {
+        QBENCHMARK_ONCE {
+            for (int i=0; i<cTiles; i++) {
+                QGCTileCacheWorkerTest::saveTile(worker, QGCTileCacheWorkerTest::tileHash(i % 100, i / 100, 15), tileImg);
+            }
+            QVERIFY(QGCTileCacheWorkerTest::waitForSaves(worker));
+        }
+    } else {
+        for (int i=0; i<cTiles; i++) {
+            QGCTileCacheWorkerTest::saveTile(worker, QGCTileCacheWorkerTest::tileHash(i % 100, i / 100, 15), tileImg);
+        }
+        QVERIFY(QGCTileCacheWorkerTest::waitForSaves(worker));
+
+        if (operation == 2) {
+            worker.setMemoryCacheBytes(QGCTileMemoryCache::defaultMaxBytes);
+            QByteArray img;
+            for (int i=0; i<cTiles; i++) {
+                QGCTileCacheWorkerTest::fetchTile(worker, QGCTileCacheWorkerTest::tileHash(i % 100, i / 100, 15), img);
+            }
+        }
+
+        int cFound = 0;
+        QBENCHMARK_ONCE {
+            for (int i=0; i<cTiles; i++) {
+                QByteArray img;
+                if (QGCTileCacheWorkerTest::fetchTile(worker, QGCTileCacheWorkerTest::tileHash(i % 100, i / 100, 15), img) && img.size() == tileImg.size()) {
+                    cFound++;
+                }
+            }
+        }
+        QCOMPARE(cFound, cTiles);
+    }
+
+    worker.quit();
+    worker.wait();
+}
@@ -0,0 +1,23 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Tile cache save and fetch throughput. These are registered standalone, run them with:
+///     QGroundControl --unittest:QGCTileCacheWorkerBenchmark
+class QGCTileCacheWorkerBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _cacheBenchmark_data(void);
+    void _cacheBenchmark     (void);
+};
@@ -0,0 +1,317 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileCacheWorkerTest.h"
+#include "QGCTileCacheWorker.h"
+#include "QGCMapEngineData.h"
+#include "QGCMapTileSet.h"
+#include "QGCTileMemoryCache.h"
+#include "QGCTileStore.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+QString QGCTileCacheWorkerTest::tileHash(int x, int y, int z)
+{
+    return QString::asprintf("%010d%08d%08d%03d", _providerHash, x, y, z);
+}
+
+bool QGCTileCacheWorkerTest::startWorker(QGCCacheWorker& worker, const QTemporaryDir& tempDir)
+{
+    worker.setDatabaseFile(tempDir.filePath("qgcMapCache.db"));
+    worker.enqueueTask(new QGCMapTask(QGCMapTask::taskInit));
+
+    // Tasks other than init are refused until the worker thread has initialized the database
+    QElapsedTimer timer;
+    timer.start();
+    while (!worker.enqueueTask(new QGCFetchTileTask(QString()))) {
+        if (timer.elapsed() > 5000) {
+            return false;
+        }
+        QTest::qWait(10);
+    }
+    return true;
+}
+
+void QGCTileCacheWorkerTest::saveTile(QGCCacheWorker& worker, const QString& hash, const QByteArray& img)
+{
+    worker.enqueueTask(new QGCSaveTileTask(new QGCCacheTile(hash, img, QStringLiteral("png"), QStringLiteral("Test"))));
+}
+
+bool QGCTileCacheWorkerTest::fetchTile(QGCCacheWorker& worker, const QString& hash, QByteArray& img)
+{
+    bool    done = false;
+    bool    found = false;
+    QObject context;    // Results are delivered on this thread
+    QGCFetchTileTask* task = new QGCFetchTileTask(hash);
+    const QMetaObject::Connection fetchedConnection = QObject::connect(task, &QGCFetchTileTask::tileFetched, &context, [&](QGCCacheTile* tile) {
+        img = tile->img();
+        delete tile;
+        found = true;
+        done = true;
+    });
+    const QMetaObject::Connection errorConnection = QObject::connect(task, &QGCMapTask::error, &context, [&](QGCMapTask::TaskType, QString) {
+        done = true;
+    });
+    worker.enqueueTask(task);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (!done && timer.elapsed() < 5000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    QObject::disconnect(fetchedConnection);
+    QObject::disconnect(errorConnection);
+    return found;
+}
+
+bool QGCTileCacheWorkerTest::waitForSaves(QGCCacheWorker& worker)
+{
+    // Fetches don't wait for queued saves. Tile set fetches do, so once the sets arrive all saves are committed.
+    bool    done = false;
+    QObject context;    // Results are delivered on this thread
+    QGCFetchTileSetTask* task = new QGCFetchTileSetTask();
+    const QMetaObject::Connection connection = QObject::connect(task, &QGCFetchTileSetTask::tileSetFetched, &context, [&](QGCCachedTileSet* tileSet) {
+        tileSet->deleteLater();
+        done = true;
+    });
+    worker.enqueueTask(task);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (!done && timer.elapsed() < 30000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    QObject::disconnect(connection);
+    return done;
+}
+
+void QGCTileCacheWorkerTest::_writeMBTiles(const QString& filename, int x, int y, int z, const QByteArray& img)
+{
+    const QString connectionName = QStringLiteral("QGCTileCacheWorkerTestMBTiles");
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(filename);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("CREATE TABLE metadata (name TEXT, value TEXT)"));
+        QVERIFY(query.exec("INSERT INTO metadata (name, value) VALUES ('format', 'jpg')"));
+        QVERIFY(query.exec("CREATE TABLE tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)"));
+        QVERIFY(query.prepare("INSERT INTO tiles (zoom_level, tile_column, tile_row, tile_data) VALUES (?, ?, ?, ?)"));
+        // MBTiles rows are TMS, counted from the south
+        query.addBindValue(z);
+        query.addBindValue(x);
+        query.addBindValue((1 << z) - 1 - y);
+        query.addBindValue(img);
+        QVERIFY(query.exec());
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+void QGCTileCacheWorkerTest::_testTileKey(void)
+{
+    const quint64 key = QGCCacheWorker::tileKeyFromHash(tileHash(3, 5, 7));
+    QCOMPARE(key, (static_cast<quint64>(_providerHash & 0xFFF) << 51) | (Q_UINT64_C(7) << 46) | (Q_UINT64_C(3) << 23) | Q_UINT64_C(5));
+
+    // Negative provider hashes still produce a key
+    QVERIFY(QGCCacheWorker::tileKeyFromHash(QString::asprintf("%010d%08d%08d%03d", -12345, 3, 5, 7)) != 0);
+
+    // Ten digit negative provider hashes are 11 characters wide
+    const QString negativeHash = QString::asprintf("%010d%08d%08d%03d", -1234567890, 3, 5, 7);
+    QCOMPARE(negativeHash.length(), 30);
+    int providerHash, x, y, z;
+    QVERIFY(QGCTileStore::tileFromHash(negativeHash, providerHash, x, y, z));
+    QCOMPARE(providerHash, -1234567890);
+    QCOMPARE(x, 3);
+    QCOMPARE(y, 5);
+    QCOMPARE(z, 7);
+    QCOMPARE(QGCCacheWorker::tileKeyFromHash(negativeHash), (static_cast<quint64>(-1234567890 & 0xFFF) << 51) | (Q_UINT64_C(7) << 46) | (Q_UINT64_C(3) << 23) | Q_UINT64_C(5));
+
+    // Keys must never fall into the range of autoincrement ids
+    QCOMPARE(QGCCacheWorker::tileKeyFromHash(QString::asprintf("%010d%08d%08d%03d", 4096, 3, 5, 0)), Q_UINT64_C(0));
+
+    // Hashes which can't be mapped fall back to hash lookups
+    QCOMPARE(QGCCacheWorker::tileKeyFromHash(QStringLiteral("not a tile hash")), Q_UINT64_C(0));
+    QCOMPARE(QGCCacheWorker::tileKeyFromHash(tileHash(1 << 23, 5, 7)), Q_UINT64_C(0));
+}
+
+void QGCTileCacheWorkerTest::_testMemoryCache(void)
+{
+    const QByteArray img(1000, 'a');
+    QByteArray foundImg;
+    QString format;
+    QString type;
+
+    QGCTileMemoryCache memoryCache(QGCTileMemoryCache::shardCount * 10 * img.size());
+    memoryCache.insert(tileHash(0, 0, 10), img, QStringLiteral("png"), QStringLiteral("Test"));
+    QVERIFY(memoryCache.find(tileHash(0, 0, 10), foundImg, format, type));
+    QCOMPARE(foundImg, img);
+    QCOMPARE(format, QStringLiteral("png"));
+    QCOMPARE(type, QStringLiteral("Test"));
+    QVERIFY(!memoryCache.find(tileHash(0, 1, 10), foundImg, format, type));
+
+    // Existing entries are not replaced
+    memoryCache.insert(tileHash(0, 0, 10), QByteArray(1000, 'b'), QStringLiteral("jpg"), QStringLiteral("Test"));
+    QVERIFY(memoryCache.find(tileHash(0, 0, 10), foundImg, format, type));
+    QCOMPARE(foundImg, img);
+
+    // Removed entries are gone, others stay
+    memoryCache.insert(tileHash(0, 2, 10), img, QStringLiteral("png"), QStringLiteral("Test"));
+    memoryCache.remove(tileHash(0, 2, 10));
+    QVERIFY(!memoryCache.find(tileHash(0, 2, 10), foundImg, format, type));
+    QVERIFY(memoryCache.find(tileHash(0, 0, 10), foundImg, format, type));
+
+    // The budget holds however many tiles are inserted
+    for (int i=0; i<1000; i++) {
+        memoryCache.insert(tileHash(i, 1, 10), img, QStringLiteral("png"), QStringLiteral("Test"));
+    }
+    QVERIFY(memoryCache.bytes() <= memoryCache.maxBytes());
+    QVERIFY(memoryCache.bytes() > 0);
+
+    memoryCache.clear();
+    QCOMPARE(memoryCache.bytes(), Q_INT64_C(0));
+
+    // No budget disables the cache
+    memoryCache.setMaxBytes(0);
+    memoryCache.insert(tileHash(0, 0, 10), img, QStringLiteral("png"), QStringLiteral("Test"));
+    QVERIFY(!memoryCache.find(tileHash(0, 0, 10), foundImg, format, type));
+}
+
+void QGCTileCacheWorkerTest::_testSaveFetch(void)
+{
+    QTemporaryDir tempDir;
+    QGCCacheWorker worker;
+    // Read everything back from the database
+    worker.setMemoryCacheBytes(0);
+    QVERIFY(startWorker(worker, tempDir));
+
+    const QByteArray img1(100, 'a');
+    const QByteArray img2(200, 'b');
+    const QString unkeyedHash = QStringLiteral("unkeyed tile");
+    const QByteArray unkeyedImg(300, 'c');
+    saveTile(worker, tileHash(1, 2, 10), img1);
+    saveTile(worker, tileHash(1, 3, 10), img2);
+    saveTile(worker, unkeyedHash, unkeyedImg);
+
+    // Same x/y/z for a provider whose key collides with the first tile
+    const QString collidingHash = QString::asprintf("%010d%08d%08d%03d", _providerHash + 4096, 1, 2, 10);
+    const QByteArray collidingImg(400, 'd');
+    saveTile(worker, collidingHash, collidingImg);
+
+    // Saving an existing tile keeps the original
+    saveTile(worker, tileHash(1, 2, 10), img2);
+    QVERIFY(waitForSaves(worker));
+
+    QByteArray img;
+    QVERIFY(fetchTile(worker, tileHash(1, 2, 10), img));
+    QCOMPARE(img, img1);
+    QVERIFY(fetchTile(worker, tileHash(1, 3, 10), img));
+    QCOMPARE(img, img2);
+    QVERIFY(fetchTile(worker, unkeyedHash, img));
+    QCOMPARE(img, unkeyedImg);
+    QVERIFY(fetchTile(worker, collidingHash, img));
+    QCOMPARE(img, collidingImg);
+    QVERIFY(!fetchTile(worker, tileHash(9, 9, 10), img));
+
+    worker.quit();
+    worker.wait();
+}
+
+void QGCTileCacheWorkerTest::_testTileStores(void)
+{
+    QTemporaryDir tempDir;
+    const QByteArray packImg(100, 'p');
+    const QByteArray mbtilesImg(200, 'm');
+    const QByteArray dbImg(300, 'd');
+    QByteArray data;
+    QString format;
+    QString errorString;
+
+    // Tile pack
+    QMap<quint64, QByteArray> tiles;
+    tiles[QGCTilePackStore::tileKey(1, 2, 10)] = packImg;
+    tiles[QGCTilePackStore::tileKey(7, 8, 12)] = QByteArray(50, 'q');
+    const QString packFile = tempDir.filePath("Test.qgctiles");
+    QVERIFY(QGCTilePackStore::write(packFile, QStringLiteral("png"), tiles, errorString));
+
+    QGCTileStore* packStore = QGCTileStore::open(packFile, QStringLiteral("Test"), errorString);
+    QVERIFY(packStore);
+    QVERIFY(packStore->isMapped());
+    QCOMPARE(static_cast<QGCTilePackStore*>(packStore)->tileCount(), 2u);
+    QVERIFY(packStore->findTile(1, 2, 10, data, format));
+    QCOMPARE(data, packImg);
+    QCOMPARE(format, QStringLiteral("png"));
+    QVERIFY(!packStore->findTile(2, 1, 10, data, format));
+
+    // Lookups return the mapped bytes, not copies
+    QByteArray data2;
+    QVERIFY(packStore->findTile(1, 2, 10, data, format));
+    QVERIFY(packStore->findTile(1, 2, 10, data2, format));
+    QCOMPARE(data.constData(), data2.constData());
+
+    // MBTiles
+    const QString mbtilesFile = tempDir.filePath("Test.mbtiles");
+    _writeMBTiles(mbtilesFile, 4, 3, 10, mbtilesImg);
+    QGCTileStore* mbtilesStore = QGCTileStore::open(mbtilesFile, QStringLiteral("Test"), errorString);
+    QVERIFY(mbtilesStore);
+    QVERIFY(!mbtilesStore->isMapped());
+    QVERIFY(mbtilesStore->findTile(4, 3, 10, data, format));
+    QCOMPARE(data, mbtilesImg);
+    QCOMPARE(format, QStringLiteral("jpg"));
+    QVERIFY(!mbtilesStore->findTile(4, 4, 10, data, format));
+    mbtilesStore->releaseThread();
+
+    // Other threads use their own connection
+    bool threadFound = false;
+    QThread* thread = QThread::create([&]() {
+        QByteArray threadData;
+        QString threadFormat;
+        threadFound = mbtilesStore->findTile(4, 3, 10, threadData, threadFormat) && threadData == mbtilesImg;
+        mbtilesStore->releaseThread();
+    });
+    thread->start();
+    QVERIFY(thread->wait(5000));
+    delete thread;
+    QVERIFY(threadFound);
+
+    // Files which aren't tile stores are refused
+    const QString badFile = tempDir.filePath("Bad.qgctiles");
+    QFile file(badFile);
+    QVERIFY(file.open(QFile::WriteOnly));
+    file.write(QByteArray(100, 'x'));
+    file.close();
+    QVERIFY(!QGCTileStore::open(badFile, QStringLiteral("Test"), errorString));
+    QVERIFY(!errorString.isEmpty());
+
+    // Package tiles take precedence over the database
+    QGCCacheWorker worker;
+    worker.setMemoryCacheBytes(0);
+    QVERIFY(startWorker(worker, tempDir));
+    worker.addTileStore(packStore, _providerHash);
+    worker.addTileStore(mbtilesStore, _providerHash);
+    saveTile(worker, tileHash(1, 2, 10), dbImg);
+    saveTile(worker, tileHash(5, 5, 10), dbImg);
+    QVERIFY(waitForSaves(worker));
+
+    QVERIFY(fetchTile(worker, tileHash(1, 2, 10), data));
+    QCOMPARE(data, packImg);
+    QVERIFY(fetchTile(worker, tileHash(4, 3, 10), data));
+    QCOMPARE(data, mbtilesImg);
+    QVERIFY(fetchTile(worker, tileHash(5, 5, 10), data));
+    QCOMPARE(data, dbImg);
+
+    // Stores only serve their own map type
+    QVERIFY(!fetchTile(worker, QString::asprintf("%010d%08d%08d%03d", _providerHash + 1, 1, 2, 10), data));
+
+    worker.quit();
+    worker.wait();
+}
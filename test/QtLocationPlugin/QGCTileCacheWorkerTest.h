@@ -0,0 +1,46 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+class QGCCacheWorker;
+
+/// Unit test for QGCCacheWorker tile storage, run against a database in a temporary directory, and for the hot tile
+/// memory cache and map package stores in front of it
+class QGCTileCacheWorkerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    /// Starts the worker on a database in tempDir
+    ///     @return false: worker did not initialize
+    static bool     startWorker     (QGCCacheWorker& worker, const QTemporaryDir& tempDir);
+    static void     saveTile        (QGCCacheWorker& worker, const QString& hash, const QByteArray& img);
+    static bool     fetchTile       (QGCCacheWorker& worker, const QString& hash, QByteArray& img);
+
+    /// @return false: queued saves were not committed in time
+    static bool     waitForSaves    (QGCCacheWorker& worker);
+
+    static QString  tileHash        (int x, int y, int z);
+
+private slots:
+    void _testTileKey       (void);
+    void _testMemoryCache   (void);
+    void _testSaveFetch     (void);
+    void _testTileStores    (void);
+
+private:
+    void    _writeMBTiles   (const QString& filename, int x, int y, int z, const QByteArray& img);
+
+    static constexpr int _providerHash = 12345;
+};
@@ -0,0 +1,167 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileDownloadSchedulerTest.h"
+#include "QGCTileDownloadScheduler.h"
+
+#include <QSignalSpy>
+#include <QTcpSocket>
+
+void QGCTileDownloadSchedulerTest::init(void)
+{
+    UnitTest::init();
+
+    _connectionCount = 0;
+    _requestCount = 0;
+    _server = new QTcpServer(this);
+    connect(_server, &QTcpServer::newConnection, this, &QGCTileDownloadSchedulerTest::_newConnection);
+    QVERIFY(_server->listen(QHostAddress::LocalHost));
+}
+
+void QGCTileDownloadSchedulerTest::cleanup(void)
+{
+    delete _server;
+    _server = nullptr;
+    _buffers.clear();
+
+    UnitTest::cleanup();
+}
+
+void QGCTileDownloadSchedulerTest::_newConnection(void)
+{
+    while (_server->hasPendingConnections()) {
+        QTcpSocket* socket = _server->nextPendingConnection();
+        _connectionCount++;
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { _readRequests(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            _buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void QGCTileDownloadSchedulerTest::_readRequests(QTcpSocket* socket)
+{
+    QByteArray& buffer = _buffers[socket];
+    buffer += socket->readAll();
+
+    // Requests may arrive pipelined, answer them in order
+    int headerEnd;
+    while ((headerEnd = buffer.indexOf("\r\n\r\n")) >= 0) {
+        const QList<QByteArray> requestLine = buffer.left(buffer.indexOf("\r\n")).split(' ');
+        buffer.remove(0, headerEnd + 4);
+        _requestCount++;
+
+        const QByteArray path = requestLine.count() > 1 ? requestLine[1] : QByteArray();
+        QByteArray response;
+        if (path.startsWith("/fail")) {
+            const QByteArray body("unavailable");
+            response = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: " + QByteArray::number(body.length()) + "\r\n\r\n" + body;
+        } else if (path.startsWith("/missing")) {
+            const QByteArray body("not found");
+            response = "HTTP/1.1 404 Not Found\r\nContent-Length: " + QByteArray::number(body.length()) + "\r\n\r\n" + body;
+        } else {
+            response = "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: " + QByteArray::number(path.length()) + "\r\n\r\n" + path;
+        }
+        socket->write(response);
+    }
+}
+
+QUrl QGCTileDownloadSchedulerTest::_url(const QString& path) const
+{
+    return QUrl(QStringLiteral("http://127.0.0.1:%1%2").arg(_server->serverPort()).arg(path));
+}
+
+void QGCTileDownloadSchedulerTest::_testDownload(void)
+{
+    QGCTileDownloadScheduler scheduler;
+    QHash<QString, QByteArray> downloads;
+    connect(&scheduler, &QGCTileDownloadScheduler::tileDownloaded, this, [&downloads](const QString& hash, const QByteArray& data) {
+        downloads[hash] = data;
+    });
+    QSignalSpy spyFailed(&scheduler, &QGCTileDownloadScheduler::tileFailed);
+    QSignalSpy spyIdle(&scheduler, &QGCTileDownloadScheduler::idle);
+
+    const int cTiles = 200;
+    for (int i=0; i<cTiles; i++) {
+        scheduler.enqueue(QString::number(i), QNetworkRequest(_url(QStringLiteral("/tile/%1").arg(i))));
+    }
+    QCOMPARE(scheduler.pendingCount(), cTiles);
+    QVERIFY(spyIdle.wait(10000));
+
+    QCOMPARE(scheduler.pendingCount(), 0);
+    QCOMPARE(spyFailed.count(), 0);
+    QCOMPARE(downloads.count(), cTiles);
+    for (int i=0; i<cTiles; i++) {
+        QCOMPARE(downloads[QString::number(i)], QStringLiteral("/tile/%1").arg(i).toUtf8());
+    }
+
+    // Requests share a few kept alive connections
+    QCOMPARE(_requestCount, cTiles);
+    QVERIFY(_connectionCount < 10);
+}
+
+void QGCTileDownloadSchedulerTest::_testAdaptiveConcurrency(void)
+{
+    QGCTileDownloadScheduler scheduler;
+    QSignalSpy spyDownloaded(&scheduler, &QGCTileDownloadScheduler::tileDownloaded);
+    QSignalSpy spyFailed(&scheduler, &QGCTileDownloadScheduler::tileFailed);
+    QSignalSpy spyIdle(&scheduler, &QGCTileDownloadScheduler::idle);
+    const QString host = _url(QString()).host();
+    QCOMPARE(scheduler.concurrency(host), static_cast<int>(QGCTileDownloadScheduler::defaultConcurrency));
+
+    // Missing tiles are not a sign of an overloaded host
+    const int cMissing = 20;
+    for (int i=0; i<cMissing; i++) {
+        scheduler.enqueue(QString::number(i), QNetworkRequest(_url(QStringLiteral("/missing/%1").arg(i))));
+    }
+    QVERIFY(spyIdle.wait(10000));
+    QCOMPARE(spyFailed.count(), cMissing);
+    QCOMPARE(spyFailed[0][1].value<QNetworkReply::NetworkError>(), QNetworkReply::ContentNotFoundError);
+    QCOMPARE(scheduler.concurrency(host), static_cast<int>(QGCTileDownloadScheduler::defaultConcurrency));
+
+    // Server errors back off to the minimum
+    spyIdle.clear();
+    spyFailed.clear();
+    const int cFailures = 20;
+    for (int i=0; i<cFailures; i++) {
+        scheduler.enqueue(QString::number(i), QNetworkRequest(_url(QStringLiteral("/fail/%1").arg(i))));
+    }
+    QVERIFY(spyIdle.wait(10000));
+    QCOMPARE(spyFailed.count(), cFailures);
+    QCOMPARE(spyFailed[0][1].value<QNetworkReply::NetworkError>(), QNetworkReply::ServiceUnavailableError);
+    QCOMPARE(scheduler.concurrency(host), static_cast<int>(QGCTileDownloadScheduler::minConcurrency));
+
+    // A healthy host gets more requests in flight again
+    spyIdle.clear();
+    const int cTiles = 100;
+    for (int i=0; i<cTiles; i++) {
+        scheduler.enqueue(QString::number(i), QNetworkRequest(_url(QStringLiteral("/tile/%1").arg(i))));
+    }
+    QVERIFY(spyIdle.wait(10000));
+    QCOMPARE(spyDownloaded.count(), cTiles);
+    QVERIFY(scheduler.concurrency(host) > QGCTileDownloadScheduler::minConcurrency);
+}
+
+void QGCTileDownloadSchedulerTest::_testAbort(void)
+{
+    QGCTileDownloadScheduler scheduler;
+    QSignalSpy spyDownloaded(&scheduler, &QGCTileDownloadScheduler::tileDownloaded);
+    QSignalSpy spyFailed(&scheduler, &QGCTileDownloadScheduler::tileFailed);
+
+    for (int i=0; i<100; i++) {
+        scheduler.enqueue(QString::number(i), QNetworkRequest(_url(QStringLiteral("/tile/%1").arg(i))));
+    }
+    scheduler.abort();
+    QCOMPARE(scheduler.pendingCount(), 0);
+
+    QTest::qWait(500);
+    QCOMPARE(spyDownloaded.count(), 0);
+    QCOMPARE(spyFailed.count(), 0);
+}
@@ -0,0 +1,43 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QHash>
+#include <QTcpServer>
+#include <QUrl>
+
+class QTcpSocket;
+
+/// Unit test for QGCTileDownloadScheduler, run against a local HTTP/1.1 server. Paths starting with /fail are
+/// answered with 503, paths starting with /missing with 404, all other paths with their own path as body.
+class QGCTileDownloadSchedulerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void init               (void) override;
+    void cleanup            (void) override;
+
+    void _testDownload      (void);
+    void _testAdaptiveConcurrency(void);
+    void _testAbort         (void);
+
+private:
+    void    _newConnection  (void);
+    void    _readRequests   (QTcpSocket* socket);
+    QUrl    _url            (const QString& path) const;
+
+    QTcpServer*                     _server             = nullptr;
+    QHash<QTcpSocket*, QByteArray>  _buffers;
+    int                             _connectionCount    = 0;
+    int                             _requestCount       = 0;
+};
@@ -0,0 +1,140 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainDEMBenchmark.h"
+#include "TerrainDEMTest.h"
+#include "TerrainDEMQuery.h"
+#include "TerrainQuery.h"
+#include "TerrainTile.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+
+/// @return Terrain tile with its south west corner at the specified coordinate, elevations from the DEM test model
+TerrainTile TerrainDEMBenchmark::_modelTile(double swLat, double swLon)
+{
+    const int gridSize = qRound(TerrainTile::tileSizeDegrees / TerrainTile::tileValueSpacingDegrees) + 1;
+
+    QJsonArray carpetArray;
+    for (int row=0; row<gridSize; row++) {
+        QJsonArray rowArray;
+        for (int col=0; col<gridSize; col++) {
+            rowArray.append(qRound(TerrainDEMTest::modelElevation(swLat + (row * TerrainTile::tileValueSpacingDegrees), swLon + (col * TerrainTile::tileValueSpacingDegrees))));
+        }
+        carpetArray.append(rowArray);
+    }
+    QJsonObject boundsObject;
+    boundsObject["sw"] = QJsonArray({ swLat, swLon });
+    boundsObject["ne"] = QJsonArray({ swLat + TerrainTile::tileSizeDegrees, swLon + TerrainTile::tileSizeDegrees });
+    QJsonObject statsObject;
+    statsObject["min"] = 0;
+    statsObject["max"] = 2000;
+    statsObject["avg"] = 1000;
+    QJsonObject dataObject;
+    dataObject["bounds"] = boundsObject;
+    dataObject["stats"] = statsObject;
+    dataObject["carpet"] = carpetArray;
+    QJsonObject rootObject;
+    rootObject["status"] = "success";
+    rootObject["data"] = dataObject;
+
+    return TerrainTile(TerrainTile::serializeFromAirMapJson(QJsonDocument(rootObject).toJson()));
+}
+
+/// @return Fixed set of segments in random directions, all inside the tile with its south west corner at the specified
+///         coordinate
+QList<TerrainDEMBenchmark::Segment_t> TerrainDEMBenchmark::_segments(double swLat, double swLon)
+{
+    const double margin = TerrainTile::tileSizeDegrees * 0.05;
+    const double span   = TerrainTile::tileSizeDegrees - (2 * margin);
+
+    QRandomGenerator random(1234);
+    QList<Segment_t> segments;
+    for (int i=0; i<100; i++) {
+        const QGeoCoordinate fromCoord(swLat + margin + (random.generateDouble() * span), swLon + margin + (random.generateDouble() * span));
+        const QGeoCoordinate toCoord(swLat + margin + (random.generateDouble() * span), swLon + margin + (random.generateDouble() * span));
+        segments.append(qMakePair(fromCoord, toCoord));
+    }
+    return segments;
+}
+
+void TerrainDEMBenchmark::_pathBenchmark_data(void)
+{
+    QTest::addColumn<bool>("dem");
+
+    QTest::newRow("TerrainTileManager") << false;
+    QTest::newRow("TerrainDEMCache")    << true;
+}
+
+/// Path queries over the same segments, either from the DEM files or from the cached terrain tiles the way
+/// TerrainTileManager answers a path query once its tiles are downloaded
+void TerrainDEMBenchmark::_pathBenchmark(void)
+{
+    QFETCH(bool, dem);
+
+    const double swLat = 47.1;
+    const double swLon = 8.1;
+    const QList<Segment_t> segments = _segments(swLat, swLon);
+
+    QTemporaryDir tempDir;
+    TerrainDEMTest::writeDEMFiles(tempDir);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    TerrainDEMCache demCache;
+    demCache.setDirectory(tempDir.path());
+
+    const TerrainTile terrainTile = _modelTile(swLat, swLon);
+    QVERIFY(terrainTile.isValid());
+    TerrainTileManager tileManager;
+    tileManager._tiles.insert(TerrainTileManager::_getTileKey(swLat + (TerrainTile::tileSizeDegrees / 2), swLon + (TerrainTile::tileSizeDegrees / 2)), terrainTile);
+
+    // Both paths have to return the same samples, both come from the same model rounded to whole meters
+    for (const Segment_t& segment: segments) {
+        double          distanceBetween;
+        double          finalDistanceBetween;
+        bool            error;
+        QList<double>   demHeights;
+        QList<double>   tileHeights;
+
+        QVERIFY(demCache.pathHeights(segment.first, segment.second, distanceBetween, finalDistanceBetween, demHeights));
+        const QList<QGeoCoordinate> coordinates = TerrainTileManager::pathQueryToCoords(segment.first, segment.second, distanceBetween, finalDistanceBetween);
+        QVERIFY(tileManager.getAltitudesForCoordinates(coordinates, tileHeights, error, false /* downloadMissing */));
+        QVERIFY(!error);
+        QCOMPARE(demHeights.count(), tileHeights.count());
+        for (int i=0; i<demHeights.count(); i++) {
+            QVERIFY(qAbs(demHeights[i] - tileHeights[i]) <= 1.5);
+        }
+    }
+
+    if (dem) {
+        QBENCHMARK {
+            for (const Segment_t& segment: segments) {
+                double          distanceBetween;
+                double          finalDistanceBetween;
+                QList<double>   heights;
+                demCache.pathHeights(segment.first, segment.second, distanceBetween, finalDistanceBetween, heights);
+            }
+        }
+    } else {
+        QBENCHMARK {
+            for (const Segment_t& segment: segments) {
+                double          distanceBetween;
+                double          finalDistanceBetween;
+                bool            error;
+                QList<double>   heights;
+                const QList<QGeoCoordinate> coordinates = TerrainTileManager::pathQueryToCoords(segment.first, segment.second, distanceBetween, finalDistanceBetween);
+                tileManager.getAltitudesForCoordinates(coordinates, heights, error, false /* downloadMissing */);
+            }
+        }
+    }
+}
@@ -0,0 +1,34 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QGeoCoordinate>
+
+class TerrainTile;
+
+/// Path query throughput of the offline DEM files against cached terrain tiles. These are registered standalone, run
+/// them with:
+///     QGroundControl --unittest:TerrainDEMBenchmark
+class TerrainDEMBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _pathBenchmark_data(void);
+    void _pathBenchmark     (void);
+
+private:
+    typedef QPair<QGeoCoordinate, QGeoCoordinate> Segment_t;
+
+    static TerrainTile      _modelTile  (double swLat, double swLon);
+    static QList<Segment_t> _segments   (double swLat, double swLon);
+};
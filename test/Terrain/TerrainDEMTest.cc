@@ -0,0 +1,296 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainDEMTest.h"
+#include "TerrainDEMFile.h"
+#include "TerrainDEMQuery.h"
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QtEndian>
+
+#include <cstring>
+
+double TerrainDEMTest::modelElevation(double latitude, double longitude)
+{
+    return 100.0 + ((latitude - 47.0) * 1000.0) + ((longitude - 8.0) * 500.0);
+}
+
+/// 3 arc-second SRTM file covering N47-48, E8-9
+void TerrainDEMTest::_writeHGT(const QString& filename)
+{
+    const int gridSize = 1201;
+
+    QByteArray bytes(gridSize * gridSize * 2, 0);
+    uchar* p = reinterpret_cast<uchar*>(bytes.data());
+    for (int row=0; row<gridSize; row++) {
+        for (int col=0; col<gridSize; col++) {
+            const double elevation = modelElevation(48.0 - (row / 1200.0), 8.0 + (col / 1200.0));
+            qToBigEndian<qint16>(static_cast<qint16>(qRound(elevation)), p);
+            p += 2;
+        }
+    }
+
+    QFile file(filename);
+    QVERIFY(file.open(QFile::WriteOnly));
+    QCOMPARE(file.write(bytes), bytes.size());
+}
+
+/// Little endian, single strip, float32 GeoTIFF with pixel is area georeferencing
+void TerrainDEMTest::_writeGeoTIFF(const QString& filename)
+{
+    struct Entry {
+        quint16 tag;
+        quint16 type;
+        quint32 count;
+        quint32 value;
+    };
+
+    const int       cEntries        = 10;
+    const quint32   ifdOffset       = 8;
+    const quint32   scaleOffset     = ifdOffset + 2 + (cEntries * 12) + 4;
+    const quint32   tiepointOffset  = scaleOffset + (3 * 8);
+    const quint32   pixelOffset     = tiepointOffset + (6 * 8);
+
+    const Entry rgEntries[cEntries] = {
+        { 256,      4,  1, _tiffSize },         // ImageWidth
+        { 257,      4,  1, _tiffSize },         // ImageLength
+        { 258,      3,  1, 32 },                // BitsPerSample
+        { 259,      3,  1, 1 },                 // Compression: none
+        { 273,      4,  1, pixelOffset },       // StripOffsets
+        { 277,      3,  1, 1 },                 // SamplesPerPixel
+        { 278,      4,  1, _tiffSize },         // RowsPerStrip
+        { 339,      3,  1, 3 },                 // SampleFormat: float
+        { 33550,    12, 3, scaleOffset },       // ModelPixelScale
+        { 33922,    12, 6, tiepointOffset },    // ModelTiepoint
+    };
+    const double rgScale[3]     = { _tiffSpacing, _tiffSpacing, 0 };
+    const double rgTiepoint[6]  = { 0, 0, 0, _tiffWest - (_tiffSpacing / 2), _tiffNorth + (_tiffSpacing / 2), 0 };
+
+    QByteArray bytes(static_cast<int>(pixelOffset) + (_tiffSize * _tiffSize * 4), 0);
+    uchar* data = reinterpret_cast<uchar*>(bytes.data());
+
+    memcpy(data, "II", 2);
+    qToLittleEndian<quint16>(42, data + 2);
+    qToLittleEndian<quint32>(ifdOffset, data + 4);
+    qToLittleEndian<quint16>(cEntries, data + ifdOffset);
+    for (int i=0; i<cEntries; i++) {
+        uchar* entry = data + ifdOffset + 2 + (i * 12);
+        qToLittleEndian<quint16>(rgEntries[i].tag, entry);
+        qToLittleEndian<quint16>(rgEntries[i].type, entry + 2);
+        qToLittleEndian<quint32>(rgEntries[i].count, entry + 4);
+        if (rgEntries[i].type == 3) {
+            qToLittleEndian<quint16>(static_cast<quint16>(rgEntries[i].value), entry + 8);
+        } else {
+            qToLittleEndian<quint32>(rgEntries[i].value, entry + 8);
+        }
+    }
+    for (int i=0; i<3; i++) {
+        quint64 bits;
+        memcpy(&bits, &rgScale[i], sizeof(bits));
+        qToLittleEndian<quint64>(bits, data + scaleOffset + (i * 8));
+    }
+    for (int i=0; i<6; i++) {
+        quint64 bits;
+        memcpy(&bits, &rgTiepoint[i], sizeof(bits));
+        qToLittleEndian<quint64>(bits, data + tiepointOffset + (i * 8));
+    }
+
+    uchar* p = data + pixelOffset;
+    for (int row=0; row<_tiffSize; row++) {
+        for (int col=0; col<_tiffSize; col++) {
+            const float elevation = static_cast<float>(modelElevation(_tiffNorth - (row * _tiffSpacing), _tiffWest + (col * _tiffSpacing)));
+            quint32 bits;
+            memcpy(&bits, &elevation, sizeof(bits));
+            qToLittleEndian<quint32>(bits, p);
+            p += 4;
+        }
+    }
+
+    QFile file(filename);
+    QVERIFY(file.open(QFile::WriteOnly));
+    QCOMPARE(file.write(bytes), bytes.size());
+}
+
+void TerrainDEMTest::writeDEMFiles(const QTemporaryDir& tempDir)
+{
+    QVERIFY(tempDir.isValid());
+    _writeHGT(tempDir.filePath("N47E008.hgt"));
+    _writeGeoTIFF(tempDir.filePath("south.tif"));
+
+    // Not a DEM file, must be skipped
+    QFile file(tempDir.filePath("readme.tif"));
+    QVERIFY(file.open(QFile::WriteOnly));
+    file.write("not a tiff");
+}
+
+void TerrainDEMTest::_testHGT(void)
+{
+    QTemporaryDir tempDir;
+    writeDEMFiles(tempDir);
+
+    QString errorString;
+    TerrainDEMFile* demFile = TerrainDEMFile::open(tempDir.filePath("N47E008.hgt"), errorString);
+    QVERIFY2(demFile, qPrintable(errorString));
+    QCOMPARE(demFile->rows(), 1201);
+    QCOMPARE(demFile->cols(), 1201);
+    QVERIFY(qAbs(demFile->south() - 47.0) < 1e-9);
+    QVERIFY(qAbs(demFile->north() - 48.0) < 1e-9);
+    QVERIFY(qAbs(demFile->west() - 8.0) < 1e-9);
+    QVERIFY(qAbs(demFile->east() - 9.0) < 1e-9);
+    delete demFile;
+
+    TerrainDEMCache demCache;
+    demCache.setDirectory(tempDir.path());
+    QCOMPARE(demCache.fileCount(), 2);
+
+    // Samples are rounded to whole meters
+    const QList<QGeoCoordinate> coordinates = { QGeoCoordinate(47.5, 8.5), QGeoCoordinate(47.12345, 8.98765), QGeoCoordinate(47.9999, 8.9999) };
+    QList<double> heights;
+    QVERIFY(demCache.coordinateHeights(coordinates, heights));
+    QCOMPARE(heights.count(), coordinates.count());
+    for (int i=0; i<coordinates.count(); i++) {
+        QVERIFY(qAbs(heights[i] - modelElevation(coordinates[i].latitude(), coordinates[i].longitude())) <= 0.5);
+    }
+
+    // Any coordinate outside the files fails the whole query
+    QVERIFY(!demCache.coordinateHeights({ QGeoCoordinate(47.5, 8.5), QGeoCoordinate(49.5, 8.5) }, heights));
+}
+
+void TerrainDEMTest::_testGeoTIFF(void)
+{
+    QTemporaryDir tempDir;
+    writeDEMFiles(tempDir);
+
+    QString errorString;
+    TerrainDEMFile* demFile = TerrainDEMFile::open(tempDir.filePath("south.tif"), errorString);
+    QVERIFY2(demFile, qPrintable(errorString));
+    QCOMPARE(demFile->rows(), _tiffSize);
+    QCOMPARE(demFile->cols(), _tiffSize);
+    QVERIFY(qAbs(demFile->north() - _tiffNorth) < 1e-9);
+    QVERIFY(qAbs(demFile->west() - _tiffWest) < 1e-9);
+    delete demFile;
+
+    QVERIFY(!TerrainDEMFile::open(tempDir.filePath("readme.tif"), errorString));
+    QVERIFY(!errorString.isEmpty());
+
+    TerrainDEMCache demCache;
+    demCache.setDirectory(tempDir.path());
+
+    // Float samples of a linear model interpolate exactly
+    const QList<QGeoCoordinate> coordinates = { QGeoCoordinate(46.7, 8.2), QGeoCoordinate(46.51234, 8.4321), QGeoCoordinate(46.9999, 8.0001) };
+    QList<double> heights;
+    QVERIFY(demCache.coordinateHeights(coordinates, heights));
+    for (int i=0; i<coordinates.count(); i++) {
+        QVERIFY(qAbs(heights[i] - modelElevation(coordinates[i].latitude(), coordinates[i].longitude())) < 0.01);
+    }
+
+    // The raster is PixelIsArea, so the outer half of the edge pixels is covered and returns the edge samples
+    heights.clear();
+    QVERIFY(demCache.coordinateHeights({ QGeoCoordinate(46.7, _tiffWest - (_tiffSpacing / 4)) }, heights));
+    QVERIFY(qAbs(heights[0] - modelElevation(46.7, _tiffWest)) < 0.01);
+    QVERIFY(!demCache.coordinateHeights({ QGeoCoordinate(46.7, _tiffWest - _tiffSpacing) }, heights));
+}
+
+void TerrainDEMTest::_testPathQuery(void)
+{
+    QTemporaryDir tempDir;
+    writeDEMFiles(tempDir);
+
+    TerrainDEMCache demCache;
+    demCache.setDirectory(tempDir.path());
+    TerrainDEMQuery query(&demCache);
+    QSignalSpy spy(&query, &TerrainQueryInterface::pathHeightsReceived);
+
+    // Path crosses from the GeoTIFF into the .hgt file
+    const QGeoCoordinate fromCoord(46.98, 8.3);
+    const QGeoCoordinate toCoord(47.03, 8.35);
+    query.requestPathHeights(fromCoord, toCoord);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy[0][0].toBool(), true);
+
+    double distanceBetween;
+    double finalDistanceBetween;
+    const QList<QGeoCoordinate> coordinates = TerrainTileManager::pathQueryToCoords(fromCoord, toCoord, distanceBetween, finalDistanceBetween);
+    const QList<double> heights = spy[0][3].value<QList<double>>();
+    QCOMPARE(spy[0][1].toDouble(), distanceBetween);
+    QCOMPARE(spy[0][2].toDouble(), finalDistanceBetween);
+    QCOMPARE(heights.count(), coordinates.count());
+    for (int i=0; i<coordinates.count(); i++) {
+        QVERIFY(qAbs(heights[i] - modelElevation(coordinates[i].latitude(), coordinates[i].longitude())) <= 0.5);
+    }
+
+    // Path leaving the covered area fails
+    spy.clear();
+    query.requestPathHeights(fromCoord, QGeoCoordinate(47.03, 9.05));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy[0][0].toBool(), false);
+}
+
+void TerrainDEMTest::_testCarpetQuery(void)
+{
+    QTemporaryDir tempDir;
+    writeDEMFiles(tempDir);
+
+    TerrainDEMCache demCache;
+    demCache.setDirectory(tempDir.path());
+    TerrainDEMQuery query(&demCache);
+    QSignalSpy spy(&query, &TerrainQueryInterface::carpetHeightsReceived);
+
+    // North east corner is half way between samples, the last sample is at 46.65, 8.12
+    const QGeoCoordinate swCoord(46.6, 8.1);
+    const QGeoCoordinate neCoord(46.6525, 8.1225);
+    query.requestCarpetHeights(swCoord, neCoord, false /* statsOnly */);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy[0][0].toBool(), true);
+    QVERIFY(qAbs(spy[0][1].toDouble() - modelElevation(swCoord.latitude(), swCoord.longitude())) < 0.01);
+    QVERIFY(qAbs(spy[0][2].toDouble() - modelElevation(46.65, 8.12)) < 0.01);
+
+    // Rows south to north at the GeoTIFF spacing
+    const QList<QList<double>> carpet = spy[0][3].value<QList<QList<double>>>();
+    QCOMPARE(carpet.count(), 11);
+    QCOMPARE(carpet[0].count(), 5);
+    QVERIFY(carpet.last().first() > carpet.first().first());
+    QVERIFY(carpet.first().last() > carpet.first().first());
+
+    spy.clear();
+    query.requestCarpetHeights(swCoord, neCoord, true /* statsOnly */);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy[0][0].toBool(), true);
+    QVERIFY(spy[0][3].value<QList<QList<double>>>().isEmpty());
+}
+
+void TerrainDEMTest::_testMemoryBudget(void)
+{
+    QTemporaryDir tempDir;
+    writeDEMFiles(tempDir);
+
+    const qint64 maxMemoryBytes = 1024 * 1024;
+
+    TerrainDEMCache demCache;
+    demCache.setDirectory(tempDir.path());
+    demCache.setMaxMemoryBytes(maxMemoryBytes);
+
+    // Touch every block of the .hgt file
+    QList<QGeoCoordinate> coordinates;
+    for (int i=0; i<20; i++) {
+        for (int j=0; j<20; j++) {
+            coordinates.append(QGeoCoordinate(47.025 + (i * 0.05), 8.025 + (j * 0.05)));
+        }
+    }
+    QList<double> heights;
+    QVERIFY(demCache.coordinateHeights(coordinates, heights));
+    QVERIFY(demCache.memoryBytes() > 0);
+    QVERIFY(demCache.memoryBytes() <= maxMemoryBytes);
+
+    // Results are the same after blocks have been evicted
+    QList<double> heightsAgain;
+    QVERIFY(demCache.coordinateHeights(coordinates, heightsAgain));
+    QCOMPARE(heightsAgain, heights);
+}
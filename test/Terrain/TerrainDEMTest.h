@@ -0,0 +1,43 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+/// Unit test for TerrainDEMFile, TerrainDEMCache and TerrainDEMQuery. The DEM files are generated from a linear
+/// elevation model so that interpolated results can be checked exactly.
+class TerrainDEMTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    /// Writes a .hgt file covering N47-48, E8-9 and a GeoTIFF south of it, both from modelElevation
+    static void     writeDEMFiles   (const QTemporaryDir& tempDir);
+    static double   modelElevation  (double latitude, double longitude);
+
+private slots:
+    void _testHGT           (void);
+    void _testGeoTIFF       (void);
+    void _testPathQuery     (void);
+    void _testCarpetQuery   (void);
+    void _testMemoryBudget  (void);
+
+private:
+    static void _writeHGT       (const QString& filename);
+    static void _writeGeoTIFF   (const QString& filename);
+
+    // GeoTIFF area, south of the .hgt file
+    static constexpr double _tiffNorth      = 47.0;
+    static constexpr double _tiffWest       = 8.0;
+    static constexpr double _tiffSpacing    = 0.005;
+    static constexpr int    _tiffSize       = 101;
+};
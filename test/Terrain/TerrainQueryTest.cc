@@ -0,0 +1,113 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainQueryTest.h"
+#include "TerrainDEMQuery.h"
+#include "QGCApplication.h"
+#include "SettingsManager.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+QList<TerrainPathQuery::PathHeightInfo_t> TerrainQueryTest::_polyPathQuery(const QList<QGeoCoordinate>& polyPath)
+{
+    TerrainPolyPathQuery query(false /* autoDelete */);
+    QSignalSpy spy(&query, &TerrainPolyPathQuery::terrainDataReceived);
+
+    query.requestData(polyPath);
+    if (spy.isEmpty() && !spy.wait(5000)) {
+        return QList<TerrainPathQuery::PathHeightInfo_t>();
+    }
+    if (!spy[0][0].toBool()) {
+        return QList<TerrainPathQuery::PathHeightInfo_t>();
+    }
+    return spy[0][1].value<QList<TerrainPathQuery::PathHeightInfo_t>>();
+}
+
+void TerrainQueryTest::_testPolyPathQuery(void)
+{
+    TerrainPathProfileCache::instance()->clear();
+
+    // Zig zag across the flat and sloped regions
+    const QGeoCoordinate origin = UnitTestTerrainQuery::flat10Region.center();
+    QList<QGeoCoordinate> polyPath;
+    for (int i=0; i<20; i++) {
+        polyPath.append(origin.atDistanceAndAzimuth(i * 100.0, 90).atDistanceAndAzimuth(i % 2 ? 200 : 0, 0));
+    }
+
+    const QList<TerrainPathQuery::PathHeightInfo_t> rgPathHeightInfo = _polyPathQuery(polyPath);
+    QCOMPARE(rgPathHeightInfo.count(), polyPath.count() - 1);
+
+    for (int i=0; i<rgPathHeightInfo.count(); i++) {
+        double distanceBetween;
+        double finalDistanceBetween;
+        const QList<QGeoCoordinate> coordinates = TerrainTileManager::pathQueryToCoords(polyPath[i], polyPath[i+1], distanceBetween, finalDistanceBetween);
+        QCOMPARE(rgPathHeightInfo[i].heights.count(), coordinates.count());
+        QCOMPARE(rgPathHeightInfo[i].distanceBetween, distanceBetween);
+        QCOMPARE(rgPathHeightInfo[i].finalDistanceBetween, finalDistanceBetween);
+        for (double height: rgPathHeightInfo[i].heights) {
+            QCOMPARE(height, UnitTestTerrainQuery::Flat10Region::amslElevation);
+        }
+    }
+
+    // Path leaving the terrain data fails as a whole
+    polyPath.append(UnitTestTerrainQuery::flat10Region.topLeft().atDistanceAndAzimuth(1000, 270));
+    QVERIFY(_polyPathQuery(polyPath).isEmpty());
+}
+
+void TerrainQueryTest::_testPolyPathProfileReuse(void)
+{
+    TerrainPathProfileCache* profileCache = TerrainPathProfileCache::instance();
+    profileCache->clear();
+
+    const QGeoCoordinate origin = UnitTestTerrainQuery::linearSlopeRegion.center();
+    QList<QGeoCoordinate> polyPath;
+    for (int i=0; i<50; i++) {
+        polyPath.append(origin.atDistanceAndAzimuth(i * 50.0, 0).atDistanceAndAzimuth(i % 2 ? 500 : -500, 90));
+    }
+
+    const QList<TerrainPathQuery::PathHeightInfo_t> rgOriginal = _polyPathQuery(polyPath);
+    QCOMPARE(rgOriginal.count(), polyPath.count() - 1);
+    QCOMPARE(profileCache->count(), polyPath.count() - 1);
+
+    // Moving a single vertex only samples the two segments touching it
+    const int movedIndex = 20;
+    polyPath[movedIndex] = polyPath[movedIndex].atDistanceAndAzimuth(100, 90);
+    const QList<TerrainPathQuery::PathHeightInfo_t> rgEdited = _polyPathQuery(polyPath);
+    QCOMPARE(rgEdited.count(), polyPath.count() - 1);
+    QCOMPARE(profileCache->count(), polyPath.count() - 1 + 2);
+
+    for (int i=0; i<rgEdited.count(); i++) {
+        if (i == movedIndex - 1 || i == movedIndex) {
+            QVERIFY(rgEdited[i].heights != rgOriginal[i].heights);
+        } else {
+            QCOMPARE(rgEdited[i].heights, rgOriginal[i].heights);
+        }
+    }
+}
+
+void TerrainQueryTest::_testProfileInvalidation(void)
+{
+    TerrainPathProfileCache* profileCache = TerrainPathProfileCache::instance();
+    profileCache->clear();
+
+    const QGeoCoordinate origin = UnitTestTerrainQuery::flat10Region.center();
+    const QList<QGeoCoordinate> polyPath = { origin, origin.atDistanceAndAzimuth(500, 90), origin.atDistanceAndAzimuth(500, 0) };
+    QCOMPARE(_polyPathQuery(polyPath).count(), polyPath.count() - 1);
+    QCOMPARE(profileCache->count(), polyPath.count() - 1);
+
+    // Changing the DEM directory changes where heights come from, so cached profiles are dropped
+    TerrainDEMCache::instance();
+    Fact*           directoryFact       = qgcApp()->toolbox()->settingsManager()->offlineMapsSettings()->terrainDEMDirectory();
+    const QVariant  previousDirectory   = directoryFact->rawValue();
+    QTemporaryDir   tempDir;
+    directoryFact->setRawValue(tempDir.path());
+    QCOMPARE(profileCache->count(), 0);
+    directoryFact->setRawValue(previousDirectory);
+}
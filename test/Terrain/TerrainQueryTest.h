@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "TerrainQuery.h"
+
+class TerrainQueryTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testPolyPathQuery         (void);
+    void _testPolyPathProfileReuse  (void);
+    void _testProfileInvalidation   (void);
+
+private:
+    QList<TerrainPathQuery::PathHeightInfo_t> _polyPathQuery(const QList<QGeoCoordinate>& polyPath);
+};
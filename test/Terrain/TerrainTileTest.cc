@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileTest.h"
+#include "TerrainTile.h"
+#include "TerrainQuery.h"
+
+/// Rows run south to north: 100 200 in the south west and south east cells, 300 400 in the north
+QByteArray TerrainTileTest::_tileBytes(void)
+{
+    const QByteArray json = QStringLiteral(
+        "{ \"status\": \"success\", \"data\": {"
+        "   \"bounds\": { \"sw\": [ %1, %2 ], \"ne\": [ %3, %4 ] },"
+        "   \"stats\": { \"min\": 100, \"max\": 400, \"avg\": 250 },"
+        "   \"carpet\": [ [ 100, 200 ], [ 300, 400 ] ] } }").arg(_swLat).arg(_swLon).arg(_neLat).arg(_neLon).toUtf8();
+
+    return TerrainTile::serializeFromAirMapJson(json);
+}
+
+void TerrainTileTest::_testNearestCell(void)
+{
+    const TerrainTile tile(_tileBytes());
+    QVERIFY(tile.isValid());
+
+    // Corners of each cell plus coordinates outside of the tile
+    const QList<double> latitudes   = { 47.001, 47.001, 47.009, 47.009, 47.0049, 47.02,  46.99 };
+    const QList<double> longitudes  = { 8.001,  8.009,  8.001,  8.009,  8.0051,  8.005,  8.005 };
+    const QList<double> expected    = { 100,    200,    300,    400,    200,     qQNaN(), qQNaN() };
+
+    QList<double> elevations(latitudes.count());
+    tile.elevations(latitudes.constData(), longitudes.constData(), latitudes.count(), elevations.data());
+
+    for (int i=0; i<latitudes.count(); i++) {
+        if (qIsNaN(expected[i])) {
+            QVERIFY(qIsNaN(elevations[i]));
+        } else {
+            QCOMPARE(elevations[i], expected[i]);
+            // Batch and single coordinate lookups agree
+            QCOMPARE(tile.elevation(QGeoCoordinate(latitudes[i], longitudes[i])), expected[i]);
+        }
+    }
+}
+
+void TerrainTileTest::_testBilinear(void)
+{
+    const TerrainTile tile(_tileBytes());
+    QVERIFY(tile.isValid());
+
+    // Cell centers are at 47.0025/47.0075 and 8.0025/8.0075. Outer half cells are clamped to the edge values.
+    const QList<double> latitudes   = { 47.0025, 47.0075, 47.005, 47.0025, 47.005,  47.001, 47.02 };
+    const QList<double> longitudes  = { 8.0025,  8.0075,  8.005,  8.005,   8.00625, 8.001,  8.005 };
+    const QList<double> expected    = { 100,     400,     250,    150,     275,     100,    qQNaN() };
+
+    QList<double> elevations(latitudes.count());
+    tile.elevations(latitudes.constData(), longitudes.constData(), latitudes.count(), elevations.data(), true /* bilinear */);
+
+    for (int i=0; i<latitudes.count(); i++) {
+        if (qIsNaN(expected[i])) {
+            QVERIFY(qIsNaN(elevations[i]));
+        } else {
+            QVERIFY2(qAbs(elevations[i] - expected[i]) < 1e-6, qPrintable(QStringLiteral("%1 != %2").arg(elevations[i]).arg(expected[i])));
+        }
+    }
+}
+
+void TerrainTileTest::_testManagerAppend(void)
+{
+    TerrainTileManager tileManager;
+
+    // Without the tile cached no altitudes are returned, and the callers existing values are left alone
+    QList<double>   altitudes = { 1, 2 };
+    bool            error;
+    QVERIFY(!tileManager.getAltitudesForCoordinates({ QGeoCoordinate(_swLat + 0.005, _swLon + 0.005) }, altitudes, error, false /* downloadMissing */));
+    QCOMPARE(altitudes, QList<double>({ 1, 2 }));
+}
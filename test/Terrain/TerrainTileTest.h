@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for TerrainTile lookups and the TerrainTileManager batch query, using a known 2x2 tile
+class TerrainTileTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testNearestCell   (void);
+    void _testBilinear      (void);
+    void _testManagerAppend (void);
+
+private:
+    static QByteArray _tileBytes(void);
+
+    static constexpr double _swLat = 47.0;
+    static constexpr double _swLon = 8.0;
+    static constexpr double _neLat = 47.01;
+    static constexpr double _neLon = 8.01;
+};
@@ -13,6 +13,7 @@
 
 #include "ComponentInformationCacheTest.h"
 #include "ComponentInformationTranslationTest.h"
+#include "FactGroupUpdateSchedulerTest.h"
 #include "FactSystemTestGeneric.h"
 #include "FactSystemTestPX4.h"
 //#include "FileDialogTest.h"
@@ -25,17 +26,23 @@
 #include "MissionManagerTest.h"
 //#include "RadioConfigTest.h"
 #include "MavlinkLogTest.h"
+#include "MAVLinkProtocolTest.h"
 //#include "MainWindowTest.h"
 //#include "FileManagerTest.h"
 #include "ParameterManagerTest.h"
+#include "ParameterManagerBenchmark.h"
 #include "MissionCommandTreeTest.h"
-//#include "LogDownloadTest.h"
+#include "LogDownloadTest.h"
+#include "MAVLinkChartSeriesTest.h"
+#include "TLogAnalyzerTest.h"
+#include "ULogReaderTest.h"
 #include "SendMavCommandWithSignallingTest.h"
 #include "SendMavCommandWithHandlerTest.h"
 #include "VisualMissionItemTest.h"
 #include "CameraSectionTest.h"
 #include "SpeedSectionTest.h"
 #include "PlanMasterControllerTest.h"
+#include "PlanUndoHistoryTest.h"
 #include "MissionSettingsTest.h"
 #include "QGCMapPolygonTest.h"
 #include "AudioOutputTest.h"
@@ -47,23 +54,38 @@
 #include "FWLandingPatternTest.h"
 #include "RequestMessageTest.h"
 #include "FTPManagerTest.h"
+#include "FTPManagerBenchmark.h"
+#include "MissionControllerBenchmark.h"
+#include "LogDownloadBenchmark.h"
+#include "QGCTileCacheWorkerBenchmark.h"
+#include "TerrainDEMBenchmark.h"
+#include "MAVLinkProtocolBenchmark.h"
 #include "MissionCommandTreeEditorTest.h"
 #include "VehicleLinkManagerTest.h"
+#include "TrajectoryPointsTest.h"
 #include "LandingComplexItemTest.h"
 #include "InitialConnectTest.h"
+#include "QGCTileCacheWorkerTest.h"
+#include "QGCTileDownloadSchedulerTest.h"
+#include "TerrainDEMTest.h"
+#include "TerrainQueryTest.h"
+#include "TerrainTileTest.h"
 
 UT_REGISTER_TEST(ComponentInformationCacheTest)
 UT_REGISTER_TEST(ComponentInformationTranslationTest)
+UT_REGISTER_TEST(FactGroupUpdateSchedulerTest)
 UT_REGISTER_TEST(FactSystemTestGeneric)
 UT_REGISTER_TEST(FactSystemTestPX4)
 //UT_REGISTER_TEST(FileDialogTest)
 UT_REGISTER_TEST(GeoTest)
 UT_REGISTER_TEST(VehicleLinkManagerTest)
+UT_REGISTER_TEST(TrajectoryPointsTest)
 //UT_REGISTER_TEST(MessageBoxTest)
 UT_REGISTER_TEST(SendMavCommandWithSignallingTest)
 UT_REGISTER_TEST(SendMavCommandWithHandlerTest)
 UT_REGISTER_TEST(RequestMessageTest)
 UT_REGISTER_TEST(FTPManagerTest)
+UT_REGISTER_TEST(MAVLinkProtocolTest)
 UT_REGISTER_TEST(InitialConnectTest)
 UT_REGISTER_TEST(MissionItemTest)
 UT_REGISTER_TEST(SimpleMissionItemTest)
@@ -73,11 +95,15 @@ UT_REGISTER_TEST(MissionManagerTest)
 //UT_REGISTER_TEST(FileManagerTest)
 UT_REGISTER_TEST(ParameterManagerTest)
 UT_REGISTER_TEST(MissionCommandTreeTest)
-//UT_REGISTER_TEST(LogDownloadTest)
+UT_REGISTER_TEST(LogDownloadTest)
+UT_REGISTER_TEST(MAVLinkChartSeriesTest)
+UT_REGISTER_TEST(TLogAnalyzerTest)
+UT_REGISTER_TEST(ULogReaderTest)
 UT_REGISTER_TEST(SurveyComplexItemTest)
 UT_REGISTER_TEST(CameraSectionTest)
 UT_REGISTER_TEST(SpeedSectionTest)
 UT_REGISTER_TEST(PlanMasterControllerTest)
+UT_REGISTER_TEST(PlanUndoHistoryTest)
 UT_REGISTER_TEST(MissionSettingsTest)
 UT_REGISTER_TEST(QGCMapPolygonTest)
 UT_REGISTER_TEST(AudioOutputTest)
@@ -88,8 +114,20 @@ UT_REGISTER_TEST(QGCMapPolylineTest)
 UT_REGISTER_TEST(CameraCalcTest)
 UT_REGISTER_TEST(FWLandingPatternTest)
 UT_REGISTER_TEST(LandingComplexItemTest)
+UT_REGISTER_TEST(QGCTileCacheWorkerTest)
+UT_REGISTER_TEST(QGCTileDownloadSchedulerTest)
+UT_REGISTER_TEST(TerrainDEMTest)
+UT_REGISTER_TEST(TerrainQueryTest)
+UT_REGISTER_TEST(TerrainTileTest)
 
 UT_REGISTER_TEST_STANDALONE(MissionCommandTreeEditorTest)
+UT_REGISTER_TEST_STANDALONE(FTPManagerBenchmark)
+UT_REGISTER_TEST_STANDALONE(LogDownloadBenchmark)
+UT_REGISTER_TEST_STANDALONE(MAVLinkProtocolBenchmark)
+UT_REGISTER_TEST_STANDALONE(MissionControllerBenchmark)
+UT_REGISTER_TEST_STANDALONE(ParameterManagerBenchmark)
+UT_REGISTER_TEST_STANDALONE(QGCTileCacheWorkerBenchmark)
+UT_REGISTER_TEST_STANDALONE(TerrainDEMBenchmark)
 
 // List of unit test which are currently disabled.
 // If disabling a new test, include reason in comment.
@@ -0,0 +1,60 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FTPManagerBenchmark.h"
+#include "FTPManagerTest.h"
+#include "MockLink.h"
+#include "FTPManager.h"
+
+void FTPManagerBenchmark::cleanup(void)
+{
+    _disconnectMockLink();
+}
+
+void FTPManagerBenchmark::_throughputBenchmark_data(void)
+{
+    QTest::addColumn<int>("latencyMSecs");
+    QTest::addColumn<double>("lossRate");
+
+    for (int latencyMSecs: { 0, 20 }) {
+        for (double lossRate: { 0.0, 0.05, 0.2 }) {
+            QTest::addRow("latency %dms loss %d%%", latencyMSecs, static_cast<int>(lossRate * 100)) << latencyMSecs << lossRate;
+        }
+    }
+}
+
+void FTPManagerBenchmark::_throughputBenchmark(void)
+{
+    QFETCH(int,     latencyMSecs);
+    QFETCH(double,  lossRate);
+
+    const int fileSize = 32 * 1024;
+
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager  = _vehicle->ftpManager();
+    QString     filename    = QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(fileSize);
+
+    _mockLink->mockLinkFTP()->setLossRate(lossRate);
+    _mockLink->mockLinkFTP()->setResponseLatencyMSecs(latencyMSecs);
+
+    QSignalSpy spyDownloadComplete(ftpManager, &FTPManager::downloadComplete);
+
+    QBENCHMARK_ONCE {
+        ftpManager->download(MAV_COMP_ID_AUTOPILOT1, filename, QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+        QCOMPARE(spyDownloadComplete.wait(60000), true);
+    }
+
+    // void downloadComplete   (const QString& file, const QString& errorMsg, int downloadId);
+    QCOMPARE(spyDownloadComplete.count(), 1);
+    QList<QVariant> arguments = spyDownloadComplete.takeFirst();
+    QVERIFY2(arguments[1].toString().isEmpty(), qPrintable(arguments[1].toString()));
+
+    FTPManagerTest::verifyFileSizeAndDelete(arguments[0].toString(), fileSize);
+}
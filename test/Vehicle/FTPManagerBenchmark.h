@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// FTP download throughput over a simulated slow and lossy link. Registered standalone, run it with:
+///     QGroundControl --unittest:FTPManagerBenchmark
+class FTPManagerBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _throughputBenchmark_data  (void);
+    void _throughputBenchmark       (void);
+
+    // Overrides from UnitTest
+    void cleanup(void) override;
+};
@@ -32,7 +32,7 @@ void FTPManagerTest::_testCaseWorker(const TestCase_t& testCase)
 
     QSignalSpy spyDownloadComplete(ftpManager, &FTPManager::downloadComplete);
 
-    // void downloadComplete   (const QString& file, const QString& errorMsg);
+    // void downloadComplete   (const QString& file, const QString& errorMsg, int downloadId);
     ftpManager->download(MAV_COMP_ID_AUTOPILOT1, testCase.file, QStandardPaths::writableLocation(QStandardPaths::TempLocation));
 
     QCOMPARE(spyDownloadComplete.wait(10000), true);
@@ -58,11 +58,11 @@ void FTPManagerTest::_sizeTestCaseWorker(int fileSize)
     QCOMPARE(spyDownloadComplete.wait(10000), true);
     QCOMPARE(spyDownloadComplete.count(), 1);
 
-    // void downloadComplete   (const QString& file, const QString& errorMsg);
+    // void downloadComplete   (const QString& file, const QString& errorMsg, int downloadId);
     QList<QVariant> arguments = spyDownloadComplete.takeFirst();
     QVERIFY(arguments[1].toString().isEmpty());
 
-    _verifyFileSizeAndDelete(arguments[0].toString(), fileSize);
+    verifyFileSizeAndDelete(arguments[0].toString(), fileSize);
 
     _disconnectMockLink();
 }
@@ -111,16 +111,57 @@ void FTPManagerTest::_testLostPackets(void)
     QCOMPARE(spyDownloadComplete.wait(10000), true);
     QCOMPARE(spyDownloadComplete.count(), 1);
 
-    // void downloadComplete   (const QString& file, const QString& errorMsg);
+    // void downloadComplete   (const QString& file, const QString& errorMsg, int downloadId);
     QList<QVariant> arguments = spyDownloadComplete.takeFirst();
     QVERIFY(arguments[1].toString().isEmpty());
 
-    _verifyFileSizeAndDelete(arguments[0].toString(), fileSize);
+    verifyFileSizeAndDelete(arguments[0].toString(), fileSize);
 
     _disconnectMockLink();
 }
 
-void FTPManagerTest::_verifyFileSizeAndDelete(const QString& filename, int expectedSize)
+void FTPManagerTest::_testConcurrentDownloads(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager*     ftpManager  = _vehicle->ftpManager();
+    MockLinkFTP*    mockLinkFTP = _mockLink->mockLinkFTP();
+    const QString   toDir       = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+
+    // Server supports fewer sessions than the client will try to use, so some downloads must wait in the queue
+    mockLinkFTP->setMaxSessions(2);
+    mockLinkFTP->enableRandromDrops(true);
+
+    QSignalSpy spyDownloadComplete(ftpManager, &FTPManager::downloadComplete);
+
+    QMap<int, int> downloadSizes;   // Key: download id, Value: file size
+    for (int i=0; i<5; i++) {
+        const int fileSize      = (i + 1) * 1024 + i;
+        const QString filename  = QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(fileSize);
+        const int downloadId    = ftpManager->download(MAV_COMP_ID_AUTOPILOT1, filename, toDir, QStringLiteral("FTPManagerTest-%1").arg(i));
+        QVERIFY(downloadId != 0);
+        downloadSizes[downloadId] = fileSize;
+    }
+    QCOMPARE(ftpManager->activeDownloadCount(), 5);
+
+    while (spyDownloadComplete.count() < downloadSizes.count()) {
+        QVERIFY(spyDownloadComplete.wait(10000));
+    }
+    QCOMPARE(spyDownloadComplete.count(), downloadSizes.count());
+    QCOMPARE(ftpManager->activeDownloadCount(), 0);
+    QCOMPARE(mockLinkFTP->sessionCount(), 0);
+
+    // void downloadComplete(const QString& file, const QString& errorMsg, int downloadId);
+    for (const QList<QVariant>& arguments: spyDownloadComplete) {
+        QVERIFY(arguments[1].toString().isEmpty());
+        QVERIFY(downloadSizes.contains(arguments[2].toInt()));
+        verifyFileSizeAndDelete(arguments[0].toString(), downloadSizes.take(arguments[2].toInt()));
+    }
+
+    _disconnectMockLink();
+}
+
+void FTPManagerTest::verifyFileSizeAndDelete(const QString& filename, int expectedSize)
 {
     QFileInfo fileInfo(filename);
 
@@ -15,8 +15,13 @@ class FTPManagerTest : public UnitTest
 {
     Q_OBJECT
 
+public:
+    /// Verifies the contents of a file downloaded from MockLinkFTP, then deletes it
+    static void verifyFileSizeAndDelete(const QString& filename, int expectedSize);
+
 private slots:
     void _testLostPackets           (void);
+    void _testConcurrentDownloads   (void);
 
     // Overrides from UnitTest
     void cleanup(void) override;
@@ -30,7 +35,6 @@ private:
 
     void _testCaseWorker            (const TestCase_t& testCase);
     void _sizeTestCaseWorker        (int fileSize);
-    void _verifyFileSizeAndDelete   (const QString& filename, int expectedSize);
 
     static const TestCase_t _rgTestCases[];
 };
@@ -0,0 +1,186 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryPointsTest.h"
+#include "TrajectoryPoints.h"
+#include "Vehicle.h"
+#include "QGCApplication.h"
+
+#include <QSignalSpy>
+
+#include <limits>
+
+static const QGeoCoordinate _startCoordinate(47.6, -122.1);
+
+TrajectoryPointsTest::TrajectoryPointsTest(void)
+{
+
+}
+
+void TrajectoryPointsTest::init(void)
+{
+    UnitTest::init();
+
+    _vehicle = new Vehicle(MAV_AUTOPILOT_PX4, MAV_TYPE_QUADROTOR, qgcApp()->toolbox()->firmwarePluginManager(), this);
+    _trajectory = new TrajectoryPoints(_vehicle, this);
+    _trajectory->start();
+}
+
+void TrajectoryPointsTest::cleanup(void)
+{
+    delete _trajectory;
+    delete _vehicle;
+    _trajectory = nullptr;
+    _vehicle    = nullptr;
+
+    UnitTest::cleanup();
+}
+
+/// Flies north, alternating 1 meter to each side of the track every 10 meters. Each position turns far enough to be
+/// a new trajectory point.
+QList<QGeoCoordinate> TrajectoryPointsTest::_addZigzag(int cPoints)
+{
+    QList<QGeoCoordinate> coordinates;
+    for (int i=0; i<cPoints; i++) {
+        const QGeoCoordinate coordinate = _startCoordinate.atDistanceAndAzimuth(i * 10.0, 0).atDistanceAndAzimuth(1, i % 2 ? 90 : -90);
+        emit _vehicle->coordinateChanged(coordinate);
+        coordinates.append(coordinate);
+    }
+    return coordinates;
+}
+
+void TrajectoryPointsTest::_testColinearPoints(void)
+{
+    QGeoCoordinate coordinate;
+    for (int i=0; i<100; i++) {
+        coordinate = _startCoordinate.atDistanceAndAzimuth(i * 10.0, 45);
+        emit _vehicle->coordinateChanged(coordinate);
+    }
+
+    // Straight line is the first point plus the last point which moves along with the vehicle
+    const QVariantList points = _trajectory->list();
+    QCOMPARE(points.count(), 2);
+    QVERIFY(points[0].value<QGeoCoordinate>().distanceTo(_startCoordinate) < 0.05);
+    QVERIFY(points[1].value<QGeoCoordinate>().distanceTo(coordinate) < 0.05);
+}
+
+void TrajectoryPointsTest::_testSimplification(void)
+{
+    const int cPoints = TrajectoryPoints::blockSize * 20;
+    const QList<QGeoCoordinate> coordinates = _addZigzag(cPoints);
+    QCOMPARE(_trajectory->count(), cPoints);
+
+    // Full resolution
+    QVariantList points = _trajectory->list();
+    QCOMPARE(points.count(), cPoints);
+    for (int i=0; i<cPoints; i++) {
+        QVERIFY(points[i].value<QGeoCoordinate>().distanceTo(coordinates[i]) < 0.05);
+    }
+
+    // The 1 meter zigzag isn't visible at 10 meters per pixel. Only the end points of the simplified blocks and the
+    // points which haven't been simplified yet are left.
+    _trajectory->setResolution(10);
+    points = _trajectory->list();
+    QVERIFY(points.count() <= cPoints / 10);
+    QVERIFY(points.first().value<QGeoCoordinate>().distanceTo(coordinates.first()) < 0.05);
+    QVERIFY(points.last().value<QGeoCoordinate>().distanceTo(coordinates.last()) < 0.05);
+
+    // Simplification only drops points, it never moves them
+    for (int i=0; i<points.count(); i++) {
+        double nearest = std::numeric_limits<double>::max();
+        for (const QGeoCoordinate& coordinate: coordinates) {
+            nearest = qMin(nearest, points[i].value<QGeoCoordinate>().distanceTo(coordinate));
+        }
+        QVERIFY(nearest < 0.05);
+    }
+}
+
+void TrajectoryPointsTest::_testResolutionReset(void)
+{
+    _addZigzag(10);
+    QSignalSpy spyReset(_trajectory, &TrajectoryPoints::pointsReset);
+
+    // Only a change of simplification level requires a reload
+    _trajectory->setResolution(TrajectoryPoints::levelTolerance(1));
+    QCOMPARE(spyReset.count(), 1);
+    _trajectory->setResolution(TrajectoryPoints::levelTolerance(1) * 1.5);
+    QCOMPARE(spyReset.count(), 1);
+    _trajectory->setResolution(TrajectoryPoints::levelTolerance(1) / 2);
+    QCOMPARE(spyReset.count(), 2);
+
+    // Points added at full resolution don't reset
+    _addZigzag(TrajectoryPoints::blockSize * 2);
+    QCOMPARE(spyReset.count(), 2);
+
+    // Simplified blocks only replace their range
+    _trajectory->setResolution(TrajectoryPoints::levelTolerance(2));
+    QCOMPARE(spyReset.count(), 3);
+    QSignalSpy spyReplaced(_trajectory, &TrajectoryPoints::pointsReplaced);
+    _addZigzag(TrajectoryPoints::blockSize * 2);
+    QCOMPARE(spyReset.count(), 3);
+    QVERIFY(spyReplaced.count() > 0);
+}
+
+void TrajectoryPointsTest::_testPointsReplaced(void)
+{
+    // Keep a copy of the trail the same way the map does
+    QList<QGeoCoordinate> path;
+    connect(_trajectory, &TrajectoryPoints::pointAdded,      this, [&path](QGeoCoordinate coordinate) { path.append(coordinate); });
+    connect(_trajectory, &TrajectoryPoints::updateLastPoint, this, [&path](QGeoCoordinate coordinate) { path.last() = coordinate; });
+    connect(_trajectory, &TrajectoryPoints::pointsReplaced,  this, [&path](int first, int count, QVariantList coordinates) {
+        QVERIFY(coordinates.count() <= count);
+        QVERIFY(first + count < path.count());
+        path.remove(first, count);
+        for (int i=0; i<coordinates.count(); i++) {
+            path.insert(first + i, coordinates[i].value<QGeoCoordinate>());
+        }
+    });
+    connect(_trajectory, &TrajectoryPoints::pointsReset,     this, [this, &path]() {
+        path.clear();
+        for (const QVariant& point: _trajectory->list()) {
+            path.append(point.value<QGeoCoordinate>());
+        }
+    });
+
+    auto verifyPath = [this, &path]() {
+        const QVariantList points = _trajectory->list();
+        QCOMPARE(path.count(), points.count());
+        for (int i=0; i<points.count(); i++) {
+            QVERIFY(path[i].distanceTo(points[i].value<QGeoCoordinate>()) < 0.05);
+        }
+    };
+
+    _trajectory->setResolution(TrajectoryPoints::levelTolerance(1));
+    _addZigzag(TrajectoryPoints::blockSize * 3 + 10);
+    verifyPath();
+
+    _trajectory->setResolution(TrajectoryPoints::levelTolerance(3));
+    _addZigzag(TrajectoryPoints::blockSize * 3 + 10);
+    verifyPath();
+
+    _trajectory->setResolution(0);
+    _addZigzag(TrajectoryPoints::blockSize * 2);
+    verifyPath();
+}
+
+void TrajectoryPointsTest::_testBoundedStorage(void)
+{
+    const int cPoints = TrajectoryPoints::maxPoints * 3;
+    const QList<QGeoCoordinate> coordinates = _addZigzag(cPoints);
+    QVERIFY(_trajectory->count() <= TrajectoryPoints::maxPoints);
+
+    // Recent detail is kept, older parts of the trail lose detail first
+    const QVariantList points = _trajectory->list();
+    QCOMPARE(points.count(), _trajectory->count());
+    const int cRecent = TrajectoryPoints::maxPoints / 4;
+    for (int i=1; i<=cRecent; i++) {
+        QVERIFY(points[points.count() - i].value<QGeoCoordinate>().distanceTo(coordinates[cPoints - i]) < 0.05);
+    }
+    QVERIFY(points.first().value<QGeoCoordinate>().distanceTo(coordinates.first()) < 0.05);
+}
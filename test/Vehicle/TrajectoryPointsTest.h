@@ -0,0 +1,42 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QGeoCoordinate>
+
+class Vehicle;
+class TrajectoryPoints;
+
+class TrajectoryPointsTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TrajectoryPointsTest(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _testColinearPoints    (void);
+    void _testSimplification    (void);
+    void _testResolutionReset   (void);
+    void _testPointsReplaced    (void);
+    void _testBoundedStorage    (void);
+
+private:
+    QList<QGeoCoordinate> _addZigzag(int cPoints);
+
+    Vehicle*            _vehicle    = nullptr;
+    TrajectoryPoints*   _trajectory = nullptr;
+};
@@ -0,0 +1,47 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkProtocolBenchmark.h"
+#include "MAVLinkProtocolTest.h"
+#include "MAVLinkParser.h"
+#include "LinkManager.h"
+#include "QGCApplication.h"
+
+#include <QElapsedTimer>
+
+/// Parser throughput on recorded multi vehicle traffic, reported in frames/sec
+void MAVLinkProtocolBenchmark::_parseFramesBenchmark(void)
+{
+    // The parser is benchmarked on its own, using a channel which is not in use by any link
+    LinkManager*    linkManager = qgcApp()->toolbox()->linkManager();
+    uint8_t         channel     = linkManager->allocateMavlinkChannel();
+    QVERIFY(channel != LinkManager::invalidMavlinkChannel());
+
+    int             frameCount      = 0;
+    QByteArray      traffic         = MAVLinkProtocolTest::recordedTraffic(channel, 8, 500, frameCount);
+    MAVLinkParser   parser(channel);
+    QElapsedTimer   timer;
+    qint64          elapsedNSecs    = 0;
+    qint64          parsedFrames    = 0;
+
+    QBENCHMARK {
+        MAVLinkMessageBatch batch;
+        timer.start();
+        parser.parse(traffic, batch);
+        elapsedNSecs += timer.nsecsElapsed();
+        parsedFrames += batch.count();
+        QCOMPARE(batch.count(), frameCount);
+    }
+
+    linkManager->freeMavlinkChannel(channel);
+
+    // Replaces the time per iteration from QBENCHMARK with the rate
+    QVERIFY(elapsedNSecs > 0);
+    QTest::setBenchmarkResult((parsedFrames * 1e9) / elapsedNSecs, QTest::FramesPerSecond);
+}
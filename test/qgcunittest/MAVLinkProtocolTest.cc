@@ -0,0 +1,150 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkProtocolTest.h"
+#include "MAVLinkProtocol.h"
+#include "MAVLinkParser.h"
+#include "LinkManager.h"
+#include "QGCApplication.h"
+#include "Vehicle.h"
+
+/// Builds a byte stream which looks like what a mesh radio with multiple vehicles delivers. There are no heartbeats
+/// in the stream so that no additional vehicles get created. System ids start above the MockLink vehicle id.
+QByteArray MAVLinkProtocolTest::recordedTraffic(uint8_t channel, int vehicleCount, int framesPerVehicle, int& frameCount)
+{
+    QByteArray          traffic;
+    mavlink_message_t   msg;
+    uint8_t             buffer[MAVLINK_MAX_PACKET_LEN];
+
+    frameCount = 0;
+    for (int frame=0; frame<framesPerVehicle; frame++) {
+        for (int vehicle=0; vehicle<vehicleCount; vehicle++) {
+            uint8_t sysid = static_cast<uint8_t>(200 + vehicle);
+
+            switch (frame % 3) {
+            case 0:
+                mavlink_msg_attitude_pack_chan(sysid, MAV_COMP_ID_AUTOPILOT1, channel, &msg, frame * 20, 0.1f, 0.2f, 0.3f, 0.01f, 0.02f, 0.03f);
+                break;
+            case 1:
+                mavlink_msg_global_position_int_pack_chan(sysid, MAV_COMP_ID_AUTOPILOT1, channel, &msg, frame * 20, 473977420, 85455940, 500000, 50000, 100, 100, 0, 9000);
+                break;
+            default:
+                mavlink_msg_vfr_hud_pack_chan(sysid, MAV_COMP_ID_AUTOPILOT1, channel, &msg, 12.0f, 11.5f, 90, 50, 500.0f, 0.5f);
+                break;
+            }
+            int len = mavlink_msg_to_send_buffer(buffer, &msg);
+            traffic.append(reinterpret_cast<const char*>(buffer), len);
+            frameCount++;
+        }
+    }
+
+    return traffic;
+}
+
+void MAVLinkProtocolTest::_batchDelivery_test(void)
+{
+    _connectMockLink();
+
+    MAVLinkProtocol*    mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
+    int                 expectedFrames  = 0;
+    QByteArray          traffic         = recordedTraffic(_mockLink->mavlinkChannel(), 8, 30, expectedFrames);
+    int                 batchCount      = 0;
+    int                 frameCount      = 0;
+    QList<uint32_t>     firstVehicleMsgIds;
+
+    QSignalSpy spyBatch(mavlinkProtocol, &MAVLinkProtocol::messageBatchReceived);
+    auto conn = connect(mavlinkProtocol, &MAVLinkProtocol::messageBatchReceived, this, [&](LinkInterface* link, const MAVLinkMessageBatch& batch) {
+        if (link != _mockLink) {
+            return;
+        }
+        bool injectedBatch = false;
+        for (const mavlink_message_t& message : batch) {
+            if (message.sysid < 200) {
+                // Traffic generated by the MockLink vehicle itself
+                continue;
+            }
+            if (message.sysid == 200) {
+                firstVehicleMsgIds.append(message.msgid);
+            }
+            injectedBatch = true;
+            frameCount++;
+        }
+        if (injectedBatch) {
+            batchCount++;
+        }
+    });
+
+    // Decoding happens on the link's parser thread, so delivery is asynchronous
+    mavlinkProtocol->receiveBytes(_mockLink, traffic);
+    for (int i=0; i<10 && frameCount < expectedFrames; i++) {
+        spyBatch.wait(500);
+    }
+    disconnect(conn);
+
+    // All frames from a single read come through in a single batch, in arrival order
+    QCOMPARE(batchCount, 1);
+    QCOMPARE(frameCount, expectedFrames);
+    QCOMPARE(firstVehicleMsgIds.count(), 30);
+    for (int i=0; i<firstVehicleMsgIds.count(); i+=3) {
+        QCOMPARE(firstVehicleMsgIds[i],     static_cast<uint32_t>(MAVLINK_MSG_ID_ATTITUDE));
+        QCOMPARE(firstVehicleMsgIds[i + 1], static_cast<uint32_t>(MAVLINK_MSG_ID_GLOBAL_POSITION_INT));
+        QCOMPARE(firstVehicleMsgIds[i + 2], static_cast<uint32_t>(MAVLINK_MSG_ID_VFR_HUD));
+    }
+
+    _disconnectMockLink();
+}
+
+void MAVLinkProtocolTest::_messageDispatch_test(void)
+{
+    _connectMockLink();
+    QVERIFY(_vehicle);
+
+    // FactGroups only see the messages they registered for
+    QVERIFY(_vehicle->gpsFactGroup()->handledMessageIds().contains(MAVLINK_MSG_ID_GPS_RAW_INT));
+    QVERIFY(!_vehicle->gpsFactGroup()->handledMessageIds().contains(MAVLINK_MSG_ID_GPS2_RAW));
+    QCOMPARE(_vehicle->gps2FactGroup()->handledMessageIds(), QList<uint32_t>({ MAVLINK_MSG_ID_GPS2_RAW }));
+
+    // Every message which reaches the vehicle is counted against its message id
+    _vehicle->resetMessageDispatchStats();
+    QSignalSpy spyReceived(_vehicle, &Vehicle::messagesReceivedChanged);
+    for (int i=0; i<10 && !_vehicle->messageDispatchStats().contains(MAVLINK_MSG_ID_HEARTBEAT); i++) {
+        spyReceived.wait(500);
+    }
+    QVERIFY(_vehicle->messageDispatchStats().contains(MAVLINK_MSG_ID_HEARTBEAT));
+    QVERIFY(_vehicle->messageDispatchStats()[MAVLINK_MSG_ID_HEARTBEAT].count > 0);
+
+    _disconnectMockLink();
+}
+
+void MAVLinkProtocolTest::_parserChannelStatus_test(void)
+{
+    // The channel status belongs to the send path on the main thread, parsing on the worker thread must leave it alone
+    LinkManager*    linkManager = qgcApp()->toolbox()->linkManager();
+    uint8_t         channel     = linkManager->allocateMavlinkChannel();
+    QVERIFY(channel != LinkManager::invalidMavlinkChannel());
+
+    int                 frameCount      = 0;
+    QByteArray          traffic         = recordedTraffic(channel, 8, 30, frameCount);
+    mavlink_status_t*   channelStatus   = mavlink_get_channel_status(channel);
+    channelStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    const mavlink_status_t savedStatus = *channelStatus;
+
+    // Split the traffic so frames are completed across calls
+    MAVLinkParser       parser(channel);
+    MAVLinkMessageBatch batch;
+    parser.parse(traffic.left(traffic.size() / 2 + 3), batch);
+    parser.parse(traffic.mid(traffic.size() / 2 + 3), batch);
+    QCOMPARE(batch.count(), frameCount);
+    QCOMPARE(parser.totalLoss(), static_cast<uint64_t>(0));
+    QVERIFY(!parser.incomingMavlink1());
+    QVERIFY(memcmp(&savedStatus, channelStatus, sizeof(savedStatus)) == 0);
+
+    channelStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    linkManager->freeMavlinkChannel(channel);
+}
@@ -0,0 +1,29 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+/// Tests for MAVLinkProtocol receive path
+class MAVLinkProtocolTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    /// Builds a byte stream which looks like what a mesh radio with multiple vehicles delivers
+    ///     @param frameCount Returns the number of frames in the stream
+    static QByteArray recordedTraffic(uint8_t channel, int vehicleCount, int framesPerVehicle, int& frameCount);
+
+private slots:
+    void _batchDelivery_test    (void);
+    void _messageDispatch_test  (void);
+    void _parserChannelStatus_test(void);
+};